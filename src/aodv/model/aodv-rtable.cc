@@ -206,7 +206,8 @@ RoutingTableEntry::Print (Ptr<OutputStreamWrapper> stream) const
  */
 
 RoutingTable::RoutingTable (Time t)
-  : m_badLinkLifetime (t)
+  : m_badLinkLifetime (t),
+    m_nextPurge (Time::Max ())
 {
 }
 
@@ -270,6 +271,10 @@ RoutingTable::AddRoute (RoutingTableEntry & rt)
     }
   std::pair<std::map<Ipv4Address, RoutingTableEntry>::iterator, bool> result =
     m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), rt));
+  if (result.second)
+    {
+      UpdateNextPurge (rt);
+    }
   return result.second;
 }
 
@@ -290,6 +295,7 @@ RoutingTable::Update (RoutingTableEntry & rt)
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " set RreqCnt to 0");
       i->second.SetRreqCnt (0);
     }
+  UpdateNextPurge (i->second);
   return true;
 }
 
@@ -306,6 +312,7 @@ RoutingTable::SetEntryState (Ipv4Address id, RouteFlags state)
     }
   i->second.SetFlag (state);
   i->second.SetRreqCnt (0);
+  UpdateNextPurge (i->second);
   NS_LOG_LOGIC ("Route set entry state to " << id << ": new state is " << state);
   return true;
 }
@@ -342,6 +349,7 @@ RoutingTable::InvalidateRoutesWithDst (const std::map<Ipv4Address, uint32_t> & u
             {
               NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
               i->second.Invalidate (m_badLinkLifetime);
+              UpdateNextPurge (i->second);
             }
         }
     }
@@ -375,36 +383,28 @@ void
 RoutingTable::Purge ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_ipv4AddressEntry.empty ())
+  if (m_ipv4AddressEntry.empty () || Simulator::Now () <= m_nextPurge)
     {
+      // no entry has expired
       return;
     }
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
+  Purge (m_ipv4AddressEntry);
+
+  m_nextPurge = Time::Max ();
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
+         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
     {
-      if (i->second.GetLifeTime () < Seconds (0))
-        {
-          if (i->second.GetFlag () == INVALID)
-            {
-              std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
-              ++i;
-              m_ipv4AddressEntry.erase (tmp);
-            }
-          else if (i->second.GetFlag () == VALID)
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-              ++i;
-            }
-          else
-            {
-              ++i;
-            }
-        }
-      else
-        {
-          ++i;
-        }
+      UpdateNextPurge (i->second);
+    }
+}
+
+void
+RoutingTable::UpdateNextPurge (RoutingTableEntry const & rt)
+{
+  // entries in search are neither invalidated nor deleted on expiration
+  if (rt.GetFlag () != IN_SEARCH)
+    {
+      m_nextPurge = std::min (m_nextPurge, Simulator::Now () + rt.GetLifeTime ());
     }
 }
 
@@ -468,8 +468,12 @@ public:
   void Clear ()
   {
     m_ipv4AddressEntry.clear ();
+    m_nextPurge = Time::Max ();
   }
-  /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
+  /**
+   * Delete all outdated entries and invalidate valid entry if Lifetime is expired.
+   * The table is only scanned once the earliest lifetime of its entries has expired.
+   */
   void Purge ();
   /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout period)
    * \param neighbor - neighbor address link to which assumed to be unidirectional
@@ -488,6 +492,13 @@ private:
   std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
   /// Deletion time for invalid routes
   Time m_badLinkLifetime;
+  /// Earliest expiration time of the valid and invalid entries (a lower bound)
+  Time m_nextPurge;
+  /**
+   * Take the lifetime of a new or modified entry into account for the next purge
+   * \param rt the routing table entry
+   */
+  void UpdateNextPurge (RoutingTableEntry const & rt);
   /**
    * const version of Purge, for use by Print() method
    * \param table the routing table entry to purge
@@ -24,6 +24,10 @@ namespace ns3
 {
 
 AodvTrustEntry::AodvTrustEntry ()
+  : rreq (0),
+    rply (0),
+    err (0),
+    hello (0)
 {
 }
 
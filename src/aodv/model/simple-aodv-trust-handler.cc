@@ -20,6 +20,11 @@
 
 #include "simple-aodv-trust-handler.h"
 #include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
 
 namespace ns3 {
 
@@ -30,7 +35,7 @@ NS_OBJECT_ENSURE_REGISTERED(SimpleAodvTrustHandler);
 
 TypeId SimpleAodvTrustHandler::GetTypeId (void)
 {
-  static TypeId tid = TypeId ("ns3::aodv::SimpleAodvTrustHandler").SetParent<Object> ().SetGroupName ("Aodv").AddConstructor<
+  static TypeId tid = TypeId ("ns3::aodv::SimpleAodvTrustHandler").SetParent<Ipv4TrustHandler> ().SetGroupName ("Aodv").AddConstructor<
       SimpleAodvTrustHandler> ();
   return tid;
 }
@@ -43,6 +48,12 @@ SimpleAodvTrustHandler::~SimpleAodvTrustHandler ()
 {
 }
 
+void SimpleAodvTrustHandler::DoDispose (void)
+{
+  m_trustParameters.clear ();
+  Ipv4TrustHandler::DoDispose ();
+}
+
 bool SimpleAodvTrustHandler::OnReceivePromiscuousCallback (Ptr<NetDevice> device,
                                                            Ptr<const Packet> packet,
                                                            uint16_t protocol,
@@ -50,71 +61,123 @@ bool SimpleAodvTrustHandler::OnReceivePromiscuousCallback (Ptr<NetDevice> device
                                                            const Address &to,
                                                            NetDevice::PacketType packetType)
 {
-  std::cout << "JUDE ADDED FROM THE TRUST FRAMEWORK" << std::endl;
+  NS_LOG_FUNCTION(device << packet << protocol << &from << &to << packetType);
 
+  if (protocol != Ipv4L3Protocol::PROT_NUMBER)
+    {
+      return true;
+    }
+  Ptr<Packet> p = packet->Copy ();
+  Ipv4Header ipv4Header;
+  p->RemoveHeader (ipv4Header);
+  if (ipv4Header.GetProtocol () != UdpL4Protocol::PROT_NUMBER
+      || ipv4Header.GetFragmentOffset () != 0)
+    {
+      return true;
+    }
+  UdpHeader udpHeader;
+  p->RemoveHeader (udpHeader);
+  if (udpHeader.GetDestinationPort () != RoutingProtocol::AODV_PORT)
+    {
+      return true;
+    }
   TypeHeader tHeader;
-  packet->PeekHeader (tHeader);
+  p->RemoveHeader (tHeader);
+  if (!tHeader.IsValid ())
+    {
+      return true;
+    }
+
+  AodvTrustEntry &entry = m_trustParameters[GetNeighbourIndex (ipv4Header.GetSource ())];
   switch (tHeader.Get ())
     {
     case AODVTYPE_RREQ:
       {
-        // increment RREQ count
-        tHeader.Print (std::cout);
+        entry.SetRreq (entry.GetRreq () + 1);
         break;
       }
     case AODVTYPE_RREP:
       {
-        // increment RPLY count
-        tHeader.Print (std::cout);
+        RrepHeader rrepHeader;
+        p->PeekHeader (rrepHeader);
+        // hello messages are RREPs whose destination is their origin
+        if (rrepHeader.GetDst () == rrepHeader.GetOrigin ())
+          {
+            entry.SetHello (entry.GetHello () + 1);
+          }
+        else
+          {
+            entry.SetRply (entry.GetRply () + 1);
+          }
         break;
       }
     case AODVTYPE_RERR:
-      {
-        // increment ERR count
-        tHeader.Print (std::cout);
-        break;
-      }
     case AODVTYPE_RREP_ACK:
       {
-        // increment ERR count
-        tHeader.Print (std::cout);
+        entry.SetErr (entry.GetErr () + 1);
         break;
       }
     }
+  return true;
+}
 
-  NS_LOG_FUNCTION(device << packet << protocol << &from << &to << packetType);
-  bool found = false;
+double SimpleAodvTrustHandler::ComputeTrust (uint32_t index)
+{
+  AodvTrustEntry &entry = m_trustParameters[index];
+  if (entry.GetRreq () == 0)
+    {
+      return 0;
+    }
+  return entry.GetRply () * 1.0 / entry.GetRreq ();
+}
 
-  return found;
+void SimpleAodvTrustHandler::NotifyNewNeighbour (uint32_t index)
+{
+  if (index >= m_trustParameters.size ())
+    {
+      m_trustParameters.resize (index + 1);
+    }
+  m_trustParameters[index] = AodvTrustEntry ();
 }
 
 int32_t SimpleAodvTrustHandler::calculateTrust (Address address)
 {
-
   Ipv4Address ipv4Address = Ipv4Address::ConvertFrom (address);
-  AodvTrustEntry m_aodvTrustEntry = m_trustParameters[ipv4Address];
-/*
-  if (m_aodvTrustEntry == NULL)
+  uint32_t index;
+  if (!GetTrustTable ().LookupIndex (ipv4Address, index))
     {
       return 0;
-    }*/
-  double trustDouble = m_aodvTrustEntry.GetRply () / m_aodvTrustEntry.GetRreq () * 1.0;
+    }
+  CheckNeighbour (index);
+  double trustDouble = ComputeTrust (index);
 
   // Update the value in Trust Table here
-//  Ptr<Node> src;
-  Ptr<Node> node = GetObject<Node> ();
-  Ptr<Ipv4RoutingProtocol> m_ipv4Routing;
-  m_ipv4Routing = Ipv4RoutingHelper::GetRouting<Ipv4RoutingProtocol> (node->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  Ipv4TrustEntry &record = GetTrustTable ().GetRecord (index);
+  record.SetTrustValue (trustDouble);
+  record.SetTimestamp (Simulator::Now ());
+  return static_cast<int32_t> (trustDouble);
+}
 
-  std::cout << trustDouble + 1 << std::endl; // to avoid unused variable compilation warning
-  return 1;
+bool SimpleAodvTrustHandler::LookupTrustParameters (Ipv4Address address, AodvTrustEntry &entry)
+{
+  uint32_t index;
+  if (!GetTrustTable ().LookupIndex (address, index))
+    {
+      return false;
+    }
+  CheckNeighbour (index);
+  entry = m_trustParameters[index];
+  return true;
 }
 
 void SimpleAodvTrustHandler::AttachPromiscuousCallbackToNode ()
 {
   Ptr<Node> node = GetObject<Node> ();
-  node->GetDevice (0)->SetPromiscReceiveCallback (ns3::MakeCallback (&SimpleAodvTrustHandler::OnReceivePromiscuousCallback,
-                                                                     this));
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      node->GetDevice (i)->SetPromiscReceiveCallback (ns3::MakeCallback (&SimpleAodvTrustHandler::OnReceivePromiscuousCallback,
+                                                                         this));
+    }
 }
 
 }
@@ -47,12 +47,16 @@ class SimpleAodvTrustHandler : public Ipv4TrustHandler
 {
 private:
   /**
-   * \brief map of AodvTrustEntry that contain runtime trust metrics
-   * for each directly connected nodes
+   * \brief AodvTrustEntry that contain runtime trust metrics for each
+   * directly connected nodes, indexed like the records of the trust table
    */
-  std::map<Ipv4Address, AodvTrustEntry> m_trustParameters;
+  std::vector<AodvTrustEntry> m_trustParameters;
 
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
   static TypeId GetTypeId (void);
 
   SimpleAodvTrustHandler ();
@@ -61,6 +65,8 @@ public:
   /**
    * \brief Promiscuous callback function which will hooked for nodes.
    * this function will be called upon a packet is being received to the node.
+   * It only counts the AODV messages sent by each neighbour; the trust
+   * values are recomputed periodically.
    * \returns bool true if the callback handle the packet successfully
    */
   bool OnReceivePromiscuousCallback (Ptr<NetDevice> device,
@@ -77,12 +83,24 @@ public:
    */
   int32_t calculateTrust (Address address);
 
+  /**
+   * \brief Get the AODV messages counted for a neighbour
+   * \param [in] address the neighbour IPv4 address
+   * \param [out] entry the counters of the neighbour, if it has a trust table record
+   * \returns true if the neighbour has a trust table record
+   */
+  bool LookupTrustParameters (Ipv4Address address, AodvTrustEntry &entry);
+
   /**
    * \brief Hook the promiscuous callback to the aggregated
    * node object
    */
   void AttachPromiscuousCallbackToNode ();
 
+protected:
+  virtual double ComputeTrust (uint32_t index);
+  virtual void NotifyNewNeighbour (uint32_t index);
+  virtual void DoDispose (void);
 };
 
 }
@@ -0,0 +1,456 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/aodv-helper.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/simple-aodv-trust-handler.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * Build an AODV message as seen by a promiscuous callback.
+ *
+ * \param source the IPv4 address of the sender
+ * \param type the AODV message type
+ * \param message the AODV message
+ * \param port the UDP destination port
+ * \returns the packet
+ */
+static Ptr<Packet>
+CreateAodvPacket (Ipv4Address source, MessageType type, const Header &message,
+                  uint16_t port = RoutingProtocol::AODV_PORT)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (message);
+  packet->AddHeader (TypeHeader (type));
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (RoutingProtocol::AODV_PORT);
+  udpHeader.SetDestinationPort (port);
+  packet->AddHeader (udpHeader);
+  Ipv4Header ipv4Header;
+  ipv4Header.SetSource (source);
+  ipv4Header.SetDestination (Ipv4Address ("10.255.255.255"));
+  ipv4Header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ipv4Header.SetPayloadSize (packet->GetSize ());
+  packet->AddHeader (ipv4Header);
+  return packet;
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Base class of the trust handler tests, feeding AODV messages to
+ * the handler of a node
+ */
+class AodvTrustHandlerTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the test case name
+   */
+  AodvTrustHandlerTestCase (std::string name);
+
+protected:
+  /**
+   * Create a node with AODV and a trust handler
+   */
+  void CreateNode (void);
+  /**
+   * Pass a packet to the promiscuous callback of the handler
+   * \param packet the packet
+   * \param protocol the L3 protocol of the packet
+   */
+  void Observe (Ptr<Packet> packet, uint16_t protocol = Ipv4L3Protocol::PROT_NUMBER);
+  /// Pass a RREQ of a neighbour to the handler
+  /// \param source the neighbour
+  void ObserveRreq (Ipv4Address source);
+  /// Pass a RREP, other than a hello message, of a neighbour to the handler
+  /// \param source the neighbour
+  void ObserveRrep (Ipv4Address source);
+  /**
+   * Get the trust value of a neighbour in the trust table
+   * \param address the neighbour
+   * \returns the trust value, or -1 if the neighbour has no record
+   */
+  double GetTrustValue (Ipv4Address address);
+  /**
+   * Get the counters of a neighbour
+   * \param address the neighbour
+   * \returns the counters, all zero if the neighbour has no record
+   */
+  AodvTrustEntry GetCounters (Ipv4Address address);
+
+  Ptr<Node> m_node;                        //!< The node
+  Ptr<SimpleAodvTrustHandler> m_handler;   //!< The trust handler of the node
+};
+
+AodvTrustHandlerTestCase::AodvTrustHandlerTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+AodvTrustHandlerTestCase::CreateNode (void)
+{
+  m_node = CreateObject<Node> ();
+  AodvHelper aodv;
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (aodv);
+  internet.Install (m_node);
+  m_handler = CreateObject<SimpleAodvTrustHandler> ();
+  m_node->AggregateObject (m_handler);
+}
+
+void
+AodvTrustHandlerTestCase::Observe (Ptr<Packet> packet, uint16_t protocol)
+{
+  Mac48Address mac;
+  m_handler->OnReceivePromiscuousCallback (m_node->GetDevice (0), packet, protocol, mac, mac,
+                                           NetDevice::PACKET_OTHERHOST);
+}
+
+void
+AodvTrustHandlerTestCase::ObserveRreq (Ipv4Address source)
+{
+  Observe (CreateAodvPacket (source, AODVTYPE_RREQ,
+                             RreqHeader (0, 0, 1, 1, Ipv4Address ("10.255.255.254"), 0, source, 1)));
+}
+
+void
+AodvTrustHandlerTestCase::ObserveRrep (Ipv4Address source)
+{
+  Observe (CreateAodvPacket (source, AODVTYPE_RREP,
+                             RrepHeader (0, 1, Ipv4Address ("10.255.255.254"), 1, source)));
+}
+
+double
+AodvTrustHandlerTestCase::GetTrustValue (Ipv4Address address)
+{
+  Ipv4TrustEntry entry;
+  if (!m_handler->GetTrustTable ().LookupTrustEntry (address, entry))
+    {
+      return -1;
+    }
+  return entry.GetTrustValue ();
+}
+
+AodvTrustEntry
+AodvTrustHandlerTestCase::GetCounters (Ipv4Address address)
+{
+  AodvTrustEntry entry;
+  m_handler->LookupTrustParameters (address, entry);
+  return entry;
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Check the AODV messages counted by the promiscuous callback
+ */
+class AodvTrustCountingTest : public AodvTrustHandlerTestCase
+{
+public:
+  AodvTrustCountingTest ();
+private:
+  virtual void DoRun (void);
+};
+
+AodvTrustCountingTest::AodvTrustCountingTest ()
+  : AodvTrustHandlerTestCase ("Count the AODV messages of the neighbours")
+{
+}
+
+void
+AodvTrustCountingTest::DoRun (void)
+{
+  CreateNode ();
+  Ipv4Address a ("10.0.0.1");
+  Ipv4Address b ("10.0.0.2");
+  Ipv4Address c ("10.0.0.3");
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      ObserveRreq (a);
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      ObserveRrep (a);
+    }
+  // hello messages are RREPs whose destination is their origin
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Observe (CreateAodvPacket (a, AODVTYPE_RREP, RrepHeader (0, 0, a, 1, a)));
+    }
+  RerrHeader rerrHeader;
+  rerrHeader.AddUnDestination (Ipv4Address ("10.0.0.9"), 1);
+  Observe (CreateAodvPacket (a, AODVTYPE_RERR, rerrHeader));
+  Observe (CreateAodvPacket (a, AODVTYPE_RREP_ACK, RrepAckHeader ()));
+  ObserveRreq (b);
+
+  // messages which are not AODV messages
+  Observe (CreateAodvPacket (c, AODVTYPE_RREQ,
+                             RreqHeader (0, 0, 1, 1, Ipv4Address ("10.255.255.254"), 0, c, 1), 9));
+  Observe (CreateAodvPacket (c, AODVTYPE_RREQ,
+                             RreqHeader (0, 0, 1, 1, Ipv4Address ("10.255.255.254"), 0, c, 1)), 0x0806);
+
+  AodvTrustEntry counters = GetCounters (a);
+  NS_TEST_EXPECT_MSG_EQ (counters.GetRreq (), 4, "Wrong number of RREQs");
+  NS_TEST_EXPECT_MSG_EQ (counters.GetRply (), 2, "Wrong number of RREPs");
+  NS_TEST_EXPECT_MSG_EQ (counters.GetHello (), 3, "Wrong number of hello messages");
+  NS_TEST_EXPECT_MSG_EQ (counters.GetErr (), 2, "Wrong number of RERRs and RREP-ACKs");
+  counters = GetCounters (b);
+  NS_TEST_EXPECT_MSG_EQ (counters.GetRreq (), 1, "Wrong number of RREQs");
+  NS_TEST_EXPECT_MSG_EQ (counters.GetRply () + counters.GetHello () + counters.GetErr (), 0,
+                         "Messages of another neighbour counted");
+  NS_TEST_EXPECT_MSG_EQ (m_handler->LookupTrustParameters (c, counters), false,
+                         "A neighbour which sent no AODV message has a record");
+
+  m_handler->RecomputeTrust ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetTrustValue (a), 0.5, 1e-9, "Wrong trust value");
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetTrustValue (b), 0, 1e-9, "Wrong trust value");
+
+  m_handler = 0;
+  m_node = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Check the metrics kept for the records of the trust table when
+ * the records are removed, or added by other objects than the handler
+ */
+class AodvTrustIndexReuseTest : public AodvTrustHandlerTestCase
+{
+public:
+  AodvTrustIndexReuseTest ();
+private:
+  virtual void DoRun (void);
+};
+
+AodvTrustIndexReuseTest::AodvTrustIndexReuseTest ()
+  : AodvTrustHandlerTestCase ("Reset the metrics of the reused trust table records")
+{
+}
+
+void
+AodvTrustIndexReuseTest::DoRun (void)
+{
+  CreateNode ();
+  Ipv4TrustTable &table = m_handler->GetTrustTable ();
+  NS_TEST_ASSERT_MSG_EQ (&table, &m_node->GetObject<Ipv4> ()->GetRoutingProtocol ()->m_trustTable,
+                         "The handler does not use the trust table of the routing protocol");
+
+  Ipv4Address a ("10.0.0.1");
+  Ipv4Address b ("10.0.0.2");
+  Ipv4Address c ("10.0.0.3");
+  Ipv4Address d ("10.0.0.4");
+
+  ObserveRreq (a);
+  ObserveRrep (a);
+  ObserveRrep (a);
+  uint32_t indexA;
+  NS_TEST_ASSERT_MSG_EQ (table.LookupIndex (a, indexA), true, "No record for the neighbour");
+
+  // the record of a is removed, and its row given to b
+  Ipv4TrustEntry entry;
+  entry.SetNeighbourAddress (a);
+  table.RemoveRecord (entry);
+  ObserveRreq (b);
+  uint32_t indexB;
+  NS_TEST_ASSERT_MSG_EQ (table.LookupIndex (b, indexB), true, "No record for the neighbour");
+  NS_TEST_EXPECT_MSG_EQ (indexB, indexA, "The row of the removed record is not reused");
+  NS_TEST_EXPECT_MSG_EQ (GetCounters (b).GetRply (), 0, "The RREPs of the removed neighbour are counted");
+  NS_TEST_EXPECT_MSG_EQ (GetCounters (b).GetRreq (), 1, "Wrong number of RREQs");
+
+  // records added to the table by another object than the handler, in a
+  // new row and in the row of a removed record
+  entry.SetNeighbourAddress (c);
+  table.AddRecord (entry);
+  ObserveRrep (b);
+  entry.SetNeighbourAddress (b);
+  table.RemoveRecord (entry);
+  entry.SetNeighbourAddress (d);
+  uint32_t indexD = table.AddRecord (entry);
+  NS_TEST_EXPECT_MSG_EQ (indexD, indexB, "The row of the removed record is not reused");
+
+  m_handler->RecomputeTrust ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetTrustValue (c), 0, 1e-9, "Wrong trust value");
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetTrustValue (d), 0, 1e-9, "Wrong trust value");
+  NS_TEST_EXPECT_MSG_EQ (GetCounters (d).GetRply (), 0, "The RREPs of the removed neighbour are counted");
+
+  ObserveRreq (d);
+  ObserveRrep (d);
+  m_handler->RecomputeTrust ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetTrustValue (d), 1, 1e-9, "Wrong trust value");
+
+  m_handler = 0;
+  m_node = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Check the metrics kept before the node has a routing protocol
+ */
+class AodvTrustLateRoutingTest : public AodvTrustHandlerTestCase
+{
+public:
+  AodvTrustLateRoutingTest ();
+private:
+  virtual void DoRun (void);
+};
+
+AodvTrustLateRoutingTest::AodvTrustLateRoutingTest ()
+  : AodvTrustHandlerTestCase ("Switch to the trust table of the routing protocol")
+{
+}
+
+void
+AodvTrustLateRoutingTest::DoRun (void)
+{
+  m_node = CreateObject<Node> ();
+  m_node->AddDevice (CreateObject<SimpleNetDevice> ());
+  m_handler = CreateObject<SimpleAodvTrustHandler> ();
+  m_node->AggregateObject (m_handler);
+
+  Ipv4Address a ("10.0.0.1");
+  Ipv4Address b ("10.0.0.2");
+  // the handler uses its own table until the routing protocol is installed
+  ObserveRreq (a);
+  ObserveRrep (a);
+  NS_TEST_EXPECT_MSG_EQ (GetCounters (a).GetRply (), 1, "Wrong number of RREPs");
+
+  AodvHelper aodv;
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (aodv);
+  internet.Install (m_node);
+
+  Ipv4TrustTable &table = m_node->GetObject<Ipv4> ()->GetRoutingProtocol ()->m_trustTable;
+  ObserveRreq (b);
+  NS_TEST_EXPECT_MSG_EQ (&m_handler->GetTrustTable (), &table,
+                         "The handler does not use the trust table of the routing protocol");
+  uint32_t index;
+  NS_TEST_EXPECT_MSG_EQ (table.LookupIndex (a, index), false, "The records of the own table are kept");
+  NS_TEST_ASSERT_MSG_EQ (table.LookupIndex (b, index), true, "No record for the neighbour");
+  NS_TEST_EXPECT_MSG_EQ (GetCounters (b).GetRply (), 0, "The RREPs of another neighbour are counted");
+
+  m_handler = 0;
+  m_node = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Check the periodic recomputation of the trust values
+ */
+class AodvTrustPeriodicRecomputeTest : public AodvTrustHandlerTestCase
+{
+public:
+  AodvTrustPeriodicRecomputeTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the trust table record of a neighbour
+   * \param address the neighbour
+   * \param trust the expected trust value
+   * \param timestamp the expected timestamp
+   */
+  void CheckRecord (Ipv4Address address, double trust, Time timestamp);
+};
+
+AodvTrustPeriodicRecomputeTest::AodvTrustPeriodicRecomputeTest ()
+  : AodvTrustHandlerTestCase ("Recompute the trust values periodically")
+{
+}
+
+void
+AodvTrustPeriodicRecomputeTest::CheckRecord (Ipv4Address address, double trust, Time timestamp)
+{
+  Ipv4TrustEntry entry;
+  NS_TEST_ASSERT_MSG_EQ (m_handler->GetTrustTable ().LookupTrustEntry (address, entry), true,
+                         "No record for the neighbour");
+  NS_TEST_EXPECT_MSG_EQ_TOL (entry.GetTrustValue (), trust, 1e-9, "Wrong trust value");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetTimestamp (), timestamp, "Wrong timestamp");
+}
+
+void
+AodvTrustPeriodicRecomputeTest::DoRun (void)
+{
+  CreateNode ();
+  m_handler->SetAttribute ("TrustUpdateInterval", TimeValue (Seconds (1)));
+  Ipv4Address a ("10.0.0.1");
+
+  Simulator::Schedule (Seconds (0.5), &AodvTrustPeriodicRecomputeTest::ObserveRreq, this, a);
+  Simulator::Schedule (Seconds (0.5), &AodvTrustPeriodicRecomputeTest::ObserveRrep, this, a);
+  // the trust value is not computed when the messages are observed
+  Simulator::Schedule (Seconds (0.9), &AodvTrustPeriodicRecomputeTest::CheckRecord, this, a, 0, Seconds (0.5));
+  Simulator::Schedule (Seconds (1.5), &AodvTrustPeriodicRecomputeTest::CheckRecord, this, a, 1, Seconds (1));
+  Simulator::Schedule (Seconds (1.6), &AodvTrustPeriodicRecomputeTest::ObserveRreq, this, a);
+  Simulator::Schedule (Seconds (1.9), &AodvTrustPeriodicRecomputeTest::CheckRecord, this, a, 1, Seconds (1));
+  Simulator::Schedule (Seconds (2.5), &AodvTrustPeriodicRecomputeTest::CheckRecord, this, a, 0.5, Seconds (2));
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  m_handler = 0;
+  m_node = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Trust Handler Test Suite
+ */
+class AodvTrustHandlerTestSuite : public TestSuite
+{
+public:
+  AodvTrustHandlerTestSuite () : TestSuite ("aodv-trust-handler", UNIT)
+  {
+    AddTestCase (new AodvTrustCountingTest, TestCase::QUICK);
+    AddTestCase (new AodvTrustIndexReuseTest, TestCase::QUICK);
+    AddTestCase (new AodvTrustLateRoutingTest, TestCase::QUICK);
+    AddTestCase (new AodvTrustPeriodicRecomputeTest, TestCase::QUICK);
+  }
+} g_aodvTrustHandlerTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
@@ -0,0 +1,453 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "timer-wheel.h"
+#include "simulator.h"
+#include "log.h"
+#include "abort.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (TimerWheel);
+
+/**
+ * \ingroup timer
+ * \param bits a non-null bitmap
+ * \return the index of the least significant bit set
+ */
+static uint32_t
+FirstBitSet (uint64_t bits)
+{
+#if defined (__GNUC__)
+  return __builtin_ctzll (bits);
+#else
+  uint32_t index = 0;
+  while ((bits & 1) == 0)
+    {
+      bits >>= 1;
+      index++;
+    }
+  return index;
+#endif
+}
+
+TypeId
+TimerWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimerWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("Core")
+    .AddConstructor<TimerWheel> ()
+    .AddAttribute ("Granularity",
+                   "The granularity of the timers. It can only be changed "
+                   "when no timer is pending.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&TimerWheel::SetGranularity,
+                                     &TimerWheel::GetGranularity),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+TimerWheel::TimerWheel ()
+  : m_granularity (MilliSeconds (1)),
+    m_tick (0),
+    m_free (NONE),
+    m_nTimers (0),
+    m_eventTick (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < LEVELS * SLOTS; i++)
+    {
+      m_heads[i] = NONE;
+    }
+  for (uint32_t k = 0; k < LEVELS; k++)
+    {
+      m_occupied[k] = 0;
+    }
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimerWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_timers.clear ();
+  m_free = NONE;
+  m_nTimers = 0;
+  for (uint32_t i = 0; i < LEVELS * SLOTS; i++)
+    {
+      m_heads[i] = NONE;
+    }
+  for (uint32_t k = 0; k < LEVELS; k++)
+    {
+      m_occupied[k] = 0;
+    }
+  Object::DoDispose ();
+}
+
+Ptr<TimerWheel>
+TimerWheel::GetTimerWheel (Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (object);
+  Ptr<TimerWheel> wheel = object->GetObject<TimerWheel> ();
+  if (wheel == 0)
+    {
+      wheel = CreateObject<TimerWheel> ();
+      object->AggregateObject (wheel);
+    }
+  return wheel;
+}
+
+void
+TimerWheel::SetGranularity (Time granularity)
+{
+  NS_LOG_FUNCTION (this << granularity);
+  NS_ABORT_MSG_IF (m_nTimers > 0, "Cannot change the granularity of a timer wheel with pending timers");
+  NS_ABORT_MSG_IF (granularity.IsStrictlyPositive () == false, "The granularity must be positive");
+  m_granularity = granularity;
+  m_tick = Simulator::Now ().GetTimeStep () / m_granularity.GetTimeStep ();
+}
+
+Time
+TimerWheel::GetGranularity (void) const
+{
+  return m_granularity;
+}
+
+uint32_t
+TimerWheel::GetNTimers (void) const
+{
+  return m_nTimers;
+}
+
+TimerWheel::TimerId
+TimerWheel::Schedule (Time delay, const Callback<void, uint64_t> &callback, uint64_t context)
+{
+  NS_LOG_FUNCTION (this << delay << context);
+  uint32_t index = Allocate (delay);
+  m_timers[index].callback = callback;
+  m_timers[index].context = context;
+  return GetId (index);
+}
+
+TimerWheel::TimerId
+TimerWheel::Schedule (Time delay, const Ptr<EventImpl> &event)
+{
+  NS_LOG_FUNCTION (this << delay << event);
+  uint32_t index = Allocate (delay);
+  m_timers[index].event = event;
+  m_timers[index].context = 0;
+  return GetId (index);
+}
+
+uint32_t
+TimerWheel::Allocate (Time delay)
+{
+  int64_t step = m_granularity.GetTimeStep ();
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  if (m_nTimers == 0 && static_cast<uint64_t> (now / step) > m_tick)
+    {
+      // no slot has to be processed before the current tick
+      m_tick = now / step;
+    }
+
+  // a timer expires at the first tick which is not earlier than its
+  // expiration time, and after the last processed tick
+  int64_t expiry = now + std::max<int64_t> (delay.GetTimeStep (), 0);
+  uint64_t tick = (expiry + step - 1) / step;
+  if (tick <= m_tick)
+    {
+      tick = m_tick + 1;
+    }
+
+  uint32_t index = m_free;
+  if (index == NONE)
+    {
+      index = m_timers.size ();
+      m_timers.push_back (Timer ());
+      m_timers[index].generation = 1;
+    }
+  else
+    {
+      m_free = m_timers[index].next;
+    }
+
+  m_timers[index].tick = tick;
+  Insert (index);
+  m_nTimers++;
+
+  ScheduleNext ();
+  return index;
+}
+
+TimerWheel::TimerId
+TimerWheel::GetId (uint32_t index) const
+{
+  return (static_cast<uint64_t> (m_timers[index].generation) << 32) | index;
+}
+
+uint32_t
+TimerWheel::Find (TimerId id) const
+{
+  uint32_t index = static_cast<uint32_t> (id);
+  uint32_t generation = static_cast<uint32_t> (id >> 32);
+  if (index < m_timers.size () && m_timers[index].generation == generation
+      && m_timers[index].slot != NONE)
+    {
+      return index;
+    }
+  return NONE;
+}
+
+void
+TimerWheel::Cancel (TimerId id)
+{
+  NS_LOG_FUNCTION (this << id);
+  uint32_t index = Find (id);
+  if (index == NONE)
+    {
+      return;
+    }
+  Unlink (index);
+  Free (index);
+
+  // an event scheduled for the cancelled timer is left alone if other
+  // timers are pending, since processing a slot too early is harmless.
+  // Otherwise, it is removed: a cancelled event would still extend the
+  // simulation
+  if (m_nTimers == 0)
+    {
+      Simulator::Remove (m_event);
+    }
+}
+
+bool
+TimerWheel::IsPending (TimerId id) const
+{
+  return Find (id) != NONE;
+}
+
+Time
+TimerWheel::GetDelayLeft (TimerId id) const
+{
+  uint32_t index = Find (id);
+  if (index == NONE)
+    {
+      return Time (0);
+    }
+  Time expiry = TimeStep (m_timers[index].tick * m_granularity.GetTimeStep ());
+  return std::max (expiry - Simulator::Now (), Time (0));
+}
+
+void
+TimerWheel::Insert (uint32_t index)
+{
+  Timer &timer = m_timers[index];
+  NS_ASSERT (timer.tick >= m_tick);
+
+  // the level is the lowest wheel whose slots cover the delay; timers
+  // beyond the highest wheel are stored in its farthest slot and moved
+  // again when the slot is processed
+  uint64_t delta = timer.tick - m_tick;
+  uint64_t tick = timer.tick;
+  uint32_t level = 0;
+  while (level < LEVELS && (delta >> (SLOT_BITS * (level + 1))) != 0)
+    {
+      level++;
+    }
+  if (level == LEVELS)
+    {
+      level = LEVELS - 1;
+      tick = m_tick + (static_cast<uint64_t> (1) << (SLOT_BITS * LEVELS)) - 1;
+    }
+  uint32_t slot = static_cast<uint32_t> ((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+  uint32_t head = level * SLOTS + slot;
+  timer.slot = head;
+  timer.prev = NONE;
+  timer.next = m_heads[head];
+  if (timer.next != NONE)
+    {
+      m_timers[timer.next].prev = index;
+    }
+  m_heads[head] = index;
+  m_occupied[level] |= static_cast<uint64_t> (1) << slot;
+}
+
+void
+TimerWheel::Unlink (uint32_t index)
+{
+  Timer &timer = m_timers[index];
+  NS_ASSERT (timer.slot != NONE);
+  if (timer.prev == NONE)
+    {
+      m_heads[timer.slot] = timer.next;
+    }
+  else
+    {
+      m_timers[timer.prev].next = timer.next;
+    }
+  if (timer.next != NONE)
+    {
+      m_timers[timer.next].prev = timer.prev;
+    }
+  if (m_heads[timer.slot] == NONE)
+    {
+      m_occupied[timer.slot / SLOTS] &= ~(static_cast<uint64_t> (1) << (timer.slot % SLOTS));
+    }
+  timer.slot = NONE;
+}
+
+void
+TimerWheel::Free (uint32_t index)
+{
+  Timer &timer = m_timers[index];
+  timer.callback = Callback<void, uint64_t> ();
+  timer.event = 0;
+  timer.generation++;
+  timer.next = m_free;
+  m_free = index;
+  m_nTimers--;
+}
+
+uint64_t
+TimerWheel::GetNextTick (void) const
+{
+  uint64_t next = 0;
+  for (uint32_t level = 0; level < LEVELS; level++)
+    {
+      if (m_occupied[level] == 0)
+        {
+          continue;
+        }
+      // a slot after the current one is processed in the current rotation
+      // of the wheel, the others in the next rotation
+      uint32_t shift = SLOT_BITS * level;
+      uint32_t current = static_cast<uint32_t> ((m_tick >> shift) & (SLOTS - 1));
+      uint64_t rotation = (m_tick >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+      uint64_t later = current == SLOTS - 1 ? 0 : m_occupied[level] & (~static_cast<uint64_t> (0) << (current + 1));
+      uint64_t tick;
+      if (later != 0)
+        {
+          tick = rotation + (static_cast<uint64_t> (FirstBitSet (later)) << shift);
+        }
+      else
+        {
+          tick = rotation + (static_cast<uint64_t> (1) << (shift + SLOT_BITS))
+            + (static_cast<uint64_t> (FirstBitSet (m_occupied[level])) << shift);
+        }
+      if (next == 0 || tick < next)
+        {
+          next = tick;
+        }
+    }
+  return next;
+}
+
+void
+TimerWheel::ScheduleNext (void)
+{
+  uint64_t next = GetNextTick ();
+  if (next == 0 || (m_event.IsRunning () && m_eventTick <= next))
+    {
+      return;
+    }
+  m_event.Cancel ();
+  m_eventTick = next;
+  Time delay = TimeStep (next * m_granularity.GetTimeStep ()) - Simulator::Now ();
+  m_event = Simulator::Schedule (std::max (delay, Time (0)), &TimerWheel::Expire, this);
+}
+
+void
+TimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_event = EventId ();
+  uint64_t now = Simulator::Now ().GetTimeStep () / m_granularity.GetTimeStep ();
+  while (m_nTimers > 0)
+    {
+      uint64_t next = GetNextTick ();
+      if (next > now)
+        {
+          break;
+        }
+      m_tick = next;
+
+      // move the timers of the slots of the higher wheels which start at
+      // this tick to the lower wheels, from the highest
+      for (uint32_t level = LEVELS - 1; level > 0; level--)
+        {
+          uint32_t shift = SLOT_BITS * level;
+          if ((m_tick & ((static_cast<uint64_t> (1) << shift) - 1)) != 0)
+            {
+              continue;
+            }
+          uint32_t slot = static_cast<uint32_t> ((m_tick >> shift) & (SLOTS - 1));
+          uint32_t index = m_heads[level * SLOTS + slot];
+          m_heads[level * SLOTS + slot] = NONE;
+          m_occupied[level] &= ~(static_cast<uint64_t> (1) << slot);
+          while (index != NONE)
+            {
+              uint32_t nextIndex = m_timers[index].next;
+              Insert (index);
+              index = nextIndex;
+            }
+        }
+
+      // expire the timers of the slot of this tick. The callbacks may
+      // schedule and cancel timers
+      uint32_t head = static_cast<uint32_t> (m_tick & (SLOTS - 1));
+      while (m_heads[head] != NONE)
+        {
+          uint32_t index = m_heads[head];
+          NS_ASSERT (m_timers[index].tick == m_tick);
+          Callback<void, uint64_t> callback = m_timers[index].callback;
+          Ptr<EventImpl> event = m_timers[index].event;
+          uint64_t context = m_timers[index].context;
+          Unlink (index);
+          Free (index);
+          if (event != 0)
+            {
+              event->Invoke ();
+            }
+          else
+            {
+              callback (context);
+            }
+        }
+    }
+  if (now > m_tick)
+    {
+      m_tick = now;
+    }
+  ScheduleNext ();
+}
+
+} // namespace ns3
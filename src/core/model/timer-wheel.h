@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "object.h"
+#include "nstime.h"
+#include "event-id.h"
+#include "callback.h"
+#include "event-impl.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::TimerWheel class declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup timer
+ * \brief A hierarchical timer wheel, for protocols managing many timers.
+ *
+ * A TimerWheel manages timers with a coarse granularity, set by the
+ * Granularity attribute: a timer expires at the first multiple of the
+ * granularity which is not earlier than its expiration time. The timers
+ * are stored in the slots of a hierarchy of wheels, as in the Linux
+ * kernel, and a single simulator event is scheduled, at the next tick
+ * where a slot must be processed. Hence, scheduling and cancelling a
+ * timer take constant time and do not schedule or cancel simulator
+ * events, unless the timer expires before all the others.
+ *
+ * The timers are stored in a pool, which grows to the largest number of
+ * timers pending at once and is then reused. A timer is identified by a
+ * TimerWheel::TimerId, which is never reused. The timers expiring at the
+ * same tick are called in an unspecified (but deterministic) order.
+ *
+ * The timers of the protocols of a node should share the same wheel,
+ * which is aggregated to the node (see GetTimerWheel).
+ */
+class TimerWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TimerWheel ();
+  virtual ~TimerWheel ();
+
+  /// Identifier of a timer; 0 never identifies a timer
+  typedef uint64_t TimerId;
+
+  /**
+   * \brief Get the timer wheel aggregated to an object (e.g., a node),
+   * aggregating a new one if there is none.
+   * \param object the object
+   * \return the timer wheel
+   */
+  static Ptr<TimerWheel> GetTimerWheel (Ptr<Object> object);
+
+  /**
+   * \brief Schedule a timer.
+   * \param delay the delay after which the timer expires
+   * \param callback the function called when the timer expires
+   * \param context the value passed to the callback
+   * \return the identifier of the timer
+   */
+  TimerId Schedule (Time delay, const Callback<void, uint64_t> &callback, uint64_t context);
+
+  /**
+   * \brief Schedule a timer invoking an event, e.g., created by MakeEvent.
+   *
+   * This is convenient for timers bound to several arguments, as with
+   * Simulator::Schedule.
+   *
+   * \param delay the delay after which the timer expires
+   * \param event the event invoked when the timer expires
+   * \return the identifier of the timer
+   */
+  TimerId Schedule (Time delay, const Ptr<EventImpl> &event);
+
+  /**
+   * \brief Cancel a timer. Nothing happens if the timer has expired or
+   * has been cancelled.
+   * \param id the identifier of the timer
+   */
+  void Cancel (TimerId id);
+
+  /**
+   * \param id the identifier of a timer
+   * \return true if the timer has neither expired nor been cancelled
+   */
+  bool IsPending (TimerId id) const;
+
+  /**
+   * \param id the identifier of a timer
+   * \return the time left before the timer expires, or zero if the timer
+   *         is not pending
+   */
+  Time GetDelayLeft (TimerId id) const;
+
+  /**
+   * \return the number of pending timers
+   */
+  uint32_t GetNTimers (void) const;
+
+  /**
+   * \return the granularity of the timers
+   */
+  Time GetGranularity (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Number of bits of the index of a slot in a wheel
+  static const uint32_t SLOT_BITS = 6;
+  /// Number of slots of a wheel
+  static const uint32_t SLOTS = 1 << SLOT_BITS;
+  /// Number of wheels
+  static const uint32_t LEVELS = 4;
+  /// Index of a missing timer
+  static const uint32_t NONE = 0xffffffff;
+
+  /// A timer
+  struct Timer
+  {
+    uint64_t tick;                        //!< Expiration tick
+    Callback<void, uint64_t> callback;    //!< Function called at expiration
+    Ptr<EventImpl> event;                 //!< Event invoked at expiration, instead of the callback
+    uint64_t context;                     //!< Value passed to the callback
+    uint32_t generation;                  //!< Generation of the timer, to detect stale identifiers
+    uint32_t slot;                        //!< Slot (level * SLOTS + index) storing the timer, or NONE if free
+    uint32_t prev;                        //!< Previous timer of the slot, or NONE
+    uint32_t next;                        //!< Next timer of the slot or of the free list, or NONE
+  };
+
+  /**
+   * \brief Set the granularity of the timers.
+   * \param granularity the granularity
+   */
+  void SetGranularity (Time granularity);
+
+  /**
+   * \brief Allocate a timer from the pool and insert it in its slot.
+   * \param delay the delay after which the timer expires
+   * \return the index of the timer in the pool
+   */
+  uint32_t Allocate (Time delay);
+
+  /**
+   * \param index the index of a pending timer in the pool
+   * \return the identifier of the timer
+   */
+  TimerId GetId (uint32_t index) const;
+
+  /**
+   * \param id the identifier of a timer
+   * \return the index of the timer in the pool, or NONE if it is not pending
+   */
+  uint32_t Find (TimerId id) const;
+
+  /**
+   * \brief Insert a timer in the slot matching its expiration tick.
+   * \param index the index of the timer in the pool
+   */
+  void Insert (uint32_t index);
+
+  /**
+   * \brief Remove a timer from its slot.
+   * \param index the index of the timer in the pool
+   */
+  void Unlink (uint32_t index);
+
+  /**
+   * \brief Return a timer, removed from its slot, to the pool.
+   * \param index the index of the timer in the pool
+   */
+  void Free (uint32_t index);
+
+  /**
+   * \return the next tick where a slot must be processed, or 0 if there
+   *         is no pending timer
+   */
+  uint64_t GetNextTick (void) const;
+
+  /**
+   * \brief Schedule the simulator event at the next tick where a slot must
+   * be processed, if it is earlier than the scheduled one.
+   */
+  void ScheduleNext (void);
+
+  /**
+   * \brief Process the slots up to the current tick and expire the timers.
+   */
+  void Expire (void);
+
+  Time m_granularity;                 //!< Granularity of the timers
+  uint64_t m_tick;                    //!< Last processed tick
+  std::vector<Timer> m_timers;        //!< Pool of timers
+  uint32_t m_free;                    //!< First free timer of the pool, or NONE
+  uint32_t m_nTimers;                 //!< Number of pending timers
+  uint32_t m_heads[LEVELS * SLOTS];   //!< First timer of each slot, or NONE
+  uint64_t m_occupied[LEVELS];        //!< Bitmap of the non-empty slots of each wheel
+  EventId m_event;                    //!< Event processing the next slot
+  uint64_t m_eventTick;               //!< Tick of m_event
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -201,13 +201,17 @@ public:
   /**
    * Set the value of the underlying variable.
    *
-   * If the new value differs from the old, the Callback will be invoked.
+   * If the new value differs from the old, the Callback will be invoked,
+   * unless none is connected.
    * \param [in] v The new value.
    */
   void Set (const T &v) {
     if (m_v != v)
       {
-        m_cb (m_v, v);
+        if (!m_cb.IsEmpty ())
+          {
+            m_cb (m_v, v);
+          }
         m_v = v;
       }
   }
@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/timer-wheel.h"
+#include "ns3/simulator.h"
+#include "ns3/make-event.h"
+#include "ns3/test.h"
+#include <map>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup timer
+ * \ingroup timer-tests
+ * TimerWheel test suite.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup timer-tests
+ *  Check the expiration times of the timers of a TimerWheel
+ */
+class TimerWheelExpiryTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TimerWheelExpiryTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Function to invoke when a timer expires.
+   * \param context The context of the timer.
+   */
+  void Expire (uint64_t context);
+  /**
+   * Schedule a timer, and record the expected expiration time.
+   * \param delay The delay of the timer.
+   * \param expected The expected expiration time.
+   */
+  void Schedule (Time delay, Time expected);
+
+  Ptr<TimerWheel> m_wheel;                //!< The timer wheel
+  uint64_t m_nScheduled;                  //!< Number of timers scheduled
+  std::map<uint64_t, Time> m_expected;    //!< Expected expiration time, by context
+  std::map<uint64_t, Time> m_expired;     //!< Expiration time, by context
+};
+
+TimerWheelExpiryTestCase::TimerWheelExpiryTestCase ()
+  : TestCase ("Check that the timers expire at the first tick after their expiration time")
+{
+}
+
+void
+TimerWheelExpiryTestCase::Expire (uint64_t context)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_expired.count (context), 0, "Timer expired twice");
+  m_expired[context] = Simulator::Now ();
+}
+
+void
+TimerWheelExpiryTestCase::Schedule (Time delay, Time expected)
+{
+  uint64_t context = m_nScheduled++;
+  m_expected[context] = expected;
+  TimerWheel::TimerId id = m_wheel->Schedule (delay, MakeCallback (&TimerWheelExpiryTestCase::Expire, this), context);
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->IsPending (id), true, "Timer not pending");
+}
+
+void
+TimerWheelExpiryTestCase::DoRun (void)
+{
+  m_wheel = CreateObject<TimerWheel> ();
+  m_nScheduled = 0;
+
+  // timers in each wheel, and beyond the highest wheel (4.66 hours with
+  // the default granularity of 1 ms)
+  Schedule (MicroSeconds (500), MilliSeconds (1));
+  Schedule (MilliSeconds (1), MilliSeconds (1));
+  Schedule (MilliSeconds (63), MilliSeconds (63));
+  Schedule (MilliSeconds (64), MilliSeconds (64));
+  Schedule (MicroSeconds (4096100), MilliSeconds (4097));
+  Schedule (Seconds (300), Seconds (300));
+  Schedule (Hours (10), Hours (10));
+
+  // timer invoking an event
+  m_expected[m_nScheduled] = MilliSeconds (30);
+  m_wheel->Schedule (MilliSeconds (30), MakeEvent (&TimerWheelExpiryTestCase::Expire, this, m_nScheduled));
+  m_nScheduled++;
+
+  // timers scheduled later, while other timers are pending
+  Simulator::Schedule (MilliSeconds (50), &TimerWheelExpiryTestCase::Schedule, this,
+                       MilliSeconds (20), MilliSeconds (70));
+  Simulator::Schedule (Seconds (100), &TimerWheelExpiryTestCase::Schedule, this,
+                       MicroSeconds (10), MilliSeconds (100001));
+  Simulator::Schedule (Seconds (299), &TimerWheelExpiryTestCase::Schedule, this,
+                       Seconds (1), Seconds (300));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), m_expected.size (), "Not all the timers expired");
+  for (std::map<uint64_t, Time>::const_iterator it = m_expected.begin (); it != m_expected.end (); it++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_expired[it->first], it->second, "Timer " << it->first << " expired at a wrong time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetNTimers (), 0, "Timers left in the wheel");
+
+  m_wheel->Dispose ();
+  m_wheel = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup timer-tests
+ *  Check the cancellation of the timers of a TimerWheel
+ */
+class TimerWheelCancelTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  TimerWheelCancelTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Function to invoke when a timer expires.
+   * \param context The context of the timer.
+   */
+  void Expire (uint64_t context);
+  /**
+   * Cancel a timer.
+   * \param id The identifier of the timer.
+   */
+  void Cancel (TimerWheel::TimerId id);
+
+  Ptr<TimerWheel> m_wheel;        //!< The timer wheel
+  std::vector<uint64_t> m_expired; //!< Contexts of the expired timers
+};
+
+TimerWheelCancelTestCase::TimerWheelCancelTestCase ()
+  : TestCase ("Check that cancelled timers do not expire")
+{
+}
+
+void
+TimerWheelCancelTestCase::Expire (uint64_t context)
+{
+  m_expired.push_back (context);
+}
+
+void
+TimerWheelCancelTestCase::Cancel (TimerWheel::TimerId id)
+{
+  m_wheel->Cancel (id);
+}
+
+void
+TimerWheelCancelTestCase::DoRun (void)
+{
+  m_wheel = CreateObject<TimerWheel> ();
+  Callback<void, uint64_t> cb = MakeCallback (&TimerWheelCancelTestCase::Expire, this);
+
+  TimerWheel::TimerId id1 = m_wheel->Schedule (MilliSeconds (10), cb, 1);
+  TimerWheel::TimerId id2 = m_wheel->Schedule (MilliSeconds (10), cb, 2);
+  TimerWheel::TimerId id3 = m_wheel->Schedule (Seconds (10), cb, 3);
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetDelayLeft (id3), Seconds (10), "Wrong delay left");
+
+  m_wheel->Cancel (id1);
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->IsPending (id1), false, "Cancelled timer still pending");
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->GetNTimers (), 2, "Wrong number of timers");
+
+  // the identifier of a cancelled timer is not reused
+  TimerWheel::TimerId id4 = m_wheel->Schedule (MilliSeconds (20), cb, 4);
+  NS_TEST_EXPECT_MSG_NE (id4, id1, "Identifier reused");
+  m_wheel->Cancel (id1);
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->IsPending (id4), true, "Timer cancelled through a stale identifier");
+
+  Simulator::Schedule (Seconds (5), &TimerWheelCancelTestCase::Cancel, this, id3);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), 2, "Wrong number of expired timers");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0], 2, "Wrong expired timer");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1], 4, "Wrong expired timer");
+  NS_TEST_EXPECT_MSG_EQ (m_wheel->IsPending (id2), false, "Expired timer still pending");
+  // cancelling the last timer does not leave an event extending the simulation
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (5), "The simulation did not end at the last cancellation");
+
+  m_wheel->Dispose ();
+  m_wheel = 0;
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup timer-tests
+ *  TimerWheel test suite
+ */
+class TimerWheelTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  TimerWheelTestSuite ()
+    : TestSuite ("timer-wheel")
+  {
+    AddTestCase (new TimerWheelExpiryTestCase ());
+    AddTestCase (new TimerWheelCancelTestCase ());
+  }
+};
+
+/**
+ * \ingroup timer-tests
+ * TimerWheelTestSuite instance variable.
+ */
+static TimerWheelTestSuite g_timerWheelTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
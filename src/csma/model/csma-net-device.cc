@@ -33,6 +33,8 @@
 #include "csma-net-device.h"
 #include "csma-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-item.h"
+#include "ns3/segmentation-offload.h"
 
 namespace ns3 {
 
@@ -218,6 +220,7 @@ CsmaNetDevice::DoDispose ()
   NS_LOG_FUNCTION_NOARGS ();
   m_channel = 0;
   m_node = 0;
+  m_txSegments.clear ();
   m_queue = 0;
   m_queueInterface = 0;
   NetDevice::DoDispose ();
@@ -595,13 +598,13 @@ CsmaNetDevice::TransmitAbort (void)
   // get that out.  If the queue is empty we just wait until someone puts one
   // in.
   //
-  if (m_queue->IsEmpty ())
+  if (m_txSegments.empty () && m_queue->IsEmpty ())
     {
       return;
     }
   else
     {
-      Ptr<Packet> packet = m_queue->Dequeue ();
+      Ptr<Packet> packet = DequeueSegment ();
       NS_ASSERT_MSG (packet != 0, "CsmaNetDevice::TransmitAbort(): IsEmpty false but no Packet on queue?");
       m_currentPkt = packet;
       m_snifferTrace (m_currentPkt);
@@ -664,13 +667,13 @@ CsmaNetDevice::TransmitReadyEvent (void)
   //
   // Get the next packet from the queue for transmitting
   //
-  if (m_queue->IsEmpty ())
+  if (m_txSegments.empty () && m_queue->IsEmpty ())
     {
       return;
     }
   else
     {
-      Ptr<Packet> packet = m_queue->Dequeue ();
+      Ptr<Packet> packet = DequeueSegment ();
       NS_ASSERT_MSG (packet != 0, "CsmaNetDevice::TransmitReadyEvent(): IsEmpty false but no Packet on queue?");
       m_currentPkt = packet;
       m_snifferTrace (m_currentPkt);
@@ -679,6 +682,46 @@ CsmaNetDevice::TransmitReadyEvent (void)
     }
 }
 
+Ptr<Packet>
+CsmaNetDevice::DequeueSegment (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<Packet> packet;
+  if (!m_txSegments.empty ())
+    {
+      packet = m_txSegments.front ();
+      m_txSegments.pop_front ();
+      return packet;
+    }
+  packet = m_queue->Dequeue ();
+  SegmentationOffloadTag tag;
+  if (packet == 0 || !packet->PeekPacketTag (tag))
+    {
+      return packet;
+    }
+
+  //
+  // Split the offloaded packet into the segments which go on the wire, each
+  // in its own frame.  Only the DIX encapsulation supports the offload, so
+  // that there is no LLC/SNAP header to remove.
+  //
+  NS_ASSERT (m_encapMode == DIX);
+  EthernetTrailer trailer;
+  packet->RemoveTrailer (trailer);
+  EthernetHeader header (false);
+  packet->RemoveHeader (header);
+  std::vector<Ptr<Packet> > segments;
+  SegmentationOffload::Segment (header.GetLengthType (), packet, segments);
+  for (std::vector<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+    {
+      AddHeader (*it, header.GetSource (), header.GetDestination (), header.GetLengthType ());
+      m_txSegments.push_back (*it);
+    }
+  packet = m_txSegments.front ();
+  m_txSegments.pop_front ();
+  return packet;
+}
+
 bool
 CsmaNetDevice::Attach (Ptr<CsmaChannel> ch)
 {
@@ -979,6 +1022,72 @@ CsmaNetDevice::Send (Ptr<Packet> packet,const Address& dest, uint16_t protocolNu
   return SendFrom (packet, m_address, dest, protocolNumber);
 }
 
+uint32_t
+CsmaNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  NS_ASSERT (IsLinkUp ());
+
+  //
+  // Only transmit if send side of net device is enabled
+  //
+  if (IsSendEnabled () == false)
+    {
+      for (uint32_t i = 0; i < items.size (); i++)
+        {
+          m_macTxDropTrace (items[i]->GetPacket ());
+        }
+      return items.size ();
+    }
+
+  //
+  // Place the packets on the send queue until the device queue is stopped,
+  // and inform the queue limits of the bytes queued once for the whole batch.
+  //
+  Ptr<NetDeviceQueue> txq = m_queueInterface ? m_queueInterface->GetTxQueue (0) : 0;
+  if (txq)
+    {
+      txq->StartBatch ();
+    }
+
+  uint32_t count = 0;
+  for (; count < items.size (); count++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = items[count]->GetPacket ();
+      AddHeader (packet, m_address, Mac48Address::ConvertFrom (items[count]->GetAddress ()),
+                 items[count]->GetProtocol ());
+      m_macTxTrace (packet);
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  if (txq)
+    {
+      txq->EndBatch ();
+    }
+
+  //
+  // If the device is idle, start the transmission of the batch
+  //
+  if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+    {
+      Ptr<Packet> packet = DequeueSegment ();
+      NS_ASSERT_MSG (packet != 0, "CsmaNetDevice::SendBatch(): IsEmpty false but no Packet on queue?");
+      m_currentPkt = packet;
+      m_promiscSnifferTrace (m_currentPkt);
+      m_snifferTrace (m_currentPkt);
+      TransmitStart ();
+    }
+  return count;
+}
+
 bool
 CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address& dest, uint16_t protocolNumber)
 {
@@ -1022,7 +1131,7 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
     {
       if (m_queue->IsEmpty () == false)
         {
-          Ptr<Packet> packet = m_queue->Dequeue ();
+          Ptr<Packet> packet = DequeueSegment ();
           NS_ASSERT_MSG (packet != 0, "CsmaNetDevice::SendFrom(): IsEmpty false but no Packet on queue?");
           m_currentPkt = packet;
           m_promiscSnifferTrace (m_currentPkt);
@@ -1084,6 +1193,13 @@ CsmaNetDevice::SupportsSendFrom () const
   return true;
 }
 
+bool
+CsmaNetDevice::SupportsSegmentationOffload (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_encapMode == DIX;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams (int64_t stream)
 {
@@ -22,6 +22,7 @@
 #define CSMA_NET_DEVICE_H
 
 #include <cstring>
+#include <deque>
 #include "ns3/node.h"
 #include "ns3/backoff.h"
 #include "ns3/address.h"
@@ -285,6 +286,13 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending a batch of packets down the channel.
+   * \param items the packets to send, with their destination and protocol number
+   * \return the number of packets taken by the device
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+
   /**
    * Get the node to which this device is attached.
    *
@@ -328,6 +336,12 @@ public:
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 
+  /**
+   * \return true in the DIX encapsulation mode, in which the packets tagged
+   *         with a SegmentationOffloadTag are split when they are transmitted
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
  /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -446,6 +460,17 @@ private:
    */
   void TransmitAbort (void);
 
+  /**
+   * Get the next packet to transmit.
+   *
+   * A packet tagged with a SegmentationOffloadTag is split into segments
+   * when it is dequeued, and the segments are transmitted one after the
+   * other, each in its own frame, before the next packet is dequeued.
+   *
+   * \return the next packet to transmit, or 0 if there is none
+   */
+  Ptr<Packet> DequeueSegment (void);
+
   /**
    * Notify any interested parties that the link has come up.
    */
@@ -520,6 +545,12 @@ private:
    */
   Ptr<Packet> m_currentPkt;
 
+  /**
+   * Frames of the segments of the current offloaded packet which have not
+   * been transmitted yet.
+   */
+  std::deque<Ptr<Packet> > m_txSegments;
+
   /**
    * The CsmaChannel to which this CsmaNetDevice has been
    * attached.
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the wall clock time spent per packet forwarded by
+// a router node with many ports.
+//
+// The router is linked to one host per port by SimpleNetDevices.  Each
+// host sends UDP packets at a constant rate to the host of the opposite
+// port, hence every packet is received by a device of the router, looked
+// up in the per-device tables of the traffic control layer, IPv4 and ARP,
+// and sent through another device.  The program prints the wall clock time
+// of the simulation divided by the number of packets received by the hosts.
+//
+// Example usage:
+//   ./waf --run "router-forwarding-benchmark --nPorts=64 --nPackets=10000"
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+using namespace ns3;
+
+static uint64_t g_rxPackets = 0; //!< Packets received by the hosts
+
+/**
+ * Count the packets received by a host.
+ *
+ * \param socket the socket
+ */
+static void
+Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_rxPackets++;
+    }
+}
+
+/**
+ * Send a packet and schedule the next one.
+ *
+ * \param socket the socket
+ * \param size the size of the packets
+ * \param left the number of packets left to send
+ * \param interval the interval between packets
+ */
+static void
+SendPacket (Ptr<Socket> socket, uint32_t size, uint32_t left, Time interval)
+{
+  socket->Send (Create<Packet> (size));
+  if (left > 1)
+    {
+      Simulator::Schedule (interval, &SendPacket, socket, size, left - 1, interval);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nPorts = 64;
+  uint32_t nPackets = 1000;
+  uint32_t size = 1000;
+  std::string interval = "100us";
+
+  CommandLine cmd;
+  cmd.AddValue ("nPorts", "Number of ports of the router", nPorts);
+  cmd.AddValue ("nPackets", "Number of packets sent by each host", nPackets);
+  cmd.AddValue ("size", "Size of the UDP payload (bytes)", size);
+  cmd.AddValue ("interval", "Interval between the packets sent by each host", interval);
+  cmd.Parse (argc, argv);
+
+  Ptr<Node> router = CreateObject<Node> ();
+  NodeContainer hosts;
+  hosts.Create (nPorts);
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (router);
+  internet.Install (hosts);
+
+  SimpleNetDeviceHelper link;
+  link.SetNetDevicePointToPointMode (true);
+  link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  link.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1)));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  std::vector<Ipv4Address> hostAddresses;
+  Ipv4StaticRoutingHelper staticRouting;
+  for (uint32_t i = 0; i < nPorts; i++)
+    {
+      NetDeviceContainer devices = link.Install (NodeContainer (router, hosts.Get (i)));
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      hostAddresses.push_back (interfaces.GetAddress (1));
+      Ptr<Ipv4StaticRouting> routing = staticRouting.GetStaticRouting (hosts.Get (i)->GetObject<Ipv4> ());
+      routing->SetDefaultRoute (interfaces.GetAddress (0), 1);
+    }
+
+  Time gap = Time (interval);
+  for (uint32_t i = 0; i < nPorts; i++)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (hosts.Get (i), UdpSocketFactory::GetTypeId ());
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+      sink->SetRecvCallback (MakeCallback (&Receive));
+
+      Ptr<Socket> source = Socket::CreateSocket (hosts.Get (i), UdpSocketFactory::GetTypeId ());
+      source->Connect (InetSocketAddress (hostAddresses[(i + nPorts / 2) % nPorts], 9));
+      // spread the start of the hosts over an interval
+      Simulator::Schedule (MilliSeconds (1) + NanoSeconds (gap.GetNanoSeconds () * i / nPorts), &SendPacket, source, size, nPackets, gap);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+
+  std::cout << nPorts << " ports: " << elapsed << " ms, " << g_rxPackets << " packets forwarded";
+  if (g_rxPackets > 0)
+    {
+      std::cout << ", " << elapsed * 1e6 / g_rxPackets << " ns/packet";
+    }
+  std::cout << std::endl;
+  return 0;
+}
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the wall clock time taken by the unicast route
+// lookups of Ipv4StaticRouting, Ipv4GlobalRouting and Ipv6StaticRouting,
+// for a routing table of a given number of host and network routes.
+//
+// With --linear, a route with a non-contiguous mask is added to each
+// table, which disables the longest prefix match index and makes the
+// lookups scan the routing tables, as they used to.
+//
+// Example usage:
+//   ./waf --run "routing-lookup-benchmark --nRoutes=10000 --nLookups=1000000"
+
+#include <iostream>
+#include <sstream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+using namespace ns3;
+
+/**
+ * Add a device, with an address, to a node.
+ *
+ * \param node the node
+ * \return the device
+ */
+static Ptr<SimpleNetDevice>
+AddDevice (Ptr<Node> node)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  return device;
+}
+
+/**
+ * Build the n-th IPv4 destination of the routing table.
+ *
+ * \param i the index of the destination
+ * \return the address
+ */
+static Ipv4Address
+MakeIpv4Destination (uint32_t i)
+{
+  return Ipv4Address (0x0a000000 + (i << 8) + 1);
+}
+
+/**
+ * Build the n-th IPv6 destination of the routing table.
+ *
+ * \param i the index of the destination
+ * \return the address
+ */
+static Ipv6Address
+MakeIpv6Destination (uint32_t i)
+{
+  uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  buf[6] = (i >> 16) & 0xff;
+  buf[7] = (i >> 8) & 0xff;
+  buf[8] = i & 0xff;
+  buf[15] = 1;
+  return Ipv6Address (buf);
+}
+
+/**
+ * Time the route lookups of an IPv4 routing protocol.
+ *
+ * \param routing the routing protocol
+ * \param nRoutes the number of host routes of the routing table
+ * \param nLookups the number of lookups
+ * \param[out] found the number of lookups that found a route
+ * \return the elapsed wall clock time (ms)
+ */
+static int64_t
+TimeIpv4Lookups (Ptr<Ipv4RoutingProtocol> routing, uint32_t nRoutes, uint32_t nLookups, uint32_t &found)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Ptr<Packet> p = Create<Packet> ();
+  Ipv4Header header;
+  Socket::SocketErrno err;
+  found = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < nLookups; i++)
+    {
+      // three quarters of the lookups hit a host route, the others a network route
+      uint32_t j = rng->GetInteger (0, nRoutes * 4 / 3);
+      Ipv4Address dest = MakeIpv4Destination (j);
+      if (j >= nRoutes)
+        {
+          dest = Ipv4Address (dest.Get () + 1);
+        }
+      header.SetDestination (dest);
+      if (routing->RouteOutput (p, header, 0, err))
+        {
+          found++;
+        }
+    }
+  return clock.End ();
+}
+
+/**
+ * Time the route lookups of Ipv4StaticRouting.
+ *
+ * \param nRoutes the number of host routes
+ * \param nLookups the number of lookups
+ * \param linear whether the route index is disabled
+ * \param[out] found the number of lookups that found a route
+ * \return the elapsed wall clock time (ms)
+ */
+static int64_t
+RunIpv4Static (uint32_t nRoutes, uint32_t nLookups, bool linear, uint32_t &found)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  int32_t ifIndex = ipv4->AddInterface (AddDevice (node));
+  ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("192.168.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (ifIndex);
+
+  Ipv4StaticRoutingHelper helper;
+  Ptr<Ipv4StaticRouting> routing = helper.GetStaticRouting (ipv4);
+  for (uint32_t i = 0; i < nRoutes; i++)
+    {
+      routing->AddHostRouteTo (MakeIpv4Destination (i), Ipv4Address ("192.168.0.2"), ifIndex);
+      if (i % 4 == 0)
+        {
+          routing->AddNetworkRouteTo (MakeIpv4Destination (i).CombineMask (Ipv4Mask ("/16")), Ipv4Mask ("/16"),
+                                      Ipv4Address ("192.168.0.3"), ifIndex);
+        }
+    }
+  if (linear)
+    {
+      routing->AddNetworkRouteTo (Ipv4Address ("172.0.16.0"), Ipv4Mask ("255.0.255.0"), Ipv4Address ("192.168.0.4"), ifIndex);
+    }
+  int64_t elapsed = TimeIpv4Lookups (routing, nRoutes, nLookups, found);
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+/**
+ * Time the route lookups of Ipv4GlobalRouting.
+ *
+ * \param nRoutes the number of host routes
+ * \param nLookups the number of lookups
+ * \param linear whether the route index is disabled
+ * \param[out] found the number of lookups that found a route
+ * \return the elapsed wall clock time (ms)
+ */
+static int64_t
+RunIpv4Global (uint32_t nRoutes, uint32_t nLookups, bool linear, uint32_t &found)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  Ipv4GlobalRoutingHelper globalRouting;
+  internet.SetRoutingHelper (globalRouting);
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  int32_t ifIndex = ipv4->AddInterface (AddDevice (node));
+  ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("192.168.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (ifIndex);
+
+  Ptr<Ipv4GlobalRouting> routing = ipv4->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  for (uint32_t i = 0; i < nRoutes; i++)
+    {
+      routing->AddHostRouteTo (MakeIpv4Destination (i), Ipv4Address ("192.168.0.2"), ifIndex);
+      if (i % 4 == 0)
+        {
+          routing->AddNetworkRouteTo (MakeIpv4Destination (i).CombineMask (Ipv4Mask ("/16")), Ipv4Mask ("/16"),
+                                      Ipv4Address ("192.168.0.3"), ifIndex);
+        }
+    }
+  if (linear)
+    {
+      routing->AddNetworkRouteTo (Ipv4Address ("172.0.16.0"), Ipv4Mask ("255.0.255.0"), Ipv4Address ("192.168.0.4"), ifIndex);
+    }
+  int64_t elapsed = TimeIpv4Lookups (routing, nRoutes, nLookups, found);
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+/**
+ * Time the route lookups of Ipv6StaticRouting.
+ *
+ * \param nRoutes the number of host routes
+ * \param nLookups the number of lookups
+ * \param linear whether the route index is disabled
+ * \param[out] found the number of lookups that found a route
+ * \return the elapsed wall clock time (ms)
+ */
+static int64_t
+RunIpv6Static (uint32_t nRoutes, uint32_t nLookups, bool linear, uint32_t &found)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  int32_t ifIndex = ipv6->AddInterface (AddDevice (node));
+  ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (Ipv6Address ("2001:db9::1"), Ipv6Prefix (64)));
+  ipv6->SetUp (ifIndex);
+
+  Ipv6StaticRoutingHelper helper;
+  Ptr<Ipv6StaticRouting> routing = helper.GetStaticRouting (ipv6);
+  for (uint32_t i = 0; i < nRoutes; i++)
+    {
+      routing->AddHostRouteTo (MakeIpv6Destination (i), Ipv6Address ("2001:db9::2"), ifIndex);
+      if (i % 4 == 0)
+        {
+          routing->AddNetworkRouteTo (MakeIpv6Destination (i).CombinePrefix (Ipv6Prefix (56)), Ipv6Prefix (56),
+                                      Ipv6Address ("2001:db9::3"), ifIndex);
+        }
+    }
+  if (linear)
+    {
+      uint8_t mask[16] = { 0xff, 0x00, 0xff };
+      routing->AddNetworkRouteTo (Ipv6Address ("3000::"), Ipv6Prefix (mask), Ipv6Address ("2001:db9::4"), ifIndex);
+    }
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Ptr<Packet> p = Create<Packet> ();
+  Ipv6Header header;
+  Socket::SocketErrno err;
+  found = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < nLookups; i++)
+    {
+      uint32_t j = rng->GetInteger (0, nRoutes * 4 / 3);
+      uint8_t buf[16];
+      MakeIpv6Destination (j).GetBytes (buf);
+      if (j >= nRoutes)
+        {
+          buf[15] = 2;
+        }
+      header.SetDestinationAddress (Ipv6Address (buf));
+      if (routing->RouteOutput (p, header, 0, err))
+        {
+          found++;
+        }
+    }
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nRoutes = 1000;
+  uint32_t nLookups = 100000;
+  bool linear = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("nRoutes", "Number of host routes (plus one network route every four host routes)", nRoutes);
+  cmd.AddValue ("nLookups", "Number of route lookups", nLookups);
+  cmd.AddValue ("linear", "Disable the longest prefix match index", linear);
+  cmd.Parse (argc, argv);
+
+  uint32_t found;
+  int64_t elapsed = RunIpv4Static (nRoutes, nLookups, linear, found);
+  std::cout << "Ipv4StaticRouting: " << elapsed << " ms, " << found << " routes found" << std::endl;
+  elapsed = RunIpv4Global (nRoutes, nLookups, linear, found);
+  std::cout << "Ipv4GlobalRouting: " << elapsed << " ms, " << found << " routes found" << std::endl;
+  elapsed = RunIpv6Static (nRoutes, nLookups, linear, found);
+  std::cout << "Ipv6StaticRouting: " << elapsed << " ms, " << found << " routes found" << std::endl;
+  return 0;
+}
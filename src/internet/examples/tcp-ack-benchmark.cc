@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the wall clock time spent per acknowledgment by a
+// bulk TCP transfer between two nodes, linked by SimpleNetDevices.
+//
+// The sender keeps its send buffer full for the given duration, and the
+// receiver reads all the data it gets.  The program prints the wall clock
+// time of the simulation divided by the number of acknowledgments sent by
+// the receiver, which includes the processing of the data segments, but is
+// dominated by the per-ACK work of the sender: congestion control,
+// transmission of new segments and updates of the traced values.
+//
+// With --traces, sinks are connected to the congestion window, slow start
+// threshold, bytes in flight and RTT trace sources of the sender, to show
+// the cost of the traces.  The built-in congestion controls TcpNewReno,
+// TcpBic and TcpHighSpeed are called without virtual dispatch; other
+// algorithms can be compared through --tcp.
+//
+// Example usage:
+//   ./waf --run "tcp-ack-benchmark --tcp=ns3::TcpBic --duration=20"
+
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+using namespace ns3;
+
+static uint64_t g_acks = 0;    //!< ACKs sent by the receiver
+static uint64_t g_rxBytes = 0; //!< Bytes read by the receiver
+
+/**
+ * Fill the send buffer of the sender.
+ *
+ * \param socket the socket
+ * \param available the space available in the send buffer
+ */
+static void
+FillTxBuffer (Ptr<Socket> socket, uint32_t available)
+{
+  while (socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min<uint32_t> (socket->GetTxAvailable (), 65536);
+      if (socket->Send (Create<Packet> (size)) < 0)
+        {
+          break;
+        }
+    }
+}
+
+/**
+ * Start the transfer once the sender is connected.
+ *
+ * \param socket the socket
+ */
+static void
+Connected (Ptr<Socket> socket)
+{
+  FillTxBuffer (socket, socket->GetTxAvailable ());
+}
+
+/**
+ * Read the data received by the receiver.
+ *
+ * \param socket the socket
+ */
+static void
+Drain (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      g_rxBytes += p->GetSize ();
+    }
+}
+
+/**
+ * Count the ACKs sent by the receiver.
+ *
+ * \param p the packet
+ * \param header the TCP header
+ * \param socket the socket
+ */
+static void
+CountAck (Ptr<const Packet> p, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  g_acks++;
+}
+
+/**
+ * Accept a connection of the receiver.
+ *
+ * \param socket the new socket
+ * \param from the address of the peer
+ */
+static void
+Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&Drain));
+  socket->TraceConnectWithoutContext ("Tx", MakeCallback (&CountAck));
+}
+
+/**
+ * Sink of the uint32_t traced values.
+ *
+ * \param oldValue the old value
+ * \param newValue the new value
+ */
+static void
+Uint32Sink (uint32_t oldValue, uint32_t newValue)
+{
+}
+
+/**
+ * Sink of the Time traced values.
+ *
+ * \param oldValue the old value
+ * \param newValue the new value
+ */
+static void
+TimeSink (Time oldValue, Time newValue)
+{
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string tcp = "ns3::TcpNewReno";
+  double duration = 10;
+  std::string dataRate = "1Gbps";
+  std::string delay = "10ms";
+  bool traces = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("tcp", "Congestion control TypeId", tcp);
+  cmd.AddValue ("duration", "Duration of the transfer (simulated seconds)", duration);
+  cmd.AddValue ("dataRate", "Data rate of the link", dataRate);
+  cmd.AddValue ("delay", "One-way delay of the link", delay);
+  cmd.AddValue ("traces", "Connect sinks to the traced values of the sender", traces);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TypeId::LookupByName (tcp)));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 24));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 24));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper link;
+  link.SetNetDevicePointToPointMode (true);
+  link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (dataRate)));
+  link.SetChannelAttribute ("Delay", TimeValue (Time (delay)));
+  link.SetQueue ("ns3::DropTailQueue<Packet>", "MaxSize", QueueSizeValue (QueueSize ("1000p")));
+  NetDeviceContainer devices = link.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  receiver->Listen ();
+  receiver->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&Accept));
+
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  if (traces)
+    {
+      sender->TraceConnectWithoutContext ("CongestionWindow", MakeCallback (&Uint32Sink));
+      sender->TraceConnectWithoutContext ("SlowStartThreshold", MakeCallback (&Uint32Sink));
+      sender->TraceConnectWithoutContext ("BytesInFlight", MakeCallback (&Uint32Sink));
+      sender->TraceConnectWithoutContext ("RTT", MakeCallback (&TimeSink));
+    }
+  sender->SetConnectCallback (MakeCallback (&Connected), MakeNullCallback<void, Ptr<Socket> > ());
+  sender->SetSendCallback (MakeCallback (&FillTxBuffer));
+  sender->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+
+  Simulator::Stop (Seconds (duration));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+
+  std::cout << tcp << ": " << elapsed << " ms, " << g_acks << " acks, "
+            << g_rxBytes << " bytes received";
+  if (g_acks > 0)
+    {
+      std::cout << ", " << elapsed * 1e6 / g_acks << " ns/ack";
+    }
+  std::cout << std::endl;
+  return 0;
+}
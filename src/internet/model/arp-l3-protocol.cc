@@ -136,6 +136,7 @@ ArpL3Protocol::DoDispose (void)
       cache->Dispose ();
     }
   m_cacheList.clear ();
+  m_cacheByDevice.clear ();
   m_node = 0;
   m_tc = 0;
   Object::DoDispose ();
@@ -152,6 +153,11 @@ ArpL3Protocol::CreateCache (Ptr<NetDevice> device, Ptr<Ipv4Interface> interface)
   device->AddLinkChangeCallback (MakeCallback (&ArpCache::Flush, cache));
   cache->SetArpRequestCallback (MakeCallback (&ArpL3Protocol::SendArpRequest, this));
   m_cacheList.push_back (cache);
+  if (device->GetIfIndex () >= m_cacheByDevice.size ())
+    {
+      m_cacheByDevice.resize (device->GetIfIndex () + 1);
+    }
+  m_cacheByDevice[device->GetIfIndex ()] = cache;
   return cache;
 }
 
@@ -159,12 +165,11 @@ Ptr<ArpCache>
 ArpL3Protocol::FindCache (Ptr<NetDevice> device)
 {
   NS_LOG_FUNCTION (this << device);
-  for (CacheList::const_iterator i = m_cacheList.begin (); i != m_cacheList.end (); i++)
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex < m_cacheByDevice.size () && m_cacheByDevice[ifIndex] != 0
+      && m_cacheByDevice[ifIndex]->GetDevice () == device)
     {
-      if ((*i)->GetDevice () == device)
-        {
-          return *i;
-        }
+      return m_cacheByDevice[ifIndex];
     }
   NS_ASSERT (false);
   // quiet compiler
@@ -21,6 +21,7 @@
 #define ARP_L3_PROTOCOL_H
 
 #include <list>
+#include <vector>
 #include "ns3/ipv4-header.h"
 #include "ns3/net-device.h"
 #include "ns3/address.h"
@@ -167,6 +168,7 @@ private:
   void SendArpReply (Ptr<const ArpCache> cache, Ipv4Address myIp, Ipv4Address toIp, Address toMac);
 
   CacheList m_cacheList; //!< ARP cache container
+  std::vector<Ptr<ArpCache> > m_cacheByDevice; //!< ARP caches, indexed by the index of their device in the node
   Ptr<Node> m_node; //!< node the ARP L3 protocol is associated with
   TracedCallback<Ptr<const Packet> > m_dropTrace; //!< trace for packets dropped by ARP
   Ptr<RandomVariableStream> m_requestJitter; //!< jitter to de-sync ARP requests
@@ -27,9 +27,17 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -44,6 +52,21 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/// Number of threads running the SPF calculations
+static GlobalValue g_globalRoutingSpfThreads ("GlobalRoutingSpfThreads",
+                                              "The number of threads among which the SPF calculations "
+                                              "rooted at the different routers are spread",
+                                              UintegerValue (1),
+                                              MakeUintegerChecker<uint32_t> (1));
+
+/// Whether the SPF calculations are only run for the routers affected by a change
+static GlobalValue g_globalRoutingIncrementalSpf ("GlobalRoutingIncrementalSpf",
+                                                  "If true, keep the routes computed for each router, and, when the "
+                                                  "routes are recomputed after a change of the link metrics, only run "
+                                                  "the SPF calculations whose result may be affected by the change",
+                                                  BooleanValue (false),
+                                                  MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -89,6 +112,7 @@ SPFVertex::SPFVertex () :
   m_vertexType (VertexUnknown), 
   m_vertexId ("255.255.255.255"), 
   m_lsa (0),
+  m_lsaIndex (0),
   m_distanceFromRoot (SPF_INFINITY), 
   m_rootOif (SPF_INFINITY),
   m_nextHop ("0.0.0.0"),
@@ -102,6 +126,7 @@ SPFVertex::SPFVertex () :
 SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) : 
   m_vertexId (lsa->GetLinkStateId ()),
   m_lsa (lsa),
+  m_lsaIndex (0),
   m_distanceFromRoot (SPF_INFINITY), 
   m_rootOif (SPF_INFINITY),
   m_nextHop ("0.0.0.0"),
@@ -216,6 +241,20 @@ SPFVertex::GetLSA (void) const
   return m_lsa;
 }
 
+void
+SPFVertex::SetLSAIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_lsaIndex = index;
+}
+
+uint32_t
+SPFVertex::GetLSAIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsaIndex;
+}
+
 void
 SPFVertex::SetDistanceFromRoot (uint32_t distance)
 {
@@ -423,7 +462,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_indexValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -471,6 +511,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_indexValid = false;
     }
 }
 
@@ -495,13 +536,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -510,6 +548,11 @@ GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
+  if (m_indexValid)
+    {
+      std::map<Ipv4Address, GlobalRoutingLSA*>::const_iterator it = m_linkDataIndex.find (addr);
+      return (it != m_linkDataIndex.end ()) ? it->second : 0;
+    }
 //
 // Look up an LSA by its address.
 //
@@ -531,6 +574,329 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::BuildIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_indexValid)
+    {
+      return;
+    }
+  m_lsas.clear ();
+  m_lsaIndex.clear ();
+  m_linkDataIndex.clear ();
+  m_edgeOffset.clear ();
+  m_edges.clear ();
+
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      m_lsaIndex[i->first] = m_lsas.size ();
+      m_lsas.push_back (i->second);
+      for (uint32_t j = 0; j < i->second->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = i->second->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              // keep the first LSA in address order, as the linear search did
+              m_linkDataIndex.insert (std::make_pair (lr->GetLinkData (), i->second));
+            }
+        }
+    }
+//
+// The edges are listed in the order in which SPFNext used to examine the
+// link records and the attached routers of each LSA.
+//
+  m_edgeOffset.reserve (m_lsas.size () + 1);
+  for (uint32_t i = 0; i < m_lsas.size (); i++)
+    {
+      m_edgeOffset.push_back (m_edges.size ());
+      GlobalRoutingLSA *lsa = m_lsas[i];
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  continue;
+                }
+              NS_ASSERT_MSG (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                             || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork,
+                             "illegal Link Type");
+              std::map<Ipv4Address, uint32_t>::const_iterator w = m_lsaIndex.find (l->GetLinkId ());
+              NS_ASSERT_MSG (w != m_lsaIndex.end (), "No LSA for link " << l->GetLinkId ());
+              SPFEdge edge;
+              edge.m_vertex = w->second;
+              edge.m_link = l;
+              m_edges.push_back (edge);
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              std::map<Ipv4Address, GlobalRoutingLSA*>::const_iterator w = m_linkDataIndex.find (lsa->GetAttachedRouter (j));
+              if (w == m_linkDataIndex.end ())
+                {
+                  continue;
+                }
+              SPFEdge edge;
+              edge.m_vertex = m_lsaIndex[w->second->GetLinkStateId ()];
+              edge.m_link = 0;
+              m_edges.push_back (edge);
+            }
+        }
+    }
+  m_edgeOffset.push_back (m_edges.size ());
+  m_indexValid = true;
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_database.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT (m_indexValid);
+  return m_lsas[index];
+}
+
+int32_t
+GlobalRouteManagerLSDB::GetLSAIndex (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  NS_ASSERT (m_indexValid);
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_lsaIndex.find (addr);
+  if (i == m_lsaIndex.end ())
+    {
+      return -1;
+    }
+  return i->second;
+}
+
+void
+GlobalRouteManagerLSDB::GetEdges (uint32_t index, const SPFEdge* &begin, const SPFEdge* &end) const
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT (m_indexValid);
+  begin = m_edges.data () + m_edgeOffset[index];
+  end = m_edges.data () + m_edgeOffset[index + 1];
+}
+
+/**
+ * \brief A change of the metric of a point-to-point or transit network link
+ *        record, i.e., of the cost of an edge of the SPF graph.
+ */
+struct LinkMetricChange
+{
+  uint32_t m_from; //!< index of the LSA the edge leaves
+  uint32_t m_to; //!< index of the LSA the edge leads to
+};
+
+/**
+ * \brief Compare two link records, ignoring the metric.
+ *
+ * \param a first link record
+ * \param b second link record
+ * \returns true if the link records are the same, except for the metric
+ */
+static bool
+SameLinkRecord (GlobalRoutingLinkRecord *a, GlobalRoutingLinkRecord *b)
+{
+  return a->GetLinkType () == b->GetLinkType ()
+         && a->GetLinkId () == b->GetLinkId ()
+         && a->GetLinkData () == b->GetLinkData ();
+}
+
+/**
+ * \brief Compare two LSAs, ignoring the metric of the link records.
+ *
+ * \param a first LSA
+ * \param b second LSA
+ * \returns true if the LSAs are the same, except for the metric of the
+ *          link records
+ */
+static bool
+SameLSA (GlobalRoutingLSA *a, GlobalRoutingLSA *b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      if (!SameLinkRecord (a->GetLinkRecord (i), b->GetLinkRecord (i)))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief Find the changes of the link metrics between two LSDBs.
+ *
+ * \param previous the previous LSDB, indexed
+ * \param current the current LSDB, indexed
+ * \param [out] changes the edges of the previous LSDB whose cost changed
+ * \returns false if the LSDBs differ in some other way
+ */
+static bool
+FindLinkMetricChanges (GlobalRouteManagerLSDB *previous, GlobalRouteManagerLSDB *current,
+                       std::vector<LinkMetricChange> &changes)
+{
+  if (previous->GetNumLSAs () != current->GetNumLSAs ()
+      || previous->GetNumExtLSAs () != current->GetNumExtLSAs ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < previous->GetNumExtLSAs (); i++)
+    {
+      if (!SameLSA (previous->GetExtLSA (i), current->GetExtLSA (i)))
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < previous->GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *a = previous->GetLSAByIndex (i);
+      GlobalRoutingLSA *b = current->GetLSAByIndex (i);
+      if (!SameLSA (a, b))
+        {
+          return false;
+        }
+      // stub link records are not part of the SPF graph
+      const GlobalRouteManagerLSDB::SPFEdge *edge;
+      const GlobalRouteManagerLSDB::SPFEdge *end;
+      previous->GetEdges (i, edge, end);
+      for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *la = a->GetLinkRecord (j);
+          if (la->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          NS_ASSERT (edge != end && edge->m_link == la);
+          if (la->GetMetric () != b->GetLinkRecord (j)->GetMetric ())
+            {
+              LinkMetricChange change;
+              change.m_from = i;
+              change.m_to = edge->m_vertex;
+              changes.push_back (change);
+            }
+          edge++;
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief Compute the distance from every vertex of the SPF graph to a
+ *        given vertex.
+ *
+ * \param lsdb the LSDB, indexed
+ * \param target the index of the target LSA
+ * \param [out] distance the distance from each LSA to the target, or the
+ *        maximum value if the target cannot be reached
+ */
+static void
+ComputeDistancesTo (GlobalRouteManagerLSDB *lsdb, uint32_t target, std::vector<uint64_t> &distance)
+{
+  uint32_t n = lsdb->GetNumLSAs ();
+  // reverse the graph, in compressed sparse row form
+  std::vector<uint32_t> offset (n + 1, 0);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      const GlobalRouteManagerLSDB::SPFEdge *e;
+      const GlobalRouteManagerLSDB::SPFEdge *end;
+      lsdb->GetEdges (i, e, end);
+      for (; e != end; e++)
+        {
+          offset[e->m_vertex + 1]++;
+        }
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      offset[i + 1] += offset[i];
+    }
+  std::vector<std::pair<uint32_t, uint32_t> > reverse (offset[n]);
+  std::vector<uint32_t> fill (offset.begin (), offset.end () - 1);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      const GlobalRouteManagerLSDB::SPFEdge *e;
+      const GlobalRouteManagerLSDB::SPFEdge *end;
+      lsdb->GetEdges (i, e, end);
+      for (; e != end; e++)
+        {
+          uint32_t cost = e->m_link ? e->m_link->GetMetric () : 0;
+          reverse[fill[e->m_vertex]++] = std::make_pair (i, cost);
+        }
+    }
+
+  distance.assign (n, std::numeric_limits<uint64_t>::max ());
+  typedef std::pair<uint64_t, uint32_t> Item;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+  distance[target] = 0;
+  queue.push (Item (0, target));
+  while (!queue.empty ())
+    {
+      Item item = queue.top ();
+      queue.pop ();
+      if (item.first > distance[item.second])
+        {
+          continue;
+        }
+      for (uint32_t k = offset[item.second]; k < offset[item.second + 1]; k++)
+        {
+          uint64_t d = item.first + reverse[k].second;
+          if (d < distance[reverse[k].first])
+            {
+              distance[reverse[k].first] = d;
+              queue.push (Item (d, reverse[k].first));
+            }
+        }
+    }
+}
+
+/**
+ * \brief Check whether the log components used by the SPF calculation are
+ *        enabled.
+ *
+ * \returns true if some of them are enabled
+ */
+static bool
+IsSpfLogEnabled (void)
+{
+  static const char *components[] = { "GlobalRouteManagerImpl", "GlobalRouter", "CandidateQueue" };
+  LogComponent::ComponentList *list = LogComponent::GetComponentList ();
+  for (uint32_t i = 0; i < sizeof (components) / sizeof (components[0]); i++)
+    {
+      LogComponent::ComponentList::const_iterator it = list->find (components[i]);
+      if (it != list->end () && !it->second->IsNoneEnabled ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,12 +905,26 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_previousLsdb (0),
+    m_rootRouter (0),
+    m_checkStubNodes (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb)
+  :
+    m_spfroot (0),
+    m_lsdb (lsdb),
+    m_previousLsdb (0),
+    m_rootRouter (0),
+    m_checkStubNodes (false)
+{
+  NS_LOG_FUNCTION (this << lsdb);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -552,6 +932,10 @@ GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
     {
       delete m_lsdb;
     }
+  if (m_previousLsdb)
+    {
+      delete m_previousLsdb;
+    }
 }
 
 void
@@ -595,7 +979,22 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
-      delete m_lsdb;
+      if (m_previousLsdb)
+        {
+          delete m_previousLsdb;
+          m_previousLsdb = 0;
+        }
+      BooleanValue incremental;
+      g_globalRoutingIncrementalSpf.GetValue (incremental);
+      if (incremental.Get () && !m_lastRootRouters.empty ())
+        {
+          // keep it to find out what changed when the routes are recomputed
+          m_previousLsdb = m_lsdb;
+        }
+      else
+        {
+          delete m_lsdb;
+        }
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
 }
@@ -696,10 +1095,13 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  m_lsdb->BuildIndex ();
+  m_checkStubNodes = NodeList::GetNNodes () > 0;
 //
-// Walk the list of nodes in the system.
+// Walk the list of nodes in the system, and gather the information needed
+// by the SPF calculation of each of them.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFRootRouter> rootRouters;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,10 +1126,249 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          rootRouters.push_back (SPFRootRouter ());
+          PrepareRootRouter (node, rtr->GetRouterId (), rootRouters.back ());
+        }
+    }
+
+  std::vector<SPFRootRouter*> pending;
+  BooleanValue incremental;
+  g_globalRoutingIncrementalSpf.GetValue (incremental);
+  if (incremental.Get () && m_previousLsdb)
+    {
+      FindAffectedRootRouters (rootRouters, pending);
+    }
+  else
+    {
+      for (std::vector<SPFRootRouter>::iterator i = rootRouters.begin (); i != rootRouters.end (); i++)
+        {
+          pending.push_back (&(*i));
         }
     }
+
+  NS_LOG_INFO ("About to start SPF calculation for " << pending.size () << " of " << rootRouters.size () << " routers");
+  RunSPFCalculations (pending);
+  for (std::vector<SPFRootRouter>::const_iterator i = rootRouters.begin (); i != rootRouters.end (); i++)
+    {
+      InstallRoutes (*i);
+    }
   NS_LOG_INFO ("Finished SPF calculation");
+
+  if (incremental.Get ())
+    {
+      m_lastRootRouters.swap (rootRouters);
+    }
+  else
+    {
+      m_lastRootRouters.clear ();
+    }
+  if (m_previousLsdb)
+    {
+      delete m_previousLsdb;
+      m_previousLsdb = 0;
+    }
+}
+
+void
+GlobalRouteManagerImpl::PrepareRootRouter (Ptr<Node> node, Ipv4Address routerId, SPFRootRouter &rootRouter)
+{
+  NS_LOG_FUNCTION (this << node << routerId);
+  rootRouter.m_routerId = routerId;
+  rootRouter.m_routing = 0;
+  rootRouter.m_interfaces.clear ();
+  rootRouter.m_routes.clear ();
+  if (node == 0)
+    {
+      return;
+    }
+  Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+  if (rtr)
+    {
+      rootRouter.m_routing = rtr->GetRoutingProtocol ();
+    }
+//
+// Collect the addresses of the interfaces in the order in which
+// Ipv4::GetInterfaceForPrefix () examines them.
+//
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4,
+                 "GlobalRouteManagerImpl::PrepareRootRouter (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          rootRouter.m_interfaces.push_back (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), i));
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (const SPFRootRouter &rootRouter)
+{
+  NS_LOG_FUNCTION (this << rootRouter.m_routerId);
+  Ptr<Ipv4GlobalRouting> gr = rootRouter.m_routing;
+  if (gr == 0)
+    {
+      NS_LOG_LOGIC ("Can't find root node " << rootRouter.m_routerId);
+      return;
+    }
+  for (std::vector<SPFRoute>::const_iterator i = rootRouter.m_routes.begin (); i != rootRouter.m_routes.end (); i++)
+    {
+      switch (i->m_type)
+        {
+        case SPFRoute::HOST_ROUTE:
+          gr->AddHostRouteTo (i->m_dest, i->m_nextHop, i->m_outIf);
+          break;
+        case SPFRoute::NETWORK_ROUTE:
+          gr->AddNetworkRouteTo (i->m_dest, i->m_mask, i->m_nextHop, i->m_outIf);
+          break;
+        case SPFRoute::EXTERNAL_ROUTE:
+          gr->AddASExternalRouteTo (i->m_dest, i->m_mask, i->m_nextHop, i->m_outIf);
+          break;
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::RunSPFCalculations (const std::vector<SPFRootRouter*> &rootRouters)
+{
+  NS_LOG_FUNCTION (this << rootRouters.size ());
+  UintegerValue threads;
+  g_globalRoutingSpfThreads.GetValue (threads);
+  uint32_t nThreads = std::min<uint32_t> (threads.Get (), rootRouters.size ());
+#ifdef HAVE_PTHREAD_H
+//
+// The SPF calculations only read the LSDB, and write the routes in their
+// SPFRootRouter, so they can run concurrently, each worker with its own
+// SPF state.  Log messages cannot be written concurrently, though.
+//
+  if (IsSpfLogEnabled ())
+    {
+      nThreads = 1;
+    }
+  if (nThreads > 1)
+    {
+      std::vector<GlobalRouteManagerImpl*> workers;
+      std::vector<Ptr<SystemThread> > systemThreads;
+      for (uint32_t k = 0; k < nThreads; k++)
+        {
+          GlobalRouteManagerImpl *worker = (k == 0) ? this : new GlobalRouteManagerImpl (m_lsdb);
+          worker->m_checkStubNodes = m_checkStubNodes;
+          worker->m_workerRootRouters.clear ();
+          for (uint32_t i = k; i < rootRouters.size (); i += nThreads)
+            {
+              worker->m_workerRootRouters.push_back (rootRouters[i]);
+            }
+          workers.push_back (worker);
+        }
+      for (uint32_t k = 1; k < nThreads; k++)
+        {
+          systemThreads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::RunSPFWorker, workers[k])));
+          systemThreads.back ()->Start ();
+        }
+      RunSPFWorker ();
+      for (uint32_t k = 1; k < nThreads; k++)
+        {
+          systemThreads[k - 1]->Join ();
+          // the LSDB is owned by this object
+          workers[k]->m_lsdb = 0;
+          delete workers[k];
+        }
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  m_workerRootRouters = rootRouters;
+  RunSPFWorker ();
+}
+
+void
+GlobalRouteManagerImpl::RunSPFWorker (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<SPFRootRouter*>::const_iterator i = m_workerRootRouters.begin (); i != m_workerRootRouters.end (); i++)
+    {
+      SPFCalculate (**i);
+    }
+  m_workerRootRouters.clear ();
+}
+
+void
+GlobalRouteManagerImpl::FindAffectedRootRouters (std::vector<SPFRootRouter> &rootRouters,
+                                                 std::vector<SPFRootRouter*> &pending)
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB *previous = m_previousLsdb;
+  previous->BuildIndex ();
+
+  std::map<Ipv4Address, SPFRootRouter*> lastRootRouters;
+  for (std::vector<SPFRootRouter>::iterator i = m_lastRootRouters.begin (); i != m_lastRootRouters.end (); i++)
+    {
+      lastRootRouters[i->m_routerId] = &(*i);
+    }
+//
+// Look for the link records whose metric changed.  Any other change of
+// the LSDB requires all the SPF calculations to be run again.
+//
+  std::vector<LinkMetricChange> changes;
+  bool comparable = FindLinkMetricChanges (previous, m_lsdb, changes);
+  NS_LOG_LOGIC ("LSDB comparable: " << comparable << ", " << changes.size () << " link metric changes");
+
+  std::vector<bool> affected (rootRouters.size (), !comparable);
+  if (comparable && !changes.empty ())
+    {
+//
+// For each changed link from U to W, compute the distance from every
+// router to U and to W in the previous LSDB.
+//
+      std::vector<uint32_t> rootIndex (rootRouters.size ());
+      for (uint32_t r = 0; r < rootRouters.size (); r++)
+        {
+          rootIndex[r] = previous->GetLSAIndex (rootRouters[r].m_routerId);
+        }
+      std::vector<uint64_t> du;
+      std::vector<uint64_t> dw;
+      for (std::vector<LinkMetricChange>::const_iterator c = changes.begin (); c != changes.end (); c++)
+        {
+          ComputeDistancesTo (previous, c->m_from, du);
+          ComputeDistancesTo (previous, c->m_to, dw);
+          for (uint32_t r = 0; r < rootRouters.size (); r++)
+            {
+              if (affected[r])
+                {
+                  continue;
+                }
+              if (rootIndex[r] == static_cast<uint32_t> (-1))
+                {
+                  affected[r] = true;
+                  continue;
+                }
+              uint64_t u = du[rootIndex[r]];
+              uint64_t w = dw[rootIndex[r]];
+              // U is not reachable: the link is never examined
+              if (u == std::numeric_limits<uint64_t>::max ())
+                {
+                  continue;
+                }
+              affected[r] = !(w < u);
+            }
+        }
+    }
+
+  for (uint32_t r = 0; r < rootRouters.size (); r++)
+    {
+      std::map<Ipv4Address, SPFRootRouter*>::iterator last = lastRootRouters.find (rootRouters[r].m_routerId);
+      if (!affected[r] && last != lastRootRouters.end ()
+          && last->second->m_interfaces == rootRouters[r].m_interfaces)
+        {
+          NS_LOG_LOGIC ("Reusing the routes of router " << rootRouters[r].m_routerId);
+          rootRouters[r].m_routes.swap (last->second->m_routes);
+        }
+      else
+        {
+          pending.push_back (&rootRouters[r]);
+        }
+    }
 }
 
 //
@@ -752,81 +1393,29 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
   GlobalRoutingLSA* w_lsa = 0;
   GlobalRoutingLinkRecord *l = 0;
   uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
 //
 // V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
-//
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
-    {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
-    }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
-    {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
-    }
-
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
-    {
-// Get w_lsa:  In case of V is Router-LSA
-      if (v->GetVertexType () == SPFVertex::VertexRouter) 
-        {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-//
-// (a) If this is a link to a stub network, examine the next link in V's LSA.
-// Links to stub networks will be considered in the second stage of the
-// shortest path calculation.
-//
-          l = v->GetLSA ()->GetLinkRecord (i);
-          NS_ASSERT (l != 0);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
-            {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              continue;
-            }
-//
-// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-// database. 
+// Loop over the links in router LSA or attached routers in Network LSA,
+// i.e., over the edges of the SPF graph leaving V.
 //
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
-            {
+// (a) Links to stub networks are not part of the graph.  They will be
+// considered in the second stage of the shortest path calculation.
 //
-// Lookup the link state advertisement of the new link -- we call it <w> in
-// the link state database.
+// (b) The edges of a Router-LSA lead to the LSA of the vertex W (router-LSA
+// or network-LSA) at the other end of a point-to-point or transit network
+// link; those of a Network-LSA lead to the Router-LSAs of the attached
+// routers.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a P2P record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-            }
-          else if (l->GetLinkType () == 
-                   GlobalRoutingLinkRecord::TransitNetwork)
-            {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a Transit record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-            }
-          else 
-            {
-              NS_ASSERT_MSG (0, "illegal Link Type");
-            }
-        }
-// Get w_lsa:  In case of V is Network-LSA
-      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
-        {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
-            {
-              continue;
-            }
-          NS_LOG_LOGIC ("Found a Network LSA from " << 
-                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
-        }
+  const GlobalRouteManagerLSDB::SPFEdge *edge;
+  const GlobalRouteManagerLSDB::SPFEdge *edgeEnd;
+  m_lsdb->GetEdges (v->GetLSAIndex (), edge, edgeEnd);
+  for (; edge != edgeEnd; ++edge)
+    {
+      l = edge->m_link;
+      uint32_t w_index = edge->m_vertex;
+      w_lsa = m_lsdb->GetLSAByIndex (w_index);
+      NS_LOG_LOGIC ("Found a record from " << 
+                    v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
 
 // Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
 //
@@ -836,7 +1425,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (m_lsaStatus[w_index] == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1450,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (m_lsaStatus[w_index] == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -871,9 +1460,11 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
+          w->SetLSAIndex (w_index);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              m_lsaStatus[w_index] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
+              m_candidateVertex[w_index] = w;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1479,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (m_lsaStatus[w_index] == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -904,7 +1495,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 * if we've found a shorter path.
 */
           SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
+          cw = m_candidateVertex[w_index];
           if (cw->GetDistanceFromRoot () < distance)
             {
 //
@@ -935,6 +1526,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
+              w->SetLSAIndex (w_index);
               SPFNexthopCalculation (v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
@@ -1247,7 +1839,18 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  m_lsdb->BuildIndex ();
+  m_checkStubNodes = NodeList::GetNNodes () > 0;
+  Ptr<Node> node = 0;
+  GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
+  if (m_checkStubNodes && rlsa)
+    {
+      node = rlsa->GetNode ();
+    }
+  SPFRootRouter rootRouter;
+  PrepareRootRouter (node, root, rootRouter);
+  SPFCalculate (rootRouter);
+  InstallRoutes (rootRouter);
 }
 
 //
@@ -1320,12 +1923,13 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  SPFRoute route;
+                  route.m_type = SPFRoute::NETWORK_ROUTE;
+                  route.m_dest = Ipv4Address ("0.0.0.0");
+                  route.m_mask = Ipv4Mask ("0.0.0.0");
+                  route.m_nextHop = lr->GetLinkData ();
+                  route.m_outIf = FindOutgoingInterfaceId (transitLink->GetLinkData ());
+                  m_rootRouter->m_routes.push_back (route);
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
                                 FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1339,15 +1943,23 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (SPFRootRouter &rootRouter)
 {
+  Ipv4Address root = rootRouter.m_routerId;
   NS_LOG_FUNCTION (this << root);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the SPF status of the Link State Advertisements.  It is kept
+// here, rather than in the (shared) Link State Database, so that several
+// calculations can run at the same time.
 //
-  m_lsdb->Initialize ();
+  m_rootRouter = &rootRouter;
+  uint32_t nLSAs = m_lsdb->GetNumLSAs ();
+  m_lsaStatus.assign (nLSAs, GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  m_candidateVertex.assign (nLSAs, 0);
+  int32_t rootIndex = m_lsdb->GetLSAIndex (root);
+  NS_ASSERT_MSG (rootIndex >= 0, "No LSA for root router " << root);
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1360,14 +1972,15 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
 //
-  v = new SPFVertex (m_lsdb->GetLSA (root));
+  v = new SPFVertex (m_lsdb->GetLSAByIndex (rootIndex));
+  v->SetLSAIndex (rootIndex);
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  m_lsaStatus[rootIndex] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +1990,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_checkStubNodes && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_rootRouter = 0;
       return;
     }
 
@@ -1428,7 +2043,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      m_lsaStatus[v->GetLSAIndex ()] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
+      m_candidateVertex[v->GetLSAIndex ()] = 0;
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1502,6 +2118,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_rootRouter = 0;
 }
 
 void
@@ -1560,58 +2177,23 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The routes are recorded in the router at the root of the SPF tree, and
+// installed on its node once the calculation is over.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  NS_ASSERT_MSG (m_rootRouter, 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): Root router not set");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2208,35 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.m_type = SPFRoute::EXTERNAL_ROUTE;
+          route.m_dest = tempip;
+          route.m_mask = tempmask;
+          route.m_nextHop = nextHop;
+          route.m_outIf = outIf;
+          m_rootRouter->m_routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1729,60 +2307,23 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
+// The routes are recorded in the router at the root of the SPF tree, and
+// installed on its node once the calculation is over.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  NS_ASSERT_MSG (m_rootRouter, 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): Root router not set");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,46 +2337,41 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.m_type = SPFRoute::NETWORK_ROUTE;
+          route.m_dest = tempip;
+          route.m_mask = tempmask;
+          route.m_nextHop = nextHop;
+          route.m_outIf = outIf;
+          m_rootRouter->m_routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is equivalent to GetInterfaceForPrefix() on the node at the root of
+// the SPF tree, whose interface addresses have been gathered beforehand.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
@@ -1844,69 +2380,26 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// We have an IP address <a> and the router at the root of the SPF tree.
+// Look through the interface addresses of that router for one that is in
+// the same prefix as the address in question.  If we find one, return the
+// corresponding interface index, or -1 if not found.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_ASSERT_MSG (m_rootRouter, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): Root router not set");
+  const InterfaceAddressList_t &interfaces = m_rootRouter->m_interfaces;
+  Ipv4Address prefix = a.CombineMask (amask);
+  for (InterfaceAddressList_t::const_iterator i = interfaces.begin (); i != interfaces.end (); i++)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
+      if (i->first.CombineMask (amask) == prefix)
         {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+          return i->second;
         }
     }
 //
 // Couldn't find it.
 //
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find interface for " << a << " on router " << m_rootRouter->m_routerId);
   return -1;
 }
 
@@ -1944,60 +2437,23 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
+// The routes are recorded in the router at the root of the SPF tree, and
+// installed on its node once the calculation is over.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  NS_ASSERT_MSG (m_rootRouter, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root router not set");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2462,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,46 +2487,38 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              SPFRoute route;
+              route.m_type = SPFRoute::HOST_ROUTE;
+              route.m_dest = lr->GetLinkData ();
+              route.m_nextHop = nextHop;
+              route.m_outIf = outIf;
+              m_rootRouter->m_routes.push_back (route);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 {
@@ -2089,95 +2537,55 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The routes are recorded in the router at the root of the SPF tree, and
+// installed on its node once the calculation is over.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  NS_ASSERT_MSG (m_rootRouter, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root router not set");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          SPFRoute route;
+          route.m_type = SPFRoute::NETWORK_ROUTE;
+          route.m_dest = tempip;
+          route.m_mask = tempmask;
+          route.m_nextHop = nextHop;
+          route.m_outIf = outIf;
+          m_rootRouter->m_routes.push_back (route);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -175,6 +175,24 @@ public:
  */
   void SetVertexId (Ipv4Address id);
 
+/**
+ * @brief Get the index, in the Link State Database, of the Link State
+ * Advertisement of this SPFVertex.
+ *
+ * @see GlobalRouteManagerLSDB::GetLSAIndex
+ * @returns The index of the LSA in the Link State Database.
+ */
+  uint32_t GetLSAIndex (void) const;
+
+/**
+ * @brief Set the index, in the Link State Database, of the Link State
+ * Advertisement of this SPFVertex.
+ *
+ * @see GlobalRouteManagerLSDB::GetLSAIndex
+ * @param index The index of the LSA in the Link State Database.
+ */
+  void SetLSAIndex (uint32_t index);
+
 /**
  * @brief Get the Global Router Link State Advertisement returned by the 
  * Global Router represented by this SPFVertex during the route discovery 
@@ -529,6 +547,7 @@ private:
   VertexType m_vertexType; //!< Vertex type
   Ipv4Address m_vertexId; //!< Vertex ID
   GlobalRoutingLSA* m_lsa; //!< Link State Advertisement
+  uint32_t m_lsaIndex; //!< Index of the Link State Advertisement in the LSDB
   uint32_t m_distanceFromRoot; //!< Distance from root node
   int32_t m_rootOif; //!< root Output Interface
   Ipv4Address m_nextHop; //!< next hop
@@ -674,6 +693,65 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief An edge of the graph explored by the SPF calculation.
+   *
+   * The edges leaving a Router-LSA correspond to its point-to-point and
+   * transit network link records; the edges leaving a Network-LSA lead to
+   * the Router-LSAs of its attached routers.
+   */
+  struct SPFEdge
+  {
+    uint32_t m_vertex; //!< index of the LSA at the other end of the edge
+    GlobalRoutingLinkRecord *m_link; //!< link record of the edge, 0 for edges leaving a Network-LSA
+  };
+
+  /**
+   * @brief Build the flat, index-based view of the database used by the
+   * SPF calculation.
+   *
+   * Each (non external) LSA gets an index, in the order of its address,
+   * and the graph of the LSAs is stored in compressed sparse row form, so
+   * that the SPF calculation does not need to search the database.  The
+   * index is invalidated by Insert () and is only rebuilt if needed.
+   */
+  void BuildIndex ();
+
+  /**
+   * @brief Get the number of (non external) Link State Advertisements.
+   *
+   * @returns the number of Link State Advertisements.
+   */
+  uint32_t GetNumLSAs () const;
+
+  /**
+   * @brief Get a Link State Advertisement by its index.
+   *
+   * @see BuildIndex
+   * @param index the index of the LSA
+   * @returns A pointer to the Link State Advertisement.
+   */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+
+  /**
+   * @brief Get the index of the Link State Advertisement associated with
+   * the given link state ID (address).
+   *
+   * @see BuildIndex
+   * @param addr The IP address associated with the LSA.
+   * @returns the index of the LSA, or -1 if there is no such LSA.
+   */
+  int32_t GetLSAIndex (Ipv4Address addr) const;
+
+  /**
+   * @brief Get the edges leaving a Link State Advertisement.
+   *
+   * @see BuildIndex
+   * @param index the index of the LSA
+   * @param [out] begin the first edge leaving the LSA
+   * @param [out] end one past the last edge leaving the LSA
+   */
+  void GetEdges (uint32_t index, const SPFEdge* &begin, const SPFEdge* &end) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -682,6 +760,13 @@ private:
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
+  bool m_indexValid; //!< whether the index built by BuildIndex () is up to date
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< LSAs, by index
+  std::map<Ipv4Address, uint32_t> m_lsaIndex; //!< index of the LSA associated with an address
+  std::map<Ipv4Address, GlobalRoutingLSA*> m_linkDataIndex; //!< LSA with a transit link record with a given link data
+  std::vector<uint32_t> m_edgeOffset; //!< offset of the edges of each LSA in m_edges
+  std::vector<SPFEdge> m_edges; //!< edges of the graph of the LSAs
+
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
  * need for it and a compiler provided shallow copy would be wrong.
@@ -732,6 +817,14 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF calculations rooted at the different routers are independent
+ * and, if the "GlobalRoutingSpfThreads" global value is larger than one,
+ * they are spread over that many threads.  If the
+ * "GlobalRoutingIncrementalSpf" global value is true, the routes computed
+ * for each router are kept so that, after a change of the link metrics,
+ * only the routers whose SPF tree may be affected by the change are
+ * recomputed.
  */
   virtual void InitializeRoutes ();
 
@@ -766,8 +859,110 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * @brief Construct a worker sharing the given Link State Database,
+   * used to run SPF calculations in a separate thread.
+   *
+   * @param lsdb the Link State Database
+   */
+  GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb);
+
+  /**
+   * @brief A route computed by the SPF calculation for the root router.
+   */
+  struct SPFRoute
+  {
+    /// Route type
+    enum RouteType
+    {
+      HOST_ROUTE,     //!< host route, see Ipv4GlobalRouting::AddHostRouteTo
+      NETWORK_ROUTE,  //!< network route, see Ipv4GlobalRouting::AddNetworkRouteTo
+      EXTERNAL_ROUTE  //!< AS external route, see Ipv4GlobalRouting::AddASExternalRouteTo
+    };
+    RouteType m_type; //!< the route type
+    Ipv4Address m_dest; //!< the destination
+    Ipv4Mask m_mask; //!< the network mask (unused for host routes)
+    Ipv4Address m_nextHop; //!< the next hop
+    uint32_t m_outIf; //!< the outgoing interface
+  };
+
+  /// List of (local address, interface index) of the interfaces of a router
+  typedef std::vector<std::pair<Ipv4Address, int32_t> > InterfaceAddressList_t;
+
+  /**
+   * @brief A router for which the SPF calculation is run.
+   *
+   * Everything the SPF calculation needs to know about the router is
+   * gathered beforehand, so that the calculation itself does not access
+   * any ns-3 object and can run in a separate thread; the routes it
+   * computes are stored here, to be installed afterwards.
+   */
+  struct SPFRootRouter
+  {
+    Ipv4Address m_routerId; //!< the router ID
+    Ptr<Ipv4GlobalRouting> m_routing; //!< the routing protocol where the routes are installed
+    InterfaceAddressList_t m_interfaces; //!< the interface addresses of the router
+    std::vector<SPFRoute> m_routes; //!< the routes computed by the SPF calculation
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  GlobalRouteManagerLSDB* m_previousLsdb; //!< the LSDB deleted by the last DeleteGlobalRoutes (), used by incremental SPF
+  std::vector<SPFRootRouter> m_lastRootRouters; //!< the routers (and routes) of the last SPF calculations, used by incremental SPF
+
+  SPFRootRouter* m_rootRouter; //!< the router at the root of the current SPF calculation
+  bool m_checkStubNodes; //!< whether stub routers only get a default route
+  std::vector<uint8_t> m_lsaStatus; //!< SPF status (GlobalRoutingLSA::SPFStatus) of each LSA, by LSA index
+  std::vector<SPFVertex*> m_candidateVertex; //!< vertex in the candidate queue for each LSA, by LSA index
+  std::vector<SPFRootRouter*> m_workerRootRouters; //!< routers whose SPF calculation is run by this worker
+
+  /**
+   * \brief Gather the information needed by the SPF calculation rooted at
+   *        a given router.
+   *
+   * \param node the node of the router, possibly 0
+   * \param routerId the router ID
+   * \param [out] rootRouter the router information
+   */
+  void PrepareRootRouter (Ptr<Node> node, Ipv4Address routerId, SPFRootRouter &rootRouter);
+
+  /**
+   * \brief Install the routes computed by the SPF calculation on a router.
+   *
+   * \param rootRouter the router
+   */
+  void InstallRoutes (const SPFRootRouter &rootRouter);
+
+  /**
+   * \brief Run the SPF calculation for the given routers, possibly in
+   *        several threads.
+   *
+   * \param rootRouters the routers
+   */
+  void RunSPFCalculations (const std::vector<SPFRootRouter*> &rootRouters);
+
+  /**
+   * \brief Run the SPF calculations assigned to this worker.
+   */
+  void RunSPFWorker (void);
+
+  /**
+   * \brief Find the routers whose SPF calculation must be run again, by
+   *        comparing the LSDB with the one used by the last calculations.
+   *
+   * Only changes of the metric of point-to-point and transit network link
+   * records are handled incrementally.  Such a change of the link from
+   * vertex U to vertex W cannot affect the SPF calculation rooted at a
+   * router R if, in the previous LSDB, W is strictly closer to R than U:
+   * W is then already in the SPF tree when U is examined, so that the link
+   * is skipped, whatever its metric.  The routers whose calculation is not
+   * affected by any change reuse the routes of the last calculation.
+   *
+   * \param rootRouters the routers
+   * \param [out] pending the routers whose SPF calculation must be run
+   */
+  void FindAffectedRootRouters (std::vector<SPFRootRouter> &rootRouters,
+                                std::vector<SPFRootRouter*> &pending);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -785,9 +980,10 @@ private:
    * \brief Calculate the shortest path first (SPF) tree
    *
    * Equivalent to quagga ospf_spf_calculate
-   * \param root the root node
+   * \param rootRouter the router at the root of the tree; the computed
+   *        routes are stored in it
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (SPFRootRouter &rootRouter);
 
   /**
    * \brief Process Stub nodes
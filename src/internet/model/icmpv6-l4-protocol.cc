@@ -31,6 +31,7 @@
 #include "ns3/pointer.h"
 #include "ns3/string.h"
 #include "ns3/integer.h"
+#include "ns3/simulator.h"
 
 #include "ipv6-raw-socket-factory-impl.h"
 #include "ipv6-l3-protocol.h"
@@ -120,6 +121,7 @@ void Icmpv6L4Protocol::DoDispose ()
       cache = 0;
     }
   m_cacheList.clear ();
+  m_cacheByDevice.clear ();
   m_downTarget.Nullify ();
 
   m_node = 0;
@@ -1269,12 +1271,11 @@ Ptr<NdiscCache> Icmpv6L4Protocol::FindCache (Ptr<NetDevice> device)
 {
   NS_LOG_FUNCTION (this << device);
 
-  for (CacheList::const_iterator i = m_cacheList.begin (); i != m_cacheList.end (); i++)
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex < m_cacheByDevice.size () && m_cacheByDevice[ifIndex] != 0
+      && m_cacheByDevice[ifIndex]->GetDevice () == device)
     {
-      if ((*i)->GetDevice () == device)
-        {
-          return *i;
-        }
+      return m_cacheByDevice[ifIndex];
     }
 
   NS_ASSERT (false);
@@ -1291,6 +1292,11 @@ Ptr<NdiscCache> Icmpv6L4Protocol::CreateCache (Ptr<NetDevice> device, Ptr<Ipv6In
   cache->SetDevice (device, interface, this);
   device->AddLinkChangeCallback (MakeCallback (&NdiscCache::Flush, cache));
   m_cacheList.push_back (cache);
+  if (device->GetIfIndex () >= m_cacheByDevice.size ())
+    {
+      m_cacheByDevice.resize (device->GetIfIndex () + 1);
+    }
+  m_cacheByDevice[device->GetIfIndex ()] = cache;
   return cache;
 }
 
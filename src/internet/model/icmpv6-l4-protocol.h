@@ -24,6 +24,7 @@
 #define ICMPV6_L4_PROTOCOL_H
 
 #include <list>
+#include <vector>
 
 #include "ns3/ipv6-address.h"
 #include "ns3/random-variable-stream.h"
@@ -419,6 +420,11 @@ private:
    */
   CacheList m_cacheList;
 
+  /**
+   * \brief The caches, indexed by the index of their device in the node.
+   */
+  std::vector<Ptr<NdiscCache> > m_cacheByDevice;
+
   /**
    * \brief Always do DAD ?
    */
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The connected endpoints (local address, peer address and peer port all
+ * set) are indexed in a hash table by their four-tuple, and the other
+ * endpoints in a table by local port, so that a lookup only looks at the
+ * endpoints which can match the packet.  The endpoints notify the demux
+ * when their addresses or bound device change, to keep the tables up to
+ * date.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +175,93 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Four-tuple of a connected endpoint.
+   */
+  struct FourTuple
+  {
+    Ipv4Address m_localAddr; //!< local address
+    Ipv4Address m_peerAddr;  //!< peer address
+    uint16_t m_localPort;    //!< local port
+    uint16_t m_peerPort;     //!< peer port
+
+    /**
+     * \brief Equality operator.
+     * \param other the other four-tuple
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const
+    {
+      return m_localPort == other.m_localPort && m_peerPort == other.m_peerPort
+             && m_localAddr == other.m_localAddr && m_peerAddr == other.m_peerAddr;
+    }
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \param t the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &t) const
+    {
+      Ipv4AddressHash hash;
+      return (hash (t.m_localAddr) * 31 + hash (t.m_peerAddr)) * 31
+             + ((static_cast<size_t> (t.m_localPort) << 16) | t.m_peerPort);
+    }
+  };
+
+  /**
+   * \brief The endpoints bound to a local port.
+   */
+  struct LocalPort
+  {
+    EndPoints m_unconnected; //!< the endpoints which are not connected, in allocation order
+    std::map<std::pair<Ipv4Address, NetDevice *>, uint32_t> m_bindings; //!< number of endpoints by local address and bound device
+  };
+
+  /**
+   * \brief Container of the connected endpoints, by four-tuple.
+   */
+  typedef std::unordered_map<FourTuple, EndPoints, FourTupleHash> ConnectedEndPoints;
+
+  /**
+   * \brief Container of the endpoints, by local port.
+   */
+  typedef std::unordered_map<uint16_t, LocalPort> LocalPorts;
+
+  /**
+   * \brief Check whether an endpoint is indexed by its four-tuple.
+   * \param localAddress the local address of the endpoint
+   * \param peerAddress the peer address of the endpoint
+   * \param peerPort the peer port of the endpoint
+   * \return true if the endpoint is connected
+   */
+  static bool IsConnected (Ipv4Address localAddress, Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add an endpoint to the lookup tables.
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the lookup tables.
+   * \param endPoint the endpoint
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add a new endpoint to the demux.
+   * \param endPoint the endpoint
+   * \return the endpoint
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +288,16 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The connected end points, by four-tuple.
+   */
+  ConnectedEndPoints m_connected;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  LocalPorts m_localPorts;
 };
 
 } // namespace ns3
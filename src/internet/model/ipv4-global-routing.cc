@@ -17,6 +17,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -37,6 +38,42 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4GlobalRouting);
 
+/**
+ * \brief Insert a network route in a route index.
+ * \param index the index
+ * \param route the route
+ * \returns false if the mask of the route is not contiguous, so that the
+ *          route cannot be indexed by prefix
+ */
+static bool
+IndexRoute (PrefixTrie<Ipv4RoutingTableEntry *, 4> &index, Ipv4RoutingTableEntry *route)
+{
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint32_t hostBits = ~mask.Get ();
+  if ((hostBits & (hostBits + 1)) != 0)
+    {
+      NS_LOG_LOGIC ("Route with non-contiguous mask " << mask << ", not using the route index");
+      return false;
+    }
+  uint8_t buf[4];
+  route->GetDestNetwork ().CombineMask (mask).Serialize (buf);
+  index.Insert (buf, mask.GetPrefixLength (), route);
+  return true;
+}
+
+/**
+ * \brief Compare indexed routes by their position in the routing table.
+ * \param a a route
+ * \param b another route
+ * \returns true if a comes before b
+ */
+static bool
+CompareRouteSeq (const PrefixTrie<Ipv4RoutingTableEntry *, 4>::Value &a,
+                 const PrefixTrie<Ipv4RoutingTableEntry *, 4>::Value &b)
+{
+  return a.m_seq < b.m_seq;
+}
+
 TypeId 
 Ipv4GlobalRouting::GetTypeId (void)
 { 
@@ -59,7 +96,9 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_routeIndexValid (false),
+    m_routeIndexIrregular (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +119,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void 
@@ -90,6 +130,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void 
@@ -105,6 +146,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void 
@@ -118,6 +160,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void 
@@ -133,6 +176,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 
@@ -146,71 +190,150 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  UpdateRouteIndex ();
+  if (!m_routeIndexIrregular)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      uint8_t buf[4];
+      dest.Serialize (buf);
+
+      NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+      const RouteTrie::ValueList *hostRoutes = m_hostRouteIndex.Find (buf, 32);
+      if (hostRoutes != 0)
         {
-          if (oif != 0)
+          for (RouteTrie::ValueList::const_iterator i = hostRoutes->begin (); i != hostRoutes->end (); i++)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != 0 && oif != m_ipv4->GetNetDevice (i->m_value->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
+              allRoutes.push_back (i->m_value);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->m_value);
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
-    }
-  if (allRoutes.size () == 0) // if no host route is found
-    {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      if (allRoutes.size () == 0) // if no host route is found
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+          // gather the routes of all the matching prefixes and put them
+          // back in the order of the table
+          m_networkRouteIndex.Lookup (buf, m_routeMatches);
+          m_matchedRoutes.clear ();
+          for (RouteTrie::MatchList::const_iterator m = m_routeMatches.begin (); m != m_routeMatches.end (); m++)
             {
-              if (oif != 0)
+              m_matchedRoutes.insert (m_matchedRoutes.end (), (*m)->begin (), (*m)->end ());
+            }
+          if (m_routeMatches.size () > 1)
+            {
+              std::sort (m_matchedRoutes.begin (), m_matchedRoutes.end (), CompareRouteSeq);
+            }
+          for (std::vector<RouteTrie::Value>::const_iterator j = m_matchedRoutes.begin (); j != m_matchedRoutes.end (); j++)
+            {
+              if (oif != 0 && oif != m_ipv4->GetNetDevice (j->m_value->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
+                }
+              allRoutes.push_back (j->m_value);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << j->m_value);
+            }
+        }
+      if (allRoutes.size () == 0)  // consider external if no host/network found
+        {
+          // the first matching route of the table
+          m_ASexternalRouteIndex.Lookup (buf, m_routeMatches);
+          const RouteTrie::Value *first = 0;
+          for (RouteTrie::MatchList::const_iterator m = m_routeMatches.begin (); m != m_routeMatches.end (); m++)
+            {
+              for (RouteTrie::ValueList::const_iterator k = (*m)->begin (); k != (*m)->end (); k++)
+                {
+                  if (first != 0 && first->m_seq < k->m_seq)
+                    {
+                      break;
+                    }
+                  if (oif != 0 && oif != m_ipv4->GetNetDevice (k->m_value->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
+                  first = &(*k);
+                  break;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+            }
+          if (first != 0)
+            {
+              NS_LOG_LOGIC ("Found external route" << first->m_value);
+              allRoutes.push_back (first->m_value);
             }
         }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  else
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+      for (HostRoutesCI i = m_hostRoutes.begin (); 
+           i != m_hostRoutes.end (); 
+           i++) 
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_ASSERT ((*i)->IsHost ());
+          if ((*i)->GetDest ().IsEqual (dest)) 
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
-              break;
+              allRoutes.push_back (*i);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+            }
+        }
+      if (allRoutes.size () == 0) // if no host route is found
+        {
+          NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+          for (NetworkRoutesI j = m_networkRoutes.begin (); 
+               j != m_networkRoutes.end (); 
+               j++) 
+            {
+              Ipv4Mask mask = (*j)->GetDestNetworkMask ();
+              Ipv4Address entry = (*j)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry)) 
+                {
+                  if (oif != 0)
+                    {
+                      if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
+                    }
+                  allRoutes.push_back (*j);
+                  NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+                }
+            }
+        }
+      if (allRoutes.size () == 0)  // consider external if no host/network found
+        {
+          for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
+               k != m_ASexternalRoutes.end ();
+               k++)
+            {
+              Ipv4Mask mask = (*k)->GetDestNetworkMask ();
+              Ipv4Address entry = (*k)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry))
+                {
+                  NS_LOG_LOGIC ("Found external route" << *k);
+                  if (oif != 0)
+                    {
+                      if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
+                    }
+                  allRoutes.push_back (*k);
+                  break;
+                }
             }
         }
     }
@@ -245,6 +368,43 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::UpdateRouteIndex (void)
+{
+  if (m_routeIndexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_hostRouteIndex.Clear ();
+  m_networkRouteIndex.Clear ();
+  m_ASexternalRouteIndex.Clear ();
+  m_routeIndexIrregular = false;
+  m_routeIndexValid = true;
+  uint8_t buf[4];
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      (*i)->GetDest ().Serialize (buf);
+      m_hostRouteIndex.Insert (buf, 32, *i);
+    }
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+    {
+      if (!IndexRoute (m_networkRouteIndex, *j))
+        {
+          m_routeIndexIrregular = true;
+          return;
+        }
+    }
+  for (ASExternalRoutesCI k = m_ASexternalRoutes.begin (); k != m_ASexternalRoutes.end (); k++)
+    {
+      if (!IndexRoute (m_ASexternalRouteIndex, *k))
+        {
+          m_routeIndexIrregular = true;
+          return;
+        }
+    }
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -321,6 +481,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
               delete *i;
               m_hostRoutes.erase (i);
+              m_routeIndexValid = false;
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
               return;
             }
@@ -338,6 +499,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
           delete *j;
           m_networkRoutes.erase (j);
+          m_routeIndexValid = false;
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -354,6 +516,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
           delete *k;
           m_ASexternalRoutes.erase (k);
+          m_routeIndexValid = false;
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
           return;
         }
@@ -392,6 +555,10 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteIndex.Clear ();
+  m_networkRouteIndex.Clear ();
+  m_ASexternalRouteIndex.Clear ();
+  m_routeIndexValid = false;
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -268,10 +269,26 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Rebuild the indexes of the routes, if they are out of date.
+   */
+  void UpdateRouteIndex (void);
+
+  /// Trie of routes, by destination prefix
+  typedef PrefixTrie<Ipv4RoutingTableEntry *, 4> RouteTrie;
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  bool m_routeIndexValid;        //!< whether the route indexes are up to date with the route lists
+  bool m_routeIndexIrregular;    //!< whether a route has a non-contiguous mask, so that the indexes cannot be used
+  RouteTrie m_hostRouteIndex;       //!< index of m_hostRoutes
+  RouteTrie m_networkRouteIndex;    //!< index of m_networkRoutes
+  RouteTrie m_ASexternalRouteIndex; //!< index of m_ASexternalRoutes
+  RouteTrie::MatchList m_routeMatches; //!< scratch list of the index entries matching a destination
+  std::vector<RouteTrie::Value> m_matchedRoutes; //!< scratch list of the routes matching a destination
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -33,6 +33,8 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/simulator.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -41,6 +43,8 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-option-ts.h"
 
 namespace ns3 {
 
@@ -69,6 +73,19 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("GenericReceiveOffload",
+                   "Coalesce the in-order TCP segments of a flow received at "
+                   "the same time, and deliver them to TCP as a single packet "
+                   "(generic receive offload).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4L3Protocol::m_gro),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GroMaxFlows",
+                   "Maximum number of flows held at once by the generic receive "
+                   "offload; the oldest flow is delivered to make room for a new one.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_groMaxFlows),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -108,8 +125,18 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_gro (false),
+    m_groMaxFlows (8)
 {
   NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < (1u << IDENTIFICATION_CACHE_BITS); i++)
+    {
+      m_identificationCache[i].counter = 0;
+    }
+  m_ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  m_mcb = MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this);
+  m_lcb = MakeCallback (&Ipv4L3Protocol::LocalDeliver, this);
+  m_ecb = MakeCallback (&Ipv4L3Protocol::RouteInputError, this);
 }
 
 Ipv4L3Protocol::~Ipv4L3Protocol ()
@@ -304,19 +331,17 @@ Ipv4L3Protocol::DoDispose (void)
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
-      it->second = 0;
-    }
-
-  for (MapFragmentsTimers_t::iterator it = m_fragmentsTimers.begin (); it != m_fragmentsTimers.end (); it++)
-    {
-      if (it->second.IsRunning ())
-        {
-          it->second.Cancel ();
-        }
+      m_timerWheel->Cancel (m_reassemblyBuffers[it->second].m_timer);
     }
 
   m_fragments.clear ();
-  m_fragmentsTimers.clear ();
+  m_reassemblyBuffers.clear ();
+  m_freeReassemblyBuffers.clear ();
+  m_timerWheel = 0;
+  m_fragmentsTimeoutCallback = Callback<void, uint64_t> ();
+
+  m_groFlushEvent.Cancel ();
+  m_groFlows.clear ();
 
   Object::DoDispose ();
 }
@@ -398,7 +423,12 @@ Ipv4L3Protocol::AddIpv4Interface (Ptr<Ipv4Interface>interface)
   NS_LOG_FUNCTION (this << interface);
   uint32_t index = m_interfaces.size ();
   m_interfaces.push_back (interface);
-  m_reverseInterfacesContainer[interface->GetDevice ()] = index;
+  uint32_t ifIndex = interface->GetDevice ()->GetIfIndex ();
+  if (ifIndex >= m_reverseInterfacesContainer.size ())
+    {
+      m_reverseInterfacesContainer.resize (ifIndex + 1, -1);
+    }
+  m_reverseInterfacesContainer[ifIndex] = index;
   return index;
 }
 
@@ -471,10 +501,16 @@ Ipv4L3Protocol::GetInterfaceForDevice (
 {
   NS_LOG_FUNCTION (this << device);
 
-  Ipv4InterfaceReverseContainer::const_iterator iter = m_reverseInterfacesContainer.find (device);
-  if (iter != m_reverseInterfacesContainer.end ())
+  // the index of a device in its node is the position of its interface index in
+  // the container. Check the device of the interface, because devices of other
+  // nodes may share the same index
+  if (device != 0 && device->GetIfIndex () < m_reverseInterfacesContainer.size ())
     {
-      return (*iter).second;
+      int32_t interface = m_reverseInterfacesContainer[device->GetIfIndex ()];
+      if (interface >= 0 && m_interfaces[interface]->GetDevice () == device)
+        {
+          return interface;
+        }
     }
 
   return -1;
@@ -562,7 +598,10 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
 
   if (ipv4Interface->IsUp ())
     {
-      m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+      if (!m_rxTrace.IsEmpty ())
+        {
+          m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+        }
     }
   else
     {
@@ -631,12 +670,7 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
-                                      MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
-                                      ))
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, m_ucb, m_mcb, m_lcb, m_ecb))
     {
       NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
       m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
@@ -709,11 +743,15 @@ Ipv4L3Protocol::SendWithHeader (Ptr<Packet> packet,
 
 void
 Ipv4L3Protocol::CallTxTrace (const Ipv4Header & ipHeader, Ptr<Packet> packet,
-                                    Ptr<Ipv4> ipv4, uint32_t interface)
+                                    uint32_t interface)
 {
+  if (m_txTrace.IsEmpty ())
+    {
+      return;
+    }
   Ptr<Packet> packetCopy = packet->Copy ();
   packetCopy->AddHeader (ipHeader);
-  m_txTrace (packetCopy, ipv4, interface);
+  m_txTrace (packetCopy, m_node->GetObject<Ipv4> (), interface);
 }
 
 void 
@@ -779,7 +817,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               NS_ASSERT (packetCopy->GetSize () <= outInterface->GetDevice ()->GetMtu ());
 
               m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
-              CallTxTrace (ipHeader, packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+              CallTxTrace (ipHeader, packetCopy, ifaceIndex);
               outInterface->Send (packetCopy, ipHeader, destination);
             }
         }
@@ -803,7 +841,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
               Ptr<Packet> packetCopy = packet->Copy ();
               m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
-              CallTxTrace (ipHeader, packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+              CallTxTrace (ipHeader, packetCopy, ifaceIndex);
               outInterface->Send (packetCopy, ipHeader, destination);
               return;
             }
@@ -882,13 +920,13 @@ Ipv4L3Protocol::BuildHeader (
   uint64_t src = source.Get ();
   uint64_t dst = destination.Get ();
   uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
+  uint16_t &identification = GetIdentification (srcDst, protocol);
 
   if (mayFragment == true)
     {
       ipHeader.SetMayFragment ();
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification);
+      identification++;
     }
   else
     {
@@ -897,8 +935,8 @@ Ipv4L3Protocol::BuildHeader (
       // identification requirement:
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification);
+      identification++;
     }
   if (Node::ChecksumEnabled ())
     {
@@ -907,6 +945,21 @@ Ipv4L3Protocol::BuildHeader (
   return ipHeader;
 }
 
+uint16_t &
+Ipv4L3Protocol::GetIdentification (uint64_t srcDst, uint8_t protocol)
+{
+  IdentificationKey_t key = std::make_pair (srcDst, protocol);
+  IdentificationCacheEntry &entry =
+    m_identificationCache[IdentificationKeyHash::Mix (key) >> (64 - IDENTIFICATION_CACHE_BITS)];
+  if (entry.counter == 0 || entry.key != key)
+    {
+      // the elements of the unordered map are never moved
+      entry.key = key;
+      entry.counter = &m_identification[key];
+    }
+  return *entry.counter;
+}
+
 void
 Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
                              Ptr<Packet> packet,
@@ -925,24 +978,49 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // A packet carrying several segments (see SegmentationOffload) goes to
+  // the device as a whole, and its segments use consecutive identifications.
+  // It is split here if the device cannot do it.
+  SegmentationOffloadTag offloadTag;
+  bool offloaded = packet->PeekPacketTag (offloadTag);
+  if (offloaded)
+    {
+      uint64_t srcDst = ipHeader.GetDestination ().Get () | (uint64_t (ipHeader.GetSource ().Get ()) << 32);
+      GetIdentification (srcDst, ipHeader.GetProtocol ()) += offloadTag.GetSegmentCount () - 1;
+      if (!outDev->SupportsSegmentationOffload ())
+        {
+          NS_LOG_LOGIC ("Segmenting a packet of " << packet->GetSize () << " bytes");
+          packet->AddHeader (ipHeader);
+          std::vector<Ptr<Packet> > segments;
+          SegmentationOffload::Segment (PROT_NUMBER, packet, segments);
+          for (std::vector<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+            {
+              Ipv4Header segmentHeader;
+              (*it)->RemoveHeader (segmentHeader);
+              SendRealOut (route, *it, segmentHeader);
+            }
+          return;
+        }
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( !offloaded && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
-                  CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
+                  CallTxTrace (it->second, it->first, interface);
                   outInterface->Send (it->first, it->second, route->GetGateway ());
                 }
             }
           else
             {
-              CallTxTrace (ipHeader, packet, m_node->GetObject<Ipv4> (), interface);
+              CallTxTrace (ipHeader, packet, interface);
               outInterface->Send (packet, ipHeader, route->GetGateway ());
             }
         }
@@ -957,20 +1035,20 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( !offloaded && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   NS_LOG_LOGIC ("Sending fragment " << *(it->first) );
-                  CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
+                  CallTxTrace (it->second, it->first, interface);
                   outInterface->Send (it->first, it->second, ipHeader.GetDestination ());
                 }
             }
           else
             {
-              CallTxTrace (ipHeader, packet, m_node->GetObject<Ipv4> (), interface);
+              CallTxTrace (ipHeader, packet, interface);
               outInterface->Send (packet, ipHeader, ipHeader.GetDestination ());
             }
         }
@@ -1080,6 +1158,18 @@ Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uin
 
   m_localDeliverTrace (ipHeader, p, iif);
 
+  if (m_gro && ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER)
+    {
+      GroReceive (p, ipHeader, iif);
+      return;
+    }
+  DeliverToL4 (p, ipHeader, iif);
+}
+
+void
+Ipv4L3Protocol::DeliverToL4 (Ptr<Packet> p, Ipv4Header const &ipHeader, uint32_t iif)
+{
+  NS_LOG_FUNCTION (this << p << ipHeader << iif);
   Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetProtocol (), iif);
   if (protocol != 0)
     {
@@ -1120,6 +1210,173 @@ Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uin
     }
 }
 
+// This function analogous to Linux tcp_gro_receive()
+void
+Ipv4L3Protocol::GroReceive (Ptr<Packet> p, Ipv4Header const &ipHeader, uint32_t iif)
+{
+  NS_LOG_FUNCTION (this << p << ipHeader << iif);
+  TcpHeader tcpHeader;
+  if (Node::ChecksumEnabled ())
+    {
+      tcpHeader.EnableChecksums ();
+      tcpHeader.InitializeChecksum (ipHeader.GetSource (), ipHeader.GetDestination (),
+                                    TcpL4Protocol::PROT_NUMBER);
+    }
+  p->PeekHeader (tcpHeader);
+  uint32_t payloadSize = p->GetSize () - tcpHeader.GetSerializedSize ();
+  uint8_t flags = tcpHeader.GetFlags ();
+
+  // Only data segments with no other flag than ACK and PSH, and no other
+  // option than the timestamps and the padding, are coalesced.  A segment
+  // with a bad checksum is passed unchanged to TCP, which drops it.
+  bool mergeable = payloadSize > 0 && (flags & ~TcpHeader::PSH) == TcpHeader::ACK
+    && tcpHeader.IsChecksumOk ();
+  const TcpHeader::TcpOptionList &options = tcpHeader.GetOptionList ();
+  for (TcpHeader::TcpOptionList::const_iterator it = options.begin (); it != options.end (); ++it)
+    {
+      uint8_t kind = (*it)->GetKind ();
+      if (kind != TcpOption::TS && kind != TcpOption::END && kind != TcpOption::NOP)
+        {
+          mergeable = false;
+        }
+    }
+
+  std::vector<GroFlow>::iterator flow = m_groFlows.begin ();
+  while (flow != m_groFlows.end ()
+         && !(flow->m_ipHeader.GetSource () == ipHeader.GetSource ()
+              && flow->m_ipHeader.GetDestination () == ipHeader.GetDestination ()
+              && flow->m_tcpHeader.GetSourcePort () == tcpHeader.GetSourcePort ()
+              && flow->m_tcpHeader.GetDestinationPort () == tcpHeader.GetDestinationPort ()))
+    {
+      ++flow;
+    }
+  if (flow != m_groFlows.end ())
+    {
+      bool merged = false;
+      if (mergeable && GroCanMerge (*flow, ipHeader, tcpHeader, payloadSize, iif))
+        {
+          merged = true;
+          p->RemoveAtStart (tcpHeader.GetSerializedSize ());
+          flow->m_payload->AddAtEnd (p);
+          flow->m_segments++;
+          flow->m_nextSeq += payloadSize;
+          flow->m_tcpHeader.SetFlags (flow->m_tcpHeader.GetFlags () | flags);
+          if ((flags & TcpHeader::PSH) == 0 && payloadSize == flow->m_segmentSize)
+            {
+              return;
+            }
+          // a segment with PSH, or smaller than the first one, ends the merge
+        }
+      else
+        {
+          mergeable = false;
+        }
+      // deliver the segments held first, to keep the flow in order
+      GroFlow held = *flow;
+      m_groFlows.erase (flow);
+      GroDeliver (held);
+      if (merged)
+        {
+          return;
+        }
+    }
+
+  if (!mergeable || (flags & TcpHeader::PSH) != 0)
+    {
+      // the segment is delivered as received, with its own checksum
+      DeliverToL4 (p, ipHeader, iif);
+      return;
+    }
+
+  p->RemoveAtStart (tcpHeader.GetSerializedSize ());
+
+  if (m_groFlows.size () >= m_groMaxFlows)
+    {
+      GroFlow held = m_groFlows.front ();
+      m_groFlows.erase (m_groFlows.begin ());
+      GroDeliver (held);
+    }
+  GroFlow newFlow;
+  newFlow.m_ipHeader = ipHeader;
+  newFlow.m_tcpHeader = tcpHeader;
+  newFlow.m_payload = p;
+  newFlow.m_iif = iif;
+  newFlow.m_segmentSize = payloadSize;
+  newFlow.m_segments = 1;
+  newFlow.m_nextSeq = tcpHeader.GetSequenceNumber () + SequenceNumber32 (payloadSize);
+  m_groFlows.push_back (newFlow);
+  if (!m_groFlushEvent.IsRunning ())
+    {
+      m_groFlushEvent = Simulator::ScheduleNow (&Ipv4L3Protocol::GroFlush, this);
+    }
+}
+
+bool
+Ipv4L3Protocol::GroCanMerge (const GroFlow &flow, const Ipv4Header &ipHeader, const TcpHeader &tcpHeader,
+                             uint32_t payloadSize, uint32_t iif)
+{
+  if (flow.m_iif != iif
+      || tcpHeader.GetSequenceNumber () != flow.m_nextSeq
+      || tcpHeader.GetAckNumber () != flow.m_tcpHeader.GetAckNumber ()
+      || tcpHeader.GetWindowSize () != flow.m_tcpHeader.GetWindowSize ()
+      || tcpHeader.GetLength () != flow.m_tcpHeader.GetLength ()
+      || ipHeader.GetTos () != flow.m_ipHeader.GetTos ()
+      || ipHeader.GetTtl () != flow.m_ipHeader.GetTtl ()
+      || payloadSize > flow.m_segmentSize)
+    {
+      return false;
+    }
+  // the merged packet must fit in an IPv4 packet
+  if (ipHeader.GetSerializedSize () + tcpHeader.GetSerializedSize ()
+      + flow.m_payload->GetSize () + payloadSize > 65535)
+    {
+      return false;
+    }
+  if (tcpHeader.HasOption (TcpOption::TS))
+    {
+      Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+      Ptr<const TcpOptionTS> flowTs = DynamicCast<const TcpOptionTS> (flow.m_tcpHeader.GetOption (TcpOption::TS));
+      if (flowTs == 0 || ts->GetTimestamp () != flowTs->GetTimestamp () || ts->GetEcho () != flowTs->GetEcho ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+Ipv4L3Protocol::GroDeliver (GroFlow &flow)
+{
+  NS_LOG_FUNCTION (this << flow.m_segments);
+  Ptr<Packet> p = flow.m_payload;
+  if (flow.m_segments > 1)
+    {
+      // the TCP socket acknowledges the packet as the segments it carries
+      p->AddPacketTag (SegmentationOffloadTag (flow.m_segmentSize, flow.m_segments));
+    }
+  if (Node::ChecksumEnabled ())
+    {
+      flow.m_tcpHeader.EnableChecksums ();
+      flow.m_tcpHeader.InitializeChecksum (flow.m_ipHeader.GetSource (), flow.m_ipHeader.GetDestination (),
+                                           TcpL4Protocol::PROT_NUMBER);
+    }
+  p->AddHeader (flow.m_tcpHeader);
+  flow.m_ipHeader.SetPayloadSize (p->GetSize ());
+  DeliverToL4 (p, flow.m_ipHeader, flow.m_iif);
+}
+
+void
+Ipv4L3Protocol::GroFlush (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<GroFlow> flows;
+  flows.swap (m_groFlows);
+  for (std::vector<GroFlow>::iterator it = flows.begin (); it != flows.end (); ++it)
+    {
+      GroDeliver (*it);
+    }
+}
+
 bool
 Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
 {
@@ -1496,52 +1753,81 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 
   uint64_t addressCombination = uint64_t (ipHeader.GetSource ().Get ()) << 32 | uint64_t (ipHeader.GetDestination ().Get ());
   uint32_t idProto = uint32_t (ipHeader.GetIdentification ()) << 16 | uint32_t (ipHeader.GetProtocol ());
-  std::pair<uint64_t, uint32_t> key;
+  FragmentKey_t key;
   bool ret = false;
   Ptr<Packet> p = packet->Copy ();
 
   key.first = addressCombination;
   key.second = idProto;
 
-  Ptr<Fragments> fragments;
+  uint32_t index;
 
   MapFragments_t::iterator it = m_fragments.find (key);
   if (it == m_fragments.end ())
     {
-      fragments = Create<Fragments> ();
-      m_fragments.insert (std::make_pair (key, fragments));
-      m_fragmentsTimers[key] = Simulator::Schedule (m_fragmentExpirationTimeout,
-                                                    &Ipv4L3Protocol::HandleFragmentsTimeout, this,
-                                                    key, ipHeader, iif);
+      if (m_freeReassemblyBuffers.empty ())
+        {
+          index = m_reassemblyBuffers.size ();
+          m_reassemblyBuffers.push_back (Fragments ());
+        }
+      else
+        {
+          index = m_freeReassemblyBuffers.back ();
+          m_freeReassemblyBuffers.pop_back ();
+        }
+      m_fragments.insert (std::make_pair (key, index));
+
+      // the expiration timers of all the packets are managed by the timer
+      // wheel of the node, instead of one simulator event per packet
+      if (m_timerWheel == 0)
+        {
+          m_timerWheel = TimerWheel::GetTimerWheel (m_node);
+          m_fragmentsTimeoutCallback = MakeCallback (&Ipv4L3Protocol::HandleFragmentsTimeout, this);
+        }
+      Fragments &fragments = m_reassemblyBuffers[index];
+      fragments.m_key = key;
+      fragments.m_ipHeader = ipHeader;
+      fragments.m_iif = iif;
+      fragments.m_timer = m_timerWheel->Schedule (m_fragmentExpirationTimeout, m_fragmentsTimeoutCallback, index);
     }
   else
     {
-      fragments = it->second;
+      index = it->second;
     }
 
+  Fragments &fragments = m_reassemblyBuffers[index];
+
   NS_LOG_LOGIC ("Adding fragment - Size: " << packet->GetSize ( ) << " - Offset: " << (ipHeader.GetFragmentOffset ()) );
 
-  fragments->AddFragment (p, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
+  fragments.AddFragment (p, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
 
-  if ( fragments->IsEntire () )
+  if ( fragments.IsEntire () )
     {
-      packet = fragments->GetPacket ();
-      fragments = 0;
-      m_fragments.erase (key);
-      if (m_fragmentsTimers[key].IsRunning ())
-        {
-          NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
-          m_fragmentsTimers[key].Cancel ();
-        }
-      m_fragmentsTimers.erase (key);
+      packet = fragments.GetPacket ();
+      NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
+      m_timerWheel->Cancel (fragments.m_timer);
+      ReleaseFragments (index);
       ret = true;
     }
 
   return ret;
 }
 
+void
+Ipv4L3Protocol::ReleaseFragments (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  Fragments &fragments = m_reassemblyBuffers[index];
+  m_fragments.erase (fragments.m_key);
+  fragments.Clear ();
+  m_freeReassemblyBuffers.push_back (index);
+}
+
 Ipv4L3Protocol::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_iif (0),
+    m_timer (0),
+    m_moreFragment (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -1556,14 +1842,13 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  // insert the fragment after those with a lower or equal offset, searching
+  // from the end since fragments usually arrive in order
+  std::vector<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_fragments.end ();
 
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  while (it != m_fragments.begin () && (it - 1)->second > fragmentOffset)
     {
-      if (it->second > fragmentOffset)
-        {
-          break;
-        }
+      it--;
     }
 
   if (it == m_fragments.end ())
@@ -1585,7 +1870,7 @@ Ipv4L3Protocol::Fragments::IsEntire () const
     {
       uint16_t lastEndOffset = 0;
 
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
+      for (std::vector<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
         {
           // overlapping fragments do exist
           NS_LOG_LOGIC ("Checking overlaps " << lastEndOffset << " - " << it->second );
@@ -1609,7 +1894,7 @@ Ipv4L3Protocol::Fragments::GetPacket () const
 {
   NS_LOG_FUNCTION (this);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
+  std::vector<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
 
   Ptr<Packet> p = it->first->Copy ();
   uint16_t lastEndOffset = p->GetSize ();
@@ -1647,7 +1932,7 @@ Ipv4L3Protocol::Fragments::GetPartialPacket () const
 {
   NS_LOG_FUNCTION (this);
   
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
+  std::vector<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
 
   Ptr<Packet> p = Create<Packet> ();
   uint16_t lastEndOffset = 0;
@@ -1678,12 +1963,26 @@ Ipv4L3Protocol::Fragments::GetPartialPacket () const
 }
 
 void
-Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif)
+Ipv4L3Protocol::Fragments::Clear ()
 {
-  NS_LOG_FUNCTION (this << &key << &ipHeader << iif);
+  NS_LOG_FUNCTION (this);
+  m_fragments.clear ();
+  m_moreFragment = false;
+  m_timer = 0;
+}
 
-  MapFragments_t::iterator it = m_fragments.find (key);
-  Ptr<Packet> packet = it->second->GetPartialPacket ();
+void
+Ipv4L3Protocol::HandleFragmentsTimeout (uint64_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  Fragments &fragments = m_reassemblyBuffers[index];
+  Ptr<Packet> packet = fragments.GetPartialPacket ();
+  Ipv4Header ipHeader = fragments.m_ipHeader;
+  uint32_t iif = fragments.m_iif;
+
+  // clear the buffers before sending the ICMP, which may add fragments
+  ReleaseFragments (index);
 
   // if we have at least 8 bytes, we can send an ICMP.
   if ( packet->GetSize () > 8 )
@@ -1692,11 +1991,5 @@ Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4H
       icmp->SendTimeExceededTtl (ipHeader, packet, true);
     }
   m_dropTrace (ipHeader, packet, DROP_FRAGMENT_TIMEOUT, m_node->GetObject<Ipv4> (), iif);
-
-  // clear the buffers
-  it->second = 0;
-
-  m_fragments.erase (key);
-  m_fragmentsTimers.erase (key);
 }
 } // namespace ns3
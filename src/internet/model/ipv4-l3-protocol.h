@@ -23,6 +23,7 @@
 
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
@@ -34,6 +35,8 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "ns3/timer-wheel.h"
+#include "tcp-header.h"
 
 class Ipv4L3ProtocolTestCase;
 
@@ -316,6 +319,19 @@ private:
     uint8_t tos,
     bool mayFragment);
 
+  /**
+   * \brief Get the identification counter of a {src, dst, proto} tuple.
+   *
+   * The counters are cached in a small table indexed by the hash of the
+   * tuple, so that the packets of a few interleaved flows do not look up
+   * the table of the counters.
+   *
+   * \param srcDst the source and destination addresses
+   * \param protocol L4 protocol
+   * \return the counter, which stays valid as long as the stack exists
+   */
+  uint16_t & GetIdentification (uint64_t srcDst, uint8_t protocol);
+
   /**
    * \brief Send packet with route.
    * \param route route
@@ -357,6 +373,33 @@ private:
    */
   void LocalDeliver (Ptr<const Packet> p, Ipv4Header const&ip, uint32_t iif);
 
+  /**
+   * \brief Deliver a packet to its layer 4 protocol.
+   * \param p packet delivered
+   * \param ipHeader IPv4 header
+   * \param iif input interface packet was received
+   */
+  void DeliverToL4 (Ptr<Packet> p, Ipv4Header const &ipHeader, uint32_t iif);
+
+  /**
+   * \brief Coalesce a received TCP segment with the previous segments of
+   * its flow received at the same time (generic receive offload).
+   *
+   * The segment is held until the end of the current time step if it can
+   * be merged with the next segments of the flow, and delivered at once
+   * otherwise, after the segments held for its flow.
+   *
+   * \param p packet delivered, starting with the TCP header
+   * \param ipHeader IPv4 header
+   * \param iif input interface packet was received
+   */
+  void GroReceive (Ptr<Packet> p, Ipv4Header const &ipHeader, uint32_t iif);
+
+  /**
+   * \brief Deliver all the segments held by the generic receive offload.
+   */
+  void GroFlush (void);
+
   /**
    * \brief Fallback when no route is found.
    * \param p packet
@@ -416,32 +459,36 @@ private:
 
   /**
    * \brief Process the timeout for packet fragments
-   * \param key representing the packet fragments
-   * \param ipHeader the IP header of the original packet
-   * \param iif Input Interface
+   * \param index the index of the reassembly buffer of the packet fragments
    */
-  void HandleFragmentsTimeout ( std::pair<uint64_t, uint32_t> key, Ipv4Header & ipHeader, uint32_t iif);
+  void HandleFragmentsTimeout (uint64_t index);
+
+  /**
+   * \brief Release a reassembly buffer, so that it can be used for another packet
+   * \param index the index of the reassembly buffer
+   */
+  void ReleaseFragments (uint32_t index);
 
   /**
    * \brief Make a copy of the packet, add the header and invoke the TX trace callback
+   *
+   * Nothing is done if no function is connected to the trace source.
+   *
    * \param ipHeader the IP header that will be added to the packet
    * \param packet the packet
-   * \param ipv4 the Ipv4 protocol
    * \param interface the interface index
-   *
-   * Note: If the TracedCallback API ever is extended, we could consider
-   * to check for connected functions before adding the header
    */
-  void CallTxTrace (const Ipv4Header & ipHeader, Ptr<Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  void CallTxTrace (const Ipv4Header & ipHeader, Ptr<Packet> packet, uint32_t interface);
 
   /**
    * \brief Container of the IPv4 Interfaces.
    */
   typedef std::vector<Ptr<Ipv4Interface> > Ipv4InterfaceList;
   /**
-   * \brief Container of NetDevices registered to IPv4 and their interface indexes.
+   * \brief Container of the interface indexes of the NetDevices registered to IPv4,
+   * indexed by the index of the NetDevices in the node (-1 if not registered).
    */
-  typedef std::map<Ptr<const NetDevice>, uint32_t > Ipv4InterfaceReverseContainer;
+  typedef std::vector<int32_t> Ipv4InterfaceReverseContainer;
   /**
    * \brief Container of the IPv4 Raw Sockets.
    */
@@ -463,7 +510,47 @@ private:
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
   Ipv4InterfaceReverseContainer m_reverseInterfacesContainer; //!< Container of NetDevice / Interface index associations.
   uint8_t m_defaultTtl;  //!< Default TTL
-  std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
+
+  /// Key of the identification counters: source and destination addresses, protocol
+  typedef std::pair<uint64_t, uint8_t> IdentificationKey_t;
+
+  /**
+   * \brief Hash function of the keys of the identification counters.
+   */
+  struct IdentificationKeyHash
+  {
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    size_t operator() (const IdentificationKey_t &key) const
+    {
+      return static_cast<size_t> (Mix (key));
+    }
+    /**
+     * \param key the key
+     * \return the 64-bit hash of the key, whose high bits are the best mixed
+     */
+    static uint64_t Mix (const IdentificationKey_t &key)
+    {
+      return (key.first ^ (key.first >> 29) ^ key.second) * 0x9e3779b97f4a7c15ULL;
+    }
+  };
+
+  /**
+   * \brief Entry of the cache of the identification counters.
+   */
+  struct IdentificationCacheEntry
+  {
+    IdentificationKey_t key; //!< the tuple
+    uint16_t *counter;       //!< the counter of the tuple, or null if the entry is unused
+  };
+
+  /// Number of bits of the index of the cache of the identification counters
+  static const uint32_t IDENTIFICATION_CACHE_BITS = 6;
+
+  std::unordered_map<IdentificationKey_t, uint16_t, IdentificationKeyHash> m_identification; //!< Identification (for each {src, dst, proto} tuple)
+  IdentificationCacheEntry m_identificationCache[1 << IDENTIFICATION_CACHE_BITS]; //!< Direct-mapped cache of the identification counters
   Ptr<Node> m_node; //!< Node attached to stack.
 
   /// Trace of sent packets
@@ -490,12 +577,24 @@ private:
 
   Ptr<Ipv4RoutingProtocol> m_routingProtocol; //!< Routing protocol associated with the stack
 
+  // The callbacks passed to the routing protocol for each received packet
+  Ipv4RoutingProtocol::UnicastForwardCallback m_ucb;   //!< Unicast forwarding callback
+  Ipv4RoutingProtocol::MulticastForwardCallback m_mcb; //!< Multicast forwarding callback
+  Ipv4RoutingProtocol::LocalDeliverCallback m_lcb;     //!< Local delivery callback
+  Ipv4RoutingProtocol::ErrorCallback m_ecb;            //!< Routing error callback
+
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
+  /// Key of the fragments of a packet: (src+dst addr, identification+proto)
+  typedef std::pair<uint64_t, uint32_t> FragmentKey_t;
+
   /**
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
+   *
+   * The sets are stored in a vector of reassembly buffers, which are reused for other
+   * packets once the packet is complete or has expired, and keep their capacity.
    */
-  class Fragments : public SimpleRefCount<Fragments>
+  class Fragments
   {
 public:
     /**
@@ -534,6 +633,16 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Release the fragments, keeping the capacity of the buffer.
+     */
+    void Clear ();
+
+    FragmentKey_t m_key;           //!< The key of the packet
+    Ipv4Header m_ipHeader;         //!< The IP header of the first fragment received
+    uint32_t m_iif;                //!< The input interface of the first fragment received
+    TimerWheel::TimerId m_timer;   //!< The expiration timer
+
 private:
     /**
      * \brief True if other fragments will be sent.
@@ -541,20 +650,74 @@ private:
     bool m_moreFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The current fragments, sorted by offset.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
+    std::vector<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
+
+  };
 
+  /**
+   * \brief Hash function of the keys of the fragments.
+   */
+  struct FragmentKeyHash
+  {
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    size_t operator() (const FragmentKey_t &key) const
+    {
+      return static_cast<size_t> (key.first ^ (key.first >> 29) ^ (static_cast<uint64_t> (key.second) * 0x9e3779b97f4a7c15ULL));
+    }
   };
 
-  /// Container of fragments, stored as pairs(src+dst addr, src+dst port) / fragment
-  typedef std::map< std::pair<uint64_t, uint32_t>, Ptr<Fragments> > MapFragments_t;
-  /// Container of fragment timeout event, stored as pairs(src+dst addr, src+dst port) / EventId
-  typedef std::map< std::pair<uint64_t, uint32_t>, EventId > MapFragmentsTimers_t;
+  /// Container of fragments, stored as pairs(src+dst addr, identification+proto) / index of the reassembly buffer
+  typedef std::unordered_map<FragmentKey_t, uint32_t, FragmentKeyHash> MapFragments_t;
 
   MapFragments_t       m_fragments; //!< Fragmented packets.
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
-  MapFragmentsTimers_t m_fragmentsTimers; //!< Expiration events.
+  std::vector<Fragments> m_reassemblyBuffers; //!< Reassembly buffers of the fragmented packets
+  std::vector<uint32_t> m_freeReassemblyBuffers; //!< Indexes of the reassembly buffers not in use
+  Ptr<TimerWheel> m_timerWheel; //!< Timer wheel of the node, for the expiration of the fragments
+  Callback<void, uint64_t> m_fragmentsTimeoutCallback; //!< Callback of the expiration timers
+
+  /**
+   * \brief TCP segments of a flow coalesced by the generic receive offload
+   */
+  struct GroFlow
+  {
+    Ipv4Header m_ipHeader;      //!< IPv4 header of the first segment
+    TcpHeader m_tcpHeader;      //!< TCP header of the first segment (with the flags of all the segments)
+    Ptr<Packet> m_payload;      //!< Payload of the segments
+    uint32_t m_iif;             //!< Input interface of the segments
+    uint32_t m_segmentSize;     //!< Payload size of the first segment
+    uint32_t m_segments;        //!< Number of segments
+    SequenceNumber32 m_nextSeq; //!< Sequence number following the last segment
+  };
+
+  /**
+   * \brief Deliver the segments of a flow held by the generic receive offload
+   * as a single packet.
+   * \param flow the flow
+   */
+  void GroDeliver (GroFlow &flow);
+
+  /**
+   * \brief Check if a segment can be coalesced with the segments of a flow.
+   * \param flow the flow
+   * \param ipHeader IPv4 header of the segment
+   * \param tcpHeader TCP header of the segment
+   * \param payloadSize payload size of the segment
+   * \param iif input interface of the segment
+   * \returns true if the segment can be coalesced
+   */
+  static bool GroCanMerge (const GroFlow &flow, const Ipv4Header &ipHeader, const TcpHeader &tcpHeader,
+                           uint32_t payloadSize, uint32_t iif);
+
+  bool                 m_gro;          //!< Generic receive offload enabled
+  uint32_t             m_groMaxFlows;  //!< Maximum number of flows held by the generic receive offload
+  std::vector<GroFlow> m_groFlows;     //!< Flows held by the generic receive offload, in arrival order
+  EventId              m_groFlushEvent; //!< Event delivering the held flows at the end of the time step
 
 };
 
@@ -54,7 +54,9 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_routeIndexValid (false),
+    m_routeIndexIrregular (false),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +75,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_routeIndexValid = false;
 }
 
 void 
@@ -87,6 +90,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_routeIndexValid = false;
 }
 
 void 
@@ -144,6 +148,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_routeIndexValid = false;
 }
 
 uint32_t 
@@ -240,55 +245,108 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // Among the routes matching the destination (on the requested interface,
+  // if any), select the one with the longest mask; among those, the last
+  // one with the lowest metric, or the first one if it is a host route.
+  Ipv4RoutingTableEntry *route = 0;
+  UpdateRouteIndex ();
+  if (!m_routeIndexIrregular)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      uint8_t buf[4];
+      dest.Serialize (buf);
+      m_routeIndex.Lookup (buf, m_routeMatches);
+      // look at the matching prefixes from the longest to the shortest one,
+      // each of them listing its routes in the order of the table
+      for (uint32_t k = m_routeMatches.size (); k > 0 && route == 0; k--)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
+          const NetworkRouteTrie::ValueList &values = *m_routeMatches[k - 1];
+          for (NetworkRouteTrie::ValueList::const_iterator v = values.begin (); v != values.end (); v++)
             {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+              Ipv4RoutingTableEntry *j = v->m_value->first;
+              uint32_t metric = v->m_value->second;
+              uint16_t masklen = j->GetDestNetworkMask ().GetPrefixLength ();
+              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+              if (oif != 0 && oif != m_ipv4->GetNetDevice (j->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
+              if (metric > shortest_metric)
+                {
+                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                  continue;
+                }
+              shortest_metric = metric;
+              route = j;
+              if (masklen == 32)
+                {
+                  break;
+                }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
+        }
+    }
+  else
+    {
+      for (NetworkRoutesI i = m_networkRoutes.begin (); 
+           i != m_networkRoutes.end (); 
+           i++) 
+        {
+          Ipv4RoutingTableEntry *j=i->first;
+          uint32_t metric =i->second;
+          Ipv4Mask mask = (j)->GetDestNetworkMask ();
+          uint16_t masklen = mask.GetPrefixLength ();
+          Ipv4Address entry = (j)->GetDestNetwork ();
+          NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
+          if (mask.IsMatch (dest, entry)) 
             {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
+              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+              if (oif != 0)
+                {
+                  if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+                    {
+                      NS_LOG_LOGIC ("Not on requested interface, skipping");
+                      continue;
+                    }
+                }
+              if (masklen < longest_mask) // Not interested if got shorter mask
+                {
+                  NS_LOG_LOGIC ("Previous match longer, skipping");
+                  continue;
+                }
+              if (masklen > longest_mask) // Reset metric if longer masklen
+                {
+                  shortest_metric = 0xffffffff;
+                }
+              longest_mask = masklen;
+              if (metric > shortest_metric)
+                {
+                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                  continue;
+                }
+              shortest_metric = metric;
+              route = j;
+              if (masklen == 32)
+                {
+                  break;
+                }
             }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
+        }
+    }
+  if (route != 0)
+    {
+      // the Ipv4Route only depends on the routing table entry and on the
+      // addresses of its interface, hence it is reused until they change
+      Ptr<Ipv4Route> &cached = m_routeCache[route];
+      if (cached == 0)
+        {
           uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
+          cached = Create<Ipv4Route> ();
+          cached->SetDestination (route->GetDest ());
+          cached->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+          cached->SetGateway (route->GetGateway ());
+          cached->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
         }
+      rtentry = cached;
     }
   if (rtentry != 0)
     {
@@ -353,6 +411,38 @@ Ipv4StaticRouting::LookupStatic (
   return mrtentry;
 }
 
+void
+Ipv4StaticRouting::UpdateRouteIndex (void)
+{
+  if (m_routeIndexValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_routeIndex.Clear ();
+  m_routeCache.clear ();
+  m_routeIndexIrregular = false;
+  for (NetworkRoutesI i = m_networkRoutes.begin (); 
+       i != m_networkRoutes.end (); 
+       i++) 
+    {
+      Ipv4Mask mask = i->first->GetDestNetworkMask ();
+      uint32_t hostBits = ~mask.Get ();
+      if ((hostBits & (hostBits + 1)) != 0)
+        {
+          // A non-contiguous mask cannot be indexed by prefix
+          NS_LOG_LOGIC ("Route with non-contiguous mask " << mask << ", not using the route index");
+          m_routeIndexIrregular = true;
+          m_routeIndex.Clear ();
+          break;
+        }
+      uint8_t buf[4];
+      i->first->GetDestNetwork ().CombineMask (mask).Serialize (buf);
+      m_routeIndex.Insert (buf, mask.GetPrefixLength (), i);
+    }
+  m_routeIndexValid = true;
+}
+
 uint32_t 
 Ipv4StaticRouting::GetNRoutes (void) const
 {
@@ -449,6 +539,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_routeIndexValid = false;
           return;
         }
       tmp++;
@@ -575,6 +666,9 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_routeIndex.Clear ();
+  m_routeCache.clear ();
+  m_routeIndexValid = false;
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -589,6 +683,8 @@ void
 Ipv4StaticRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  // the source address of the cached routes may change
+  m_routeCache.clear ();
   // If interface address and network mask have been set, add a route
   // to the network of the interface (like e.g. ifconfig does on a
   // Linux box)
@@ -608,6 +704,8 @@ void
 Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  // the source address of the cached routes may change
+  m_routeCache.clear ();
   // Remove all static routes that are going through this interface
   for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); )
     {
@@ -615,6 +713,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
         }
       else
         {
@@ -627,6 +726,8 @@ void
 Ipv4StaticRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  // the source address of the cached routes may change
+  m_routeCache.clear ();
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -645,6 +746,8 @@ void
 Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  // the source address of the cached routes may change
+  m_routeCache.clear ();
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -662,6 +765,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_routeIndexValid = false;
         }
       else
         {
@@ -24,6 +24,7 @@
 
 #include <list>
 #include <utility>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -413,11 +415,30 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Rebuild the index of the network routes, if it is out of date.
+   *
+   * The routes cached for the network routes are discarded at the same time.
+   */
+  void UpdateRouteIndex (void);
+
+  /// Trie of the network routes, by destination prefix
+  typedef PrefixTrie<NetworkRoutesI, 4> NetworkRouteTrie;
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  bool m_routeIndexValid;     //!< whether m_routeIndex is up to date with m_networkRoutes
+  bool m_routeIndexIrregular; //!< whether a route has a non-contiguous mask, so that the index cannot be used
+  NetworkRouteTrie m_routeIndex; //!< longest prefix match index of m_networkRoutes
+  NetworkRouteTrie::MatchList m_routeMatches; //!< scratch list of the index entries matching a destination
+
+  /// Routes returned by LookupStatic, by network route; cleared with the route index
+  typedef std::unordered_map<const Ipv4RoutingTableEntry *, Ptr<Ipv4Route> > RouteCache;
+  RouteCache m_routeCache; //!< routes returned by LookupStatic, reused while the table is unchanged
+
   /**
    * \brief the forwarding table for multicast.
    */
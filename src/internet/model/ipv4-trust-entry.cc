@@ -23,6 +23,7 @@
 namespace ns3 {
 
 Ipv4TrustEntry::Ipv4TrustEntry ()
+  : m_trustValue (0)
 {
 }
 
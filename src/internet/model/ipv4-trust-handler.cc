@@ -19,9 +19,33 @@
  */
 
 #include "ipv4-trust-handler.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("Ipv4TrustHandler");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4TrustHandler);
+
+TypeId
+Ipv4TrustHandler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4TrustHandler")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("TrustUpdateInterval",
+                   "The interval between two recomputations of the trust values "
+                   "of all the neighbours. Zero disables the periodic recomputation.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&Ipv4TrustHandler::m_trustUpdateInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
 Ipv4TrustHandler::Ipv4TrustHandler ()
 {
 }
@@ -30,4 +54,118 @@ Ipv4TrustHandler::~Ipv4TrustHandler ()
 {
 }
 
+void
+Ipv4TrustHandler::DoInitialize (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_routingProtocol == 0)
+    {
+      FindRoutingProtocol ();
+    }
+  if (m_trustUpdateInterval.IsStrictlyPositive ())
+    {
+      m_trustUpdateEvent = Simulator::Schedule (m_trustUpdateInterval,
+                                                &Ipv4TrustHandler::PeriodicRecomputeTrust, this);
+    }
+  Object::DoInitialize ();
+}
+
+void
+Ipv4TrustHandler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_trustUpdateEvent.Cancel ();
+  m_routingProtocol = 0;
+  m_ownTrustTable.Clear ();
+  m_generations.clear ();
+  Object::DoDispose ();
+}
+
+void
+Ipv4TrustHandler::FindRoutingProtocol (void)
+{
+  Ptr<Ipv4> ipv4 = GetObject<Ipv4> ();
+  if (ipv4 == 0 || ipv4->GetRoutingProtocol () == 0)
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Using the trust table of " << ipv4->GetRoutingProtocol ());
+  m_routingProtocol = ipv4->GetRoutingProtocol ();
+  // the indices of the own table are meaningless in the new table
+  m_ownTrustTable.Clear ();
+  m_generations.clear ();
+}
+
+Ipv4TrustTable &
+Ipv4TrustHandler::GetTrustTable (void)
+{
+  if (m_routingProtocol == 0)
+    {
+      FindRoutingProtocol ();
+      if (m_routingProtocol == 0)
+        {
+          return m_ownTrustTable;
+        }
+    }
+  return m_routingProtocol->m_trustTable;
+}
+
+uint32_t
+Ipv4TrustHandler::GetNeighbourIndex (Ipv4Address address)
+{
+  Ipv4TrustTable &table = GetTrustTable ();
+  uint32_t index;
+  if (!table.LookupIndex (address, index))
+    {
+      NS_LOG_LOGIC ("New neighbour " << address);
+      Ipv4TrustEntry entry;
+      entry.SetNeighbourAddress (address);
+      entry.SetTimestamp (Simulator::Now ());
+      index = table.AddRecord (entry);
+    }
+  CheckNeighbour (index);
+  return index;
+}
+
+void
+Ipv4TrustHandler::CheckNeighbour (uint32_t index)
+{
+  uint32_t generation = GetTrustTable ().GetGeneration (index);
+  if (index >= m_generations.size ())
+    {
+      m_generations.resize (index + 1, 0);
+    }
+  if (m_generations[index] != generation)
+    {
+      m_generations[index] = generation;
+      NotifyNewNeighbour (index);
+    }
+}
+
+void
+Ipv4TrustHandler::RecomputeTrust (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv4TrustTable &table = GetTrustTable ();
+  Time now = Simulator::Now ();
+  for (uint32_t i = 0; i < table.GetNRecords (); i++)
+    {
+      if (table.IsInUse (i))
+        {
+          CheckNeighbour (i);
+          Ipv4TrustEntry &entry = table.GetRecord (i);
+          entry.SetTrustValue (ComputeTrust (i));
+          entry.SetTimestamp (now);
+        }
+    }
+}
+
+void
+Ipv4TrustHandler::PeriodicRecomputeTrust (void)
+{
+  RecomputeTrust ();
+  m_trustUpdateEvent = Simulator::Schedule (m_trustUpdateInterval,
+                                            &Ipv4TrustHandler::PeriodicRecomputeTrust, this);
+}
+
 } // namespace ns3
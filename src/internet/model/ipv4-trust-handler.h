@@ -24,9 +24,15 @@
 #include "ns3/object.h"
 #include "ns3/node.h"
 #include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ipv4-trust-table.h"
+#include <vector>
 
 namespace ns3 {
 
+class Ipv4RoutingProtocol;
+
 class Ipv4TrustHandler : public Object
 {
 
@@ -41,8 +47,19 @@ class Ipv4TrustHandler : public Object
   /**
    * \ingroup trust
    * \brief Intermediate class that used to communicate with trust table
+   *
+   * The handler updates the trust table of the routing protocol of the
+   * node it is aggregated to. Subclasses only record their metrics as
+   * packets are observed; the trust values of all the neighbours are
+   * recomputed together every TrustUpdateInterval, in a single pass over
+   * the table (RecomputeTrust).
    */
 public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
 
   Ipv4TrustHandler ();
   virtual ~Ipv4TrustHandler ();
@@ -55,6 +72,83 @@ public:
    */
   virtual int32_t calculateTrust (Address address) = 0;
 
+  /**
+   * \brief Recompute the trust values of all the neighbours in the
+   * trust table, and set their timestamp to the current time
+   */
+  void RecomputeTrust (void);
+
+  /**
+   * \brief Get the trust table updated by this handler
+   *
+   * This is the trust table of the routing protocol of the node the
+   * handler is aggregated to or, if there is none yet, a table owned by the
+   * handler. The metrics kept for the records of the table owned by the
+   * handler are dropped once the routing protocol is found.
+   *
+   * \returns the trust table
+   */
+  Ipv4TrustTable & GetTrustTable (void);
+
+protected:
+  virtual void DoInitialize (void);
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Get the index of the trust table record of a neighbour,
+   * adding a record if there is none
+   * \param [in] address the neighbour address
+   * \returns the index of the record
+   */
+  uint32_t GetNeighbourIndex (Ipv4Address address);
+
+  /**
+   * \brief Check that the metrics of the subclass at an index were reset
+   * for the record at that index
+   *
+   * The records may be added or removed by other objects than this handler,
+   * so NotifyNewNeighbour is called if the record at the index is not the
+   * one the metrics were last reset for.
+   *
+   * \param [in] index the index of a trust table record
+   */
+  void CheckNeighbour (uint32_t index);
+
+  /**
+   * \brief Compute the trust value of a neighbour from the metrics of
+   * the subclass
+   * \param [in] index the index of the trust table record of the neighbour
+   * \returns the trust value
+   */
+  virtual double ComputeTrust (uint32_t index) = 0;
+
+  /**
+   * \brief Notify the subclass that a neighbour has been given a trust
+   * table record, so that it can reset its metrics at that index
+   *
+   * The index may be beyond the metrics of the subclass.
+   *
+   * \param [in] index the index of the new record
+   */
+  virtual void NotifyNewNeighbour (uint32_t index) = 0;
+
+private:
+  /**
+   * \brief Recompute the trust values and schedule the next recomputation
+   */
+  void PeriodicRecomputeTrust (void);
+
+  /**
+   * \brief Look for the routing protocol of the node the handler is
+   * aggregated to, whose trust table is then updated by the handler
+   */
+  void FindRoutingProtocol (void);
+
+  Ptr<Ipv4RoutingProtocol> m_routingProtocol; //!< The routing protocol whose trust table is updated, if any
+  Ipv4TrustTable m_ownTrustTable;     //!< The trust table used without routing protocol
+  std::vector<uint32_t> m_generations; //!< Generation of the record each index of the metrics was last reset for
+  Time m_trustUpdateInterval;         //!< The interval between trust recomputations
+  EventId m_trustUpdateEvent;         //!< The next trust recomputation
 };
 
 } // namespace ns3
@@ -19,47 +19,120 @@
  */
 
 #include "ipv4-trust-table.h"
+#include "ns3/log.h"
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("Ipv4TrustTable");
+
 Ipv4TrustTable::Ipv4TrustTable ()
+  : m_nGenerations (0)
 {
 }
 
-void Ipv4TrustTable::AddRecord (Ipv4TrustEntry entry)
+uint32_t Ipv4TrustTable::AddRecord (Ipv4TrustEntry entry)
 {
-//  m_tableRecords.push_back (entry);
+  Ipv4Address address = entry.GetNeighbourAddress ();
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_index.find (address);
+  if (i != m_index.end ())
+    {
+      m_tableRecords[i->second] = entry;
+      return i->second;
+    }
+
+  uint32_t index;
+  if (m_freeRecords.empty ())
+    {
+      index = m_tableRecords.size ();
+      m_tableRecords.push_back (entry);
+      m_inUse.push_back (true);
+      m_generations.push_back (++m_nGenerations);
+    }
+  else
+    {
+      index = m_freeRecords.back ();
+      m_freeRecords.pop_back ();
+      m_tableRecords[index] = entry;
+      m_inUse[index] = true;
+      m_generations[index] = ++m_nGenerations;
+    }
+  m_index[address] = index;
+  return index;
 }
 
 void Ipv4TrustTable::RemoveRecord (Ipv4TrustEntry entry)
 {
-//  m_tableRecords.pop_back (); //need to change this
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::iterator i = m_index.find (entry.GetNeighbourAddress ());
+  if (i == m_index.end ())
+    {
+      return;
+    }
+  m_inUse[i->second] = false;
+  m_freeRecords.push_back (i->second);
+  m_index.erase (i);
 }
 
 void Ipv4TrustTable::UpdateRecord (Ipv4TrustEntry entry)
 {
-  // TODO write update trust record logic
+  AddRecord (entry);
 }
 
 bool Ipv4TrustTable::LookupTrustEntry (Ipv4Address dst,
                                        Ipv4TrustEntry & tt)
 {
-  if (m_tableRecords.empty ())
+  uint32_t index;
+  if (!LookupIndex (dst, index))
     {
-      std::cout<<"Trust entry to " << dst << " not found; trust table is empty";
+      NS_LOG_LOGIC ("Trust entry to " << dst << " not found");
       return false;
     }
-  std::map<Ipv4Address, Ipv4TrustEntry>::const_iterator i = m_tableRecords.find (dst);
-  if (i == m_tableRecords.end ())
+  tt = m_tableRecords[index];
+  NS_LOG_LOGIC ("Trust entry to " << dst << " found");
+  return true;
+}
+
+bool Ipv4TrustTable::LookupIndex (Ipv4Address address, uint32_t &index) const
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_index.find (address);
+  if (i == m_index.end ())
     {
-      std::cout<<"Trust entry to " << dst << " not found";
       return false;
     }
-  tt = i->second;
-  std::cout<<"Trust entry to " << dst << " found";
+  index = i->second;
   return true;
 }
 
+uint32_t Ipv4TrustTable::GetNRecords (void) const
+{
+  return m_tableRecords.size ();
+}
+
+bool Ipv4TrustTable::IsInUse (uint32_t index) const
+{
+  return m_inUse[index];
+}
+
+uint32_t Ipv4TrustTable::GetGeneration (uint32_t index) const
+{
+  NS_ASSERT (m_inUse[index]);
+  return m_generations[index];
+}
+
+Ipv4TrustEntry & Ipv4TrustTable::GetRecord (uint32_t index)
+{
+  NS_ASSERT (m_inUse[index]);
+  return m_tableRecords[index];
+}
+
+void Ipv4TrustTable::Clear (void)
+{
+  m_tableRecords.clear ();
+  m_inUse.clear ();
+  m_generations.clear ();
+  m_freeRecords.clear ();
+  m_index.clear ();
+}
+
 Ipv4TrustTable::~Ipv4TrustTable ()
 {
 }
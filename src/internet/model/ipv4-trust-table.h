@@ -23,9 +23,8 @@
 
 #include "ipv4-trust-entry.h"
 #include "ns3/ipv4-address.h"
-#include <map>
-
-using std::map;
+#include <vector>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -40,16 +39,29 @@ namespace ns3 {
 /**
  * \ingroup trust
  * \brief The abstract Trust table for the nodes.
+ *
+ * The records are stored in a flat array, indexed by a hash table on the
+ * neighbour address. The index of a record does not change while the
+ * record is in the table, so that trust handlers can keep their own
+ * per-neighbour metrics in arrays indexed the same way, and recompute
+ * all the trust values in a single pass over the array. The slots of
+ * removed records are reused by the next added records.
  */
 class Ipv4TrustTable
 {
 
 private:
   /**
-   * \brief m_tableRecords type of <Ipv4Address, Ipv4TrustEntry> classes
-   * contains here representing the IPv4 trust table rows
+   * \brief m_tableRecords the IPv4 trust table rows; the rows whose
+   * m_inUse flag is false are free
    */
-  std::map<Ipv4Address, Ipv4TrustEntry> m_tableRecords;
+  std::vector<Ipv4TrustEntry> m_tableRecords;
+  std::vector<bool> m_inUse;                   //!< Whether each row is in use
+  std::vector<uint32_t> m_generations;         //!< Generation of the record in each row
+  uint32_t m_nGenerations;                     //!< Number of generations given to the records
+  std::vector<uint32_t> m_freeRecords;         //!< Indices of the free rows
+  /// Index of the rows by neighbour address
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_index;
 
 public:
   Ipv4TrustTable ();
@@ -57,9 +69,14 @@ public:
 
   /**
    * \brief Add a new record to the Trust Table
+   *
+   * If the table already has a record for the neighbour of the entry,
+   * that record is replaced.
+   *
    * \param [in] entry The new entry.
+   * \returns the index of the record
    */
-  void AddRecord (Ipv4TrustEntry entry);
+  uint32_t AddRecord (Ipv4TrustEntry entry);
 
   /**
    * \brief Remove a record from the Trust Table
@@ -69,6 +86,10 @@ public:
 
   /**
    * \brief Update a record of the Trust Table
+   *
+   * The record is added if the table has no record for the neighbour of
+   * the entry.
+   *
    * \param [in] entry The entry to be modified.
    */
   void UpdateRecord (Ipv4TrustEntry entry);
@@ -80,6 +101,52 @@ public:
    * \return true on success
    */
   bool LookupTrustEntry (Ipv4Address dst, Ipv4TrustEntry & tt);
+
+  /**
+   * Lookup the index of the record of a neighbour
+   * \param [in] address the neighbour address
+   * \param [out] index the index of the record, if it exists
+   * \return true if the table has a record for the neighbour
+   */
+  bool LookupIndex (Ipv4Address address, uint32_t &index) const;
+
+  /**
+   * \brief Get the number of rows of the table, including the free ones
+   *
+   * The valid record indices are lower than this number.
+   *
+   * \returns the number of rows
+   */
+  uint32_t GetNRecords (void) const;
+
+  /**
+   * \param [in] index a record index
+   * \returns true if the row at the given index holds a record
+   */
+  bool IsInUse (uint32_t index) const;
+
+  /**
+   * \brief Get the generation of the record at a given index
+   *
+   * The generation changes each time a new neighbour is given the row,
+   * including after the table has been cleared, and is never 0.
+   *
+   * \param [in] index the index of a row in use
+   * \returns the generation of the record
+   */
+  uint32_t GetGeneration (uint32_t index) const;
+
+  /**
+   * \brief Get the record at a given index
+   * \param [in] index the index of a row in use
+   * \returns the record
+   */
+  Ipv4TrustEntry & GetRecord (uint32_t index);
+
+  /**
+   * \brief Remove all the records
+   */
+  void Clear (void);
 };
 
 } // namespace ns3
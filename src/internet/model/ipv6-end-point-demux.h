@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,10 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The connected end points (local address, peer address and peer port
+ * all set) are indexed in a hash table by their four-tuple, and the other
+ * end points in a table by local port.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,94 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Four-tuple of a connected end point.
+   */
+  struct FourTuple
+  {
+    Ipv6Address m_localAddr; //!< local address
+    Ipv6Address m_peerAddr;  //!< peer address
+    uint16_t m_localPort;    //!< local port
+    uint16_t m_peerPort;     //!< peer port
+
+    /**
+     * \brief Equality operator.
+     * \param other the other four-tuple
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const
+    {
+      return m_localPort == other.m_localPort && m_peerPort == other.m_peerPort
+             && m_localAddr == other.m_localAddr && m_peerAddr == other.m_peerAddr;
+    }
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \param t the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const FourTuple &t) const
+    {
+      Ipv6AddressHash hash;
+      return (hash (t.m_localAddr) * 31 + hash (t.m_peerAddr)) * 31
+             + ((static_cast<size_t> (t.m_localPort) << 16) | t.m_peerPort);
+    }
+  };
+
+  /**
+   * \brief The end points bound to a local port.
+   */
+  struct LocalPort
+  {
+    EndPoints m_unconnected; //!< the end points which are not connected, in allocation order
+    std::map<std::pair<Ipv6Address, NetDevice *>, uint32_t> m_bindings; //!< number of end points by local address and bound device
+  };
+
+  /**
+   * \brief Container of the connected end points, by four-tuple.
+   */
+  typedef std::unordered_map<FourTuple, EndPoints, FourTupleHash> ConnectedEndPoints;
+
+  /**
+   * \brief Container of the end points, by local port.
+   */
+  typedef std::unordered_map<uint16_t, LocalPort> LocalPorts;
+
+  /**
+   * \brief Check whether an end point is indexed by its four-tuple.
+   * \param localAddress the local address of the end point
+   * \param peerAddress the peer address of the end point
+   * \param peerPort the peer port of the end point
+   * \return true if the end point is connected
+   */
+  static bool IsConnected (Ipv6Address localAddress, Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add an end point to the lookup tables.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the lookup tables.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add a new end point to the demux.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv6EndPoint * Insert (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +272,16 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The connected end points, by four-tuple.
+   */
+  ConnectedEndPoints m_connected;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  LocalPorts m_localPorts;
 };
 
 } /* namespace ns3 */
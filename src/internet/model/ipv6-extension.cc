@@ -335,10 +335,14 @@ void Ipv6ExtensionFragment::DoDispose ()
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
-      it->second = 0;
+      m_timerWheel->Cancel (m_reassemblyBuffers[it->second].m_timer);
     }
 
   m_fragments.clear ();
+  m_reassemblyBuffers.clear ();
+  m_freeReassemblyBuffers.clear ();
+  m_timerWheel = 0;
+  m_fragmentsTimeoutCallback = Callback<void, uint64_t> ();
   Ipv6Extension::DoDispose ();
 }
 
@@ -376,8 +380,8 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
   uint32_t identification = fragmentHeader.GetIdentification ();
   Ipv6Address src = ipv6Header.GetSourceAddress ();
 
-  std::pair<Ipv6Address, uint32_t> fragmentsId = std::pair<Ipv6Address, uint32_t> (src, identification);
-  Ptr<Fragments> fragments;
+  FragmentKey_t fragmentsId = FragmentKey_t (src, identification);
+  uint32_t index;
 
   Ipv6Header ipHeader = ipv6Header;
   ipHeader.SetNextHeader (fragmentHeader.GetNextHeader ());
@@ -385,32 +389,49 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
   MapFragments_t::iterator it = m_fragments.find (fragmentsId);
   if (it == m_fragments.end ())
     {
-      fragments = Create<Fragments> ();
-      m_fragments.insert (std::make_pair (fragmentsId, fragments));
-      EventId timeout = Simulator::Schedule (Seconds (60),
-                                             &Ipv6ExtensionFragment::HandleFragmentsTimeout, this,
-                                             fragmentsId, ipHeader);
-      fragments->SetTimeoutEventId (timeout);
+      if (m_freeReassemblyBuffers.empty ())
+        {
+          index = m_reassemblyBuffers.size ();
+          m_reassemblyBuffers.push_back (Fragments ());
+        }
+      else
+        {
+          index = m_freeReassemblyBuffers.back ();
+          m_freeReassemblyBuffers.pop_back ();
+        }
+      m_fragments.insert (std::make_pair (fragmentsId, index));
+
+      if (m_timerWheel == 0)
+        {
+          m_timerWheel = TimerWheel::GetTimerWheel (GetNode ());
+          m_fragmentsTimeoutCallback = MakeCallback (&Ipv6ExtensionFragment::HandleFragmentsTimeout, this);
+        }
+      Fragments &fragments = m_reassemblyBuffers[index];
+      fragments.m_key = fragmentsId;
+      fragments.m_ipHeader = ipHeader;
+      fragments.m_timer = m_timerWheel->Schedule (Seconds (60), m_fragmentsTimeoutCallback, index);
     }
   else
     {
-      fragments = it->second;
+      index = it->second;
     }
 
+  Fragments &fragments = m_reassemblyBuffers[index];
+
   if (fragmentOffset == 0)
     {
       Ptr<Packet> unfragmentablePart = packet->Copy ();
       unfragmentablePart->RemoveAtEnd (packet->GetSize () - offset);
-      fragments->SetUnfragmentablePart (unfragmentablePart);
+      fragments.SetUnfragmentablePart (unfragmentablePart);
     }
 
-  fragments->AddFragment (p, fragmentOffset, moreFragment);
+  fragments.AddFragment (p, fragmentOffset, moreFragment);
 
-  if (fragments->IsEntire ())
+  if (fragments.IsEntire ())
     {
-      packet = fragments->GetPacket ();
-      fragments->CancelTimeout ();
-      m_fragments.erase (fragmentsId);
+      packet = fragments.GetPacket ();
+      m_timerWheel->Cancel (fragments.m_timer);
+      ReleaseFragments (index);
       stopProcessing = false;
     }
   else
@@ -594,16 +615,16 @@ void Ipv6ExtensionFragment::GetFragments (Ptr<Packet> packet, Ipv6Header ipv6Hea
 }
 
 
-void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint32_t> fragmentsId,
-                                                    Ipv6Header ipHeader)
+void Ipv6ExtensionFragment::HandleFragmentsTimeout (uint64_t index)
 {
-  Ptr<Fragments> fragments;
+  NS_LOG_FUNCTION (this << index);
 
-  MapFragments_t::iterator it = m_fragments.find (fragmentsId);
-  NS_ASSERT_MSG(it != m_fragments.end (), "IPv6 Fragment timeout reached for non-existent fragment");
-  fragments = it->second;
+  Fragments &fragments = m_reassemblyBuffers[index];
+  Ptr<Packet> packet = fragments.GetPartialPacket ();
+  Ipv6Header ipHeader = fragments.m_ipHeader;
 
-  Ptr<Packet> packet = fragments->GetPartialPacket ();
+  // clear the buffers before sending the ICMP, which may add fragments
+  ReleaseFragments (index);
 
   // if we have at least 8 bytes, we can send an ICMP.
   if ( packet->GetSize () > 8 )
@@ -616,13 +637,21 @@ void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint3
 
   Ptr<Ipv6L3Protocol> ipL3 = GetNode ()->GetObject<Ipv6L3Protocol> ();
   ipL3->ReportDrop (ipHeader, packet, Ipv6L3Protocol::DROP_FRAGMENT_TIMEOUT);
+}
+
+void Ipv6ExtensionFragment::ReleaseFragments (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
 
-  // clear the buffers
-  m_fragments.erase (fragmentsId);
+  Fragments &fragments = m_reassemblyBuffers[index];
+  m_fragments.erase (fragments.m_key);
+  fragments.Clear ();
+  m_freeReassemblyBuffers.push_back (index);
 }
 
 Ipv6ExtensionFragment::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_timer (0),
+    m_moreFragment (0)
 {
 }
 
@@ -632,14 +661,13 @@ Ipv6ExtensionFragment::Fragments::~Fragments ()
 
 void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  // insert the fragment after those with a lower or equal offset, searching
+  // from the end since fragments usually arrive in order
+  std::vector<std::pair<Ptr<Packet>, uint16_t> >::iterator it = m_packetFragments.end ();
 
-  for (it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  while (it != m_packetFragments.begin () && (it - 1)->second > fragmentOffset)
     {
-      if (it->second > fragmentOffset)
-        {
-          break;
-        }
+      it--;
     }
 
   if (it == m_packetFragments.end ())
@@ -663,7 +691,7 @@ bool Ipv6ExtensionFragment::Fragments::IsEntire () const
     {
       uint16_t lastEndOffset = 0;
 
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+      for (std::vector<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
         {
           if (lastEndOffset != it->second)
             {
@@ -682,7 +710,7 @@ Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPacket () const
 {
   Ptr<Packet> p =  m_unfragmentable->Copy ();
 
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  for (std::vector<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
       p->AddAtEnd (it->first);
     }
@@ -700,12 +728,12 @@ Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPartialPacket () const
     }
   else
     {
-      return p;
+      return Create<Packet> ();
     }
 
   uint16_t lastEndOffset = 0;
 
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  for (std::vector<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
       if (lastEndOffset != it->second)
         {
@@ -718,19 +746,14 @@ Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPartialPacket () const
   return p;
 }
 
-void Ipv6ExtensionFragment::Fragments::SetTimeoutEventId (EventId event)
+void Ipv6ExtensionFragment::Fragments::Clear ()
 {
-  m_timeoutEventId = event;
-  return;
+  m_packetFragments.clear ();
+  m_unfragmentable = 0;
+  m_moreFragment = false;
+  m_timer = 0;
 }
 
-void Ipv6ExtensionFragment::Fragments::CancelTimeout ()
-{
-  m_timeoutEventId.Cancel ();
-  return;
-}
-
-
 NS_OBJECT_ENSURE_REGISTERED (Ipv6ExtensionRouting);
 
 TypeId Ipv6ExtensionRouting::GetTypeId ()
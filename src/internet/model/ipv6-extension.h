@@ -23,6 +23,8 @@
 
 #include <map>
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 #include "ns3/object.h"
 #include "ns3/node.h"
@@ -35,6 +37,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/traced-callback.h"
+#include "ns3/timer-wheel.h"
 
 
 namespace ns3 {
@@ -321,7 +324,18 @@ private:
    *
    * \brief This class stores the fragments of a packet waiting to be rebuilt.
    */
-  class Fragments : public SimpleRefCount<Fragments>
+  /// Key of the fragments of a packet: source address and identification
+  typedef std::pair<Ipv6Address, uint32_t> FragmentKey_t;
+
+  /**
+   * \ingroup ipv6HeaderExt
+   *
+   * \brief This class stores the fragments of a packet waiting to be rebuilt.
+   *
+   * The buffers are pooled by Ipv6ExtensionFragment and reused once the
+   * packet has been rebuilt or has expired.
+   */
+  class Fragments
   {
 public:
     /**
@@ -367,15 +381,13 @@ public:
     Ptr<Packet> GetPartialPacket () const;
 
     /**
-     * \brief Set the Timeout EventId.
-     * \param event The event.
+     * \brief Remove the fragments, to reuse the buffer for another packet.
      */
-    void SetTimeoutEventId (EventId event);
+    void Clear ();
 
-    /**
-     * \brief Cancel the timeout event
-     */
-    void CancelTimeout ();
+    FragmentKey_t m_key;           //!< The key of the packet
+    Ipv6Header m_ipHeader;         //!< The IP header of the packet
+    TimerWheel::TimerId m_timer;   //!< The expiration timer
 
 private:
     /**
@@ -384,54 +396,73 @@ private:
     bool m_moreFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The current fragments, sorted by offset.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_packetFragments;
+    std::vector<std::pair<Ptr<Packet>, uint16_t> > m_packetFragments;
 
     /**
      * \brief The unfragmentable part.
      */
     Ptr<Packet> m_unfragmentable;
+  };
 
+  /**
+   * \brief Process the timeout for packet fragments
+   * \param index the index of the reassembly buffer of the packet
+   */
+  void HandleFragmentsTimeout (uint64_t index);
+
+  /**
+   * \brief Remove a packet from the fragmented packets and return its
+   * reassembly buffer to the pool.
+   * \param index the index of the reassembly buffer of the packet
+   */
+  void ReleaseFragments (uint32_t index);
+
+  /**
+   * \brief Hash function of the keys of the fragments.
+   */
+  struct FragmentKeyHash
+  {
     /**
-     * \brief Timeout handler event
+     * \param key the key
+     * \return the hash of the key
      */
-    EventId m_timeoutEventId;
+    size_t operator() (const FragmentKey_t &key) const
+    {
+      return Ipv6AddressHash () (key.first) ^ static_cast<size_t> (key.second * 0x9e3779b9U);
+    }
   };
 
   /**
-   * \brief Process the timeout for packet fragments
-   * \param key representing the packet fragments
-   * \param ipHeader the IP header of the original packet
+   * \brief Container for the packet fragments: key / index of the reassembly buffer.
    */
-  void HandleFragmentsTimeout (std::pair<Ipv6Address, uint32_t> key, Ipv6Header ipHeader);
+  typedef std::unordered_map<FragmentKey_t, uint32_t, FragmentKeyHash> MapFragments_t;
 
   /**
-   * \brief Get the packet parts so far received.
-   * \return the partial packet
+   * \brief The hash of fragmented packets.
    */
-  Ptr<Packet> GetPartialPacket () const;
+  MapFragments_t m_fragments;
 
   /**
-   * \brief Set the Timeout EventId.
-   * \param event The event.
+   * \brief Reassembly buffers of the fragmented packets.
    */
-  void SetTimeoutEventId (EventId event);
+  std::vector<Fragments> m_reassemblyBuffers;
 
   /**
-   * \brief Cancel the timeout event
+   * \brief Indexes of the reassembly buffers not in use.
    */
-  void CancelTimeout ();
+  std::vector<uint32_t> m_freeReassemblyBuffers;
 
   /**
-   * \brief Container for the packet fragments.
+   * \brief Timer wheel of the node, for the expiration of the fragments.
    */
-  typedef std::map<std::pair<Ipv6Address, uint32_t>, Ptr<Fragments> > MapFragments_t;
+  Ptr<TimerWheel> m_timerWheel;
 
   /**
-   * \brief The hash of fragmented packets.
+   * \brief Callback of the expiration timers.
    */
-  MapFragments_t m_fragments;
+  Callback<void, uint64_t> m_fragmentsTimeoutCallback;
 };
 
 /**
@@ -217,7 +217,12 @@ uint32_t Ipv6L3Protocol::AddIpv6Interface (Ptr<Ipv6Interface> interface)
   uint32_t index = m_nInterfaces;
 
   m_interfaces.push_back (interface);
-  m_reverseInterfacesContainer[interface->GetDevice ()] = index;
+  uint32_t ifIndex = interface->GetDevice ()->GetIfIndex ();
+  if (ifIndex >= m_reverseInterfacesContainer.size ())
+    {
+      m_reverseInterfacesContainer.resize (ifIndex + 1, -1);
+    }
+  m_reverseInterfacesContainer[ifIndex] = index;
   m_nInterfaces++;
   return index;
 }
@@ -291,10 +296,16 @@ int32_t Ipv6L3Protocol::GetInterfaceForDevice (Ptr<const NetDevice> device) cons
 {
   NS_LOG_FUNCTION (this << device);
 
-  Ipv6InterfaceReverseContainer::const_iterator iter = m_reverseInterfacesContainer.find (device);
-  if (iter != m_reverseInterfacesContainer.end ())
+  // the index of a device in its node is the position of its interface index in
+  // the container. Check the device of the interface, because devices of other
+  // nodes may share the same index
+  if (device != 0 && device->GetIfIndex () < m_reverseInterfacesContainer.size ())
     {
-      return (*iter).second;
+      int32_t interface = m_reverseInterfacesContainer[device->GetIfIndex ()];
+      if (interface >= 0 && m_interfaces[interface]->GetDevice () == device)
+        {
+          return interface;
+        }
     }
 
   return -1;
@@ -22,6 +22,7 @@
 #define IPV6_L3_PROTOCOL_H
 
 #include <list>
+#include <vector>
 
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
@@ -479,9 +480,10 @@ private:
   typedef std::vector<Ptr<Ipv6Interface> > Ipv6InterfaceList;
 
   /**
-   * \brief Container of NetDevices registered to IPv6 and their interface indexes.
+   * \brief Container of the interface indexes of the NetDevices registered to IPv6,
+   * indexed by the index of the NetDevices in the node (-1 if not registered).
    */
-  typedef std::map<Ptr<const NetDevice>, uint32_t > Ipv6InterfaceReverseContainer;
+  typedef std::vector<int32_t> Ipv6InterfaceReverseContainer;
 
   /**
    * \brief Container of the IPv6 Raw Sockets.
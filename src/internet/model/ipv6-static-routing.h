@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -281,11 +282,24 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Rebuild the index of the network routes, if it is out of date.
+   */
+  void UpdateRouteIndex (void);
+
+  /// Trie of the network routes, by destination prefix
+  typedef PrefixTrie<NetworkRoutesI, 16> NetworkRouteTrie;
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  bool m_routeIndexValid;     //!< whether m_routeIndex is up to date with m_networkRoutes
+  bool m_routeIndexIrregular; //!< whether a route has a non-contiguous prefix, so that the index cannot be used
+  NetworkRouteTrie m_routeIndex; //!< longest prefix match index of m_networkRoutes
+  NetworkRouteTrie::MatchList m_routeMatches; //!< scratch list of the index entries matching a destination
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -22,6 +22,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ns3/names.h"
+#include "ns3/make-event.h"
+#include "ns3/simulator.h"
 
 #include "ipv6-l3-protocol.h" 
 #include "icmpv6-l4-protocol.h"
@@ -67,9 +69,21 @@ void NdiscCache::DoDispose ()
   m_device = 0;
   m_interface = 0;
   m_icmpv6 = 0;
+  m_timerWheel = 0;
   Object::DoDispose ();
 }
 
+Ptr<TimerWheel> NdiscCache::GetTimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_timerWheel == 0)
+    {
+      Ptr<Node> node = m_device ? m_device->GetNode () : 0;
+      m_timerWheel = node ? TimerWheel::GetTimerWheel (node) : CreateObject<TimerWheel> ();
+    }
+  return m_timerWheel;
+}
+
 void NdiscCache::SetDevice (Ptr<NetDevice> device, Ptr<Ipv6Interface> interface, Ptr<Icmpv6L4Protocol> icmpv6)
 {
   NS_LOG_FUNCTION (this << device << interface);
@@ -228,13 +242,22 @@ NdiscCache::Entry::Entry (NdiscCache* nd)
   : m_ndCache (nd),
     m_waiting (),
     m_router (false),
-    m_nudTimer (Timer::CANCEL_ON_DESTROY),
+    m_nudTimer (0),
     m_lastReachabilityConfirmation (Seconds (0.0)),
     m_nsRetransmit (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+NdiscCache::Entry::~Entry ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_nudTimer != 0)
+    {
+      m_ndCache->GetTimerWheel ()->Cancel (m_nudTimer);
+    }
+}
+
 void NdiscCache::Entry::SetRouter (bool router)
 {
   NS_LOG_FUNCTION (this << router);
@@ -417,15 +440,8 @@ Time NdiscCache::Entry::GetLastReachabilityConfirmation () const
 void NdiscCache::Entry::StartReachableTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
   m_lastReachabilityConfirmation = Simulator::Now ();
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionReachableTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetReachableTime ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionReachableTimeout, m_ndCache->m_icmpv6->GetReachableTime ());
 }
 
 void NdiscCache::Entry::UpdateReachableTimer ()
@@ -435,60 +451,47 @@ void NdiscCache::Entry::UpdateReachableTimer ()
   if (m_state == REACHABLE)
     {
       m_lastReachabilityConfirmation = Simulator::Now ();
-      if (m_nudTimer.IsRunning ())
-        {
-          m_nudTimer.Cancel ();
-        }
-      m_nudTimer.Schedule ();
+      ScheduleNudTimer (&NdiscCache::Entry::FunctionReachableTimeout, m_ndCache->m_icmpv6->GetReachableTime ());
     }
 }
 
 void NdiscCache::Entry::StartProbeTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionProbeTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetRetransmissionTime ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionProbeTimeout, m_ndCache->m_icmpv6->GetRetransmissionTime ());
 }
 
 void NdiscCache::Entry::StartDelayTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionDelayTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetDelayFirstProbe ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionDelayTimeout, m_ndCache->m_icmpv6->GetDelayFirstProbe ());
 }
 
 void NdiscCache::Entry::StartRetransmitTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  if (m_nudTimer.IsRunning ())
-    {
-      m_nudTimer.Cancel ();
-    }
-
-  m_nudTimer.SetFunction (&NdiscCache::Entry::FunctionRetransmitTimeout, this);
-  m_nudTimer.SetDelay (m_ndCache->m_icmpv6->GetRetransmissionTime ());
-  m_nudTimer.Schedule ();
+  ScheduleNudTimer (&NdiscCache::Entry::FunctionRetransmitTimeout, m_ndCache->m_icmpv6->GetRetransmissionTime ());
 }
 
 void NdiscCache::Entry::StopNudTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_nudTimer.Cancel ();
+  if (m_nudTimer != 0)
+    {
+      m_ndCache->GetTimerWheel ()->Cancel (m_nudTimer);
+      m_nudTimer = 0;
+    }
   m_nsRetransmit = 0;
 }
 
+void NdiscCache::Entry::ScheduleNudTimer (void (NdiscCache::Entry::*function)(), Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  Ptr<TimerWheel> wheel = m_ndCache->GetTimerWheel ();
+  wheel->Cancel (m_nudTimer);
+  m_nudTimer = wheel->Schedule (delay, MakeEvent (function, this));
+}
+
 void NdiscCache::Entry::MarkIncomplete (Ipv6PayloadHeaderPair p)
 {
   NS_LOG_FUNCTION (this << p.second << p.first);
@@ -29,7 +29,7 @@
 #include "ns3/net-device.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
-#include "ns3/timer.h"
+#include "ns3/timer-wheel.h"
 #include "ns3/sgi-hashmap.h"
 #include "ns3/output-stream-wrapper.h"
 
@@ -162,6 +162,11 @@ public:
      */
     Entry (NdiscCache* nd);
 
+    /**
+     * \brief Destructor.
+     */
+    ~Entry ();
+
     /**
      * \brief Changes the state to this entry to INCOMPLETE.
      * \param p packet that wait to be sent
@@ -386,10 +391,18 @@ private:
      */
     bool m_router;
 
+    /**
+     * \brief Schedule the NUD timer on the timer wheel of the cache,
+     * cancelling the pending one.
+     * \param function the function called when the timer expires
+     * \param delay the delay of the timer
+     */
+    void ScheduleNudTimer (void (NdiscCache::Entry::*function)(), Time delay);
+
     /**
      * \brief Timer (used for NUD).
      */
-    Timer m_nudTimer;
+    TimerWheel::TimerId m_nudTimer;
 
     /**
      * \brief Last time we see a reachability confirmation.
@@ -432,6 +445,13 @@ private:
    */
   void DoDispose ();
 
+  /**
+   * \brief Get the timer wheel of the node, which manages the NUD timers
+   * of the entries.
+   * \return the timer wheel
+   */
+  Ptr<TimerWheel> GetTimerWheel ();
+
   /**
    * \brief The NetDevice.
    */
@@ -456,6 +476,11 @@ private:
    * \brief Max number of packet stored in m_waiting.
    */
   uint32_t m_unresQlen;
+
+  /**
+   * \brief The timer wheel of the node.
+   */
+  Ptr<TimerWheel> m_timerWheel;
 };
 
 } /* namespace ns3 */
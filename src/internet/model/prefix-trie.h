@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Path-compressed binary trie of address prefixes, used for the
+ * longest prefix match lookups of the routing protocols.
+ *
+ * Each prefix of N bytes (4 for IPv4, 16 for IPv6) and its length map to
+ * the list of values inserted with that prefix, in insertion order.  Every
+ * value is numbered in insertion order, so that the values matching an
+ * address can be put back in the order of the routing table they index.
+ *
+ * Nodes are only created for the inserted prefixes and for the branching
+ * points between them, and are stored in a single vector.
+ *
+ * \tparam T the type of the values
+ * \tparam N the size of the prefixes, in bytes
+ */
+template <typename T, uint32_t N>
+class PrefixTrie
+{
+public:
+  /// A value, with its insertion sequence number
+  struct Value
+  {
+    uint32_t m_seq; //!< insertion sequence number
+    T m_value;      //!< the value
+  };
+
+  /// The values inserted with a prefix
+  typedef std::vector<Value> ValueList;
+
+  /// The lists of values of the prefixes matching an address, from the shortest to the longest prefix
+  typedef std::vector<const ValueList *> MatchList;
+
+  PrefixTrie ()
+  {
+    Clear ();
+  }
+
+  /**
+   * \brief Remove all the prefixes.
+   */
+  void Clear (void)
+  {
+    m_nodes.clear ();
+    m_nodes.push_back (Node ());
+    m_nextSeq = 0;
+  }
+
+  /**
+   * \brief Insert a value.
+   * \param prefix the prefix (N bytes, bits beyond the prefix length are ignored)
+   * \param length the prefix length, in bits
+   * \param value the value
+   */
+  void Insert (const uint8_t *prefix, uint8_t length, const T &value)
+  {
+    NS_ASSERT (length <= N * 8);
+    Value v;
+    v.m_seq = m_nextSeq++;
+    v.m_value = value;
+
+    uint32_t n = 0;
+    for (;;)
+      {
+        // the key of node n is a prefix of the inserted prefix
+        if (m_nodes[n].m_length == length)
+          {
+            m_nodes[n].m_values.push_back (v);
+            return;
+          }
+        uint8_t b = GetBit (prefix, m_nodes[n].m_length);
+        uint32_t c = m_nodes[n].m_child[b];
+        if (c == 0)
+          {
+            uint32_t leaf = NewNode (prefix, length);
+            m_nodes[leaf].m_values.push_back (v);
+            m_nodes[n].m_child[b] = leaf;
+            return;
+          }
+        uint8_t childLength = m_nodes[c].m_length;
+        uint8_t common = CommonLength (prefix, m_nodes[c].m_key,
+                                       length < childLength ? length : childLength);
+        if (common == childLength)
+          {
+            n = c;
+            continue;
+          }
+        // the prefix diverges from (or ends within) the key of the child:
+        // split the edge at the common part
+        uint32_t mid = NewNode (prefix, common);
+        m_nodes[mid].m_child[GetBit (m_nodes[c].m_key, common)] = c;
+        if (common == length)
+          {
+            m_nodes[mid].m_values.push_back (v);
+          }
+        else
+          {
+            uint32_t leaf = NewNode (prefix, length);
+            m_nodes[leaf].m_values.push_back (v);
+            m_nodes[mid].m_child[GetBit (prefix, common)] = leaf;
+          }
+        m_nodes[n].m_child[b] = mid;
+        return;
+      }
+  }
+
+  /**
+   * \brief Find the prefixes matching an address.
+   * \param address the address (N bytes)
+   * \param [out] matches the values of the matching prefixes, from the
+   *        shortest to the longest prefix
+   */
+  void Lookup (const uint8_t *address, MatchList &matches) const
+  {
+    matches.clear ();
+    uint32_t n = 0;
+    for (;;)
+      {
+        const Node &node = m_nodes[n];
+        if (!node.m_values.empty ())
+          {
+            matches.push_back (&node.m_values);
+          }
+        if (node.m_length == N * 8)
+          {
+            return;
+          }
+        uint32_t c = node.m_child[GetBit (address, node.m_length)];
+        if (c == 0 || CommonLength (address, m_nodes[c].m_key, m_nodes[c].m_length) < m_nodes[c].m_length)
+          {
+            return;
+          }
+        n = c;
+      }
+  }
+
+  /**
+   * \brief Find the values inserted with exactly the given prefix.
+   * \param prefix the prefix (N bytes)
+   * \param length the prefix length, in bits
+   * \returns the values, or 0 if there is none
+   */
+  const ValueList * Find (const uint8_t *prefix, uint8_t length) const
+  {
+    uint32_t n = 0;
+    while (m_nodes[n].m_length < length)
+      {
+        uint32_t c = m_nodes[n].m_child[GetBit (prefix, m_nodes[n].m_length)];
+        if (c == 0 || m_nodes[c].m_length > length
+            || CommonLength (prefix, m_nodes[c].m_key, m_nodes[c].m_length) < m_nodes[c].m_length)
+          {
+            return 0;
+          }
+        n = c;
+      }
+    return m_nodes[n].m_values.empty () ? 0 : &m_nodes[n].m_values;
+  }
+
+private:
+  /// A node of the trie
+  struct Node
+  {
+    Node ()
+      : m_length (0)
+    {
+      std::memset (m_key, 0, N);
+      m_child[0] = 0;
+      m_child[1] = 0;
+    }
+    uint8_t m_key[N];     //!< the prefix of the node, with the bits beyond m_length cleared
+    uint8_t m_length;     //!< the prefix length
+    uint32_t m_child[2];  //!< the children, by value of the next bit (0 if none, as the root cannot be a child)
+    ValueList m_values;   //!< the values inserted with this prefix
+  };
+
+  /**
+   * \param key a key
+   * \param bit the index of a bit, 0 being the most significant bit of the first byte
+   * \returns the value of the bit
+   */
+  static uint8_t GetBit (const uint8_t *key, uint32_t bit)
+  {
+    return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+  }
+
+  /**
+   * \param a a key
+   * \param b another key
+   * \param maxLength the maximum length to compare, in bits
+   * \returns the length of the longest common prefix of the keys, up to maxLength
+   */
+  static uint8_t CommonLength (const uint8_t *a, const uint8_t *b, uint8_t maxLength)
+  {
+    uint32_t length = 0;
+    for (uint32_t i = 0; length < maxLength; i++)
+      {
+        uint8_t diff = a[i] ^ b[i];
+        if (diff == 0)
+          {
+            length += 8;
+            continue;
+          }
+        while ((diff & 0x80) == 0)
+          {
+            diff <<= 1;
+            length++;
+          }
+        break;
+      }
+    return length < maxLength ? length : maxLength;
+  }
+
+  /**
+   * \param prefix the prefix
+   * \param length the prefix length
+   * \returns the index of a new node with the given prefix
+   */
+  uint32_t NewNode (const uint8_t *prefix, uint8_t length)
+  {
+    Node node;
+    node.m_length = length;
+    for (uint32_t i = 0; i < N && i * 8 < length; i++)
+      {
+        uint32_t bits = length - i * 8;
+        node.m_key[i] = bits >= 8 ? prefix[i] : prefix[i] & static_cast<uint8_t> (0xff << (8 - bits));
+      }
+    m_nodes.push_back (node);
+    return m_nodes.size () - 1;
+  }
+
+  std::vector<Node> m_nodes; //!< the nodes, the first one being the root (empty prefix)
+  uint32_t m_nextSeq;        //!< the sequence number of the next inserted value
+};
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
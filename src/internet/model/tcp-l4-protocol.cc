@@ -29,6 +29,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/segmentation-offload.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -45,6 +46,7 @@
 #include "tcp-recovery-ops.h"
 #include "rtt-estimator.h"
 
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -99,6 +101,7 @@ TcpL4Protocol::TcpL4Protocol ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_LOGIC ("Made a TcpL4Protocol " << this);
+  SegmentationOffload::Register (Ipv4L3Protocol::PROT_NUMBER, MakeCallback (&TcpL4Protocol::SegmentIpv4));
 }
 
 TcpL4Protocol::~TcpL4Protocol ()
@@ -551,6 +554,53 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
   return IpL4Protocol::RX_OK;
 }
 
+void
+TcpL4Protocol::SegmentIpv4 (Ptr<Packet> packet, uint32_t segmentSize, std::vector<Ptr<Packet> > &segments)
+{
+  Ipv4Header ipHeader;
+  packet->RemoveHeader (ipHeader);
+  NS_ASSERT (ipHeader.GetProtocol () == PROT_NUMBER);
+  TcpHeader tcpHeader;
+  packet->RemoveHeader (tcpHeader);
+
+  uint32_t size = packet->GetSize ();
+  uint16_t identification = ipHeader.GetIdentification ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = packet->CreateFragment (offset, length);
+
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      uint8_t flags = tcpHeader.GetFlags ();
+      if (offset > 0)
+        {
+          flags &= ~TcpHeader::CWR;
+        }
+      if (offset + length < size)
+        {
+          flags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      segmentTcpHeader.SetFlags (flags);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentTcpHeader.EnableChecksums ();
+        }
+      segmentTcpHeader.InitializeChecksum (ipHeader.GetSource (), ipHeader.GetDestination (), PROT_NUMBER);
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentIpHeader = ipHeader;
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+      segmentIpHeader.SetIdentification (identification++);
+      if (Node::ChecksumEnabled ())
+        {
+          segmentIpHeader.EnableChecksum ();
+        }
+      segment->AddHeader (segmentIpHeader);
+      segments.push_back (segment);
+    }
+}
+
 void
 TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv4Address &saddr, const Ipv4Address &daddr,
@@ -22,6 +22,7 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <vector>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -313,6 +314,21 @@ protected:
   void NoEndPointsFound (const TcpHeader &incomingHeader, const Address &incomingSAddr,
                          const Address &incomingDAddr);
 
+  /**
+   * \brief Split an IPv4 packet carrying several TCP segments
+   *
+   * This function is registered to SegmentationOffload for the IPv4
+   * protocol.  Each segment gets a copy of the IPv4 and TCP headers, with
+   * its own sequence number, identification, lengths and checksums.  The
+   * FIN and PSH flags are only kept in the last segment, and CWR only in
+   * the first one.
+   *
+   * \param packet the packet, starting with the IPv4 header
+   * \param segmentSize the size of the payload of the segments
+   * \param segments the list to fill with the segments
+   */
+  static void SegmentIpv4 (Ptr<Packet> packet, uint32_t segmentSize, std::vector<Ptr<Packet> > &segments);
+
 private:
   Ptr<Node> m_node;                //!< the node this stack is associated with
   Ipv4EndPointDemux *m_endPoints;  //!< A list of IPv4 end points.
@@ -18,6 +18,7 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -113,9 +114,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
+  else if (!m_data.empty () && m_nextRxSeq > m_data.front ().m_start)
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return m_data.front ().m_start + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -149,76 +150,64 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (!m_data.empty ())
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = m_data.front ().m_start + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
+
+  // Store the parts of the packet which fill the holes between the blocks,
+  // starting from the first block which ends at or after headSeq
+  uint32_t i = std::lower_bound (m_data.begin (), m_data.end (), headSeq, EndsBefore) - m_data.begin ();
+  SequenceNumber32 seq = headSeq;
+  int32_t stored = -1;
+  while (seq < tailSeq)
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      if (lastByteSeq > headSeq)
+      SequenceNumber32 holeEnd = tailSeq;
+      if (i < m_data.size () && m_data[i].m_start < holeEnd)
         {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
-              continue;
-            }
-          if (i->first <= headSeq)
-            { // Incoming head is overlapped
-              headSeq = lastByteSeq;
-            }
-          if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-              tailSeq = i->first;
-            }
+          holeEnd = m_data[i].m_start;
         }
+      if (seq < holeEnd)
+        {
+          uint32_t start = static_cast<uint32_t> (seq - tcph.GetSequenceNumber ());
+          uint32_t length = static_cast<uint32_t> (holeEnd - seq);
+          // the whole payload is stored as is, without copy
+          Ptr<Packet> fragment = (length == pktSize) ? p : p->CreateFragment (start, length);
+          NS_LOG_LOGIC ("Buffered packet of seqno=" << seq << " len=" << length);
+          m_size += length;
+          i = stored = Insert (i, seq, holeEnd, fragment);
+        }
+      if (i == m_data.size ())
+        {
+          break;
+        }
+      // skip the data already stored
+      seq = m_data[i].m_end;
       ++i;
     }
-  // We now know how much we are going to store, trim the packet
-  if (headSeq >= tailSeq)
+
+  if (stored < 0)
     {
       NS_LOG_LOGIC ("Nothing to buffer");
       return false; // Nothing to buffer anyway
     }
-  else
-    {
-      uint32_t start = static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ());
-      uint32_t length = static_cast<uint32_t> (tailSeq - headSeq);
-      p = p->CreateFragment (start, length);
-      NS_ASSERT (length == p->GetSize ());
-    }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
 
-  if (headSeq > m_nextRxSeq)
+  const DataBlock &block = m_data[stored];
+  if (block.m_start > m_nextRxSeq)
     {
       // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      UpdateSackList (block.m_start, block.m_end);
     }
-
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  else if (block.m_end > m_nextRxSeq)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      // The in-order data has grown
+      m_availBytes += block.m_end - m_nextRxSeq;
+      m_nextRxSeq = block.m_end;
       ClearSackList (m_nextRxSeq);
     }
+
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
     { // Account for the FIN packet
@@ -227,6 +216,61 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+bool
+TcpRxBuffer::EndsBefore (const DataBlock &block, const SequenceNumber32 &seq)
+{
+  return block.m_end < seq;
+}
+
+uint32_t
+TcpRxBuffer::Insert (uint32_t i, const SequenceNumber32 &head, const SequenceNumber32 &tail, Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << i << head << tail);
+  bool joinPrevious = (i > 0 && m_data[i - 1].m_end == head);
+  bool joinNext = (i < m_data.size () && m_data[i].m_start == tail);
+
+  if (joinPrevious)
+    {
+      DataBlock &previous = m_data[i - 1];
+      previous.m_packets.push_back (p);
+      previous.m_end = tail;
+      if (joinNext)
+        {
+          // the hole between the two blocks is filled
+          DataBlock &next = m_data[i];
+          previous.m_packets.insert (previous.m_packets.end (),
+                                     next.m_packets.begin () + next.m_first,
+                                     next.m_packets.end ());
+          previous.m_end = next.m_end;
+          m_data.erase (m_data.begin () + i);
+        }
+      return i - 1;
+    }
+
+  if (joinNext)
+    {
+      DataBlock &next = m_data[i];
+      if (next.m_first == 0)
+        {
+          // make room at the front, as much as the block holds
+          uint32_t room = std::max<uint32_t> (next.m_packets.size (), 4);
+          next.m_packets.insert (next.m_packets.begin (), room, Ptr<Packet> ());
+          next.m_first = room;
+        }
+      next.m_packets[--next.m_first] = p;
+      next.m_start = head;
+      return i;
+    }
+
+  DataBlock block;
+  block.m_start = head;
+  block.m_end = tail;
+  block.m_packets.push_back (p);
+  block.m_first = 0;
+  m_data.insert (m_data.begin () + i, block);
+  return i;
+}
+
 uint32_t
 TcpRxBuffer::GetSackListSize () const
 {
@@ -271,53 +315,21 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
   //     following SACK blocks in the SACK option may be listed in
   //     arbitrary order.
 
-  m_sackList.push_front (current);
-
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
-  TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
-  while (it != m_sackList.end ())
+  //
+  // The block is the whole block of data which contains the segment: the
+  // blocks previously reported which are part of it are subsets of it.
+  for (TcpOptionSack::SackList::iterator it = m_sackList.begin (); it != m_sackList.end (); )
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
+      if (it->first >= head && it->second <= tail)
         {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
-        {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          ++it;
         }
-
-      ++it;
     }
+  m_sackList.push_front (current);
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
   // point on maintaining the others.
@@ -325,11 +337,6 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     {
       m_sackList.pop_back ();
     }
-
-  // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
 }
 
 void
@@ -369,39 +376,67 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  DataBlock &block = m_data.front ();
+  NS_ASSERT (block.m_start < m_nextRxSeq); // in-sequence data expected
+  Ptr<Packet> outPkt; // The packet that contains all the data to return
+  bool owned = false; // Whether outPkt is not a stored payload
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Ptr<Packet> &head = block.m_packets[block.m_first];
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = head->GetSize ();
+      uint32_t size = std::min (pktSize, extractSize);
+      Ptr<Packet> data = head;
+      bool fragment = false;
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
+          head = 0;
+          ++block.m_first;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          data = head->CreateFragment (0, extractSize);
+          head = head->CreateFragment (extractSize, pktSize - extractSize);
+          fragment = true;
+        }
+      if (outPkt == 0)
+        {
+          outPkt = data;
+          owned = fragment;
         }
+      else
+        {
+          if (!owned)
+            {
+              // do not modify the stored payload
+              outPkt = outPkt->Copy ();
+              owned = true;
+            }
+          outPkt->AddAtEnd (data);
+        }
+      block.m_start += size;
+      m_size -= size;
+      m_availBytes -= size;
+      extractSize -= size;
+    }
+  if (!owned)
+    {
+      // The payload was stored as passed to Add, and was already seen by
+      // the trace sinks of the receive path: give a copy to the application
+      outPkt = outPkt->Copy ();
+    }
+  if (block.m_first == block.m_packets.size ())
+    {
+      m_data.erase (m_data.begin ());
     }
-  if (outPkt->GetSize () == 0)
+  else if (block.m_first > block.m_packets.size () / 2)
     {
-      NS_LOG_LOGIC ("Nothing extracted.");
-      return nullptr;
+      // release the room of the payloads already extracted
+      block.m_packets.erase (block.m_packets.begin (), block.m_packets.begin () + block.m_first);
+      block.m_first = 0;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num blocks in buffer=" << m_data.size ());
   return outPkt;
 }
 
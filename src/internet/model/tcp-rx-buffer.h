@@ -21,7 +21,7 @@
 #ifndef TCP_RX_BUFFER_H
 #define TCP_RX_BUFFER_H
 
-#include <map>
+#include <vector>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -53,6 +53,13 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The data is kept as a sorted vector of blocks of contiguous data. Each block
+ * holds the payloads of the segments it is made of, which are not copied when
+ * blocks are coalesced; the first block is the in-order data, if any, and the
+ * following ones are the out-of-order data, separated by holes. A segment is
+ * stored by filling the holes it covers, found by a binary search, and the
+ * SACK list reports the whole block which contains it.
+ *
  * SACK list
  * ---------
  *
@@ -152,6 +159,7 @@ public:
   /**
    * Extract data from the head of the buffer as indicated by nextRxSeq.
    * The extracted data is going to be forwarded to the application.
+   * The returned packet is never one of the packets passed to Add.
    *
    * \param maxSize maximum number of bytes to extract
    * \returns a packet
@@ -182,6 +190,37 @@ public:
   bool GotFin () const { return m_gotFin; }
 
 private:
+  /**
+   * \brief A block of contiguous data, made of the payloads of one or more
+   * segments, in sequence order
+   */
+  struct DataBlock
+  {
+    SequenceNumber32 m_start;            //!< Seqnum of the first byte of the block
+    SequenceNumber32 m_end;              //!< Seqnum of the byte following the block
+    std::vector<Ptr<Packet> > m_packets; //!< The payloads, starting at m_first
+    uint32_t m_first;                    //!< Index in m_packets of the first payload
+  };
+
+  /**
+   * \brief Compare the end of a block of data with a sequence number
+   * \param block the block
+   * \param seq the sequence number
+   * \returns true if the block ends before seq
+   */
+  static bool EndsBefore (const DataBlock &block, const SequenceNumber32 &seq);
+
+  /**
+   * \brief Store data, coalescing it with the blocks next to it
+   *
+   * \param i index of the first block after the data
+   * \param head sequence number of the first byte of the data
+   * \param tail sequence number of the byte following the data
+   * \param p the data
+   * \returns the index of the block which contains the data
+   */
+  uint32_t Insert (uint32_t i, const SequenceNumber32 &head, const SequenceNumber32 &tail, Ptr<Packet> p);
+
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
@@ -197,6 +236,10 @@ private:
    * (or other) options, it is even less. For more detail about this function,
    * please see the source code and in-line comments.
    *
+   * The block is the whole block of data which contains the segment just
+   * received, and the blocks already in the list which are part of it are
+   * removed.
+   *
    * \param head sequence number of the block at the beginning
    * \param tail sequence number of the block at the end
    */
@@ -217,15 +260,13 @@ private:
 
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
-  /// container for data stored in the buffer
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::vector<DataBlock> m_data;             //!< Blocks of data, in sequence order, neither overlapping nor adjacent
 };
 
 } //namespace ns3
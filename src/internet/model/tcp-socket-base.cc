@@ -42,6 +42,7 @@
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
+#include "ns3/segmentation-offload.h"
 #include "ns3/object.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -57,10 +58,13 @@
 #include "tcp-option-sack-permitted.h"
 #include "tcp-option-sack.h"
 #include "tcp-congestion-ops.h"
+#include "tcp-bic.h"
+#include "tcp-highspeed.h"
 #include "tcp-recovery-ops.h"
 
 #include <math.h>
 #include <algorithm>
+#include <typeinfo>
 
 namespace ns3 {
 
@@ -68,6 +72,52 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+/**
+ * \ingroup tcp
+ *
+ * \brief Accessor of a trace source of the TcpSocketState of a socket.
+ *
+ * The sinks are connected directly to the traced value of the
+ * TcpSocketState, instead of being chained through a callback of the
+ * socket, so that a change of the value invokes no callback when nothing
+ * is connected.
+ */
+class TcpSocketBase::TcbTraceSourceAccessor : public TraceSourceAccessor
+{
+public:
+  /**
+   * \brief Constructor
+   * \param name the name of the trace source of TcpSocketState
+   */
+  TcbTraceSourceAccessor (std::string name)
+    : m_name (name)
+  {
+  }
+  virtual bool ConnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const
+  {
+    TcpSocketBase *socket = dynamic_cast<TcpSocketBase *> (obj);
+    return socket != 0 && socket->m_tcb->TraceConnectWithoutContext (m_name, cb);
+  }
+  virtual bool Connect (ObjectBase *obj, std::string context, const CallbackBase &cb) const
+  {
+    TcpSocketBase *socket = dynamic_cast<TcpSocketBase *> (obj);
+    return socket != 0 && socket->m_tcb->TraceConnect (m_name, context, cb);
+  }
+  virtual bool DisconnectWithoutContext (ObjectBase *obj, const CallbackBase &cb) const
+  {
+    TcpSocketBase *socket = dynamic_cast<TcpSocketBase *> (obj);
+    return socket != 0 && socket->m_tcb->TraceDisconnectWithoutContext (m_name, cb);
+  }
+  virtual bool Disconnect (ObjectBase *obj, std::string context, const CallbackBase &cb) const
+  {
+    TcpSocketBase *socket = dynamic_cast<TcpSocketBase *> (obj);
+    return socket != 0 && socket->m_tcb->TraceDisconnect (m_name, context, cb);
+  }
+
+private:
+  std::string m_name; //!< Name of the trace source of TcpSocketState
+};
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -141,6 +191,13 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsoMaxSegments",
+                   "Maximum number of new segments handed at once to the IPv4 layer, "
+                   "and split by the NetDevice (segmentation offload). 1 disables the offload. "
+                   "The packet is also limited to 64 KB with its headers",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1, 65535))
     .AddAttribute ("EcnMode", "Determines the mode of ECN",
                    EnumValue (EcnMode_t::NoEcn),
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
@@ -152,15 +209,15 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::Time")
     .AddTraceSource ("RTT",
                      "Last RTT sample",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_lastRttTrace),
+                     Create<TcbTraceSourceAccessor> ("RTT"),
                      "ns3::TracedValueCallback::Time")
     .AddTraceSource ("NextTxSequence",
                      "Next sequence number to send (SND.NXT)",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_nextTxSequenceTrace),
+                     Create<TcbTraceSourceAccessor> ("NextTxSequence"),
                      "ns3::SequenceNumber32TracedValueCallback")
     .AddTraceSource ("HighestSequence",
                      "Highest sequence number ever sent in socket's life time",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_highTxMarkTrace),
+                     Create<TcbTraceSourceAccessor> ("HighestSequence"),
                      "ns3::TracedValueCallback::SequenceNumber32")
     .AddTraceSource ("State",
                      "TCP state",
@@ -168,11 +225,11 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TcpStatesTracedValueCallback")
     .AddTraceSource ("CongState",
                      "TCP Congestion machine state",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_congStateTrace),
+                     Create<TcbTraceSourceAccessor> ("CongState"),
                      "ns3::TcpSocketState::TcpCongStatesTracedValueCallback")
     .AddTraceSource ("EcnState",
                      "Trace ECN state change of socket",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_ecnStateTrace),
+                     Create<TcbTraceSourceAccessor> ("EcnState"),
                      "ns3::TcpSocketState::EcnStatesTracedValueCallback")
     .AddTraceSource ("AdvWND",
                      "Advertised Window Size",
@@ -184,7 +241,7 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("BytesInFlight",
                      "Socket estimation of bytes in flight",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_bytesInFlightTrace),
+                     Create<TcbTraceSourceAccessor> ("BytesInFlight"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("HighestRxSequence",
                      "Highest sequence number received from peer",
@@ -196,15 +253,15 @@ TcpSocketBase::GetTypeId (void)
                      "ns3::TracedValueCallback::SequenceNumber32")
     .AddTraceSource ("CongestionWindow",
                      "The TCP connection's congestion window",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_cWndTrace),
+                     Create<TcbTraceSourceAccessor> ("CongestionWindow"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("CongestionWindowInflated",
                      "The TCP connection's congestion window inflates as in older RFC",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_cWndInflTrace),
+                     Create<TcbTraceSourceAccessor> ("CongestionWindowInflated"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("SlowStartThreshold",
                      "TCP slow start threshold (bytes)",
-                     MakeTraceSourceAccessor (&TcpSocketBase::m_ssThTrace),
+                     Create<TcbTraceSourceAccessor> ("SlowStartThreshold"),
                      "ns3::TracedValueCallback::Uint32")
     .AddTraceSource ("Tx",
                      "Send tcp packet to IP protocol",
@@ -246,44 +303,6 @@ TcpSocketBase::TcpSocketBase (void)
 
   m_tcb->m_currentPacingRate = m_tcb->m_maxPacingRate;
   m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
-
-  bool ok;
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
-                                          MakeCallback (&TcpSocketBase::UpdateCwnd, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
-                                          MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
-                                          MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongState",
-                                          MakeCallback (&TcpSocketBase::UpdateCongState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
-                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
-                                          MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("RTT",
-                                          MakeCallback (&TcpSocketBase::UpdateRtt, this));
-  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
@@ -363,50 +382,13 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   if (sock.m_congestionControl)
     {
       m_congestionControl = sock.m_congestionControl->Fork ();
+      m_congestionOpsKind = sock.m_congestionOpsKind;
     }
 
   if (sock.m_recoveryOps)
     {
       m_recoveryOps = sock.m_recoveryOps->Fork ();
     }
-
-  bool ok;
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindow",
-                                          MakeCallback (&TcpSocketBase::UpdateCwnd, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongestionWindowInflated",
-                                          MakeCallback (&TcpSocketBase::UpdateCwndInfl, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("SlowStartThreshold",
-                                          MakeCallback (&TcpSocketBase::UpdateSsThresh, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("CongState",
-                                          MakeCallback (&TcpSocketBase::UpdateCongState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
-                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("HighestSequence",
-                                          MakeCallback (&TcpSocketBase::UpdateHighTxMark, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("BytesInFlight",
-                                          MakeCallback (&TcpSocketBase::UpdateBytesInFlight, this));
-  NS_ASSERT (ok == true);
-
-  ok = m_tcb->TraceConnectWithoutContext ("RTT",
-                                          MakeCallback (&TcpSocketBase::UpdateRtt, this));
-  NS_ASSERT (ok == true);
 }
 
 TcpSocketBase::~TcpSocketBase (void)
@@ -1566,7 +1548,7 @@ TcpSocketBase::EnterRecovery ()
   // If SACK is not enabled, still consider the head as 'in flight' for
   // compatibility with old ns-3 versions
   uint32_t bytesInFlight = m_sackEnabled ? BytesInFlight () : BytesInFlight () + m_tcb->m_segmentSize;
-  m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, bytesInFlight);
+  m_tcb->m_ssThresh = CongestionGetSsThresh (bytesInFlight);
   m_recoveryOps->EnterRecovery (m_tcb, m_dupAckCount, UnAckDataCount (), m_txBuffer->GetSacked ());
 
   NS_LOG_INFO (m_dupAckCount << " dupack. Enter fast recovery mode." <<
@@ -1781,7 +1763,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
   else if (ackNumber == oldHeadSequence)
     {
       // DupAck. Artificially call PktsAcked: after all, one segment has been ACKed.
-      m_congestionControl->PktsAcked (m_tcb, 1, m_tcb->m_lastRtt);
+      CongestionPktsAcked (1);
     }
   else if (ackNumber > oldHeadSequence)
     {
@@ -1845,7 +1827,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
           // This partial ACK acknowledge the fact that one segment has been
           // previously lost and now successfully received. All others have
           // been processed when they come under the form of dupACKs
-          m_congestionControl->PktsAcked (m_tcb, 1, m_tcb->m_lastRtt);
+          CongestionPktsAcked (1);
           NewAck (ackNumber, m_isFirstPartialAck);
 
           if (m_isFirstPartialAck)
@@ -1872,8 +1854,8 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
       // of RecoveryPoint.
       else if (ackNumber < m_recover && m_tcb->m_congState == TcpSocketState::CA_LOSS)
         {
-          m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
-          m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+          CongestionPktsAcked (segsAcked);
+          CongestionIncreaseWindow (segsAcked);
 
           NS_LOG_DEBUG (" Cong Control Called, cWnd=" << m_tcb->m_cWnd <<
                         " ssTh=" << m_tcb->m_ssThresh);
@@ -1889,13 +1871,13 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
         {
           if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
             {
-              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
+              CongestionPktsAcked (segsAcked);
             }
           else if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
             {
               if (segsAcked >= oldDupAckCount)
                 {
-                  m_congestionControl->PktsAcked (m_tcb, segsAcked - oldDupAckCount, m_tcb->m_lastRtt);
+                  CongestionPktsAcked (segsAcked - oldDupAckCount);
                 }
 
               if (!isDupack)
@@ -1930,7 +1912,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
               // (which are the ones we have not passed to PktsAcked and that
               // can increase cWnd)
               segsAcked = static_cast<uint32_t>(ackNumber - m_recover) / m_tcb->m_segmentSize;
-              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
+              CongestionPktsAcked (segsAcked);
               m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_COMPLETE_CWR);
               m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
               m_tcb->m_congState = TcpSocketState::CA_OPEN;
@@ -1949,7 +1931,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
               // can increase cWnd)
               segsAcked = (ackNumber - m_recover) / m_tcb->m_segmentSize;
 
-              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
+              CongestionPktsAcked (segsAcked);
 
               m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
               m_tcb->m_congState = TcpSocketState::CA_OPEN;
@@ -1966,7 +1948,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              CongestionIncreaseWindow (segsAcked);
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -2840,8 +2822,24 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
+  Ptr<Packet> p = m_txBuffer->CopyFromSequence (std::min (maxSize, m_tcb->m_segmentSize), seq);
   uint32_t sz = p->GetSize (); // Size of packet
+  if (sz < maxSize && sz == m_tcb->m_segmentSize)
+    {
+      // Segmentation offload: the segments are copied one by one, so that
+      // the scoreboard of the Tx buffer still tracks each of them
+      while (sz < maxSize && m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz)) > 0)
+        {
+          p->AddAtEnd (m_txBuffer->CopyFromSequence (std::min (maxSize - sz, m_tcb->m_segmentSize),
+                                                     seq + SequenceNumber32 (sz)));
+          sz = p->GetSize ();
+        }
+      if (sz > m_tcb->m_segmentSize)
+        {
+          p->AddPacketTag (SegmentationOffloadTag (m_tcb->m_segmentSize,
+                                                   (sz + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize));
+        }
+    }
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
@@ -3076,6 +3074,23 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_tsoMaxSegments > 1 && m_endPoint != nullptr && !m_tcb->m_pacing
+              && next == m_tcb->m_highTxMark)
+            {
+              // Segmentation offload: new data is sent in several full
+              // segments at once, and a smaller last segment is left to
+              // the checks above in the next round.  As with the Linux GSO,
+              // the packet must fit in 64 KB with the largest IPv4 (20 bytes,
+              // without options) and TCP (60 bytes) headers.
+              uint32_t maxSegments = std::min (m_tsoMaxSegments, (65535 - 20 - 60) / m_tcb->m_segmentSize);
+              uint32_t tso = std::min (std::min (availableWindow, availableData),
+                                       m_tcb->m_segmentSize * maxSegments);
+              tso -= tso % m_tcb->m_segmentSize;
+              if (tso > s)
+                {
+                  s = tso;
+                }
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -3230,6 +3245,14 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // A packet coalesced by the receive offload counts as the segments it carries
+  uint32_t segments = 1;
+  SegmentationOffloadTag offloadTag;
+  if (p->RemovePacketTag (offloadTag))
+    {
+      segments = offloadTag.GetSegmentCount ();
+    }
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -3283,7 +3306,8 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -3521,7 +3545,7 @@ TcpSocketBase::ReTxTimeout ()
   // retransmission timer, decrease ssThresh
   if (m_tcb->m_congState != TcpSocketState::CA_LOSS || !m_txBuffer->IsHeadRetransmitted ())
     {
-      m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, inFlightBeforeRto);
+      m_tcb->m_ssThresh = CongestionGetSsThresh (inFlightBeforeRto);
     }
 
   // Cwnd set to 1 MSS
@@ -4133,68 +4157,79 @@ TcpSocketBase::SetRetxThresh (uint32_t retxThresh)
 }
 
 void
-TcpSocketBase::UpdateCwnd (uint32_t oldValue, uint32_t newValue)
-{
-  m_cWndTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateCwndInfl (uint32_t oldValue, uint32_t newValue)
-{
-  m_cWndInflTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateSsThresh (uint32_t oldValue, uint32_t newValue)
-{
-  m_ssThTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
-                                TcpSocketState::TcpCongState_t newValue)
-{
-  m_congStateTrace (oldValue, newValue);
-}
-
- void
-TcpSocketBase::UpdateEcnState (TcpSocketState::EcnState_t oldValue,
-                                TcpSocketState::EcnState_t newValue)
-{
-  m_ecnStateTrace (oldValue, newValue);
-}
-
-void
-TcpSocketBase::UpdateNextTxSequence (SequenceNumber32 oldValue,
-                                     SequenceNumber32 newValue)
-
+TcpSocketBase::SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo)
 {
-  m_nextTxSequenceTrace (oldValue, newValue);
-}
+  NS_LOG_FUNCTION (this << algo);
+  m_congestionControl = algo;
 
-void
-TcpSocketBase::UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 newValue)
-{
-  m_highTxMarkTrace (oldValue, newValue);
+  // the built-in algorithms are bound statically, but not their subclasses,
+  // which may not register a TypeId of their own
+  if (algo == 0)
+    {
+      m_congestionOpsKind = CC_GENERIC;
+      return;
+    }
+  const std::type_info &type = typeid (*algo);
+  if (type == typeid (TcpNewReno))
+    {
+      m_congestionOpsKind = CC_NEW_RENO;
+    }
+  else if (type == typeid (TcpBic))
+    {
+      m_congestionOpsKind = CC_BIC;
+    }
+  else if (type == typeid (TcpHighSpeed))
+    {
+      m_congestionOpsKind = CC_HIGH_SPEED;
+    }
+  else
+    {
+      m_congestionOpsKind = CC_GENERIC;
+    }
 }
 
 void
-TcpSocketBase::UpdateBytesInFlight (uint32_t oldValue, uint32_t newValue)
+TcpSocketBase::CongestionPktsAcked (uint32_t segmentsAcked)
 {
-  m_bytesInFlightTrace (oldValue, newValue);
+  // none of the built-in algorithms uses the RTT samples
+  if (m_congestionOpsKind == CC_GENERIC)
+    {
+      m_congestionControl->PktsAcked (m_tcb, segmentsAcked, m_tcb->m_lastRtt);
+    }
 }
 
 void
-TcpSocketBase::UpdateRtt (Time oldValue, Time newValue)
+TcpSocketBase::CongestionIncreaseWindow (uint32_t segmentsAcked)
 {
-  m_lastRttTrace (oldValue, newValue);
+  switch (m_congestionOpsKind)
+    {
+    case CC_NEW_RENO:
+    case CC_HIGH_SPEED:
+      static_cast<TcpNewReno *> (PeekPointer (m_congestionControl))->TcpNewReno::IncreaseWindow (m_tcb, segmentsAcked);
+      break;
+    case CC_BIC:
+      static_cast<TcpBic *> (PeekPointer (m_congestionControl))->TcpBic::IncreaseWindow (m_tcb, segmentsAcked);
+      break;
+    default:
+      m_congestionControl->IncreaseWindow (m_tcb, segmentsAcked);
+      break;
+    }
 }
 
-void
-TcpSocketBase::SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo)
+uint32_t
+TcpSocketBase::CongestionGetSsThresh (uint32_t bytesInFlight)
 {
-  NS_LOG_FUNCTION (this << algo);
-  m_congestionControl = algo;
+  switch (m_congestionOpsKind)
+    {
+    case CC_NEW_RENO:
+      return static_cast<TcpNewReno *> (PeekPointer (m_congestionControl))->TcpNewReno::GetSsThresh (m_tcb, bytesInFlight);
+    case CC_BIC:
+      return static_cast<TcpBic *> (PeekPointer (m_congestionControl))->TcpBic::GetSsThresh (m_tcb, bytesInFlight);
+    case CC_HIGH_SPEED:
+      return static_cast<TcpHighSpeed *> (PeekPointer (m_congestionControl))->TcpHighSpeed::GetSsThresh (m_tcb, bytesInFlight);
+    default:
+      return m_congestionControl->GetSsThresh (m_tcb, bytesInFlight);
+    }
 }
 
 void
@@ -314,116 +314,6 @@ public:
    */
   uint32_t GetRetxThresh (void) const { return m_retxThresh; }
 
-  /**
-   * \brief Callback pointer for cWnd trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_cWndTrace;
-
-  /**
-   * \brief Callback pointer for cWndInfl trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_cWndInflTrace;
-
-  /**
-   * \brief Callback pointer for ssTh trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_ssThTrace;
-
-  /**
-   * \brief Callback pointer for congestion state trace chaining
-   */
-  TracedCallback<TcpSocketState::TcpCongState_t, TcpSocketState::TcpCongState_t> m_congStateTrace;
-
-   /**
-   * \brief Callback pointer for ECN state trace chaining
-   */
-  TracedCallback<TcpSocketState::EcnState_t, TcpSocketState::EcnState_t> m_ecnStateTrace;
-
-  /**
-   * \brief Callback pointer for high tx mark chaining
-   */
-  TracedCallback <SequenceNumber32, SequenceNumber32> m_highTxMarkTrace;
-
-  /**
-   * \brief Callback pointer for next tx sequence chaining
-   */
-  TracedCallback<SequenceNumber32, SequenceNumber32> m_nextTxSequenceTrace;
-
-  /**
-   * \brief Callback pointer for bytesInFlight trace chaining
-   */
-  TracedCallback<uint32_t, uint32_t> m_bytesInFlightTrace;
-
-  /**
-   * \brief Callback pointer for RTT trace chaining
-   */
-  TracedCallback<Time, Time> m_lastRttTrace;
-
-  /**
-   * \brief Callback function to hook to TcpSocketState congestion window
-   * \param oldValue old cWnd value
-   * \param newValue new cWnd value
-   */
-  void UpdateCwnd (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState inflated congestion window
-   * \param oldValue old cWndInfl value
-   * \param newValue new cWndInfl value
-   */
-  void UpdateCwndInfl (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState slow start threshold
-   * \param oldValue old ssTh value
-   * \param newValue new ssTh value
-   */
-  void UpdateSsThresh (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState congestion state
-   * \param oldValue old congestion state value
-   * \param newValue new congestion state value
-   */
-  void UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
-                        TcpSocketState::TcpCongState_t newValue);
-
-   /**
-   * \brief Callback function to hook to EcnState state
-   * \param oldValue old ecn state value
-   * \param newValue new ecn state value
-   */
-  void UpdateEcnState (TcpSocketState::EcnState_t oldValue,
-                        TcpSocketState::EcnState_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState high tx mark
-   * \param oldValue old high tx mark
-   * \param newValue new high tx mark
-   */
-  void UpdateHighTxMark (SequenceNumber32 oldValue, SequenceNumber32 newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState next tx sequence
-   * \param oldValue old nextTxSeq value
-   * \param newValue new nextTxSeq value
-   */
-  void UpdateNextTxSequence (SequenceNumber32 oldValue, SequenceNumber32 newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState bytes inflight
-   * \param oldValue old bytesInFlight value
-   * \param newValue new bytesInFlight value
-   */
-  void UpdateBytesInFlight (uint32_t oldValue, uint32_t newValue);
-
-  /**
-   * \brief Callback function to hook to TcpSocketState rtt
-   * \param oldValue old rtt value
-   * \param newValue new rtt value
-   */
-  void UpdateRtt (Time oldValue, Time newValue);
-
   /**
    * \brief Install a congestion control algorithm on this socket
    *
@@ -941,6 +831,34 @@ protected:
    */
   void UpdateWindowSize (const TcpHeader& header);
 
+  /**
+   * \brief Call PktsAcked of the congestion control
+   *
+   * The built-in algorithms are called without virtual dispatch.
+   *
+   * \param segmentsAcked count of segments acked
+   */
+  void CongestionPktsAcked (uint32_t segmentsAcked);
+
+  /**
+   * \brief Call IncreaseWindow of the congestion control
+   *
+   * The built-in algorithms are called without virtual dispatch.
+   *
+   * \param segmentsAcked count of segments acked
+   */
+  void CongestionIncreaseWindow (uint32_t segmentsAcked);
+
+  /**
+   * \brief Call GetSsThresh of the congestion control
+   *
+   * The built-in algorithms are called without virtual dispatch.
+   *
+   * \param bytesInFlight total bytes in flight
+   * \return the slow start threshold
+   */
+  uint32_t CongestionGetSsThresh (uint32_t bytesInFlight);
+
 
   // Manage data tx/rx
 
@@ -1241,6 +1159,7 @@ protected:
   uint32_t m_timestampToEcho  {0};    //!< Timestamp to echo
 
   EventId m_sendPendingDataEvent {}; //!< micro-delay event to send pending data
+  uint32_t m_tsoMaxSegments {1};    //!< Max segments handed at once to IPv4 (segmentation offload)
 
   // Fast Retransmit and Recovery
   SequenceNumber32       m_recover    {0};   //!< Previous highest Tx seqnum for fast recovery (set it to initial seq number)
@@ -1252,6 +1171,19 @@ protected:
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
   Ptr<TcpRecoveryOps>    m_recoveryOps;       //!< Recovery Algorithm
 
+  /**
+   * \brief Congestion control algorithms bound statically in the ACK path
+   */
+  typedef enum
+  {
+    CC_GENERIC,    //!< Any algorithm, called through the TcpCongestionOps interface
+    CC_NEW_RENO,   //!< TcpNewReno
+    CC_BIC,        //!< TcpBic
+    CC_HIGH_SPEED  //!< TcpHighSpeed
+  } CongestionOpsKind_t;
+
+  CongestionOpsKind_t    m_congestionOpsKind {CC_GENERIC}; //!< Kind of m_congestionControl
+
   // Guesses over the other connection end
   bool m_isFirstPartialAck {true}; //!< First partial ACK during RECOVERY
 
@@ -1270,6 +1202,12 @@ protected:
   TracedValue<SequenceNumber32> m_ecnEchoSeq {0};      //!< Sequence number of the last received ECN Echo
   TracedValue<SequenceNumber32> m_ecnCESeq   {0};      //!< Sequence number of the last received Congestion Experienced
   TracedValue<SequenceNumber32> m_ecnCWRSeq  {0};      //!< Sequence number of the last sent CWR
+
+private:
+  /**
+   * \brief Accessor of the trace sources of the TcpSocketState of the socket
+   */
+  class TcbTraceSourceAccessor;
 };
 
 /**
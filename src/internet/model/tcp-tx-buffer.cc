@@ -96,7 +96,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostFrontier (n)
 {
 }
 
@@ -169,6 +170,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostFrontier = seq;
 }
 
 bool
@@ -285,7 +287,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_LOG_INFO ("AppList start at " << startOfAppList << ", sentSize = " <<
                m_sentSize << " firstByte: " << m_firstByteSeq);
 
-  TcpTxItem *item = GetPacketFromList (m_appList, startOfAppList,
+  TcpTxItem *item = GetPacketFromList (m_appList, m_appList.begin (), startOfAppList,
                                        numBytes, startOfAppList);
   item->m_startSeq = startOfAppList;
 
@@ -294,7 +296,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  Index (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,45 +310,64 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  // The item containing seq, and the one before it, which is not
+  // touched by the fragmentations and merges done for this block
+  PacketList::iterator it = FindSentItem (seq);
+  NS_ASSERT (it != m_sentList.end ());
+  SequenceNumber32 itemSeq = (*it)->m_startSeq;
+  PacketList::iterator previous = it;
+  bool hasPrevious = (it != m_sentList.begin ());
+  if (hasPrevious)
+    {
+      --previous;
+    }
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if (itemSeq == seq)
     {
-      if ((*it)->m_startSeq == seq)
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
-  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, s, seq, &listEdited);
+  TcpTxItem *item = GetPacketFromList (m_sentList, it, itemSeq, s, seq, &listEdited);
+
+  if (listEdited)
+    {
+      // Index again the items which have been fragmented or merged
+      SequenceNumber32 last = item->m_startSeq + item->m_packet->GetSize ();
+      Unindex (itemSeq, last);
+      for (it = hasPrevious ? ++previous : m_sentList.begin ();
+           it != m_sentList.end () && (*it)->m_startSeq <= last; ++it)
+        {
+          Index (it);
+        }
+    }
 
   if (! item->m_retrans)
     {
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      Index (m_sentIndex.find (item->m_startSeq)->second);
     }
 
   return item;
@@ -396,7 +417,8 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 }
 
 TcpTxItem*
-TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
+TcpTxBuffer::GetPacketFromList (PacketList &list, PacketList::iterator startingItem,
+                                const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
                                 bool *listEdited) const
 {
@@ -432,7 +454,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   Ptr<Packet> currentPacket = nullptr;
   TcpTxItem *currentItem = nullptr;
   TcpTxItem *outItem = nullptr;
-  PacketList::iterator it = list.begin ();
+  PacketList::iterator it = startingItem;
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
   while (it != list.end ())
@@ -468,14 +490,14 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               TcpTxItem *firstPart = new TcpTxItem ();
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
-              // insert firstPart before currentItem
+              // insert firstPart before currentItem, which now starts at seq
               list.insert (it, firstPart);
               if (listEdited)
                 {
                   *listEdited = true;
                 }
 
-              return GetPacketFromList (list, listStartFrom, numBytes, seq, listEdited);
+              return GetPacketFromList (list, it, seq, numBytes, seq, listEdited);
             }
           else
             {
@@ -524,7 +546,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                       *listEdited = true;
                     }
 
-                  return GetPacketFromList (list, listStartFrom, numBytes, seq, listEdited);
+                  return GetPacketFromList (list, startingItem, listStartFrom, numBytes, seq, listEdited);
                 }
             }
           else if (numBytes < currentPacket->GetSize ())
@@ -548,6 +570,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
         {
           // The end isn't inside current packet, but there is an exception for
           // the merge and recurse strategy...
+          PacketList::iterator current = it;
           if (++it == list.end ())
             {
               // ...current is the last packet we sent. We have not more data;
@@ -573,7 +596,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               *listEdited = true;
             }
 
-          return GetPacketFromList (list, listStartFrom, numBytes, seq, listEdited);
+          return GetPacketFromList (list, current, seq, numBytes, seq, listEdited);
         }
     }
 
@@ -693,6 +716,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          Unindex (item->m_startSeq, item->m_startSeq);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -704,8 +728,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           pktSize -= offset;
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
+          Unindex (item->m_startSeq, item->m_startSeq);
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          Index (i);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -735,6 +761,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          Index (m_sentList.begin ());
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -749,6 +776,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
     {
       m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
+  if (m_lostFrontier < m_firstByteSeq)
+    {
+      m_lostFrontier = m_firstByteSeq;
+    }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
                 " retrans: " << m_retrans << " sacked: " << m_sackedOut);
@@ -768,59 +799,25 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
-      while (item_it != m_sentList.end ())
+      // Walk the items starting inside the block. Only mark them as sacked
+      // if they are precisely mapped over the option. It means that if the
+      // receiver is reporting as sacked single range bytes that are not
+      // mapped 1:1 in what we have, the option is discarded. There's room
+      // for improvement here.
+      for (SentIndex::iterator index_it = m_sentIndex.lower_bound ((*option_it).first);
+           index_it != m_sentIndex.end (); ++index_it)
         {
+          PacketList::iterator item_it = index_it->second;
+          SequenceNumber32 beginOfCurrentPacket = index_it->first;
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
 
-          // Check the boundary of this packet ... only mark as sacked if
-          // it is precisely mapped over the option. It means that if the receiver
-          // is reporting as sacked single range bytes that are not mapped 1:1
-          // in what we have, the option is discarded. There's room for improvement
-          // here.
-          if (beginOfCurrentPacket >= (*option_it).first
-              && beginOfCurrentPacket + pktSize <= (*option_it).second)
-            {
-              if ((*item_it)->m_sacked)
-                {
-                  NS_ASSERT (!(*item_it)->m_lost);
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard already sacked");
-                }
-              else
-                {
-                  if ((*item_it)->m_lost)
-                    {
-                      (*item_it)->m_lost = false;
-                      m_lostOut -= (*item_it)->m_packet->GetSize ();
-                    }
-
-                  (*item_it)->m_sacked = true;
-                  m_sackedOut += (*item_it)->m_packet->GetSize ();
-
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
-                    {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
-                    }
-
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
-                }
-              modified = true;
-            }
-          else if (beginOfCurrentPacket + pktSize > (*option_it).second)
+          if (beginOfCurrentPacket + pktSize > (*option_it).second)
             {
               // We already passed the received block end. Exit from the loop
               NS_LOG_INFO ("Received block [" << *option_it <<
@@ -829,8 +826,37 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
-          ++item_it;
+          if ((*item_it)->m_sacked)
+            {
+              NS_ASSERT (!(*item_it)->m_lost);
+              NS_LOG_INFO ("Received block " << *option_it <<
+                           ", checking sentList for block " << *(*item_it) <<
+                           ", found in the sackboard already sacked");
+            }
+          else
+            {
+              if ((*item_it)->m_lost)
+                {
+                  (*item_it)->m_lost = false;
+                  m_lostOut -= (*item_it)->m_packet->GetSize ();
+                }
+
+              (*item_it)->m_sacked = true;
+              m_sackedOut += (*item_it)->m_packet->GetSize ();
+              Index (item_it);
+
+              if (m_highestSack.first == m_sentList.end()
+                  || m_highestSack.second <= beginOfCurrentPacket + pktSize)
+                {
+                  m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+                }
+
+              NS_LOG_INFO ("Received block " << *option_it <<
+                           ", checking sentList for block " << *(*item_it) <<
+                           ", found in the sackboard, sacking, current highSack: " <<
+                           m_highestSack.second);
+            }
+          modified = true;
         }
     }
 
@@ -852,47 +878,36 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
-  uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
-    }
+  NS_LOG_INFO ("Status before the update: " << *this);
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // A segment is lost when at least dupThresh sacked segments are above
+  // it: these are the segments below the dupThresh-th highest sacked one.
+  uint32_t dupThresh = std::max (m_dupAckThresh, 1U);
+  if (m_sackedSeqs.size () < dupThresh)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          sacked++;
-        }
-
-      if (sacked >= m_dupAckThresh)
-        {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
-        }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      NS_LOG_INFO ("Not enough sacked segments to mark segments as lost");
+      return;
     }
+  SequenceSet::const_reverse_iterator limit = m_sackedSeqs.rbegin ();
+  std::advance (limit, dupThresh - 1);
 
-  if (sacked >= m_dupAckThresh)
+  // The segments below m_lostFrontier have been marked already
+  for (SentIndex::iterator it = m_sentIndex.lower_bound (m_lostFrontier);
+       it != m_sentIndex.end () && it->first < *limit; ++it)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      TcpTxItem *item = *it->second;
+      if (!item->m_sacked && !item->m_lost)
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          Index (it->second);
         }
     }
+  if (m_lostFrontier < *limit)
+    {
+      m_lostFrontier = *limit;
+    }
+
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
 }
@@ -902,38 +917,26 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first item at or after seq which is lost or sacked decides
+  SequenceSet::const_iterator lost = m_lostSeqs.lower_bound (seq);
+  if (lost == m_lostSeqs.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      return false;
+    }
+  SequenceSet::const_iterator sacked = m_sackedSeqs.lower_bound (seq);
+  if (sacked != m_sackedSeqs.end () && *sacked < *lost)
+    {
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+      return false;
     }
 
-  return false;
+  NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+  return true;
 }
 
 bool
@@ -954,35 +957,11 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (!m_lostNotRetransSeqs.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO("IsLost, returning" << *m_lostNotRetransSeqs.begin ());
+      *seq = *m_lostNotRetransSeqs.begin ();
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,11 +987,17 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery)
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
-      return true;
+      for (PacketList::const_iterator it = m_sentList.begin (); it != m_sentList.end (); ++it)
+        {
+          if ((*it)->m_retrans == false && (*it)->m_sacked == false)
+            {
+              NS_LOG_INFO ("Rule3 valid. " << (*it)->m_startSeq);
+              *seq = (*it)->m_startSeq;
+              return true;
+            }
+        }
     }
 
   /* (4) If the conditions for (1), (2), and (3) fail, but there exists
@@ -1184,8 +1169,10 @@ TcpTxBuffer::ResetRenoSack ()
     {
       (*it)->m_sacked = false;
     }
+  RebuildIndex ();
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostFrontier = m_firstByteSeq;
 }
 
 void
@@ -1208,6 +1195,8 @@ TcpTxBuffer::ResetSentList ()
   m_retrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  RebuildIndex ();
+  m_lostFrontier = m_firstByteSeq;
 }
 
 void
@@ -1218,6 +1207,11 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      Unindex (item->m_startSeq, item->m_startSeq);
+      if (item->m_startSeq < m_lostFrontier)
+        {
+          m_lostFrontier = item->m_startSeq;
+        }
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1270,6 +1264,8 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
       (*it)->m_retrans = false;
     }
+  RebuildIndex ();
+  m_lostFrontier = m_firstByteSeq + m_sentSize;
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
@@ -1303,6 +1299,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      Index (m_sentList.begin ());
     }
   ConsistencyCheck ();
 }
@@ -1332,6 +1329,7 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+      Index (m_sentList.begin ());
     }
   ConsistencyCheck ();
 }
@@ -1358,6 +1356,7 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
+      Index (it);
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
@@ -1406,6 +1405,86 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Index of " <<
+                 m_sentIndex.size () << " items for " << m_sentList.size () << " items sent");
+  for (auto it = m_sentIndex.begin (); it != m_sentIndex.end (); ++it)
+    {
+      const TcpTxItem *item = *it->second;
+      NS_ASSERT (item->m_startSeq == it->first);
+      NS_ASSERT (item->m_sacked == (m_sackedSeqs.count (it->first) == 1));
+      NS_ASSERT (item->m_lost == (m_lostSeqs.count (it->first) == 1));
+      NS_ASSERT ((item->m_lost && !item->m_retrans && !item->m_sacked)
+                 == (m_lostNotRetransSeqs.count (it->first) == 1));
+    }
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  SentIndex::const_iterator it = m_sentIndex.upper_bound (seq);
+  if (it == m_sentIndex.begin ())
+    {
+      return const_cast<PacketList &> (m_sentList).end ();
+    }
+  --it;
+  return it->second;
+}
+
+void
+TcpTxBuffer::Index (PacketList::iterator it)
+{
+  const TcpTxItem *item = *it;
+  const SequenceNumber32 &seq = item->m_startSeq;
+  m_sentIndex[seq] = it;
+
+  if (item->m_sacked)
+    {
+      m_sackedSeqs.insert (seq);
+    }
+  else
+    {
+      m_sackedSeqs.erase (seq);
+    }
+  if (item->m_lost)
+    {
+      m_lostSeqs.insert (seq);
+    }
+  else
+    {
+      m_lostSeqs.erase (seq);
+    }
+  if (item->m_lost && !item->m_retrans && !item->m_sacked)
+    {
+      m_lostNotRetransSeqs.insert (seq);
+    }
+  else
+    {
+      m_lostNotRetransSeqs.erase (seq);
+    }
+}
+
+void
+TcpTxBuffer::Unindex (const SequenceNumber32 &first, const SequenceNumber32 &last)
+{
+  m_sentIndex.erase (m_sentIndex.lower_bound (first), m_sentIndex.upper_bound (last));
+  m_sackedSeqs.erase (m_sackedSeqs.lower_bound (first), m_sackedSeqs.upper_bound (last));
+  m_lostSeqs.erase (m_lostSeqs.lower_bound (first), m_lostSeqs.upper_bound (last));
+  m_lostNotRetransSeqs.erase (m_lostNotRetransSeqs.lower_bound (first),
+                              m_lostNotRetransSeqs.upper_bound (last));
+}
+
+void
+TcpTxBuffer::RebuildIndex ()
+{
+  m_sentIndex.clear ();
+  m_sackedSeqs.clear ();
+  m_lostSeqs.clear ();
+  m_lostNotRetransSeqs.clear ();
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      Index (it);
+    }
 }
 
 std::ostream &
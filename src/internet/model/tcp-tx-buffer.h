@@ -22,6 +22,10 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <list>
+#include <map>
+#include <set>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -102,8 +106,16 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of setting the
+ * SACK flag on the corresponding segments sent.
+ *
+ * To avoid walking the list, which holds tens of thousands of segments on
+ * paths with a large bandwidth-delay product, the sent segments are also
+ * indexed by the sequence number of their first byte, in a balanced search
+ * tree. The sequence numbers of the sacked segments, of the lost segments,
+ * and of the lost segments which were not retransmitted yet are kept in
+ * ordered sets as well. Finding the segments covered by a SACK block, and
+ * answering IsLost and NextSeg, then takes a logarithmic time.
  *
  * Item properties
  * ---------------
@@ -410,6 +422,35 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< sent items, by sequence number of their first byte
+  typedef std::set<SequenceNumber32> SequenceSet; //!< ordered set of sequence numbers
+
+  /**
+   * \brief Find the sent item which contains a sequence number
+   * \param seq the sequence number
+   * \return the item, or the end of the sent list if there is none
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Add a sent item to the scoreboard index, or update it after
+   * a change of the flags of the item
+   * \param it the item in the sent list
+   */
+  void Index (PacketList::iterator it);
+
+  /**
+   * \brief Remove from the scoreboard index the items starting in [first, last]
+   * \param first the first sequence number
+   * \param last the last sequence number
+   */
+  void Unindex (const SequenceNumber32 &first, const SequenceNumber32 &last);
+
+  /**
+   * \brief Index again the whole sent list, after a change of the flags
+   * of all the items
+   */
+  void RebuildIndex ();
 
   /**
    * \brief Update the lost count
@@ -426,9 +467,9 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
-   *
+   * and updates the lost count. The segments below the dupThresh-th highest
+   * sacked segment are lost; since the ones below m_lostFrontier have been
+   * marked already, only the segments between the two are visited.
    */
   void UpdateLostCount ();
 
@@ -552,13 +593,15 @@ private:
    * each segment).
    *
    * \param list List to extract block from
-   * \param startingSeq Starting sequence of the list
+   * \param startingItem Item from which the list is searched
+   * \param startingSeq Starting sequence of startingItem
    * \param numBytes Bytes to extract, starting from requestedSeq
    * \param requestedSeq Requested sequence
    * \param listEdited output parameter which indicates if the list has been edited
    * \return the item that contains the right packet
    */
-  TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
+  TcpTxItem* GetPacketFromList (PacketList &list, PacketList::iterator startingItem,
+                                const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
                                 bool *listEdited = nullptr) const;
 
@@ -608,6 +651,12 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  SentIndex m_sentIndex;             //!< Index of the sent list
+  SequenceSet m_sackedSeqs;          //!< First sequence number of the sacked items
+  SequenceSet m_lostSeqs;            //!< First sequence number of the lost items
+  SequenceSet m_lostNotRetransSeqs;  //!< First sequence number of the lost items not retransmitted (nor sacked)
+  SequenceNumber32 m_lostFrontier;   //!< The items below it which are not sacked are marked lost
+
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
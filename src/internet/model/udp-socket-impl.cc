@@ -32,6 +32,7 @@
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/boolean.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/ipv6-packet-info-tag.h"
 #include "udp-socket-impl.h"
@@ -71,6 +72,13 @@ UdpSocketImpl::GetTypeId (void)
                    CallbackValue (),
                    MakeCallbackAccessor (&UdpSocketImpl::m_icmpCallback6),
                    MakeCallbackChecker ())
+    .AddAttribute ("RecvPacketTags",
+                   "If false, the receive metadata enabled by the socket options "
+                   "(packet info, TOS/Traffic Class, TTL/Hop Limit) is not attached "
+                   "to the received packets as tags, and can only be read with RecvFromBatch.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&UdpSocketImpl::m_recvPacketTags),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -854,8 +862,8 @@ UdpSocketImpl::RecvFrom (uint32_t maxSize, uint32_t flags,
       m_errno = ERROR_AGAIN;
       return 0;
     }
-  Ptr<Packet> p = m_deliveryQueue.front ().first;
-  fromAddress = m_deliveryQueue.front ().second;
+  Ptr<Packet> p = m_deliveryQueue.front ().packet;
+  fromAddress = m_deliveryQueue.front ().from;
 
   if (p->GetSize () <= maxSize)
     {
@@ -869,6 +877,27 @@ UdpSocketImpl::RecvFrom (uint32_t maxSize, uint32_t flags,
   return p;
 }
 
+uint32_t
+UdpSocketImpl::RecvFromBatch (std::vector<RecvDatagram> &datagrams)
+{
+  NS_LOG_FUNCTION (this << datagrams.size ());
+
+  if (m_deliveryQueue.empty ())
+    {
+      m_errno = ERROR_AGAIN;
+      return 0;
+    }
+  uint32_t n = 0;
+  while (n < datagrams.size () && !m_deliveryQueue.empty ())
+    {
+      datagrams[n] = m_deliveryQueue.front ();
+      m_deliveryQueue.pop ();
+      m_rxAvailable -= datagrams[n].packet->GetSize ();
+      n++;
+    }
+  return n;
+}
+
 int
 UdpSocketImpl::GetSockName (Address &address) const
 {
@@ -1011,28 +1040,36 @@ UdpSocketImpl::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
       return;
     }
 
-  // Should check via getsockopt ()..
-  if (IsRecvPktInfo ())
-    {
-      Ipv4PacketInfoTag tag;
-      packet->RemovePacketTag (tag);
-      tag.SetRecvIf (incomingInterface->GetDevice ()->GetIfIndex ());
-      packet->AddPacketTag (tag);
-    }
+  RecvDatagram datagram;
+  datagram.recvIf = incomingInterface->GetDevice ()->GetIfIndex ();
+  datagram.tos = header.GetTos ();
+  datagram.ttl = header.GetTtl ();
 
-  //Check only version 4 options
-  if (IsIpRecvTos ())
+  if (m_recvPacketTags)
     {
-      SocketIpTosTag ipTosTag;
-      ipTosTag.SetTos (header.GetTos ());
-      packet->AddPacketTag (ipTosTag);
-    }
+      // Should check via getsockopt ()..
+      if (IsRecvPktInfo ())
+        {
+          Ipv4PacketInfoTag tag;
+          packet->RemovePacketTag (tag);
+          tag.SetRecvIf (datagram.recvIf);
+          packet->AddPacketTag (tag);
+        }
 
-  if (IsIpRecvTtl ())
-    {
-      SocketIpTtlTag ipTtlTag;
-      ipTtlTag.SetTtl (header.GetTtl ());
-      packet->AddPacketTag (ipTtlTag);
+      //Check only version 4 options
+      if (IsIpRecvTos ())
+        {
+          SocketIpTosTag ipTosTag;
+          ipTosTag.SetTos (datagram.tos);
+          packet->AddPacketTag (ipTosTag);
+        }
+
+      if (IsIpRecvTtl ())
+        {
+          SocketIpTtlTag ipTtlTag;
+          ipTtlTag.SetTtl (datagram.ttl);
+          packet->AddPacketTag (ipTtlTag);
+        }
     }
 
   // in case the packet still has a priority tag attached, remove it
@@ -1041,8 +1078,9 @@ UdpSocketImpl::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
 
   if ((m_rxAvailable + packet->GetSize ()) <= m_rcvBufSize)
     {
-      Address address = InetSocketAddress (header.GetSource (), port);
-      m_deliveryQueue.push (std::make_pair (packet, address));
+      datagram.packet = packet;
+      datagram.from = InetSocketAddress (header.GetSource (), port);
+      m_deliveryQueue.push (datagram);
       m_rxAvailable += packet->GetSize ();
       NotifyDataRecv ();
     }
@@ -1068,28 +1106,36 @@ UdpSocketImpl::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
       return;
     }
 
-  // Should check via getsockopt ().
-  if (IsRecvPktInfo ())
-    {
-      Ipv6PacketInfoTag tag;
-      packet->RemovePacketTag (tag);
-      tag.SetRecvIf (incomingInterface->GetDevice ()->GetIfIndex ());
-      packet->AddPacketTag (tag);
-    }
+  RecvDatagram datagram;
+  datagram.recvIf = incomingInterface->GetDevice ()->GetIfIndex ();
+  datagram.tos = header.GetTrafficClass ();
+  datagram.ttl = header.GetHopLimit ();
 
-  // Check only version 6 options
-  if (IsIpv6RecvTclass ())
+  if (m_recvPacketTags)
     {
-      SocketIpv6TclassTag ipTclassTag;
-      ipTclassTag.SetTclass (header.GetTrafficClass ());
-      packet->AddPacketTag (ipTclassTag);
-    }
+      // Should check via getsockopt ().
+      if (IsRecvPktInfo ())
+        {
+          Ipv6PacketInfoTag tag;
+          packet->RemovePacketTag (tag);
+          tag.SetRecvIf (datagram.recvIf);
+          packet->AddPacketTag (tag);
+        }
 
-  if (IsIpv6RecvHopLimit ())
-    {
-      SocketIpv6HopLimitTag ipHopLimitTag;
-      ipHopLimitTag.SetHopLimit (header.GetHopLimit ());
-      packet->AddPacketTag (ipHopLimitTag);
+      // Check only version 6 options
+      if (IsIpv6RecvTclass ())
+        {
+          SocketIpv6TclassTag ipTclassTag;
+          ipTclassTag.SetTclass (datagram.tos);
+          packet->AddPacketTag (ipTclassTag);
+        }
+
+      if (IsIpv6RecvHopLimit ())
+        {
+          SocketIpv6HopLimitTag ipHopLimitTag;
+          ipHopLimitTag.SetHopLimit (datagram.ttl);
+          packet->AddPacketTag (ipHopLimitTag);
+        }
     }
 
   // in case the packet still has a priority tag attached, remove it
@@ -1098,8 +1144,9 @@ UdpSocketImpl::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
 
   if ((m_rxAvailable + packet->GetSize ()) <= m_rcvBufSize)
     {
-      Address address = Inet6SocketAddress (header.GetSourceAddress (), port);
-      m_deliveryQueue.push (std::make_pair (packet, address));
+      datagram.packet = packet;
+      datagram.from = Inet6SocketAddress (header.GetSourceAddress (), port);
+      m_deliveryQueue.push (datagram);
       m_rxAvailable += packet->GetSize ();
       NotifyDataRecv ();
     }
@@ -109,6 +109,7 @@ public:
   virtual Ptr<Packet> Recv (uint32_t maxSize, uint32_t flags);
   virtual Ptr<Packet> RecvFrom (uint32_t maxSize, uint32_t flags,
                                 Address &fromAddress);
+  virtual uint32_t RecvFromBatch (std::vector<RecvDatagram> &datagrams);
   virtual int GetSockName (Address &address) const; 
   virtual int GetPeerName (Address &address) const;
   virtual int MulticastJoinGroup (uint32_t interfaceIndex, const Address &groupAddress);
@@ -250,7 +251,7 @@ private:
   bool                     m_connected;       //!< Connection established
   bool                     m_allowBroadcast;  //!< Allow send broadcast packets
 
-  std::queue<std::pair<Ptr<Packet>, Address> > m_deliveryQueue; //!< Queue for incoming packets
+  std::queue<RecvDatagram> m_deliveryQueue; //!< Queue for incoming packets, with their metadata
   uint32_t m_rxAvailable;                   //!< Number of available bytes to be received
 
   // Socket attributes
@@ -259,6 +260,7 @@ private:
   int32_t m_ipMulticastIf;  //!< Multicast Interface
   bool m_ipMulticastLoop;   //!< Allow multicast loop
   bool m_mtuDiscover;       //!< Allow MTU discovery
+  bool m_recvPacketTags;    //!< Attach the receive metadata to the packets as tags
 };
 
 } // namespace ns3
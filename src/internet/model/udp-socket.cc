@@ -87,4 +87,12 @@ UdpSocket::~UdpSocket ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+uint32_t
+UdpSocket::RecvFromBatch (std::vector<RecvDatagram> &datagrams)
+{
+  NS_LOG_FUNCTION (this << datagrams.size ());
+  NS_LOG_WARN ("RecvFromBatch is not supported by this socket");
+  return 0;
+}
+
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/callback.h"
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -103,6 +104,37 @@ public:
    */
   virtual int MulticastLeaveGroup (uint32_t interface, const Address &groupAddress) = 0;
 
+  /**
+   * \brief A datagram returned by RecvFromBatch, with its receive metadata
+   */
+  struct RecvDatagram
+  {
+    Ptr<Packet> packet; //!< the datagram
+    Address from;       //!< the address of the sender
+    uint32_t recvIf;    //!< the index of the NetDevice the datagram was received on
+    uint8_t tos;        //!< the IPv4 TOS or IPv6 Traffic Class of the datagram
+    uint8_t ttl;        //!< the IPv4 TTL or IPv6 Hop Limit of the datagram
+  };
+
+  /**
+   * \brief Read several datagrams at once, along with their metadata
+   *
+   * \param datagrams the preallocated datagrams to fill
+   * \returns the number of datagrams read, at most datagrams.size ().
+   *          Zero is returned, and errno is set to ERROR_AGAIN, if no
+   *          datagram is available.
+   *
+   * The datagrams are returned whole, in their order of arrival. The
+   * metadata is always filled, whatever the socket options; with the
+   * RecvPacketTags attribute set to false, this is the only way to
+   * read it, since no tag is attached to the received packets.
+   *
+   * The default implementation, for the sockets which do not support
+   * batch reads, reads no datagram and returns zero.  The error code
+   * being kept by the subclasses, it cannot set ERROR_OPNOTSUPP itself.
+   */
+  virtual uint32_t RecvFromBatch (std::vector<RecvDatagram> &datagrams);
+
 private:
   // Indirect the attribute setting and getting through private virtual methods
   /**
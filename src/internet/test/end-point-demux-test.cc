@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-interface.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux lookup tables test.
+ *
+ * Checks that the lookups find the connected endpoints by four-tuple and
+ * the listening endpoints by local port, also after the endpoints have
+ * been connected, disconnected or removed.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Lookup a single endpoint.
+   * \param demux the demux
+   * \param daddr the destination address
+   * \param dport the destination port
+   * \param saddr the source address
+   * \param sport the source port
+   * \return the endpoint found, or 0 if none
+   */
+  Ipv4EndPoint * LookupOne (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                            Ipv4Address saddr, uint16_t sport);
+
+  Ptr<Ipv4Interface> m_interface; //!< The incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup tables")
+{
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::LookupOne (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                                      Ipv4Address saddr, uint16_t sport)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  Ipv4EndPointDemux demux;
+  Ipv4Address local ("10.0.0.1");
+
+  Ipv4EndPoint *listener = demux.Allocate (0, Ipv4Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Listening endpoint not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, Ipv4Address::GetAny (), 80), 0, "Duplicated endpoint allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), true, "Port 80 not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (81), false, "Port 81 in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (0, Ipv4Address::GetAny (), 80), true, "Binding not found");
+
+  Ipv4EndPoint *connected = demux.Allocate (0, local, 80, Ipv4Address ("10.0.0.2"), 5000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "Connected endpoint not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, Ipv4Address ("10.0.0.2"), 5000), 0, "Duplicated endpoint allocated");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address ("10.0.0.2"), 5000), connected, "Connected endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address ("10.0.0.3"), 5000), listener, "Listening endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 81, Ipv4Address ("10.0.0.2"), 5000), 0, "Unexpected endpoint found");
+
+  // an endpoint connected after its allocation
+  Ipv4EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Ephemeral endpoint not allocated");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ ((port >= 49152), true, "Not an ephemeral port");
+  client->SetPeer (Ipv4Address ("10.0.0.9"), 7);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv4Address ("10.0.0.9"), 7), client, "Connected endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv4Address ("10.0.0.8"), 7), 0, "Unexpected endpoint found");
+  client->SetPeer (Ipv4Address::GetAny (), 0);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv4Address ("10.0.0.8"), 7), client, "Disconnected endpoint not found");
+
+  Ipv4EndPoint *other = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (other, 0, "Ephemeral endpoint not allocated");
+  NS_TEST_EXPECT_MSG_NE (other->GetLocalPort (), port, "Ephemeral port allocated twice");
+
+  // a disabled endpoint does not match
+  listener->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address ("10.0.0.3"), 5000), 0, "Disabled endpoint found");
+  listener->SetRxEnabled (true);
+
+  demux.DeAllocate (connected);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address ("10.0.0.2"), 5000), listener, "Listening endpoint not found");
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 still in use");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv4Address ("10.0.0.2"), 5000), 0, "Removed endpoint found");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 2, "Wrong number of endpoints");
+
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux lookup tables test.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Lookup a single end point.
+   * \param demux the demux
+   * \param daddr the destination address
+   * \param dport the destination port
+   * \param saddr the source address
+   * \param sport the source port
+   * \return the end point found, or 0 if none
+   */
+  Ipv6EndPoint * LookupOne (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                            Ipv6Address saddr, uint16_t sport);
+
+  Ptr<Ipv6Interface> m_interface; //!< The incoming interface
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookup tables")
+{
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::LookupOne (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                                      Ipv6Address saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv6Interface> ();
+  Ipv6EndPointDemux demux;
+  Ipv6Address local ("2001:db8::1");
+
+  Ipv6EndPoint *listener = demux.Allocate (0, Ipv6Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Listening end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, Ipv6Address::GetAny (), 80), 0, "Duplicated end point allocated");
+
+  Ipv6EndPoint *connected = demux.Allocate (0, local, 80, Ipv6Address ("2001:db8::2"), 5000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "Connected end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv6Address ("2001:db8::2"), 5000), connected, "Connected end point not found");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv6Address ("2001:db8::3"), 5000), listener, "Listening end point not found");
+
+  Ipv6EndPoint *client = demux.Allocate (local);
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Ephemeral end point not allocated");
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (Ipv6Address ("2001:db8::9"), 7);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port, Ipv6Address ("2001:db8::9"), 7), client, "Connected end point not found");
+  client->SetLocalPort (port + 1);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Old port still in use");
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, port + 1, Ipv6Address ("2001:db8::9"), 7), client, "Moved end point not found");
+
+  demux.DeAllocate (connected);
+  NS_TEST_EXPECT_MSG_EQ (LookupOne (demux, local, 80, Ipv6Address ("2001:db8::2"), 5000), listener, "Listening end point not found");
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 1, "Wrong number of end points");
+
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -9,6 +9,7 @@
 # See test.py for more information.
 cpp_examples = [
     ("main-simple", "True", "True"),
+    ("routing-lookup-benchmark --nRoutes=100 --nLookups=1000", "True", "True"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
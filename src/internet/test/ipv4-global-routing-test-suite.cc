@@ -15,8 +15,10 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-value.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -1244,6 +1246,237 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting parallel and incremental SPF test
+ *
+ * Routes are computed on a ring of routers, first serially, then with
+ * several threads and incrementally after a change of a link metric, and
+ * must be the same as the ones computed from scratch.
+ */
+class Ipv4GlobalRoutingIncrementalSpfTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalSpfTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Dump the global routes of all the nodes.
+   * \returns the routes, as a string
+   */
+  std::string DumpRoutes (void) const;
+  /**
+   * \brief Recompute the routes.
+   * \param threads the number of SPF threads
+   * \param incremental whether the SPF calculations are incremental
+   * \returns the routes, as a string
+   */
+  std::string Recompute (uint32_t threads, bool incremental);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingIncrementalSpfTestCase::Ipv4GlobalRoutingIncrementalSpfTestCase ()
+  : TestCase ("Global routing with parallel and incremental SPF calculations")
+{
+}
+
+std::string
+Ipv4GlobalRoutingIncrementalSpfTestCase::DumpRoutes (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << i << ": " << *routing->GetRoute (j) << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+std::string
+Ipv4GlobalRoutingIncrementalSpfTestCase::Recompute (uint32_t threads, bool incremental)
+{
+  GlobalValue::Bind ("GlobalRoutingSpfThreads", UintegerValue (threads));
+  GlobalValue::Bind ("GlobalRoutingIncrementalSpf", BooleanValue (incremental));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  return DumpRoutes ();
+}
+
+void
+Ipv4GlobalRoutingIncrementalSpfTestCase::DoRun (void)
+{
+  const uint32_t nNodes = 6;
+  m_nodes.Create (nNodes);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      NetDeviceContainer net = simpleHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get ((i + 1) % nNodes)));
+      ipv4.Assign (net);
+      ipv4.NewNetwork ();
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string serial = DumpRoutes ();
+  NS_TEST_ASSERT_MSG_EQ (Recompute (4, true), serial, "Parallel SPF calculations give different routes");
+
+  // Make the link between n0 and n1 expensive, in one direction, then
+  // restore it: the results must match a full recomputation.
+  Ptr<Ipv4> ipv4n0 = m_nodes.Get (0)->GetObject<Ipv4> ();
+  ipv4n0->SetMetric (1, 10);
+  std::string incremental = Recompute (4, true);
+  std::string full = Recompute (1, false);
+  NS_TEST_ASSERT_MSG_EQ (incremental, full, "Incremental SPF calculations give different routes");
+  NS_TEST_ASSERT_MSG_NE (incremental, serial, "The metric change should have changed the routes");
+
+  Recompute (1, true);
+  ipv4n0->SetMetric (1, 1);
+  NS_TEST_ASSERT_MSG_EQ (Recompute (2, true), serial, "Incremental SPF calculations give different routes");
+
+  GlobalValue::Bind ("GlobalRoutingSpfThreads", UintegerValue (1));
+  GlobalValue::Bind ("GlobalRoutingIncrementalSpf", BooleanValue (false));
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting route lookup Test
+ *
+ * Checks the route selected among overlapping routes: a host route first,
+ * then the first matching network route in table order (not the longest
+ * one), then the first matching AS external route, including with an
+ * output interface, after a route removal and with a non-contiguous mask.
+ */
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up a route.
+   * \param dest The destination.
+   * \param oif The output device, if any.
+   * \return The gateway of the selected route, or 255.255.255.255 if there is none.
+   */
+  Ipv4Address Lookup (const char *dest, Ptr<NetDevice> oif = 0);
+  /**
+   * \brief Remove the first route to a destination.
+   * \param dest The destination network of the route.
+   * \param mask The destination network mask of the route.
+   */
+  void Remove (const char *dest, const char *mask);
+
+  Ptr<Ipv4GlobalRouting> m_routing; //!< The routing protocol under test.
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase ()
+  : TestCase ("Global routing route lookup")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingLookupTestCase::Lookup (const char *dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest));
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (Create<Packet> (), header, oif, err);
+  return route ? route->GetGateway () : Ipv4Address::GetBroadcast ();
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::Remove (const char *dest, const char *mask)
+{
+  for (uint32_t i = 0; i < m_routing->GetNRoutes (); i++)
+    {
+      if (m_routing->GetRoute (i)->GetDestNetwork () == Ipv4Address (dest)
+          && m_routing->GetRoute (i)->GetDestNetworkMask () == Ipv4Mask (mask))
+        {
+          m_routing->RemoveRoute (i);
+          return;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (true, false, "No route to " << dest << mask << " to remove");
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+  std::vector<Ptr<SimpleNetDevice> > devices;
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      devices.push_back (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+      std::ostringstream address;
+      address << "192.168." << i << ".1";
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (address.str ().c_str ()), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+    }
+
+  m_routing = CreateObject<Ipv4GlobalRouting> ();
+  m_routing->SetIpv4 (ipv4);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("192.168.1.2"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.2.2"), 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.2.0"), Ipv4Mask ("/24"), Ipv4Address ("192.168.3.2"), 3);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.1.1"), Ipv4Address ("192.168.2.3"), 2);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.1.1"), Ipv4Address ("192.168.3.3"), 3);
+  m_routing->AddASExternalRouteTo (Ipv4Address ("172.16.0.0"), Ipv4Mask ("/12"), Ipv4Address ("192.168.2.4"), 2);
+  m_routing->AddASExternalRouteTo (Ipv4Address ("172.16.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.3.4"), 3);
+  m_routing->AddASExternalRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0"), Ipv4Address ("192.168.1.4"), 1);
+
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.1.1"), Ipv4Address ("192.168.2.3"), "The first host route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.1.1", devices[2]), Ipv4Address ("192.168.3.3"), "The host route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.1.1", devices[0]), Ipv4Address ("192.168.1.2"), "The network route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.1.2"), "The first matching network route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3", devices[2]), Ipv4Address ("192.168.3.2"), "The network route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("172.16.5.5"), Ipv4Address ("192.168.2.4"), "The first matching external route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("172.16.5.5", devices[2]), Ipv4Address ("192.168.3.4"), "The external route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("11.0.0.1"), Ipv4Address ("192.168.1.4"), "The default external route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("11.0.0.1", devices[1]), Ipv4Address::GetBroadcast (), "No route should be found on the requested interface");
+
+  Remove ("10.0.0.0", "/8");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.2.2"), "The /16 route should be selected after the removal");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1"), Ipv4Address ("192.168.1.4"), "The default external route should be selected after the removal");
+  Remove ("10.1.1.1", "/32");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.1.1"), Ipv4Address ("192.168.3.3"), "The remaining host route should be selected");
+
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.255.0"), Ipv4Address ("192.168.1.9"), 1);
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1"), Ipv4Address ("192.168.1.9"), "The route with a non-contiguous mask should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.2.2"), "The first matching network route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("172.16.5.5"), Ipv4Address ("192.168.2.4"), "The first matching external route should be selected");
+
+  m_routing->Dispose ();
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1500,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingIncrementalSpfTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
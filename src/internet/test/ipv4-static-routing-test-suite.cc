@@ -35,6 +35,9 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-route.h"
 
 using namespace ns3;
 
@@ -201,6 +204,109 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting longest prefix match Test
+ *
+ * Checks the route selected among overlapping routes (longest prefix,
+ * lowest metric, output interface), including after a route removal and
+ * with a non-contiguous mask.
+ */
+class Ipv4StaticRoutingLongestPrefixMatchTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLongestPrefixMatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up a route.
+   * \param dest The destination.
+   * \param oif The output device, if any.
+   * \return The gateway of the selected route, or 255.255.255.255 if there is none.
+   */
+  Ipv4Address Lookup (const char *dest, Ptr<NetDevice> oif = 0);
+
+  Ptr<Ipv4StaticRouting> m_routing; //!< The routing protocol under test.
+};
+
+Ipv4StaticRoutingLongestPrefixMatchTestCase::Ipv4StaticRoutingLongestPrefixMatchTestCase ()
+  : TestCase ("Static routing longest prefix match")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLongestPrefixMatchTestCase::Lookup (const char *dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest));
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (Create<Packet> (), header, oif, err);
+  return route ? route->GetGateway () : Ipv4Address::GetBroadcast ();
+}
+
+void
+Ipv4StaticRoutingLongestPrefixMatchTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+  std::vector<Ptr<SimpleNetDevice> > devices;
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      devices.push_back (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+      std::ostringstream address;
+      address << "192.168." << i << ".1";
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (address.str ().c_str ()), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+    }
+
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  m_routing = ipv4RoutingHelper.GetStaticRouting (ipv4);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("192.168.1.2"), 1);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.2.2"), 2, 5);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.3.2"), 3, 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.1.3"), 1, 2);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.1.1"), Ipv4Address ("192.168.2.2"), 2);
+  m_routing->AddHostRouteTo (Ipv4Address ("10.1.1.1"), Ipv4Address ("192.168.3.2"), 3);
+  m_routing->SetDefaultRoute (Ipv4Address ("192.168.3.2"), 3);
+
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.1.1"), Ipv4Address ("192.168.2.2"), "The first host route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.1.3"), "The last route with the lowest metric should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1"), Ipv4Address ("192.168.1.2"), "The /8 route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("11.0.0.1"), Ipv4Address ("192.168.3.2"), "The default route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("192.168.2.7"), Ipv4Address ("0.0.0.0"), "The interface route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.1.1", devices[2]), Ipv4Address ("192.168.3.2"), "The route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3", devices[1]), Ipv4Address ("192.168.2.2"), "The route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1", devices[1]), Ipv4Address::GetBroadcast (), "No route should be found on the requested interface");
+
+  for (uint32_t i = 0; i < m_routing->GetNRoutes (); i++)
+    {
+      if (m_routing->GetRoute (i).GetDestNetwork () == Ipv4Address ("10.0.0.0")
+          && m_routing->GetRoute (i).GetDestNetworkMask () == Ipv4Mask ("/8"))
+        {
+          m_routing->RemoveRoute (i);
+          break;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1"), Ipv4Address ("192.168.3.2"), "The default route should be selected after the removal");
+
+  m_routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.255.0"), Ipv4Address ("192.168.2.9"), 2);
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.2.0.1"), Ipv4Address ("192.168.2.9"), "The route with a non-contiguous mask should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("10.1.2.3"), Ipv4Address ("192.168.1.3"), "The last route with the lowest metric should be selected");
+
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +323,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLongestPrefixMatchTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
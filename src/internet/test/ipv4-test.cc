@@ -28,7 +28,13 @@
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/loopback-net-device.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/tcp-header.h"
+#include "ns3/segmentation-offload.h"
+#include <map>
 
 using namespace ns3;
 
@@ -134,6 +140,133 @@ Ipv4L3ProtocolTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Identification Test
+ *
+ * Packets are sent to many destinations, with two protocols, in turn, so
+ * that the identification counters of the {src, dst, proto} tuples are
+ * evicted from the cache of the counters.  Each tuple must still use
+ * consecutive identifications, and a packet carrying several segments (see
+ * SegmentationOffload) must use one identification per segment.
+ */
+class Ipv4L3ProtocolIdentificationTestCase : public TestCase
+{
+public:
+  Ipv4L3ProtocolIdentificationTestCase ();
+  virtual ~Ipv4L3ProtocolIdentificationTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Send a packet
+   * \param destination the destination
+   * \param protocol the protocol
+   * \param segments the number of segments carried by the packet
+   */
+  void Send (Ipv4Address destination, uint8_t protocol, uint32_t segments);
+  /**
+   * Check the identification of a packet sent by the IPv4 layer
+   * \param header the IPv4 header
+   * \param p the packet
+   * \param interface the output interface
+   */
+  void SendOutgoing (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+
+  Ptr<Ipv4L3Protocol> m_ipv4;      //!< The IPv4 layer
+  Ptr<Ipv4Route> m_route;          //!< The route of the packets
+  /// Next identification expected for each {dst, proto} tuple
+  std::map<std::pair<uint32_t, uint8_t>, uint16_t> m_nextIdentification;
+  uint32_t m_segments;             //!< Number of segments carried by the packet being sent
+  uint32_t m_sent;                 //!< Number of packets checked
+};
+
+Ipv4L3ProtocolIdentificationTestCase::Ipv4L3ProtocolIdentificationTestCase ()
+  : TestCase ("Verify the IPv4 identification of interleaved flows"),
+    m_segments (1),
+    m_sent (0)
+{
+}
+
+Ipv4L3ProtocolIdentificationTestCase::~Ipv4L3ProtocolIdentificationTestCase ()
+{
+}
+
+void
+Ipv4L3ProtocolIdentificationTestCase::Send (Ipv4Address destination, uint8_t protocol, uint32_t segments)
+{
+  Ptr<Packet> p = Create<Packet> (500 * segments);
+  if (segments > 1)
+    {
+      // the segments are split by the IPv4 layer, as the device does not
+      // support the offload
+      TcpHeader tcpHeader;
+      p->AddHeader (tcpHeader);
+      p->AddPacketTag (SegmentationOffloadTag (500, segments));
+    }
+  m_segments = segments;
+  m_route->SetDestination (destination);
+  m_ipv4->Send (p, m_route->GetSource (), destination, protocol, m_route);
+}
+
+void
+Ipv4L3ProtocolIdentificationTestCase::SendOutgoing (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  std::pair<uint32_t, uint8_t> key = std::make_pair (header.GetDestination ().Get (), header.GetProtocol ());
+  uint16_t &next = m_nextIdentification[key];
+  NS_TEST_EXPECT_MSG_EQ (header.GetIdentification (), next,
+                         "Wrong identification for " << header.GetDestination () << " protocol " << (uint16_t) header.GetProtocol ());
+  next = header.GetIdentification () + m_segments;
+  m_sent++;
+}
+
+void
+Ipv4L3ProtocolIdentificationTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (node);
+  m_ipv4 = node->GetObject<Ipv4L3Protocol> ();
+
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  node->AddDevice (device);
+  int32_t ifIndex = m_ipv4->AddInterface (device);
+  m_ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.0.0.0")));
+  m_ipv4->SetUp (ifIndex);
+  m_ipv4->TraceConnectWithoutContext ("SendOutgoing",
+                                      MakeCallback (&Ipv4L3ProtocolIdentificationTestCase::SendOutgoing, this));
+
+  m_route = Create<Ipv4Route> ();
+  m_route->SetSource (Ipv4Address ("10.0.0.1"));
+  m_route->SetGateway (Ipv4Address ("10.0.0.2"));
+  m_route->SetOutputDevice (device);
+
+  // more tuples than the entries of the cache of the counters
+  const uint32_t nDestinations = 100;
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint32_t i = 0; i < nDestinations; i++)
+        {
+          Ipv4Address destination (Ipv4Address ("10.0.1.0").Get () + i + 1);
+          Send (destination, 17, 1);
+          Send (destination, 6, (round == 1 && i % 10 == 0) ? 3 : 1);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_sent, 3 * 2 * nDestinations, "Not all the packets have been sent");
+  NS_TEST_EXPECT_MSG_EQ (m_nextIdentification.size (), 2 * nDestinations, "Wrong number of tuples");
+  Ipv4Address offloaded (Ipv4Address ("10.0.1.0").Get () + 1);
+  NS_TEST_EXPECT_MSG_EQ (m_nextIdentification[std::make_pair (offloaded.Get (), uint8_t (6))], 5,
+                         "The offloaded segments should use one identification each");
+
+  m_route = 0;
+  m_ipv4 = 0;
+  Simulator::Destroy ();
+}
+
   
 /**
  * \ingroup internet-test
@@ -148,6 +281,7 @@ public:
     TestSuite ("ipv4-protocol", UNIT)
   {
     AddTestCase (new Ipv4L3ProtocolTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4L3ProtocolIdentificationTestCase (), TestCase::QUICK);
   }
 };
 
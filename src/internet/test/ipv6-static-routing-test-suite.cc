@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Tests for the route lookups of Ipv6 static routing
+
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-routing-table-entry.h"
+#include "ns3/ipv6-route.h"
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 StaticRouting longest prefix match Test
+ *
+ * Checks the route selected among overlapping routes (longest prefix,
+ * lowest metric, output interface), including after a route removal and
+ * with a non-contiguous prefix.
+ */
+class Ipv6StaticRoutingLongestPrefixMatchTestCase : public TestCase
+{
+public:
+  Ipv6StaticRoutingLongestPrefixMatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up a route.
+   * \param dest The destination.
+   * \param oif The output device, if any.
+   * \return The gateway of the selected route, or ff02::1 if there is none.
+   */
+  Ipv6Address Lookup (const char *dest, Ptr<NetDevice> oif = 0);
+
+  Ptr<Ipv6StaticRouting> m_routing; //!< The routing protocol under test.
+};
+
+Ipv6StaticRoutingLongestPrefixMatchTestCase::Ipv6StaticRoutingLongestPrefixMatchTestCase ()
+  : TestCase ("Static routing longest prefix match")
+{
+}
+
+Ipv6Address
+Ipv6StaticRoutingLongestPrefixMatchTestCase::Lookup (const char *dest, Ptr<NetDevice> oif)
+{
+  Ipv6Header header;
+  header.SetDestinationAddress (Ipv6Address (dest));
+  Socket::SocketErrno err;
+  Ptr<Ipv6Route> route = m_routing->RouteOutput (Create<Packet> (), header, oif, err);
+  return route ? route->GetGateway () : Ipv6Address::GetAllNodesMulticast ();
+}
+
+void
+Ipv6StaticRoutingLongestPrefixMatchTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+
+  std::vector<Ptr<SimpleNetDevice> > devices;
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      devices.push_back (device);
+      int32_t ifIndex = ipv6->AddInterface (device);
+      std::ostringstream address;
+      address << "2001:" << i << "::1";
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (Ipv6Address (address.str ().c_str ()), Ipv6Prefix (64)));
+      ipv6->SetUp (ifIndex);
+    }
+
+  Ipv6StaticRoutingHelper ipv6RoutingHelper;
+  m_routing = ipv6RoutingHelper.GetStaticRouting (ipv6);
+  m_routing->AddNetworkRouteTo (Ipv6Address ("2001:db8::"), Ipv6Prefix (32), Ipv6Address ("2001:1::2"), 1);
+  m_routing->AddNetworkRouteTo (Ipv6Address ("2001:db8:1::"), Ipv6Prefix (48), Ipv6Address ("2001:2::2"), 2, 5);
+  m_routing->AddNetworkRouteTo (Ipv6Address ("2001:db8:1::"), Ipv6Prefix (48), Ipv6Address ("2001:3::2"), 3, 2);
+  m_routing->AddNetworkRouteTo (Ipv6Address ("2001:db8:1::"), Ipv6Prefix (48), Ipv6Address ("2001:1::3"), 1, 2);
+  m_routing->AddHostRouteTo (Ipv6Address ("2001:db8:1::1"), Ipv6Address ("2001:2::2"), 2);
+  m_routing->AddHostRouteTo (Ipv6Address ("2001:db8:1::1"), Ipv6Address ("2001:3::2"), 3);
+  m_routing->SetDefaultRoute (Ipv6Address ("2001:3::2"), 3);
+
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:1::1"), Ipv6Address ("2001:2::2"), "The first host route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:1::2"), Ipv6Address ("2001:1::3"), "The last route with the lowest metric should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:2::1"), Ipv6Address ("2001:1::2"), "The /32 route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db9::1"), Ipv6Address ("2001:3::2"), "The default route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:2::7"), Ipv6Address ("::"), "The interface route should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:1::1", devices[2]), Ipv6Address ("2001:3::2"), "The route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:1::2", devices[1]), Ipv6Address ("2001:2::2"), "The route on the requested interface should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:2::1", devices[1]), Ipv6Address::GetAllNodesMulticast (), "No route should be found on the requested interface");
+
+  for (uint32_t i = 0; i < m_routing->GetNRoutes (); i++)
+    {
+      if (m_routing->GetRoute (i).GetDestNetwork () == Ipv6Address ("2001:db8::")
+          && m_routing->GetRoute (i).GetDestNetworkPrefix () == Ipv6Prefix (32))
+        {
+          m_routing->RemoveRoute (i);
+          break;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:2::1"), Ipv6Address ("2001:3::2"), "The default route should be selected after the removal");
+
+  // a prefix with a hole, matching 2001:db8:*:0::/64, and counted as 48 bits long
+  uint8_t prefix[16] = { 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0xff, 0xff };
+  m_routing->AddNetworkRouteTo (Ipv6Address ("2001:db8::"), Ipv6Prefix (prefix), Ipv6Address ("2001:2::9"), 2, 10);
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:2::1"), Ipv6Address ("2001:2::9"), "The route with a non-contiguous prefix should be selected");
+  NS_TEST_EXPECT_MSG_EQ (Lookup ("2001:db8:1::2"), Ipv6Address ("2001:1::3"), "The last route with the lowest metric should be selected");
+
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 StaticRouting TestSuite
+ */
+class Ipv6StaticRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv6StaticRoutingTestSuite ();
+};
+
+Ipv6StaticRoutingTestSuite::Ipv6StaticRoutingTestSuite ()
+  : TestSuite ("ipv6-static-routing", UNIT)
+{
+  AddTestCase (new Ipv6StaticRoutingLongestPrefixMatchTestCase, TestCase::QUICK);
+}
+
+static Ipv6StaticRoutingTestSuite ipv6StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -44,6 +44,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the storage of segments received in reverse order.
+   */
+  void TestReordering ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReordering ();
 }
 
 void
@@ -338,6 +344,66 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReordering ()
+{
+  TcpRxBuffer rxBuf (1);
+  TcpOptionSack::SackList sackList;
+  TcpHeader h;
+  rxBuf.SetMaxBufferSize (100000);
+
+  // all the segments but the first one, in reverse order
+  for (uint32_t i = 99; i > 0; --i)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (1 + 100 * i));
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (100), h), true,
+                             "Segment not stored");
+      sackList = rxBuf.GetSackList ();
+      NS_TEST_ASSERT_MSG_EQ (sackList.size (), 1,
+                             "SACK list should contain one element");
+      NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (1 + 100 * i),
+                             "SACK block different than expected");
+      NS_TEST_ASSERT_MSG_EQ (sackList.front ().second, SequenceNumber32 (10001),
+                             "SACK block different than expected");
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "Out-of-order data available");
+
+  // a duplicate segment is not stored
+  h.SetSequenceNumber (SequenceNumber32 (501));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (100), h), false,
+                         "Duplicate segment stored");
+
+  // a segment which overlaps the stored data only fills the hole
+  h.SetSequenceNumber (SequenceNumber32 (51));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (100), h), true,
+                         "Segment not stored");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 9950, "Wrong buffer occupancy");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (51),
+                         "SACK block different than expected");
+
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (100), h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (10001),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0,
+                         "SACK list should contain no element");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 10000, "Wrong available data");
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Extract (150)->GetSize (), 150, "Wrong extracted size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Extract (100000)->GetSize (), 9850, "Wrong extracted size");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Data left in the buffer");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Extract (100), 0, "Data extracted from an empty buffer");
+
+  // a payload extracted whole is not the packet which was added
+  Ptr<Packet> p = Create<Packet> (100);
+  h.SetSequenceNumber (SequenceNumber32 (10001));
+  rxBuf.Add (p, h);
+  Ptr<Packet> extracted = rxBuf.Extract (100);
+  NS_TEST_ASSERT_MSG_EQ (extracted->GetSize (), 100, "Wrong extracted size");
+  NS_TEST_ASSERT_MSG_NE (extracted, p, "The added packet was returned");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -0,0 +1,491 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/ip-l4-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/tcp-option-rfc793.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/tcp-option-sack.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentationOffloadTest");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the split of an IPv4 packet carrying several TCP segments.
+ */
+class TcpSegmentationOffloadSplitTest : public TestCase
+{
+public:
+  TcpSegmentationOffloadSplitTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpSegmentationOffloadSplitTest::TcpSegmentationOffloadSplitTest ()
+  : TestCase ("Split of an IPv4 packet carrying TCP segments")
+{
+}
+
+void
+TcpSegmentationOffloadSplitTest::DoRun (void)
+{
+  // the TCP protocol registers the function splitting the IPv4 packets
+  Ptr<TcpL4Protocol> tcp = CreateObject<TcpL4Protocol> ();
+
+  Ptr<Packet> p = Create<Packet> (1300);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (1000));
+  tcpHeader.SetFlags (TcpHeader::ACK | TcpHeader::CWR | TcpHeader::FIN);
+  p->AddHeader (tcpHeader);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  ipHeader.SetIdentification (7);
+  p->AddHeader (ipHeader);
+
+  std::vector<Ptr<Packet> > segments;
+  NS_TEST_EXPECT_MSG_EQ (SegmentationOffload::Segment (Ipv4L3Protocol::PROT_NUMBER, p->Copy (), segments),
+                         false, "Packet without tag split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 1, "Packet without tag not returned");
+
+  p->AddPacketTag (SegmentationOffloadTag (500, 3));
+  NS_TEST_EXPECT_MSG_EQ (SegmentationOffload::Segment (Ipv4L3Protocol::PROT_NUMBER, p, segments),
+                         true, "Tagged packet not split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 3, "Wrong number of segments");
+  for (uint32_t i = 0; i < segments.size (); i++)
+    {
+      SegmentationOffloadTag tag;
+      NS_TEST_EXPECT_MSG_EQ (segments[i]->PeekPacketTag (tag), false, "Segment still tagged");
+      Ipv4Header segmentIpHeader;
+      segments[i]->RemoveHeader (segmentIpHeader);
+      TcpHeader segmentTcpHeader;
+      segments[i]->RemoveHeader (segmentTcpHeader);
+      uint32_t size = (i < 2 ? 500 : 300);
+      NS_TEST_EXPECT_MSG_EQ (segments[i]->GetSize (), size, "Wrong segment size");
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetPayloadSize (), size + segmentTcpHeader.GetSerializedSize (),
+                             "Wrong IPv4 payload size");
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetIdentification (), 7 + i, "Wrong identification");
+      NS_TEST_EXPECT_MSG_EQ (segmentTcpHeader.GetSequenceNumber (), SequenceNumber32 (1000 + 500 * i),
+                             "Wrong sequence number");
+      NS_TEST_EXPECT_MSG_EQ (((segmentTcpHeader.GetFlags () & TcpHeader::CWR) != 0), (i == 0),
+                             "CWR not only in the first segment");
+      NS_TEST_EXPECT_MSG_EQ (((segmentTcpHeader.GetFlags () & TcpHeader::FIN) != 0), (i == 2),
+                             "FIN not only in the last segment");
+      NS_TEST_EXPECT_MSG_EQ (((segmentTcpHeader.GetFlags () & TcpHeader::ACK) != 0), true,
+                             "ACK not in every segment");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check a transfer with the segmentation offload.
+ *
+ * The sender hands several segments at once to the IPv4 layer, which
+ * splits them as the SimpleNetDevice does not support the offload.  The
+ * receiver must get all the data in order, in segments no larger than
+ * the segment size.
+ */
+class TcpSegmentationOffloadTransferTest : public TcpGeneralTest
+{
+public:
+  TcpSegmentationOffloadTransferTest ();
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual void ConfigureEnvironment (void);
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks (void);
+
+private:
+  uint32_t m_maxTxSize;         //!< Largest packet sent by the sender socket
+  uint32_t m_rxBytes;           //!< Bytes received by the receiver socket
+  SequenceNumber32 m_nextRxSeq; //!< Next sequence number expected by the receiver
+};
+
+TcpSegmentationOffloadTransferTest::TcpSegmentationOffloadTransferTest ()
+  : TcpGeneralTest ("Transfer with segmentation offload"),
+    m_maxTxSize (0),
+    m_rxBytes (0),
+    m_nextRxSeq (1)
+{
+}
+
+void
+TcpSegmentationOffloadTransferTest::ConfigureEnvironment (void)
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpSegmentationOffloadTransferTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> socket = TcpGeneralTest::CreateSenderSocket (node);
+  socket->SetAttribute ("TsoMaxSegments", UintegerValue (8));
+  return socket;
+}
+
+void
+TcpSegmentationOffloadTransferTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      m_maxTxSize = std::max (m_maxTxSize, p->GetSize ());
+    }
+}
+
+void
+TcpSegmentationOffloadTransferTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () > 0)
+    {
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (p->GetSize (), GetSegSize (SENDER), "Segment larger than the segment size");
+      NS_TEST_EXPECT_MSG_EQ (h.GetSequenceNumber (), m_nextRxSeq, "Segment received out of order");
+      m_nextRxSeq = h.GetSequenceNumber () + SequenceNumber32 (p->GetSize ());
+      m_rxBytes += p->GetSize ();
+    }
+}
+
+void
+TcpSegmentationOffloadTransferTest::FinalChecks (void)
+{
+  NS_TEST_EXPECT_MSG_GT (m_maxTxSize, GetSegSize (SENDER), "No segments sent at once");
+  NS_TEST_EXPECT_MSG_EQ (m_rxBytes, GetPktSize () * GetPktCount (), "Not all the data received");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check a transfer with the receive offload.
+ *
+ * The segments sent back to back by the sender arrive at the same time at
+ * the receiver, where IPv4 coalesces them.  The receiver must get all the
+ * data in order, and acknowledge at once each packet carrying at least two
+ * segments, as the delayed acknowledgments count each of them.  With the
+ * checksums enabled, TCP must accept both the coalesced packets and the
+ * segments passed unchanged, such as those of the handshake.
+ */
+class TcpReceiveOffloadTransferTest : public TcpGeneralTest
+{
+public:
+  /**
+   * rief Constructor.
+   * \param checksums whether the checksums are enabled
+   */
+  TcpReceiveOffloadTransferTest (bool checksums);
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+  virtual void ConfigureEnvironment (void);
+  virtual void DoTeardown (void);
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks (void);
+
+private:
+  bool m_checksums;               //!< Whether the checksums are enabled
+  uint32_t m_rxBytes;             //!< Bytes received by the receiver socket
+  SequenceNumber32 m_nextRxSeq;   //!< Next sequence number expected by the receiver
+  uint32_t m_coalesced;           //!< Packets carrying at least two segments received
+  uint32_t m_immediateAcks;       //!< Coalesced packets acknowledged at once
+  SequenceNumber32 m_pendingAck;  //!< Acknowledgment expected for the last coalesced packet
+  Time m_pendingAckTime;          //!< Reception time of the last coalesced packet
+};
+
+TcpReceiveOffloadTransferTest::TcpReceiveOffloadTransferTest (bool checksums)
+  : TcpGeneralTest (checksums ? "Transfer with receive offload and checksums" : "Transfer with receive offload"),
+    m_checksums (checksums),
+    m_rxBytes (0),
+    m_nextRxSeq (1),
+    m_coalesced (0),
+    m_immediateAcks (0),
+    m_pendingAck (0),
+    m_pendingAckTime (Seconds (-1))
+{
+}
+
+void
+TcpReceiveOffloadTransferTest::ConfigureEnvironment (void)
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+  SetAppPktInterval (MicroSeconds (10));
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (m_checksums));
+}
+
+void
+TcpReceiveOffloadTransferTest::DoTeardown (void)
+{
+  TcpGeneralTest::DoTeardown ();
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+}
+
+Ptr<TcpSocketMsgBase>
+TcpReceiveOffloadTransferTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  node->GetObject<Ipv4L3Protocol> ()->SetAttribute ("GenericReceiveOffload", BooleanValue (true));
+  return TcpGeneralTest::CreateReceiverSocket (node);
+}
+
+void
+TcpReceiveOffloadTransferTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && Simulator::Now () == m_pendingAckTime
+      && h.GetAckNumber () == m_pendingAck)
+    {
+      m_immediateAcks++;
+      m_pendingAckTime = Seconds (-1);
+    }
+}
+
+void
+TcpReceiveOffloadTransferTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () > 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (h.GetSequenceNumber (), m_nextRxSeq, "Segment received out of order");
+      m_nextRxSeq = h.GetSequenceNumber () + SequenceNumber32 (p->GetSize ());
+      m_rxBytes += p->GetSize ();
+      if (p->GetSize () >= 2 * GetSegSize (SENDER))
+        {
+          m_coalesced++;
+          m_pendingAck = m_nextRxSeq;
+          m_pendingAckTime = Simulator::Now ();
+        }
+    }
+}
+
+void
+TcpReceiveOffloadTransferTest::FinalChecks (void)
+{
+  NS_TEST_EXPECT_MSG_GT (m_coalesced, 0, "No segments coalesced");
+  NS_TEST_EXPECT_MSG_EQ (m_immediateAcks, m_coalesced, "Coalesced segments not acknowledged at once");
+  NS_TEST_EXPECT_MSG_EQ (m_rxBytes, GetPktSize () * GetPktCount (), "Not all the data received");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Transport protocol recording the TCP packets delivered by IPv4.
+ */
+class GroRecordingL4Protocol : public IpL4Protocol
+{
+public:
+  virtual int GetProtocolNumber (void) const
+  {
+    return TcpL4Protocol::PROT_NUMBER;
+  }
+  virtual enum RxStatus Receive (Ptr<Packet> p, Ipv4Header const &header, Ptr<Ipv4Interface> incomingInterface)
+  {
+    m_packets.push_back (p);
+    return RX_OK;
+  }
+  virtual enum RxStatus Receive (Ptr<Packet> p, Ipv6Header const &header, Ptr<Ipv6Interface> incomingInterface)
+  {
+    return RX_OK;
+  }
+  virtual void SetDownTarget (DownTargetCallback cb)
+  {
+  }
+  virtual void SetDownTarget6 (DownTargetCallback6 cb)
+  {
+  }
+  virtual DownTargetCallback GetDownTarget (void) const
+  {
+    return DownTargetCallback ();
+  }
+  virtual DownTargetCallback6 GetDownTarget6 (void) const
+  {
+    return DownTargetCallback6 ();
+  }
+
+  std::vector<Ptr<Packet> > m_packets; //!< Packets received, in order
+};
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the TCP options of the segments coalesced by the receive offload.
+ *
+ * The segments of a flow with the same timestamps are coalesced, whether
+ * their options are padded with NOP or END options.  A segment with a
+ * different timestamp, or with another option, is not.
+ */
+class TcpReceiveOffloadOptionsTest : public TestCase
+{
+public:
+  TcpReceiveOffloadOptionsTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive a TCP segment on the device.
+   * \param seq the sequence number
+   * \param timestamp the timestamp
+   * \param nopPadding whether to pad the options with NOP (rather than END) options
+   * \param sack whether to add a SACK option
+   */
+  void ReceiveSegment (uint32_t seq, uint32_t timestamp, bool nopPadding, bool sack);
+
+  Ptr<Ipv4L3Protocol> m_ipv4;     //!< IPv4 of the receiver
+  Ptr<SimpleNetDevice> m_device;  //!< Device of the receiver
+};
+
+TcpReceiveOffloadOptionsTest::TcpReceiveOffloadOptionsTest ()
+  : TestCase ("Options of the segments coalesced by the receive offload")
+{
+}
+
+void
+TcpReceiveOffloadOptionsTest::ReceiveSegment (uint32_t seq, uint32_t timestamp, bool nopPadding, bool sack)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSourcePort (1000);
+  tcpHeader.SetDestinationPort (2000);
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetAckNumber (SequenceNumber32 (1));
+  tcpHeader.SetFlags (TcpHeader::ACK);
+  tcpHeader.SetWindowSize (1000);
+  if (nopPadding)
+    {
+      tcpHeader.AppendOption (CreateObject<TcpOptionNOP> ());
+      tcpHeader.AppendOption (CreateObject<TcpOptionNOP> ());
+    }
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (timestamp);
+  ts->SetEcho (3);
+  tcpHeader.AppendOption (ts);
+  if (sack)
+    {
+      Ptr<TcpOptionSack> sackOption = CreateObject<TcpOptionSack> ();
+      sackOption->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (1001), SequenceNumber32 (1101)));
+      tcpHeader.AppendOption (sackOption);
+    }
+  p->AddHeader (tcpHeader);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  ipHeader.SetTtl (64);
+  p->AddHeader (ipHeader);
+  m_ipv4->Receive (m_device, p, Ipv4L3Protocol::PROT_NUMBER, Mac48Address::Allocate (),
+                   m_device->GetAddress (), NetDevice::PACKET_HOST);
+}
+
+void
+TcpReceiveOffloadOptionsTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  m_device = CreateObject<SimpleNetDevice> ();
+  m_device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (m_device);
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (node);
+
+  m_ipv4 = node->GetObject<Ipv4L3Protocol> ();
+  m_ipv4->SetAttribute ("GenericReceiveOffload", BooleanValue (true));
+  int32_t ifIndex = m_ipv4->AddInterface (m_device);
+  m_ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("/24")));
+  m_ipv4->SetUp (ifIndex);
+  m_ipv4->Remove (m_ipv4->GetProtocol (TcpL4Protocol::PROT_NUMBER));
+  Ptr<GroRecordingL4Protocol> l4 = CreateObject<GroRecordingL4Protocol> ();
+  m_ipv4->Insert (l4);
+
+  // padded with NOP, then with END options: coalesced
+  Simulator::Schedule (Seconds (1), &TcpReceiveOffloadOptionsTest::ReceiveSegment, this, 1, 5, true, false);
+  Simulator::Schedule (Seconds (1), &TcpReceiveOffloadOptionsTest::ReceiveSegment, this, 101, 5, false, false);
+  // a different timestamp: not coalesced
+  Simulator::Schedule (Seconds (1), &TcpReceiveOffloadOptionsTest::ReceiveSegment, this, 201, 6, false, false);
+  // a SACK option: not coalesced
+  Simulator::Schedule (Seconds (1), &TcpReceiveOffloadOptionsTest::ReceiveSegment, this, 301, 6, false, true);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (l4->m_packets.size (), 3, "Wrong number of packets delivered to TCP");
+  uint32_t sizes[3] = { 200, 100, 100 };
+  uint32_t segments[3] = { 2, 1, 1 };
+  uint32_t seqs[3] = { 1, 201, 301 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<Packet> p = l4->m_packets[i];
+      SegmentationOffloadTag tag;
+      NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (tag), (segments[i] > 1), "Wrong tag on packet " << i);
+      if (segments[i] > 1)
+        {
+          NS_TEST_EXPECT_MSG_EQ (tag.GetSegmentCount (), segments[i], "Wrong number of segments in packet " << i);
+        }
+      TcpHeader tcpHeader;
+      p->RemoveHeader (tcpHeader);
+      NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetSequenceNumber (), SequenceNumber32 (seqs[i]), "Wrong sequence number of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (p->GetSize (), sizes[i], "Wrong payload size of packet " << i);
+    }
+
+  m_ipv4 = 0;
+  m_device = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP segmentation offload TestSuite
+ */
+class TcpSegmentationOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentationOffloadTestSuite ()
+    : TestSuite ("tcp-segmentation-offload", UNIT)
+  {
+    AddTestCase (new TcpSegmentationOffloadSplitTest, TestCase::QUICK);
+    AddTestCase (new TcpSegmentationOffloadTransferTest, TestCase::QUICK);
+    AddTestCase (new TcpReceiveOffloadTransferTest (false), TestCase::QUICK);
+    AddTestCase (new TcpReceiveOffloadTransferTest (true), TestCase::QUICK);
+    AddTestCase (new TcpReceiveOffloadOptionsTest, TestCase::QUICK);
+  }
+};
+
+static TcpSegmentationOffloadTestSuite g_tcpSegmentationOffloadTestSuite; //!< Static variable for test initialization
@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard with a long sent list */
+  void TestScoreboard ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestScoreboard, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,79 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestScoreboard ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 100;
+  uint32_t nSegments = 1000;
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segmentSize * nSegments);
+
+  txBuf.Add (Create<Packet> (segmentSize * nSegments));
+  for (uint32_t i = 0; i < nSegments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // every other segment is received: all the segments below the
+  // third highest sacked segment (995) are lost
+  for (uint32_t i = 1; i < nSegments; i += 2)
+    {
+      sack->ClearSackList ();
+      sack->AddSackBlock (TcpOptionSack::SackBlock (head + (segmentSize * i),
+                                                    head + (segmentSize * (i + 1))));
+      txBuf.Update (sack->GetSackList ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * 500,
+                         "Wrong number of sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * 498,
+                         "Wrong number of lost bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * 2,
+                         "Wrong number of bytes in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head), true,
+                         "First segment not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 1)), false,
+                         "Sacked segment lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 994)), true,
+                         "Segment below the third highest SACK not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 996)), false,
+                         "Segment above the third highest SACK lost");
+
+  // the lost segments are retransmitted in order
+  for (uint32_t i = 0; i < 995; i += 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i),
+                             "Different NextSeq than expected for lost segments");
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * 500,
+                         "Wrong number of bytes in flight after retransmissions");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, false), false,
+                         "NextSeq returned without lost segments nor data");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                         "No NextSeq for rule 3 in recovery");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 996),
+                         "Different NextSeq than expected for rule 3");
+
+  txBuf.DiscardUpTo (head + (segmentSize * 996));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), segmentSize * 4,
+                         "Size is different than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * 2,
+                         "Wrong number of sacked bytes after the ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 0,
+                         "Wrong number of lost bytes after the ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * 2,
+                         "Wrong number of bytes in flight after the ACK");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
@@ -25,6 +25,8 @@
 #include "ns3/test.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/udp-socket.h"
+#include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/simulator.h"
 #include "ns3/simple-channel.h"
 #include "ns3/simple-net-device.h"
@@ -166,6 +168,74 @@ Udp6SocketLoopbackTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 246, "first socket should not receive it (it is bound specifically to the second interface's address");
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief UDP Socket batch receive without packet tags Test
+ */
+class UdpSocketRecvFromBatchTest : public TestCase
+{
+public:
+  UdpSocketRecvFromBatchTest ();
+  virtual void DoRun (void);
+};
+
+UdpSocketRecvFromBatchTest::UdpSocketRecvFromBatchTest ()
+  : TestCase ("UDP batch receive without packet tags test")
+{
+}
+
+void
+UdpSocketRecvFromBatchTest::DoRun ()
+{
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (rxNode);
+
+  Ptr<SocketFactory> rxSocketFactory = rxNode->GetObject<UdpSocketFactory> ();
+  Ptr<UdpSocket> rxSocket = DynamicCast<UdpSocket> (rxSocketFactory->CreateSocket ());
+  rxSocket->SetAttribute ("RecvPacketTags", BooleanValue (false));
+  rxSocket->SetRecvPktInfo (true);
+  rxSocket->SetIpRecvTos (true);
+  rxSocket->SetIpRecvTtl (true);
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+
+  Ptr<Socket> txSocket = rxSocketFactory->CreateSocket ();
+  txSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      InetSocketAddress to ("127.0.0.1", 80);
+      to.SetTos (0x28);
+      txSocket->SendTo (Create<Packet> (100 + i), 0, to);
+    }
+  Simulator::Run ();
+
+  std::vector<UdpSocket::RecvDatagram> datagrams (2);
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->RecvFromBatch (datagrams), 2, "the batch should be filled");
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (datagrams[i].packet->GetSize (), 100 + i, "datagrams should be received in order");
+      NS_TEST_EXPECT_MSG_EQ (datagrams[i].from, InetSocketAddress ("127.0.0.1", 1234), "wrong sender address");
+      NS_TEST_EXPECT_MSG_EQ (datagrams[i].recvIf, 0, "datagrams should be received on the loopback device");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) datagrams[i].tos, 0x28, "wrong TOS");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) datagrams[i].ttl, 64, "wrong TTL");
+      SocketIpTosTag tosTag;
+      SocketIpTtlTag ttlTag;
+      Ipv4PacketInfoTag infoTag;
+      NS_TEST_EXPECT_MSG_EQ (datagrams[i].packet->PeekPacketTag (tosTag), false, "no TOS tag expected");
+      NS_TEST_EXPECT_MSG_EQ (datagrams[i].packet->PeekPacketTag (ttlTag), false, "no TTL tag expected");
+      NS_TEST_EXPECT_MSG_EQ (datagrams[i].packet->PeekPacketTag (infoTag), false, "no packet info tag expected");
+    }
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->RecvFromBatch (datagrams), 1, "one datagram should be left");
+  NS_TEST_EXPECT_MSG_EQ (datagrams[0].packet->GetSize (), 102, "datagrams should be received in order");
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->RecvFromBatch (datagrams), 0, "no datagram should be left");
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->GetErrno (), Socket::ERROR_AGAIN, "an empty queue should set ERROR_AGAIN");
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->GetRxAvailable (), 0, "the receive buffer should be empty");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -721,6 +791,7 @@ public:
   {
     AddTestCase (new UdpSocketImplTest, TestCase::QUICK);
     AddTestCase (new UdpSocketLoopbackTest, TestCase::QUICK);
+    AddTestCase (new UdpSocketRecvFromBatchTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketImplTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketLoopbackTest, TestCase::QUICK);
   }
@@ -188,9 +188,12 @@ LteInterference::ConditionallyEvaluateChunk ()
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
 
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
-
-      SpectrumValue sinr = (*m_rxSignal) / interf;
+      // compute the interference and the SINR in the member scratch
+      // buffers, to avoid allocating temporary SpectrumValues per chunk
+      m_interf.SetSubtractAdd (*m_allSignals, *m_rxSignal, *m_noise);
+      m_sinr.SetQuotient (*m_rxSignal, m_interf);
+      const SpectrumValue& interf = m_interf;
+      const SpectrumValue& sinr = m_sinr;
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<LteChunkProcessor> >::const_iterator it = m_sinrChunkProcessorList.begin (); it != m_sinrChunkProcessorList.end (); ++it)
         {
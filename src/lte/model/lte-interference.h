@@ -152,6 +152,9 @@ private:
 
   Ptr<const SpectrumValue> m_noise; ///< the noise value
 
+  SpectrumValue m_interf; ///< scratch buffer for the interference of the current chunk
+  SpectrumValue m_sinr; ///< scratch buffer for the SINR of the current chunk
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
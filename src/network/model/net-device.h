@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -34,6 +35,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -260,6 +262,23 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param items packets sent from above down to Network Device, with their
+   *        destination address and protocol number
+   *
+   *  Called from the traffic control layer to send a batch of packets into
+   *  the Network Device, much like the xmit_more flag of the Linux kernel
+   *  tells a driver that more packets follow. The device stops taking the
+   *  packets of the batch as soon as the transmission queue of the next
+   *  packet is stopped; the packets not taken remain with the caller.
+   *  The default implementation calls Send for each packet; devices can
+   *  override it to perform the per-packet checks and start the
+   *  transmission once per batch.
+   *
+   * \return the number of packets taken by the device (sent or dropped),
+   *         starting from the first one
+   */
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -359,6 +378,15 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface splits the packets tagged with a
+   *         SegmentationOffloadTag when it transmits them, false otherwise
+   *         (the default).
+   *
+   * \see SegmentationOffload
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
 };
 
 } // namespace ns3
@@ -30,7 +30,9 @@ NS_LOG_COMPONENT_DEFINE ("NetDeviceQueueInterface");
 
 NetDeviceQueue::NetDeviceQueue ()
   : m_stoppedByDevice (false),
-    m_stoppedByQueueLimits (false)
+    m_stoppedByQueueLimits (false),
+    m_inBatch (false),
+    m_batchBytes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -90,6 +92,11 @@ NetDeviceQueue::NotifyQueuedBytes (uint32_t bytes)
     {
       return;
     }
+  if (m_inBatch)
+    {
+      m_batchBytes += bytes;
+      return;
+    }
   m_queueLimits->Queued (bytes);
   if (m_queueLimits->Available () >= 0)
     {
@@ -98,6 +105,27 @@ NetDeviceQueue::NotifyQueuedBytes (uint32_t bytes)
   m_stoppedByQueueLimits = true;
 }
 
+void
+NetDeviceQueue::StartBatch (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_inBatch = true;
+  m_batchBytes = 0;
+}
+
+void
+NetDeviceQueue::EndBatch (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_inBatch = false;
+  if (m_batchBytes)
+    {
+      uint32_t bytes = m_batchBytes;
+      m_batchBytes = 0;
+      NotifyQueuedBytes (bytes);
+    }
+}
+
 void
 NetDeviceQueue::NotifyTransmittedBytes (uint32_t bytes)
 {
@@ -119,6 +119,23 @@ public:
    */
   void NotifyTransmittedBytes (uint32_t bytes);
 
+  /**
+   * \brief Called by the netdevice before it enqueues a batch of packets
+   *
+   * Until EndBatch is called, the number of bytes reported through
+   * NotifyQueuedBytes is accumulated, and the queue limits are only
+   * informed once, when the batch ends. The netdevice must not transmit
+   * packets of the batch before calling EndBatch.
+   */
+  void StartBatch (void);
+
+  /**
+   * \brief Called by the netdevice after it enqueued a batch of packets
+   *
+   * Report the number of bytes queued during the batch to the queue limits.
+   */
+  void EndBatch (void);
+
   /**
    * \brief Reset queue limits state
    */
@@ -196,6 +213,8 @@ private:
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
+  bool m_inBatch;                 //!< True if the device is enqueuing a batch of packets
+  uint32_t m_batchBytes;          //!< Bytes queued during the current batch
   WakeCallback m_wakeCallback;    //!< Wake callback
 };
 
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include "segmentation-offload.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentationOffload");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentationOffloadTag);
+
+TypeId
+SegmentationOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentationOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SegmentationOffloadTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+SegmentationOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SegmentationOffloadTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+SegmentationOffloadTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_segmentSize);
+  buf.WriteU32 (m_segmentCount);
+}
+
+void
+SegmentationOffloadTag::Deserialize (TagBuffer buf)
+{
+  m_segmentSize = buf.ReadU32 ();
+  m_segmentCount = buf.ReadU32 ();
+}
+
+void
+SegmentationOffloadTag::Print (std::ostream &os) const
+{
+  os << "SegmentSize=" << m_segmentSize << " SegmentCount=" << m_segmentCount;
+}
+
+SegmentationOffloadTag::SegmentationOffloadTag ()
+  : Tag (),
+    m_segmentSize (0),
+    m_segmentCount (0)
+{
+}
+
+SegmentationOffloadTag::SegmentationOffloadTag (uint32_t segmentSize, uint32_t segmentCount)
+  : Tag (),
+    m_segmentSize (segmentSize),
+    m_segmentCount (segmentCount)
+{
+}
+
+uint32_t
+SegmentationOffloadTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+uint32_t
+SegmentationOffloadTag::GetSegmentCount (void) const
+{
+  return m_segmentCount;
+}
+
+/**
+ * \returns the functions splitting the packets, by protocol number
+ */
+static std::map<uint16_t, SegmentationOffload::SegmentCallback> &
+GetSegmentCallbacks (void)
+{
+  static std::map<uint16_t, SegmentationOffload::SegmentCallback> callbacks;
+  return callbacks;
+}
+
+void
+SegmentationOffload::Register (uint16_t protocolNumber, SegmentCallback cb)
+{
+  NS_LOG_FUNCTION (protocolNumber);
+  GetSegmentCallbacks ()[protocolNumber] = cb;
+}
+
+bool
+SegmentationOffload::Segment (uint16_t protocolNumber, Ptr<Packet> packet, std::vector<Ptr<Packet> > &segments)
+{
+  NS_LOG_FUNCTION (protocolNumber << packet);
+  segments.clear ();
+  SegmentationOffloadTag tag;
+  if (!packet->RemovePacketTag (tag))
+    {
+      segments.push_back (packet);
+      return false;
+    }
+  std::map<uint16_t, SegmentCallback>::const_iterator it = GetSegmentCallbacks ().find (protocolNumber);
+  NS_ABORT_MSG_IF (it == GetSegmentCallbacks ().end (),
+                   "No segmentation function for protocol " << protocolNumber);
+  segments.reserve (tag.GetSegmentCount ());
+  it->second (packet, tag.GetSegmentSize (), segments);
+  NS_LOG_LOGIC ("Packet of " << packet->GetSize () << " bytes split into " << segments.size () << " segments");
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENTATION_OFFLOAD_H
+#define SEGMENTATION_OFFLOAD_H
+
+#include <vector>
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Tag marking a packet which carries several segments of a
+ * transport protocol, to be split by the NetDevice which transmits it.
+ *
+ * The tag is added by the transport protocol, and removed when the packet
+ * is split into segments, which do not carry it.
+ *
+ * The receive offload of the network layer also marks with this tag the
+ * packets it coalesces from several received segments, so that the
+ * transport protocol accounts for each of them.
+ */
+class SegmentationOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentationOffloadTag ();
+
+  /**
+   * Constructs a SegmentationOffloadTag
+   *
+   * \param segmentSize the size of the payload of each segment
+   * \param segmentCount the number of segments
+   */
+  SegmentationOffloadTag (uint32_t segmentSize, uint32_t segmentCount);
+
+  /**
+   * \returns the size of the payload of each segment (the last segment may be smaller)
+   */
+  uint32_t GetSegmentSize (void) const;
+
+  /**
+   * \returns the number of segments
+   */
+  uint32_t GetSegmentCount (void) const;
+
+private:
+  uint32_t m_segmentSize;  //!< Payload size of the segments
+  uint32_t m_segmentCount; //!< Number of segments
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Registry of the functions splitting the packets tagged with a
+ * SegmentationOffloadTag, by protocol number.
+ *
+ * The layer 3 protocols register a function which splits a packet
+ * (starting with their header) into segments, each with its own copy of
+ * the headers.  The NetDevices supporting segmentation offload call
+ * Segment on the packets they are about to transmit, before adding their
+ * own header, so that each segment is transmitted (and traced) as if it
+ * had been sent on its own.  The layer 3 protocols also call Segment in
+ * software for the NetDevices which do not support the offload.
+ */
+class SegmentationOffload
+{
+public:
+  /**
+   * Callback splitting a packet.  The arguments are the packet (untagged),
+   * the size of the payload of the segments and the list to fill with the
+   * segments.
+   */
+  typedef Callback<void, Ptr<Packet>, uint32_t, std::vector<Ptr<Packet> > &> SegmentCallback;
+
+  /**
+   * \brief Register the function splitting the packets of a protocol.
+   * \param protocolNumber the protocol number (as passed to NetDevice::Send)
+   * \param cb the function
+   */
+  static void Register (uint16_t protocolNumber, SegmentCallback cb);
+
+  /**
+   * \brief Split a packet tagged with a SegmentationOffloadTag.
+   *
+   * A packet without the tag is returned as the only segment.
+   *
+   * \param protocolNumber the protocol number (as passed to NetDevice::Send)
+   * \param packet the packet
+   * \param [out] segments the segments
+   * \returns true if the packet has been split
+   */
+  static bool Segment (uint16_t protocolNumber, Ptr<Packet> packet, std::vector<Ptr<Packet> > &segments);
+};
+
+} // namespace ns3
+
+#endif /* SEGMENTATION_OFFLOAD_H */
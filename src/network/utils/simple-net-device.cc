@@ -30,6 +30,7 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-item.h"
 
 namespace ns3 {
 
@@ -482,15 +483,7 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
     {
       if (m_queue->GetNPackets () == 1 && !TransmitCompleteEvent.IsRunning ())
         {
-          p = m_queue->Dequeue ();
-          p->RemovePacketTag (tag);
-          Time txTime = Time (0);
-          if (m_bps > DataRate (0))
-            {
-              txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
-            }
-          m_channel->Send (p, protocolNumber, to, from, this);
-          TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+          StartTransmission ();
         }
       return true;
     }
@@ -501,6 +494,80 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
 }
 
 
+uint32_t
+SimpleNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  // Enqueue the packets until the device queue is stopped, and inform the
+  // queue limits of the bytes queued once for the whole batch
+  Ptr<NetDeviceQueue> txq = m_queueInterface ? m_queueInterface->GetTxQueue (0) : 0;
+  if (txq)
+    {
+      txq->StartBatch ();
+    }
+
+  Mac48Address from = Mac48Address::ConvertFrom (m_address);
+  uint32_t count = 0;
+  for (; count < items.size (); count++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> p = items[count]->GetPacket ();
+      if (p->GetSize () > GetMtu ())
+        {
+          continue;
+        }
+
+      Mac48Address to = Mac48Address::ConvertFrom (items[count]->GetAddress ());
+      SimpleTag tag;
+      tag.SetSrc (from);
+      tag.SetDst (to);
+      tag.SetProto (items[count]->GetProtocol ());
+      p->AddPacketTag (tag);
+
+      if (!m_queue->Enqueue (p))
+        {
+          // as SendFrom does, a packet which does not fit the queue is sent right away
+          p->RemovePacketTag (tag);
+          m_channel->Send (p, items[count]->GetProtocol (), to, from, this);
+        }
+    }
+
+  if (txq)
+    {
+      txq->EndBatch ();
+    }
+
+  // start the transmission of the batch, unless a transmission is ongoing
+  if (m_queue->GetNPackets () && !TransmitCompleteEvent.IsRunning ())
+    {
+      StartTransmission ();
+    }
+  return count;
+}
+
+void
+SimpleNetDevice::StartTransmission (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Packet> packet = m_queue->Dequeue ();
+
+  SimpleTag tag;
+  packet->RemovePacketTag (tag);
+
+  Time txTime = Time (0);
+  if (m_bps > DataRate (0))
+    {
+      txTime = m_bps.CalculateBytesTxTime (packet->GetSize ());
+    }
+  m_channel->Send (packet, tag.GetProto (), tag.GetDst (), tag.GetSrc (), this);
+  TransmitCompleteEvent = Simulator::Schedule (txTime, &SimpleNetDevice::TransmitComplete, this);
+}
+
 void
 SimpleNetDevice::TransmitComplete ()
 {
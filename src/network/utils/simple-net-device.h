@@ -126,6 +126,7 @@ public:
   virtual bool IsBridge (void) const;
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
   virtual bool NeedsArp (void) const;
@@ -168,6 +169,12 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Dequeue the packet at the head of the queue, send it on the channel
+   * and schedule the end of its transmission.
+   */
+  void StartTransmission (void);
+
   bool m_linkUp; //!< Flag indicating whether or not the link is up
 
   /**
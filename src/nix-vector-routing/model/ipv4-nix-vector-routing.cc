@@ -18,7 +18,8 @@
  * Authors: Josh Pelkey <jpelkey@gatech.edu>
  */
 
-#include <queue>
+#include <algorithm>
+#include <limits>
 #include <iomanip>
 
 #include "ns3/log.h"
@@ -35,6 +36,18 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
 bool Ipv4NixVectorRouting::g_isCacheDirty = false;
+std::map<uint32_t, std::set<std::pair<uint32_t, Ipv4Address> > > Ipv4NixVectorRouting::g_pathsByNode;
+std::map<uint64_t, std::pair<uint32_t, Ipv4Address> > Ipv4NixVectorRouting::g_pathsBySeq;
+uint64_t Ipv4NixVectorRouting::g_nextPathSeq = 0;
+std::map<std::pair<uint32_t, uint32_t>, uint64_t> Ipv4NixVectorRouting::g_downInterfaces;
+uint32_t Ipv4NixVectorRouting::g_nInstances = 0;
+Ipv4NixVectorRouting::Topology Ipv4NixVectorRouting::g_topology;
+
+Ipv4NixVectorRouting::Topology::Topology ()
+  : m_valid (false),
+    m_stamp (0)
+{
+}
 
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
@@ -51,6 +64,7 @@ Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
   : m_totalNeighbors (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  g_nInstances++;
 }
 
 Ipv4NixVectorRouting::~Ipv4NixVectorRouting ()
@@ -73,8 +87,39 @@ Ipv4NixVectorRouting::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
+  if (m_node != 0)
+    {
+      // Remove the paths computed by this node.  The other nodes may be
+      // disposed too, so the paths crossing this node are only dropped from
+      // the index, and left to the next flush of the caches.
+      uint32_t nodeId = m_node->GetId ();
+      while (!m_nixPaths.empty ())
+        {
+          InvalidateNixVector (m_nixPaths.begin ()->first);
+        }
+      if (g_pathsByNode.erase (nodeId) > 0)
+        {
+          g_isCacheDirty = true;
+        }
+      g_downInterfaces.erase (g_downInterfaces.lower_bound (std::make_pair (nodeId, 0u)),
+                              g_downInterfaces.upper_bound (std::make_pair (nodeId, std::numeric_limits<uint32_t>::max ())));
+    }
+
   m_node = 0;
   m_ipv4 = 0;
+  g_topology.m_valid = false;
+
+  NS_ASSERT (g_nInstances > 0);
+  if (--g_nInstances == 0)
+    {
+      // the last instance, e.g., at the end of the simulation: start afresh
+      g_pathsByNode.clear ();
+      g_pathsBySeq.clear ();
+      g_downInterfaces.clear ();
+      g_nextPathSeq = 0;
+      g_topology = Topology ();
+      g_isCacheDirty = false;
+    }
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -105,6 +150,10 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
       rp->FlushNixCache ();
       rp->FlushIpv4RouteCache ();
     }
+  g_pathsByNode.clear ();
+  g_pathsBySeq.clear ();
+  g_downInterfaces.clear ();
+  g_topology.m_valid = false;
 }
 
 void
@@ -112,6 +161,7 @@ Ipv4NixVectorRouting::FlushNixCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_nixCache.clear ();
+  m_nixPaths.clear ();
 }
 
 void
@@ -119,14 +169,144 @@ Ipv4NixVectorRouting::FlushIpv4RouteCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_ipv4RouteCache.clear ();
+  m_ipv4RouteNixIndex.clear ();
+}
+
+void
+Ipv4NixVectorRouting::CacheNixVector (Ipv4Address dest, Ptr<NixVector> nixVector, const std::vector<uint32_t> & path)
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  InvalidateNixVector (dest);
+  m_nixCache.insert (NixMap_t::value_type (dest, nixVector));
+
+  NixPath & nixPath = m_nixPaths[dest];
+  nixPath.m_seq = g_nextPathSeq++;
+  nixPath.m_nodes = path;
+
+  std::pair<uint32_t, Ipv4Address> key (m_node->GetId (), dest);
+  g_pathsBySeq[nixPath.m_seq] = key;
+  for (std::vector<uint32_t>::const_iterator i = path.begin (); i != path.end (); i++)
+    {
+      g_pathsByNode[*i].insert (key);
+    }
+}
+
+void
+Ipv4NixVectorRouting::InvalidateNixVector (Ipv4Address dest) const
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  m_nixCache.erase (dest);
+  m_ipv4RouteCache.erase (dest);
+  m_ipv4RouteNixIndex.erase (dest);
+
+  std::map<Ipv4Address, NixPath>::iterator it = m_nixPaths.find (dest);
+  if (it == m_nixPaths.end ())
+    {
+      return;
+    }
+  std::pair<uint32_t, Ipv4Address> key (m_node->GetId (), dest);
+  g_pathsBySeq.erase (it->second.m_seq);
+  for (std::vector<uint32_t>::const_iterator i = it->second.m_nodes.begin (); i != it->second.m_nodes.end (); i++)
+    {
+      std::map<uint32_t, std::set<std::pair<uint32_t, Ipv4Address> > >::iterator paths = g_pathsByNode.find (*i);
+      if (paths != g_pathsByNode.end ())
+        {
+          paths->second.erase (key);
+          if (paths->second.empty ())
+            {
+              g_pathsByNode.erase (paths);
+            }
+        }
+    }
+  m_nixPaths.erase (it);
+}
+
+void
+Ipv4NixVectorRouting::InvalidatePath (uint32_t nodeId, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (nodeId << dest);
+
+  Ptr<Ipv4NixVectorRouting> rp;
+  if (nodeId < NodeList::GetNNodes ())
+    {
+      rp = NodeList::GetNode (nodeId)->GetObject<Ipv4NixVectorRouting> ();
+    }
+  if (rp)
+    {
+      rp->InvalidateNixVector (dest);
+    }
+  else
+    {
+      // stale entry, e.g., left by a previous simulation
+      std::pair<uint32_t, Ipv4Address> key (nodeId, dest);
+      for (std::map<uint32_t, std::set<std::pair<uint32_t, Ipv4Address> > >::iterator i = g_pathsByNode.begin (); i != g_pathsByNode.end (); i++)
+        {
+          i->second.erase (key);
+        }
+      for (std::map<uint64_t, std::pair<uint32_t, Ipv4Address> >::iterator i = g_pathsBySeq.begin (); i != g_pathsBySeq.end (); )
+        {
+          if (i->second == key)
+            {
+              g_pathsBySeq.erase (i++);
+            }
+          else
+            {
+              i++;
+            }
+        }
+    }
+}
+
+void
+Ipv4NixVectorRouting::InvalidatePathsThroughNode (uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (nodeId);
+
+  std::map<uint32_t, std::set<std::pair<uint32_t, Ipv4Address> > >::iterator it = g_pathsByNode.find (nodeId);
+  if (it == g_pathsByNode.end ())
+    {
+      return;
+    }
+  // invalidating the paths updates the set, work on a copy
+  std::set<std::pair<uint32_t, Ipv4Address> > paths;
+  paths.swap (it->second);
+  g_pathsByNode.erase (it);
+  NS_LOG_LOGIC ("Invalidating " << paths.size () << " paths through node " << nodeId);
+  for (std::set<std::pair<uint32_t, Ipv4Address> >::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      InvalidatePath (i->first, i->second);
+    }
+}
+
+void
+Ipv4NixVectorRouting::InvalidatePathsSince (uint64_t seq)
+{
+  NS_LOG_FUNCTION (seq);
+
+  std::map<uint64_t, std::pair<uint32_t, Ipv4Address> >::iterator it = g_pathsBySeq.lower_bound (seq);
+  std::vector<std::pair<uint32_t, Ipv4Address> > paths;
+  for (; it != g_pathsBySeq.end (); it++)
+    {
+      paths.push_back (it->second);
+    }
+  NS_LOG_LOGIC ("Invalidating " << paths.size () << " paths computed since " << seq);
+  for (std::vector<std::pair<uint32_t, Ipv4Address> >::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      InvalidatePath (i->first, i->second);
+    }
 }
 
 Ptr<NixVector>
-Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif, std::vector<uint32_t> & path)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
   Ptr<NixVector> nixVector = Create<NixVector> ();
+  path.clear ();
+
+  UpdateTopology ();
 
   // not in cache, must build the nix vector
   // First, we have to figure out the nodes 
@@ -150,17 +330,15 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     {
       // otherwise proceed as normal 
       // and build the nix vector
-      std::vector< Ptr<Node> > parentVector;
-
-      BFS (NodeList::GetNNodes (), source, destNode, parentVector, oif);
-
-      if (BuildNixVector (parentVector, source->GetId (), destNode->GetId (), nixVector))
+      if (BFS (source->GetId (), destNode->GetId (), oif, path)
+          && BuildNixVector (path, nixVector))
         {
           return nixVector;
         }
       else
         {
           NS_LOG_ERROR ("No routing path exists");
+          path.clear ();
           return 0;
         }
     }
@@ -185,14 +363,16 @@ Ipv4NixVectorRouting::GetNixVectorInCache (Ipv4Address address)
 }
 
 Ptr<Ipv4Route>
-Ipv4NixVectorRouting::GetIpv4RouteInCache (Ipv4Address address)
+Ipv4NixVectorRouting::GetIpv4RouteInCache (Ipv4Address address, uint32_t nodeIndex)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
   CheckCacheStateAndFlush ();
 
+  // the route is only valid for packets going to the same neighbor:
+  // packets from different sources can follow different paths
   Ipv4RouteMap_t::iterator iter = m_ipv4RouteCache.find (address);
-  if (iter != m_ipv4RouteCache.end ())
+  if (iter != m_ipv4RouteCache.end () && m_ipv4RouteNixIndex[address] == nodeIndex)
     {
       NS_LOG_LOGIC ("Found Ipv4Route in cache.");
       return iter->second;
@@ -230,75 +410,67 @@ Ipv4NixVectorRouting::BuildNixVectorLocal (Ptr<NixVector> nixVector)
 }
 
 bool
-Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector)
+Ipv4NixVectorRouting::BuildNixVector (const std::vector<uint32_t> & path, Ptr<NixVector> nixVector)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  if (source == dest)
+  // walk the path from the destination, adding the index
+  // of each node among the neighbors of its parent
+  for (uint32_t k = 0; k + 1 < path.size (); k++)
     {
-      return true;
-    }
+      uint32_t dest = path[k];
+      Ptr<Node> parentNode = NodeList::GetNode (path[k + 1]);
 
-  if (parentVector.at (dest) == 0)
-    {
-      return false;
-    }
+      uint32_t numberOfDevices = parentNode->GetNDevices ();
+      uint32_t destId = 0;
+      uint32_t totalNeighbors = 0;
 
-  Ptr<Node> parentNode = parentVector.at (dest);
-
-  uint32_t numberOfDevices = parentNode->GetNDevices ();
-  uint32_t destId = 0;
-  uint32_t totalNeighbors = 0;
-
-  // scan through the net devices on the parent node
-  // and then look at the nodes adjacent to them
-  for (uint32_t i = 0; i < numberOfDevices; i++)
-    {
-      // Get a net device from the node
-      // as well as the channel, and figure
-      // out the adjacent net devices
-      Ptr<NetDevice> localNetDevice = parentNode->GetDevice (i);
-      if (localNetDevice->IsBridge ())
-        {
-          continue;
-        }
-      Ptr<Channel> channel = localNetDevice->GetChannel ();
-      if (channel == 0)
+      // scan through the net devices on the parent node
+      // and then look at the nodes adjacent to them
+      for (uint32_t i = 0; i < numberOfDevices; i++)
         {
-          continue;
-        }
-
-      // this function takes in the local net dev, and channel, and
-      // writes to the netDeviceContainer the adjacent net devs
-      NetDeviceContainer netDeviceContainer;
-      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          // Get a net device from the node
+          // as well as the channel, and figure
+          // out the adjacent net devices
+          Ptr<NetDevice> localNetDevice = parentNode->GetDevice (i);
+          if (localNetDevice->IsBridge ())
+            {
+              continue;
+            }
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
 
-      // Finally we can get the adjacent nodes
-      // and scan through them.  If we find the 
-      // node that matches "dest" then we can add 
-      // the index  to the nix vector.
-      // the index corresponds to the neighbor index
-      uint32_t offset = 0;
-      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
-        {
-          Ptr<Node> remoteNode = (*iter)->GetNode ();
+          // this function takes in the local net dev, and channel, and
+          // writes to the netDeviceContainer the adjacent net devs
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
 
-          if (remoteNode->GetId () == dest)
+          // Finally we can get the adjacent nodes
+          // and scan through them.  If we find the 
+          // node that matches "dest" then we can add 
+          // the index  to the nix vector.
+          // the index corresponds to the neighbor index
+          uint32_t offset = 0;
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
             {
-              destId = totalNeighbors + offset;
+              Ptr<Node> remoteNode = (*iter)->GetNode ();
+
+              if (remoteNode->GetId () == dest)
+                {
+                  destId = totalNeighbors + offset;
+                }
+              offset += 1;
             }
-          offset += 1;
-        }
 
-      totalNeighbors += netDeviceContainer.GetN ();
+          totalNeighbors += netDeviceContainer.GetN ();
+        }
+      NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
+      nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
     }
-  NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
-                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
-  nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
-
-  // recurse through parent vector, grabbing the path 
-  // and building the nix vector
-  BuildNixVector (parentVector, source, (parentVector.at (dest))->GetId (), nixVector);
   return true;
 }
 
@@ -347,27 +519,16 @@ Ipv4NixVectorRouting::GetNodeByIp (Ipv4Address dest)
 { 
   NS_LOG_FUNCTION_NOARGS ();
 
-  NodeContainer allNodes = NodeContainer::GetGlobal ();
-  Ptr<Node> destNode;
+  UpdateTopology ();
 
-  for (NodeContainer::Iterator i = allNodes.Begin (); i != allNodes.End (); ++i)
-    {
-      Ptr<Node> node = *i;
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetInterfaceForAddress (dest) != -1)
-        {
-          destNode = node;
-          break;
-        }
-    }
-
-  if (!destNode)
+  std::map<Ipv4Address, uint32_t>::const_iterator it = g_topology.m_addresses.find (dest);
+  if (it == g_topology.m_addresses.end ())
     {
       NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
       return 0;
     }
 
-  return destNode;
+  return NodeList::GetNode (it->second);
 }
 
 uint32_t
@@ -507,10 +668,11 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
       NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
       // Build the nix-vector, given this node and the
       // dest IP address
-      nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
+      std::vector<uint32_t> path;
+      nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif, path);
 
       // cache it
-      m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+      CacheNixVector (header.GetDestination (), nixVectorInCache, path);
     }
 
   // path exists
@@ -537,7 +699,7 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
 
       // Search here in a cache for this node index 
       // and look for a Ipv4Route
-      rtentry = GetIpv4RouteInCache (header.GetDestination ());
+      rtentry = GetIpv4RouteInCache (header.GetDestination (), nodeIndex);
 
       if (!rtentry || !(rtentry->GetOutputDevice () == oif))
         {
@@ -588,7 +750,8 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
           sockerr = Socket::ERROR_NOTERROR;
 
           // add rtentry to cache
-          m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
+          m_ipv4RouteCache[header.GetDestination ()] = rtentry;
+          m_ipv4RouteNixIndex[header.GetDestination ()] = nodeIndex;
         }
 
       NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: " << nixVectorForPacket->GetRemainingBits ());
@@ -661,7 +824,7 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
   uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
   uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
 
-  rtentry = GetIpv4RouteInCache (header.GetDestination ());
+  rtentry = GetIpv4RouteInCache (header.GetDestination (), nodeIndex);
   // not in cache
   if (!rtentry)
     {
@@ -680,7 +843,8 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
       rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIndex));
 
       // add rtentry to cache
-      m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
+      m_ipv4RouteCache[header.GetDestination ()] = rtentry;
+      m_ipv4RouteNixIndex[header.GetDestination ()] = nodeIndex;
     }
 
   NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
@@ -752,12 +916,39 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
-  g_isCacheDirty = true;
+  if (g_isCacheDirty || m_node == 0)
+    {
+      g_isCacheDirty = true;
+      return;
+    }
+  std::map<std::pair<uint32_t, uint32_t>, uint64_t>::iterator it = g_downInterfaces.find (std::make_pair (m_node->GetId (), i));
+  if (it == g_downInterfaces.end ())
+    {
+      // a new interface, which can shorten any path
+      g_isCacheDirty = true;
+      return;
+    }
+  // The interface is back: the topology is the same as when it went down,
+  // except for the paths computed in the meantime, and the paths through
+  // this node (through this interface, or which could use it again).
+  uint64_t seq = it->second;
+  g_downInterfaces.erase (it);
+  InvalidatePathsThroughNode (m_node->GetId ());
+  InvalidatePathsSince (seq);
+  UpdateInterfaceState (i);
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
-  g_isCacheDirty = true;
+  if (g_isCacheDirty || m_node == 0)
+    {
+      g_isCacheDirty = true;
+      return;
+    }
+  // removing links does not change the paths which do not use them
+  g_downInterfaces.insert (std::make_pair (std::make_pair (m_node->GetId (), i), g_nextPathSeq));
+  InvalidatePathsThroughNode (m_node->GetId ());
+  UpdateInterfaceState (i);
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
@@ -771,151 +962,257 @@ Ipv4NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddr
 }
 
 bool
-Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source, 
-                           Ptr<Node> dest, std::vector< Ptr<Node> > & parentVector,
-                           Ptr<NetDevice> oif)
+Ipv4NixVectorRouting::CanSendThrough (Ptr<Node> node, Ptr<NetDevice> device)
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (ipv4)
+    {
+      uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (device);
+      if (!(ipv4->IsUp (interfaceIndex)))
+        {
+          NS_LOG_LOGIC ("Ipv4Interface is down");
+          return false;
+        }
+    }
+  if (!(device->IsLinkUp ()))
+    {
+      NS_LOG_LOGIC ("Link is down.");
+      return false;
+    }
+  return true;
+}
 
-  NS_LOG_LOGIC ("Going from Node " << source->GetId () << " to Node " << dest->GetId ());
-  std::queue< Ptr<Node> > greyNodeList;  // discovered nodes with unexplored children
+void
+Ipv4NixVectorRouting::UpdateTopology (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
 
-  // reset the parent vector
-  parentVector.clear ();
-  parentVector.reserve (sizeof (Ptr<Node>)*numberOfNodes);
-  parentVector.insert (parentVector.begin (), sizeof (Ptr<Node>)*numberOfNodes, 0); // initialize to 0
+  Topology & t = g_topology;
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+  if (t.m_valid && t.m_outOffsets.size () == numberOfNodes + 1)
+    {
+      return;
+    }
 
-  // Add the source node to the queue, set its parent to itself 
-  greyNodeList.push (source);
-  parentVector.at (source->GetId ()) = source;
+  NS_LOG_LOGIC ("Building the topology snapshot of " << numberOfNodes << " nodes");
+  t.m_outOffsets.assign (1, 0);
+  t.m_outNeighbors.clear ();
+  t.m_outDevices.clear ();
+  t.m_deviceOffsets.clear ();
+  t.m_deviceUp.clear ();
+  t.m_addresses.clear ();
 
-  // BFS loop
-  while (greyNodeList.size () != 0)
+  for (uint32_t n = 0; n < numberOfNodes; n++)
     {
-      Ptr<Node> currNode = greyNodeList.front ();
-      Ptr<Ipv4> ipv4 = currNode->GetObject<Ipv4> ();
- 
-      if (currNode == dest) 
-        {
-          NS_LOG_LOGIC ("Made it to Node " << currNode->GetId ());
-          return true;
-        }
+      Ptr<Node> node = NodeList::GetNode (n);
+      uint32_t firstDevice = t.m_deviceUp.size ();
+      t.m_deviceOffsets.push_back (firstDevice);
 
-      // if this is the first iteration of the loop and a 
-      // specific output interface was given, make sure 
-      // we go this way
-      if (currNode == source && oif)
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
         {
-          // make sure that we can go this way
-          if (ipv4)
-            {
-              uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (oif);
-              if (!(ipv4->IsUp (interfaceIndex)))
-                {
-                  NS_LOG_LOGIC ("Ipv4Interface is down");
-                  return false;
-                }
-            }
-          if (!(oif->IsLinkUp ()))
-            {
-              NS_LOG_LOGIC ("Link is down.");
-              return false;
-            }
-          Ptr<Channel> channel = oif->GetChannel ();
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          t.m_deviceUp.push_back (CanSendThrough (node, localNetDevice));
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
           if (channel == 0)
-            { 
-              return false;
+            {
+              continue;
             }
-
-          // this function takes in the local net dev, and channel, and
-          // writes to the netDeviceContainer the adjacent net devs
           NetDeviceContainer netDeviceContainer;
-          GetAdjacentNetDevices (oif, channel, netDeviceContainer);
-
-          // Finally we can get the adjacent nodes
-          // and scan through them.  We push them
-          // to the greyNode queue, if they aren't 
-          // already there.
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
           for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
             {
-              Ptr<Node> remoteNode = (*iter)->GetNode ();
+              t.m_outNeighbors.push_back ((*iter)->GetNode ()->GetId ());
+              t.m_outDevices.push_back (firstDevice + i);
+            }
+        }
+      t.m_outOffsets.push_back (t.m_outNeighbors.size ());
 
-              // check to see if this node has been pushed before
-              // by checking to see if it has a parent
-              // if it doesn't (null or 0), then set its parent and 
-              // push to the queue
-              if (parentVector.at (remoteNode->GetId ()) == 0)
+      // the first node found with an address owns it, as GetNodeByIp used to do
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (ipv4)
+        {
+          for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+            {
+              for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
                 {
-                  parentVector.at (remoteNode->GetId ()) = currNode;
-                  greyNodeList.push (remoteNode);
+                  t.m_addresses.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), n));
                 }
             }
         }
-      else
+    }
+  t.m_deviceOffsets.push_back (t.m_deviceUp.size ());
+
+  // the in edges are the out edges, grouped by the node they reach
+  t.m_inOffsets.assign (numberOfNodes + 1, 0);
+  for (uint32_t e = 0; e < t.m_outNeighbors.size (); e++)
+    {
+      t.m_inOffsets[t.m_outNeighbors[e] + 1]++;
+    }
+  for (uint32_t n = 0; n < numberOfNodes; n++)
+    {
+      t.m_inOffsets[n + 1] += t.m_inOffsets[n];
+    }
+  t.m_inNeighbors.resize (t.m_outNeighbors.size ());
+  t.m_inDevices.resize (t.m_outNeighbors.size ());
+  std::vector<uint32_t> next (t.m_inOffsets.begin (), t.m_inOffsets.end () - 1);
+  for (uint32_t n = 0; n < numberOfNodes; n++)
+    {
+      for (uint32_t e = t.m_outOffsets[n]; e < t.m_outOffsets[n + 1]; e++)
         {
-          // Iterate over the current node's adjacent vertices
-          // and push them into the queue
-          for (uint32_t i = 0; i < (currNode->GetNDevices ()); i++)
-            {
-              // Get a net device from the node
-              // as well as the channel, and figure
-              // out the adjacent net device
-              Ptr<NetDevice> localNetDevice = currNode->GetDevice (i);
+          uint32_t k = next[t.m_outNeighbors[e]]++;
+          t.m_inNeighbors[k] = n;
+          t.m_inDevices[k] = t.m_outDevices[e];
+        }
+    }
 
-              // make sure that we can go this way
-              if (ipv4)
-                {
-                  uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (currNode->GetDevice (i));
-                  if (!(ipv4->IsUp (interfaceIndex)))
-                    {
-                      NS_LOG_LOGIC ("Ipv4Interface is down");
-                      continue;
-                    }
-                }
-              if (!(localNetDevice->IsLinkUp ()))
+  t.m_stamp = 0;
+  t.m_forwardStamp.assign (numberOfNodes, 0);
+  t.m_backwardStamp.assign (numberOfNodes, 0);
+  t.m_parent.resize (numberOfNodes);
+  t.m_child.resize (numberOfNodes);
+  t.m_forwardDistance.resize (numberOfNodes);
+  t.m_backwardDistance.resize (numberOfNodes);
+  t.m_valid = true;
+}
+
+void
+Ipv4NixVectorRouting::UpdateInterfaceState (uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+
+  Topology & t = g_topology;
+  if (!t.m_valid || m_node == 0 || m_node->GetId () + 1 >= t.m_deviceOffsets.size ())
+    {
+      return;
+    }
+  Ptr<NetDevice> device = m_ipv4->GetNetDevice (interface);
+  uint32_t slot = t.m_deviceOffsets[m_node->GetId ()] + device->GetIfIndex ();
+  if (slot < t.m_deviceOffsets[m_node->GetId () + 1])
+    {
+      t.m_deviceUp[slot] = CanSendThrough (m_node, device);
+    }
+}
+
+bool
+Ipv4NixVectorRouting::BFS (uint32_t source, uint32_t dest, Ptr<NetDevice> oif,
+                           std::vector<uint32_t> & path)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NS_LOG_LOGIC ("Going from Node " << source << " to Node " << dest);
+
+  Topology & t = g_topology;
+  path.clear ();
+  if (source >= t.m_parent.size () || dest >= t.m_parent.size ())
+    {
+      return false;
+    }
+
+  // the stamps tell which nodes were reached by this search,
+  // without clearing the arrays
+  if (++t.m_stamp == 0)
+    {
+      std::fill (t.m_forwardStamp.begin (), t.m_forwardStamp.end (), 0);
+      std::fill (t.m_backwardStamp.begin (), t.m_backwardStamp.end (), 0);
+      t.m_stamp = 1;
+    }
+  uint32_t stamp = t.m_stamp;
+
+  // if a specific output interface was given for the source,
+  // make sure we go this way
+  uint32_t sourceDevice = std::numeric_limits<uint32_t>::max ();
+  if (oif)
+    {
+      sourceDevice = t.m_deviceOffsets[source] + oif->GetIfIndex ();
+    }
+
+  // the forward search sets the parent of the nodes (towards the source),
+  // the backward search sets their child (towards the destination)
+  t.m_forwardStamp[source] = stamp;
+  t.m_parent[source] = source;
+  t.m_forwardDistance[source] = 0;
+  t.m_backwardStamp[dest] = stamp;
+  t.m_child[dest] = dest;
+  t.m_backwardDistance[dest] = 0;
+
+  uint32_t meetingNode = source;
+  bool met = (source == dest);
+  uint32_t meetingDistance = std::numeric_limits<uint32_t>::max ();
+
+  // discovered nodes with unexplored neighbors, on each side
+  std::vector<uint32_t> forwardNodes (1, source);
+  std::vector<uint32_t> backwardNodes (1, dest);
+  std::vector<uint32_t> nextNodes;
+
+  // Expand a whole level of the smallest frontier at a time, so that
+  // the shortest path is found among the nodes where the searches meet.
+  // The backward search can stop early (e.g., with bridges), the forward
+  // one then finishes the search alone.
+  while (!forwardNodes.empty () && !met)
+    {
+      bool forward = backwardNodes.empty () || forwardNodes.size () <= backwardNodes.size ();
+      std::vector<uint32_t> & currNodes = forward ? forwardNodes : backwardNodes;
+      const std::vector<uint32_t> & offsets = forward ? t.m_outOffsets : t.m_inOffsets;
+      const std::vector<uint32_t> & neighbors = forward ? t.m_outNeighbors : t.m_inNeighbors;
+      const std::vector<uint32_t> & devices = forward ? t.m_outDevices : t.m_inDevices;
+      std::vector<uint32_t> & reachedStamp = forward ? t.m_forwardStamp : t.m_backwardStamp;
+      std::vector<uint32_t> & otherStamp = forward ? t.m_backwardStamp : t.m_forwardStamp;
+      std::vector<uint32_t> & reachedVector = forward ? t.m_parent : t.m_child;
+      std::vector<uint32_t> & reachedDistance = forward ? t.m_forwardDistance : t.m_backwardDistance;
+      std::vector<uint32_t> & otherDistance = forward ? t.m_backwardDistance : t.m_forwardDistance;
+
+      nextNodes.clear ();
+      for (std::vector<uint32_t>::const_iterator i = currNodes.begin (); i != currNodes.end (); i++)
+        {
+          uint32_t currNode = *i;
+          for (uint32_t e = offsets[currNode]; e < offsets[currNode + 1]; e++)
+            {
+              uint32_t id = neighbors[e];
+              if (!t.m_deviceUp[devices[e]] || reachedStamp[id] == stamp)
                 {
-                  NS_LOG_LOGIC ("Link is down.");
                   continue;
                 }
-              Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
-                { 
+              // the sending node of the edge is currNode going forward, id going backward
+              if ((forward ? currNode : id) == source && oif && devices[e] != sourceDevice)
+                {
                   continue;
                 }
-
-              // this function takes in the local net dev, and channel, and
-              // writes to the netDeviceContainer the adjacent net devs
-              NetDeviceContainer netDeviceContainer;
-              GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
-              // Finally we can get the adjacent nodes
-              // and scan through them.  We push them
-              // to the greyNode queue, if they aren't 
-              // already there.
-              for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+              reachedStamp[id] = stamp;
+              reachedVector[id] = currNode;
+              reachedDistance[id] = reachedDistance[currNode] + 1;
+              nextNodes.push_back (id);
+              if (otherStamp[id] == stamp && otherDistance[id] < meetingDistance)
                 {
-                  Ptr<Node> remoteNode = (*iter)->GetNode ();
-
-                  // check to see if this node has been pushed before
-                  // by checking to see if it has a parent
-                  // if it doesn't (null or 0), then set its parent and 
-                  // push to the queue
-                  if (parentVector.at (remoteNode->GetId ()) == 0)
-                    {
-                      parentVector.at (remoteNode->GetId ()) = currNode;
-                      greyNodeList.push (remoteNode);
-                    }
+                  meetingNode = id;
+                  meetingDistance = otherDistance[id];
+                  met = true;
                 }
             }
         }
+      currNodes.swap (nextNodes);
+    }
 
-      // Pop off the head grey node.  We have all its children.
-      // It is now black.
-      greyNodeList.pop ();
+  if (!met)
+    {
+      // Didn't find the dest...
+      return false;
     }
 
-  // Didn't find the dest...
-  return false;
+  NS_LOG_LOGIC ("Searches met at Node " << meetingNode);
+  // the path runs from the destination to the meeting node,
+  // then up to the source
+  for (uint32_t node = meetingNode; node != dest; node = t.m_child[node])
+    {
+      path.push_back (node);
+    }
+  path.push_back (dest);
+  std::reverse (path.begin (), path.end ());
+  for (uint32_t node = meetingNode; node != source; )
+    {
+      node = t.m_parent[node];
+      path.push_back (node);
+    }
+  return true;
 }
 
 void 
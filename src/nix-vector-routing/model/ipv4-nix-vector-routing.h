@@ -22,6 +22,8 @@
 #define IPV4_NIX_VECTOR_ROUTING_H
 
 #include <map>
+#include <set>
+#include <vector>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -33,6 +35,9 @@
 #include "ns3/bridge-net-device.h"
 #include "ns3/nstime.h"
 
+/// Base class of the nix-vector routing test cases
+class NixVectorRoutingTestCase;
+
 namespace ns3 {
 
 /**
@@ -60,6 +65,11 @@ typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
 public:
+  /**
+   * Declared friend to enable unit tests.
+   */
+  friend class ::NixVectorRoutingTestCase;
+
   Ipv4NixVectorRouting ();
   ~Ipv4NixVectorRouting ();
   /**
@@ -79,7 +89,10 @@ public:
   /**
    * @brief Called when run-time link topology change occurs
    * which iterates through the node list and flushes any
-   * nix vector caches
+   * nix vector caches.  Interfaces going down, and coming back
+   * up, only invalidate the cached paths that they affect
+   * (see NotifyInterfaceDown and NotifyInterfaceUp), while the
+   * other topology changes flush all the caches.
    *
    * \internal
    * \c const is used here due to need to potentially flush the cache
@@ -114,26 +127,65 @@ private:
    * BFS, accounting for any output interface specified, and finally
    * BuildNixVector to return the built nix-vector
    *
-   * \param source Source node
-   * \param dest Destination node address
-   * \param oif Preferred output interface
+   * \param [in] source Source node
+   * \param [in] dest Destination node address
+   * \param [in] oif Preferred output interface
+   * \param [out] path The ids of the nodes crossed by the path, from the destination to the source
    * \returns The NixVector to be used in routing.
    */
-  Ptr<NixVector> GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif);
+  Ptr<NixVector> GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif, std::vector<uint32_t> & path);
 
   /**
-   * Checks the cache based on dest IP for the nix-vector
+   * Adds a nix-vector to the cache, and records the nodes crossed
+   * by its path so that it can be invalidated when they change
+   * \param dest Destination address
+   * \param nixVector The nix-vector (null if there is no path)
+   * \param path The ids of the nodes crossed by the path
+   */
+  void CacheNixVector (Ipv4Address dest, Ptr<NixVector> nixVector, const std::vector<uint32_t> & path);
+
+  /**
+   * Removes the nix-vector (and the Ipv4Route) cached for a
+   * destination, and its dependencies
+   * \param dest Destination address
+   */
+  void InvalidateNixVector (Ipv4Address dest) const;
+
+  /**
+   * Removes the nix-vectors cached by all the nodes whose path
+   * crosses a node
+   * \param nodeId the id of the node
+   */
+  static void InvalidatePathsThroughNode (uint32_t nodeId);
+
+  /**
+   * Removes the nix-vectors cached by all the nodes since a point in time
+   * \param seq the sequence number of the first nix-vector to remove
+   */
+  static void InvalidatePathsSince (uint64_t seq);
+
+  /**
+   * Removes a nix-vector cached by a node
+   * \param nodeId the id of the node caching the nix-vector
+   * \param dest Destination address
+   */
+  static void InvalidatePath (uint32_t nodeId, Ipv4Address dest);
+
+  /**
+   * Checks the cache based on dest IP for the Ipv4Route built
+   * for a given neighbor index
    * \param address Address to check
-   * \returns The NixVector to be used in routing.
+   * \param nodeIndex Nix neighbor index of the next hop
+   * \returns The cached route, or null if none, or built for another neighbor.
    */
-  Ptr<NixVector> GetNixVectorInCache (Ipv4Address address);
+  Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address address, uint32_t nodeIndex);
 
   /**
-   * Checks the cache based on dest IP for the Ipv4Route
+   * Checks the cache based on dest IP for the nix-vector
    * \param address Address to check
-   * \returns The cached route.
+   * \returns The NixVector to be used in routing.
    */
-  Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address address);
+  Ptr<NixVector> GetNixVectorInCache (Ipv4Address address);
 
   /**
    * Given a net-device returns all the adjacent net-devices,
@@ -145,22 +197,20 @@ private:
   void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
 
   /**
-   * Iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address
+   * Finds the node corresponding to the given Ipv4Address
+   * in the topology snapshot
    * \param dest destination node IP
    * \return The node with the specified IP.
    */
   Ptr<Node> GetNodeByIp (Ipv4Address dest);
 
   /**
-   * Recurses the parent vector, created by BFS and actually builds the nixvector
-   * \param [in] parentVector Parent vector for retracing routes
-   * \param [in] source Source Node index
-   * \param [in] dest Destination Node index
+   * Walks the path, found by BFS, and actually builds the nixvector
+   * \param [in] path Ids of the nodes of the path, from the destination to the source
    * \param [out] nixVector the NixVector to be used for routing
    * \returns true on success, false otherwise.
    */
-  bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
+  bool BuildNixVector (const std::vector<uint32_t> & path, Ptr<NixVector> nixVector);
 
   /**
    * Special variation of BuildNixVector for when a node is sending to itself
@@ -194,19 +244,41 @@ private:
   uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp);
 
   /**
-   * \brief Breadth first search algorithm.
-   * \param [in] numberOfNodes total number of nodes
-   * \param [in] source Source Node
-   * \param [in] dest Destination Node
-   * \param [out] parentVector Parent vector for retracing routes
+   * Checks whether a node can send packets through one of its devices
+   * \param node The node
+   * \param device The device of the node
+   * \returns true if the Ipv4 interface and the link of the device are up.
+   */
+  static bool CanSendThrough (Ptr<Node> node, Ptr<NetDevice> device);
+
+  /**
+   * Builds the topology snapshot, if it is not up to date
+   */
+  void UpdateTopology (void);
+
+  /**
+   * Updates the state of the device of an interface in the topology snapshot
+   * \param interface The interface index
+   */
+  void UpdateInterfaceState (uint32_t interface);
+
+  /**
+   * \brief Bidirectional breadth first search algorithm.
+   *
+   * Searches the topology snapshot from the source and from the
+   * destination at the same time, expanding the smallest frontier,
+   * until they meet.
+   *
+   * \param [in] source Source Node id
+   * \param [in] dest Destination Node id
    * \param [in] oif specific output interface to use from source node, if not null
+   * \param [out] path Ids of the nodes of the path, from the destination to the source
    * \returns false if dest not found, true o.w.
    */
-  bool BFS (uint32_t numberOfNodes,
-            Ptr<Node> source,
-            Ptr<Node> dest,
-            std::vector< Ptr<Node> > & parentVector,
-            Ptr<NetDevice> oif);
+  bool BFS (uint32_t source,
+            uint32_t dest,
+            Ptr<NetDevice> oif,
+            std::vector<uint32_t> & path);
 
   void DoDispose (void);
 
@@ -239,6 +311,71 @@ private:
   /** Cache stores Ipv4Routes based on destination ip */
   mutable Ipv4RouteMap_t m_ipv4RouteCache;
 
+  /** Nix neighbor index of the next hop of the Ipv4Routes in cache */
+  mutable std::map<Ipv4Address, uint32_t> m_ipv4RouteNixIndex;
+
+  /**
+   * \ingroup nix-vector-routing
+   * Path of a cached nix-vector
+   */
+  struct NixPath
+  {
+    uint64_t m_seq;                //!< Sequence number of the computation of the path
+    std::vector<uint32_t> m_nodes; //!< Ids of the nodes crossed by the path
+  };
+
+  /** Paths of the nix-vectors in cache, based on destination ip */
+  mutable std::map<Ipv4Address, NixPath> m_nixPaths;
+
+  /** Cached paths (source node id and destination) crossing each node, by node id */
+  static std::map<uint32_t, std::set<std::pair<uint32_t, Ipv4Address> > > g_pathsByNode;
+
+  /** Cached paths (source node id and destination), by sequence number */
+  static std::map<uint64_t, std::pair<uint32_t, Ipv4Address> > g_pathsBySeq;
+
+  /** Sequence number of the next computed path */
+  static uint64_t g_nextPathSeq;
+
+  /** Interfaces (node id and interface index) which are down, with the sequence number when they went down */
+  static std::map<std::pair<uint32_t, uint32_t>, uint64_t> g_downInterfaces;
+
+  /** Number of instances not disposed yet, sharing the tables above */
+  static uint32_t g_nInstances;
+
+  /**
+   * \ingroup nix-vector-routing
+   * Snapshot of the topology, shared by all the nodes, with the
+   * adjacency lists of the nodes in compressed sparse row form.
+   * It is rebuilt when the caches are flushed, while interfaces
+   * going down and up only update the state of their device.
+   */
+  struct Topology
+  {
+    Topology ();
+
+    bool m_valid;                          //!< Whether the snapshot is up to date
+    std::vector<uint32_t> m_outOffsets;    //!< Index of the first out edge of each node, followed by the number of edges
+    std::vector<uint32_t> m_outNeighbors;  //!< Node reached by each out edge
+    std::vector<uint32_t> m_outDevices;    //!< Device (index in m_deviceUp) of each out edge
+    std::vector<uint32_t> m_inOffsets;     //!< Index of the first in edge of each node, followed by the number of edges
+    std::vector<uint32_t> m_inNeighbors;   //!< Node sending through each in edge
+    std::vector<uint32_t> m_inDevices;     //!< Device (index in m_deviceUp) of each in edge
+    std::vector<uint32_t> m_deviceOffsets; //!< Index in m_deviceUp of the first device of each node
+    std::vector<uint8_t> m_deviceUp;       //!< Whether each node can send through each of its devices
+    std::map<Ipv4Address, uint32_t> m_addresses; //!< Node of each address
+
+    uint32_t m_stamp;                         //!< Number of the current search
+    std::vector<uint32_t> m_forwardStamp;     //!< Search in which each node was reached from the source
+    std::vector<uint32_t> m_backwardStamp;    //!< Search in which each node was reached from the destination
+    std::vector<uint32_t> m_parent;           //!< Previous node on the path from the source
+    std::vector<uint32_t> m_child;            //!< Next node on the path to the destination
+    std::vector<uint32_t> m_forwardDistance;  //!< Distance from the source
+    std::vector<uint32_t> m_backwardDistance; //!< Distance to the destination
+  };
+
+  /** The topology snapshot */
+  static Topology g_topology;
+
   Ptr<Ipv4> m_ipv4; //!< IPv4 object
   Ptr<Node> m_node; //!< Node object
 
@@ -0,0 +1,769 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <deque>
+#include <limits>
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/boolean.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \defgroup nix-vector-routing-test Nix-vector routing module tests
+ */
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Base class of the nix-vector routing tests, building the
+ * topologies and giving access to the caches of the routing protocol.
+ *
+ * The links are made of SimpleNetDevices: a SimpleChannel with two
+ * devices in point-to-point mode stands for a point-to-point link, and
+ * a SimpleChannel shared by more devices for a CSMA segment.
+ */
+class NixVectorRoutingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the test case name
+   */
+  NixVectorRoutingTestCase (std::string name);
+
+protected:
+  /**
+   * Create nodes with IPv4 and the nix-vector routing
+   * \param n the number of nodes
+   */
+  void CreateNodes (uint32_t n);
+  /**
+   * Connect nodes with a new channel, in a new /24 network
+   * \param nodes the ids of the nodes
+   */
+  void Connect (std::vector<uint32_t> nodes);
+  /**
+   * Connect two nodes with a point-to-point link
+   * \param a the id of the first node
+   * \param b the id of the second node
+   */
+  void Connect (uint32_t a, uint32_t b);
+  /**
+   * Get an address of a node
+   * \param node the id of the node
+   * \returns the first address of the first interface with a channel
+   */
+  Ipv4Address GetAddress (uint32_t node);
+  /**
+   * Get the interface of a node towards another node
+   * \param node the id of the node
+   * \param neighbor the id of the neighbor
+   * \returns the index of the interface of node on a channel to neighbor
+   */
+  uint32_t GetInterface (uint32_t node, uint32_t neighbor);
+  /**
+   * Route a packet from a node
+   * \param source the id of the source node
+   * \param dest the id of the destination node
+   * \returns the route
+   */
+  Ptr<Ipv4Route> RouteOutput (uint32_t source, uint32_t dest);
+  /**
+   * Check whether a node has a nix-vector in cache
+   * \param source the id of the node
+   * \param dest the id of the destination node
+   * \returns true if a nix-vector (or the lack of a path) is cached
+   */
+  bool IsCached (uint32_t source, uint32_t dest);
+  /**
+   * Get the path of a nix-vector in cache
+   * \param source the id of the node
+   * \param dest the id of the destination node
+   * \returns the ids of the nodes crossed by the path, from the destination
+   */
+  std::vector<uint32_t> GetCachedPath (uint32_t source, uint32_t dest);
+  /**
+   * Search a path in the topology snapshot, bypassing the caches
+   * \param source the id of the source node
+   * \param dest the id of the destination node
+   * \param [out] path the ids of the nodes crossed by the path, from the destination
+   * \returns true if a path was found
+   */
+  bool SearchPath (uint32_t source, uint32_t dest, std::vector<uint32_t> & path);
+  /**
+   * Get the number of searches run on the topology snapshot since it was built
+   * \returns the number of searches
+   */
+  static uint32_t GetSearchCount (void);
+  /**
+   * Check whether the tables shared by the instances are in their initial state
+   * \returns true if the tables are empty
+   */
+  static bool AreSharedTablesReset (void);
+  /**
+   * Check whether the tables shared by the instances record a path or
+   * an interface down
+   * \returns true if a path or an interface down is recorded
+   */
+  static bool AreSharedTablesUsed (void);
+
+  /**
+   * Get the routing protocol of a node
+   * \param node the id of the node
+   * \returns the routing protocol
+   */
+  Ptr<Ipv4NixVectorRouting> GetRouting (uint32_t node);
+
+  NodeContainer m_nodes;   //!< The nodes
+  uint32_t m_nNetworks;    //!< Number of networks created
+};
+
+NixVectorRoutingTestCase::NixVectorRoutingTestCase (std::string name)
+  : TestCase (name),
+    m_nNetworks (0)
+{
+}
+
+void
+NixVectorRoutingTestCase::CreateNodes (uint32_t n)
+{
+  m_nodes = NodeContainer ();
+  m_nNetworks = 0;
+  m_nodes.Create (n);
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (Ipv4NixVectorHelper ());
+  internet.Install (m_nodes);
+}
+
+void
+NixVectorRoutingTestCase::Connect (std::vector<uint32_t> nodes)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (std::vector<uint32_t>::const_iterator it = nodes.begin (); it != nodes.end (); it++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("PointToPointMode", BooleanValue (nodes.size () == 2));
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      m_nodes.Get (*it)->AddDevice (device);
+      devices.Add (device);
+    }
+  std::ostringstream network;
+  network << "10." << 1 + m_nNetworks / 256 << "." << m_nNetworks % 256 << ".0";
+  m_nNetworks++;
+  Ipv4AddressHelper addresses;
+  addresses.SetBase (Ipv4Address (network.str ().c_str ()), "255.255.255.0");
+  addresses.Assign (devices);
+}
+
+void
+NixVectorRoutingTestCase::Connect (uint32_t a, uint32_t b)
+{
+  std::vector<uint32_t> nodes;
+  nodes.push_back (a);
+  nodes.push_back (b);
+  Connect (nodes);
+}
+
+Ipv4Address
+NixVectorRoutingTestCase::GetAddress (uint32_t node)
+{
+  Ptr<Ipv4> ipv4 = m_nodes.Get (node)->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      if (ipv4->GetNetDevice (i)->GetChannel () != 0 && ipv4->GetNAddresses (i) > 0)
+        {
+          return ipv4->GetAddress (i, 0).GetLocal ();
+        }
+    }
+  return Ipv4Address ();
+}
+
+uint32_t
+NixVectorRoutingTestCase::GetInterface (uint32_t node, uint32_t neighbor)
+{
+  Ptr<Ipv4> ipv4 = m_nodes.Get (node)->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      Ptr<Channel> channel = ipv4->GetNetDevice (i)->GetChannel ();
+      for (uint32_t j = 0; channel != 0 && j < channel->GetNDevices (); j++)
+        {
+          if (channel->GetDevice (j)->GetNode ()->GetId () == neighbor)
+            {
+              return i;
+            }
+        }
+    }
+  NS_FATAL_ERROR ("Node " << node << " is not connected to node " << neighbor);
+  return 0;
+}
+
+Ptr<Ipv4NixVectorRouting>
+NixVectorRoutingTestCase::GetRouting (uint32_t node)
+{
+  return m_nodes.Get (node)->GetObject<Ipv4NixVectorRouting> ();
+}
+
+Ptr<Ipv4Route>
+NixVectorRoutingTestCase::RouteOutput (uint32_t source, uint32_t dest)
+{
+  Ipv4Header header;
+  header.SetSource (GetAddress (source));
+  header.SetDestination (GetAddress (dest));
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4RoutingProtocol> routing = GetRouting (source);
+  return routing->RouteOutput (0, header, 0, sockerr);
+}
+
+bool
+NixVectorRoutingTestCase::IsCached (uint32_t source, uint32_t dest)
+{
+  return GetRouting (source)->m_nixCache.count (GetAddress (dest)) > 0;
+}
+
+std::vector<uint32_t>
+NixVectorRoutingTestCase::GetCachedPath (uint32_t source, uint32_t dest)
+{
+  Ptr<Ipv4NixVectorRouting> routing = GetRouting (source);
+  std::map<Ipv4Address, Ipv4NixVectorRouting::NixPath>::const_iterator it = routing->m_nixPaths.find (GetAddress (dest));
+  if (it == routing->m_nixPaths.end ())
+    {
+      return std::vector<uint32_t> ();
+    }
+  return it->second.m_nodes;
+}
+
+bool
+NixVectorRoutingTestCase::SearchPath (uint32_t source, uint32_t dest, std::vector<uint32_t> & path)
+{
+  return GetRouting (source)->GetNixVector (m_nodes.Get (source), GetAddress (dest), 0, path) != 0;
+}
+
+uint32_t
+NixVectorRoutingTestCase::GetSearchCount (void)
+{
+  return Ipv4NixVectorRouting::g_topology.m_stamp;
+}
+
+bool
+NixVectorRoutingTestCase::AreSharedTablesReset (void)
+{
+  return Ipv4NixVectorRouting::g_nInstances == 0
+         && Ipv4NixVectorRouting::g_pathsByNode.empty ()
+         && Ipv4NixVectorRouting::g_pathsBySeq.empty ()
+         && Ipv4NixVectorRouting::g_downInterfaces.empty ()
+         && Ipv4NixVectorRouting::g_nextPathSeq == 0
+         && !Ipv4NixVectorRouting::g_isCacheDirty
+         && !Ipv4NixVectorRouting::g_topology.m_valid
+         && Ipv4NixVectorRouting::g_topology.m_outNeighbors.empty ();
+}
+
+bool
+NixVectorRoutingTestCase::AreSharedTablesUsed (void)
+{
+  return !Ipv4NixVectorRouting::g_pathsByNode.empty ()
+         && !Ipv4NixVectorRouting::g_pathsBySeq.empty ()
+         && !Ipv4NixVectorRouting::g_downInterfaces.empty ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check the paths invalidated by an interface going down and up.
+ *
+ * The nodes form a ring of five point-to-point links.  An interface of
+ * node 1 going down must only invalidate the cached paths crossing node 1.
+ * When it comes back up, the paths computed while it was down must be
+ * invalidated too, as they may not be the shortest ones anymore, while
+ * the paths computed before are kept.
+ */
+class NixVectorInterfaceDownUpTest : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorInterfaceDownUpTest ();
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorInterfaceDownUpTest::NixVectorInterfaceDownUpTest ()
+  : NixVectorRoutingTestCase ("Paths invalidated by an interface going down and up")
+{
+}
+
+void
+NixVectorInterfaceDownUpTest::DoRun (void)
+{
+  CreateNodes (5);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Connect (i, (i + 1) % 5);
+    }
+
+  uint32_t viaNode1[] = { 2, 1, 0 };
+  uint32_t viaNodes4And3[] = { 2, 3, 4, 0 };
+
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (0, 2), 0, "No route from node 0 to node 2");
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (2, 0), 0, "No route from node 2 to node 0");
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (0, 3), 0, "No route from node 0 to node 3");
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (4, 2), 0, "No route from node 4 to node 2");
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (3, 0), 0, "No route from node 3 to node 0");
+  NS_TEST_EXPECT_MSG_EQ ((GetCachedPath (0, 2) == std::vector<uint32_t> (viaNode1, viaNode1 + 3)), true,
+                         "Node 0 does not reach node 2 through node 1");
+
+  // the link from node 1 to node 2 goes down
+  Ptr<Ipv4> ipv4 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t interface = GetInterface (1, 2);
+  ipv4->SetDown (interface);
+
+  NS_TEST_EXPECT_MSG_EQ (IsCached (0, 2), false, "Path from node 0 to node 2 through node 1 not invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (2, 0), false, "Path from node 2 to node 0 through node 1 not invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (0, 3), true, "Path from node 0 to node 3 invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (4, 2), true, "Path from node 4 to node 2 invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (3, 0), true, "Path from node 3 to node 0 invalidated");
+
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (0, 2), 0, "No route from node 0 to node 2 with the link down");
+  NS_TEST_EXPECT_MSG_EQ ((GetCachedPath (0, 2) == std::vector<uint32_t> (viaNodes4And3, viaNodes4And3 + 4)), true,
+                         "Node 0 does not reach node 2 around the link down");
+
+  // the link comes back up: the path computed in the meantime, which does
+  // not cross node 1, is invalidated, but not those computed before
+  ipv4->SetUp (interface);
+
+  NS_TEST_EXPECT_MSG_EQ (IsCached (0, 2), false, "Path computed with the link down not invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (0, 3), true, "Path from node 0 to node 3 invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (4, 2), true, "Path from node 4 to node 2 invalidated");
+  NS_TEST_EXPECT_MSG_EQ (IsCached (3, 0), true, "Path from node 3 to node 0 invalidated");
+
+  NS_TEST_EXPECT_MSG_NE (RouteOutput (0, 2), 0, "No route from node 0 to node 2 with the link up");
+  NS_TEST_EXPECT_MSG_EQ ((GetCachedPath (0, 2) == std::vector<uint32_t> (viaNode1, viaNode1 + 3)), true,
+                         "Node 0 does not reach node 2 through node 1 again");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check the routes of a transit node for packets going to the
+ * same destination through different neighbors.
+ *
+ * Node 1 is connected to nodes 0, 2 and 3.  It receives packets for the
+ * same destination whose nix-vectors select different neighbors, as
+ * packets from different sources can do.  Each must be forwarded to the
+ * neighbor of its nix-vector, rather than along the route cached for the
+ * previous packet.
+ */
+class NixVectorTransitRouteTest : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorTransitRouteTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Forward a packet from node 0 through node 1
+   * \param neighborIndex the nix neighbor index of the next hop
+   * \returns the route used by node 1
+   */
+  Ptr<Ipv4Route> Forward (uint32_t neighborIndex);
+  /**
+   * Unicast forward callback, recording the route
+   * \param route the route
+   * \param p the packet
+   * \param header the IPv4 header
+   */
+  void UnicastForward (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header);
+
+  Ptr<Ipv4Route> m_route; //!< Route of the last forwarded packet
+};
+
+NixVectorTransitRouteTest::NixVectorTransitRouteTest ()
+  : NixVectorRoutingTestCase ("Routes of a transit node towards different neighbors")
+{
+}
+
+void
+NixVectorTransitRouteTest::UnicastForward (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  m_route = route;
+}
+
+Ptr<Ipv4Route>
+NixVectorTransitRouteTest::Forward (uint32_t neighborIndex)
+{
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  nixVector->AddNeighborIndex (neighborIndex, nixVector->BitCount (3));
+  Ptr<Packet> p = Create<Packet> (100);
+  p->SetNixVector (nixVector);
+  Ipv4Header header;
+  header.SetSource (GetAddress (0));
+  header.SetDestination (Ipv4Address ("10.200.0.1"));
+  Ptr<Ipv4> ipv4 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  Ptr<Ipv4RoutingProtocol> routing = GetRouting (1);
+  m_route = 0;
+  routing->RouteInput (p, header, ipv4->GetNetDevice (GetInterface (1, 0)),
+                       MakeCallback (&NixVectorTransitRouteTest::UnicastForward, this),
+                       Ipv4RoutingProtocol::MulticastForwardCallback (),
+                       Ipv4RoutingProtocol::LocalDeliverCallback (),
+                       Ipv4RoutingProtocol::ErrorCallback ());
+  return m_route;
+}
+
+void
+NixVectorTransitRouteTest::DoRun (void)
+{
+  CreateNodes (4);
+  Connect (1, 0);
+  Connect (1, 2);
+  Connect (1, 3);
+  Ptr<Ipv4> ipv4 = m_nodes.Get (1)->GetObject<Ipv4> ();
+
+  // the neighbors of node 1 are indexed in the order of its devices
+  uint32_t neighbors[] = { 2, 3, 2, 2, 3 };
+  for (uint32_t i = 0; i < sizeof (neighbors) / sizeof (neighbors[0]); i++)
+    {
+      uint32_t neighbor = neighbors[i];
+      Ptr<Ipv4Route> route = Forward (neighbor - 1);
+      NS_TEST_ASSERT_MSG_NE (route, 0, "Packet " << i << " not forwarded");
+      NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), GetAddress (neighbor), "Wrong gateway for packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), ipv4->GetNetDevice (GetInterface (1, neighbor)),
+                             "Wrong output device for packet " << i);
+    }
+
+  m_route = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check that the tables shared by the nix-vector routing instances
+ * are reset when the last instance is disposed.
+ *
+ * A simulation leaves paths in cache and an interface down.  Once it is
+ * destroyed, the shared tables must be empty, so that the next simulation
+ * does not find stale paths, node ids or interfaces in them.
+ */
+class NixVectorDisposeTest : public NixVectorRoutingTestCase
+{
+public:
+  NixVectorDisposeTest ();
+private:
+  virtual void DoRun (void);
+};
+
+NixVectorDisposeTest::NixVectorDisposeTest ()
+  : NixVectorRoutingTestCase ("Shared tables reset when the last instance is disposed")
+{
+}
+
+void
+NixVectorDisposeTest::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (AreSharedTablesReset (), true, "Shared tables not reset before the test");
+
+  for (uint32_t run = 0; run < 2; run++)
+    {
+      CreateNodes (4);
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          Connect (i, (i + 1) % 4);
+        }
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          RouteOutput (i, (i + 2) % 4);
+        }
+      m_nodes.Get (1)->GetObject<Ipv4> ()->SetDown (GetInterface (1, 2));
+      NS_TEST_EXPECT_MSG_NE (RouteOutput (1, 2), 0, "No route from node 1 to node 2 in run " << run);
+      NS_TEST_EXPECT_MSG_EQ (AreSharedTablesUsed (), true, "No path or interface down recorded in run " << run);
+
+      m_nodes = NodeContainer ();
+      Simulator::Destroy ();
+      NS_TEST_EXPECT_MSG_EQ (AreSharedTablesReset (), true, "Shared tables not reset after run " << run);
+    }
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Check the paths found in the topology snapshot against a
+ * reference breadth first search.
+ *
+ * For each pair of nodes, the path must be a valid path through devices
+ * that are up, as long as the shortest path found by the reference
+ * search, or not exist if the reference search finds none.  Interfaces
+ * going down and up only update the state of their device in the
+ * snapshot, which must be taken into account without rebuilding it.
+ */
+class NixVectorBfsTest : public NixVectorRoutingTestCase
+{
+public:
+  /**
+   * Constructor
+   * \param csma whether the nodes are connected by CSMA segments, rather
+   * than point-to-point links
+   */
+  NixVectorBfsTest (bool csma);
+private:
+  virtual void DoRun (void);
+  /**
+   * Check whether a node can send through a device, as the reference
+   * \param node the id of the node
+   * \param device the device
+   * \returns true if the interface of the device and its link are up
+   */
+  bool IsUp (uint32_t node, Ptr<NetDevice> device);
+  /**
+   * Compute the distances from a node with a reference breadth first search
+   * \param source the id of the node
+   * \returns the distance to each node, or the maximum value if not reachable
+   */
+  std::vector<uint32_t> GetDistances (uint32_t source);
+  /**
+   * Check whether a node can send to another through a device which is up
+   * \param from the id of the sending node
+   * \param to the id of the receiving node
+   * \returns true if the nodes are neighbors
+   */
+  bool CanSend (uint32_t from, uint32_t to);
+  /**
+   * Check the paths between all the pairs of nodes
+   * \param context description of the state of the topology
+   */
+  void CheckPaths (std::string context);
+
+  bool m_csma; //!< Whether the nodes are connected by CSMA segments
+};
+
+NixVectorBfsTest::NixVectorBfsTest (bool csma)
+  : NixVectorRoutingTestCase (csma ? "Paths found in a CSMA topology" : "Paths found in a point-to-point topology"),
+    m_csma (csma)
+{
+}
+
+bool
+NixVectorBfsTest::IsUp (uint32_t node, Ptr<NetDevice> device)
+{
+  Ptr<Ipv4> ipv4 = m_nodes.Get (node)->GetObject<Ipv4> ();
+  return ipv4->IsUp (ipv4->GetInterfaceForDevice (device)) && device->IsLinkUp ();
+}
+
+bool
+NixVectorBfsTest::CanSend (uint32_t from, uint32_t to)
+{
+  Ptr<Node> node = m_nodes.Get (from);
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      Ptr<Channel> channel = device->GetChannel ();
+      if (channel == 0 || !IsUp (from, device))
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          if (channel->GetDevice (j) != device && channel->GetDevice (j)->GetNode ()->GetId () == to)
+            {
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+std::vector<uint32_t>
+NixVectorBfsTest::GetDistances (uint32_t source)
+{
+  uint32_t n = m_nodes.GetN ();
+  std::vector<uint32_t> distances (n, std::numeric_limits<uint32_t>::max ());
+  std::deque<uint32_t> queue;
+  distances[source] = 0;
+  queue.push_back (source);
+  while (!queue.empty ())
+    {
+      uint32_t node = queue.front ();
+      queue.pop_front ();
+      for (uint32_t next = 0; next < n; next++)
+        {
+          if (distances[next] == std::numeric_limits<uint32_t>::max () && CanSend (node, next))
+            {
+              distances[next] = distances[node] + 1;
+              queue.push_back (next);
+            }
+        }
+    }
+  return distances;
+}
+
+void
+NixVectorBfsTest::CheckPaths (std::string context)
+{
+  for (uint32_t source = 0; source < m_nodes.GetN (); source++)
+    {
+      std::vector<uint32_t> distances = GetDistances (source);
+      for (uint32_t dest = 0; dest < m_nodes.GetN (); dest++)
+        {
+          if (dest == source)
+            {
+              continue;
+            }
+          std::vector<uint32_t> path;
+          bool found = SearchPath (source, dest, path);
+          bool reachable = distances[dest] != std::numeric_limits<uint32_t>::max ();
+          NS_TEST_EXPECT_MSG_EQ (found, reachable, "Wrong existence of a path from node " << source
+                                 << " to node " << dest << " " << context);
+          if (!found || !reachable)
+            {
+              continue;
+            }
+          NS_TEST_EXPECT_MSG_EQ (path.size (), distances[dest] + 1, "Path from node " << source
+                                 << " to node " << dest << " not the shortest " << context);
+          NS_TEST_EXPECT_MSG_EQ (path.front (), dest, "Path from node " << source << " to node " << dest
+                                 << " does not end at the destination " << context);
+          NS_TEST_EXPECT_MSG_EQ (path.back (), source, "Path from node " << source << " to node " << dest
+                                 << " does not start at the source " << context);
+          for (uint32_t k = 0; k + 1 < path.size (); k++)
+            {
+              NS_TEST_EXPECT_MSG_EQ (CanSend (path[k + 1], path[k]), true, "Path from node " << source
+                                     << " to node " << dest << " goes from node " << path[k + 1]
+                                     << " to node " << path[k] << " " << context);
+            }
+        }
+    }
+}
+
+void
+NixVectorBfsTest::DoRun (void)
+{
+  // a grid of 4 x 4 nodes, with some shortcuts, or a ring of
+  // segments of 4 nodes, sharing a node with the next segment
+  std::vector<std::pair<uint32_t, uint32_t> > flips;
+  if (!m_csma)
+    {
+      CreateNodes (16);
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          for (uint32_t j = 0; j < 4; j++)
+            {
+              if (j < 3)
+                {
+                  Connect (4 * i + j, 4 * i + j + 1);
+                }
+              if (i < 3)
+                {
+                  Connect (4 * i + j, 4 * i + j + 4);
+                }
+            }
+        }
+      Connect (0, 5);
+      Connect (6, 11);
+      Connect (3, 12);
+      // cut the shortcut from node 3, and isolate node 15
+      flips.push_back (std::make_pair (3, 12));
+      flips.push_back (std::make_pair (11, 15));
+      flips.push_back (std::make_pair (14, 15));
+    }
+  else
+    {
+      CreateNodes (13);
+      for (uint32_t s = 0; s < 4; s++)
+        {
+          std::vector<uint32_t> segment;
+          for (uint32_t k = 0; k < 4; k++)
+            {
+              segment.push_back ((3 * s + k) % 12);
+            }
+          Connect (segment);
+        }
+      // a node hanging from a point-to-point link
+      Connect (7, 12);
+      // nodes 3 and 6 cannot send on their segment shared with node 4 and 5
+      flips.push_back (std::make_pair (3, 4));
+      flips.push_back (std::make_pair (6, 5));
+      flips.push_back (std::make_pair (12, 7));
+    }
+
+  // route once, to flush the caches after the setup of the interfaces
+  RouteOutput (0, 1);
+  CheckPaths ("with all the interfaces up");
+
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = flips.begin (); it != flips.end (); it++)
+    {
+      m_nodes.Get (it->first)->GetObject<Ipv4> ()->SetDown (GetInterface (it->first, it->second));
+    }
+  uint32_t searches = GetSearchCount ();
+  std::ostringstream down;
+  down << "with " << flips.size () << " interfaces down";
+  CheckPaths (down.str ());
+  uint32_t n = m_nodes.GetN ();
+  NS_TEST_EXPECT_MSG_EQ (GetSearchCount (), searches + n * (n - 1), "Topology snapshot rebuilt after interfaces went down");
+
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = flips.begin (); it != flips.end (); it++)
+    {
+      m_nodes.Get (it->first)->GetObject<Ipv4> ()->SetUp (GetInterface (it->first, it->second));
+    }
+  searches = GetSearchCount ();
+  CheckPaths ("with the interfaces back up");
+  NS_TEST_EXPECT_MSG_EQ (GetSearchCount (), searches + n * (n - 1), "Topology snapshot rebuilt after interfaces came back up");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing TestSuite
+ */
+class NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  NixVectorRoutingTestSuite ()
+    : TestSuite ("nix-vector-routing", UNIT)
+  {
+    AddTestCase (new NixVectorInterfaceDownUpTest (), TestCase::QUICK);
+    AddTestCase (new NixVectorTransitRouteTest (), TestCase::QUICK);
+    AddTestCase (new NixVectorDisposeTest (), TestCase::QUICK);
+    AddTestCase (new NixVectorBfsTest (false), TestCase::QUICK);
+    AddTestCase (new NixVectorBfsTest (true), TestCase::QUICK);
+  }
+};
+
+static NixVectorRoutingTestSuite g_nixVectorRoutingTestSuite; //!< Static variable for test initialization
@@ -36,6 +36,7 @@
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/simulator.h"
+#include "ns3/make-event.h"
 #include "ns3/log.h"
 #include "ns3/names.h"
 #include "ns3/inet-socket-address.h"
@@ -237,6 +238,14 @@ RoutingProtocol::SetIpv4 (Ptr<Ipv4> ipv4)
 
 void RoutingProtocol::DoDispose ()
 {
+  for (std::vector<TimerWheel::TimerId>::const_iterator it = m_tupleTimers.begin ();
+       it != m_tupleTimers.end (); it++)
+    {
+      m_timerWheel->Cancel (*it);
+    }
+  m_tupleTimers.clear ();
+  m_timerWheel = 0;
+
   m_ipv4 = 0;
   m_hnaRoutingTable = 0;
   m_routingTableAssociation = 0;
@@ -1389,11 +1398,11 @@ RoutingProtocol::ProcessTc (const olsr::MessageHeader &msg,
           AddTopologyTuple (topologyTuple);
 
           // Schedules topology tuple deletion
-          m_events.Track (Simulator::Schedule (DELAY (topologyTuple.expirationTime),
-                                               &RoutingProtocol::TopologyTupleTimerExpire,
-                                               this,
-                                               topologyTuple.destAddr,
-                                               topologyTuple.lastAddr));
+          ScheduleTupleTimer (topologyTuple.expirationTime,
+                              MakeEvent (&RoutingProtocol::TopologyTupleTimerExpire,
+                                         this,
+                                         topologyTuple.destAddr,
+                                         topologyTuple.lastAddr));
         }
     }
 
@@ -1458,8 +1467,8 @@ RoutingProtocol::ProcessMid (const olsr::MessageHeader &msg,
           AddIfaceAssocTuple (tuple);
           NS_LOG_LOGIC ("New IfaceAssoc added: " << tuple);
           // Schedules iface association tuple deletion
-          Simulator::Schedule (DELAY (tuple.time),
-                               &RoutingProtocol::IfaceAssocTupleTimerExpire, this, tuple.ifaceAddr);
+          ScheduleTupleTimer (tuple.time,
+                              MakeEvent (&RoutingProtocol::IfaceAssocTupleTimerExpire, this, tuple.ifaceAddr));
         }
     }
 
@@ -1533,9 +1542,9 @@ RoutingProtocol::ProcessHna (const olsr::MessageHeader &msg,
           AddAssociationTuple (assocTuple);
 
           //Schedule Association Tuple deletion
-          Simulator::Schedule (DELAY (assocTuple.expirationTime),
-                               &RoutingProtocol::AssociationTupleTimerExpire, this,
-                               assocTuple.gatewayAddr,assocTuple.networkAddr,assocTuple.netmask);
+          ScheduleTupleTimer (assocTuple.expirationTime,
+                              MakeEvent (&RoutingProtocol::AssociationTupleTimerExpire, this,
+                                         assocTuple.gatewayAddr,assocTuple.networkAddr,assocTuple.netmask));
         }
 
     }
@@ -1603,9 +1612,9 @@ RoutingProtocol::ForwardDefault (olsr::MessageHeader olsrMessage,
       newDup.ifaceList.push_back (localIface);
       AddDuplicateTuple (newDup);
       // Schedule dup tuple deletion
-      Simulator::Schedule (OLSR_DUP_HOLD_TIME,
-                           &RoutingProtocol::DupTupleTimerExpire, this,
-                           newDup.address, newDup.sequenceNumber);
+      ScheduleTupleTimer (newDup.expirationTime,
+                          MakeEvent (&RoutingProtocol::DupTupleTimerExpire, this,
+                                     newDup.address, newDup.sequenceNumber));
     }
 }
 
@@ -2113,9 +2122,9 @@ RoutingProtocol::LinkSensing (const olsr::MessageHeader &msg,
   if (created)
     {
       LinkTupleAdded (*link_tuple, hello.willingness);
-      m_events.Track (Simulator::Schedule (DELAY (std::min (link_tuple->time, link_tuple->symTime)),
-                                           &RoutingProtocol::LinkTupleTimerExpire, this,
-                                           link_tuple->neighborIfaceAddr));
+      ScheduleTupleTimer (std::min (link_tuple->time, link_tuple->symTime),
+                          MakeEvent (&RoutingProtocol::LinkTupleTimerExpire, this,
+                                     link_tuple->neighborIfaceAddr));
     }
   NS_LOG_DEBUG ("@" << now.GetSeconds () << ": Olsr node " << m_mainAddress
                     << ": LinkSensing END");
@@ -2207,10 +2216,10 @@ RoutingProtocol::PopulateTwoHopNeighborSet (const olsr::MessageHeader &msg,
                       new_nb2hop_tuple.expirationTime = now + msg.GetVTime ();
                       AddTwoHopNeighborTuple (new_nb2hop_tuple);
                       // Schedules nb2hop tuple deletion
-                      m_events.Track (Simulator::Schedule (DELAY (new_nb2hop_tuple.expirationTime),
-                                                           &RoutingProtocol::Nb2hopTupleTimerExpire, this,
-                                                           new_nb2hop_tuple.neighborMainAddr,
-                                                           new_nb2hop_tuple.twoHopNeighborAddr));
+                      ScheduleTupleTimer (new_nb2hop_tuple.expirationTime,
+                                          MakeEvent (&RoutingProtocol::Nb2hopTupleTimerExpire, this,
+                                                     new_nb2hop_tuple.neighborMainAddr,
+                                                     new_nb2hop_tuple.twoHopNeighborAddr));
                     }
                   else
                     {
@@ -2278,10 +2287,9 @@ RoutingProtocol::PopulateMprSelectorSet (const olsr::MessageHeader &msg,
                       AddMprSelectorTuple (mprsel_tuple);
 
                       // Schedules mpr selector tuple deletion
-                      m_events.Track (Simulator::Schedule
-                                        (DELAY (mprsel_tuple.expirationTime),
-                                        &RoutingProtocol::MprSelTupleTimerExpire, this,
-                                        mprsel_tuple.mainAddr));
+                      ScheduleTupleTimer (mprsel_tuple.expirationTime,
+                                          MakeEvent (&RoutingProtocol::MprSelTupleTimerExpire, this,
+                                                     mprsel_tuple.mainAddr));
                     }
                   else
                     {
@@ -2669,10 +2677,39 @@ RoutingProtocol::DupTupleTimerExpire (Ipv4Address address, uint16_t sequenceNumb
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (tuple->expirationTime),
-                                           &RoutingProtocol::DupTupleTimerExpire, this,
-                                           address, sequenceNumber));
+      ScheduleTupleTimer (tuple->expirationTime,
+                          MakeEvent (&RoutingProtocol::DupTupleTimerExpire, this,
+                                     address, sequenceNumber));
+    }
+}
+
+void
+RoutingProtocol::ScheduleTupleTimer (Time expirationTime, Ptr<EventImpl> event)
+{
+  if (m_timerWheel == 0)
+    {
+      m_timerWheel = TimerWheel::GetTimerWheel (m_ipv4->GetObject<Node> ());
+    }
+  if (m_tupleTimers.size () == m_tupleTimers.capacity ())
+    {
+      // forget the expired timers before growing the vector, and grow it
+      // anyway if more than half the timers are pending
+      std::vector<TimerWheel::TimerId>::iterator pending = m_tupleTimers.begin ();
+      for (std::vector<TimerWheel::TimerId>::const_iterator it = m_tupleTimers.begin ();
+           it != m_tupleTimers.end (); it++)
+        {
+          if (m_timerWheel->IsPending (*it))
+            {
+              *pending++ = *it;
+            }
+        }
+      m_tupleTimers.erase (pending, m_tupleTimers.end ());
+      if (m_tupleTimers.size () > m_tupleTimers.capacity () / 2)
+        {
+          m_tupleTimers.reserve (std::max<size_t> (2 * m_tupleTimers.capacity (), 64));
+        }
     }
+  m_tupleTimers.push_back (m_timerWheel->Schedule (DELAY (expirationTime), event));
 }
 
 void
@@ -2701,15 +2738,15 @@ RoutingProtocol::LinkTupleTimerExpire (Ipv4Address neighborIfaceAddr)
           NeighborLoss (*tuple);
         }
 
-      m_events.Track (Simulator::Schedule (DELAY (tuple->time),
-                                           &RoutingProtocol::LinkTupleTimerExpire, this,
-                                           neighborIfaceAddr));
+      ScheduleTupleTimer (tuple->time,
+                          MakeEvent (&RoutingProtocol::LinkTupleTimerExpire, this,
+                                     neighborIfaceAddr));
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (std::min (tuple->time, tuple->symTime)),
-                                           &RoutingProtocol::LinkTupleTimerExpire, this,
-                                           neighborIfaceAddr));
+      ScheduleTupleTimer (std::min (tuple->time, tuple->symTime),
+                          MakeEvent (&RoutingProtocol::LinkTupleTimerExpire, this,
+                                     neighborIfaceAddr));
     }
 }
 
@@ -2728,9 +2765,9 @@ RoutingProtocol::Nb2hopTupleTimerExpire (Ipv4Address neighborMainAddr, Ipv4Addre
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (tuple->expirationTime),
-                                           &RoutingProtocol::Nb2hopTupleTimerExpire,
-                                           this, neighborMainAddr, twoHopNeighborAddr));
+      ScheduleTupleTimer (tuple->expirationTime,
+                          MakeEvent (&RoutingProtocol::Nb2hopTupleTimerExpire,
+                                     this, neighborMainAddr, twoHopNeighborAddr));
     }
 }
 
@@ -2748,9 +2785,9 @@ RoutingProtocol::MprSelTupleTimerExpire (Ipv4Address mainAddr)
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (tuple->expirationTime),
-                                           &RoutingProtocol::MprSelTupleTimerExpire,
-                                           this, mainAddr));
+      ScheduleTupleTimer (tuple->expirationTime,
+                          MakeEvent (&RoutingProtocol::MprSelTupleTimerExpire,
+                                     this, mainAddr));
     }
 }
 
@@ -2768,9 +2805,9 @@ RoutingProtocol::TopologyTupleTimerExpire (Ipv4Address destAddr, Ipv4Address las
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (tuple->expirationTime),
-                                           &RoutingProtocol::TopologyTupleTimerExpire,
-                                           this, tuple->destAddr, tuple->lastAddr));
+      ScheduleTupleTimer (tuple->expirationTime,
+                          MakeEvent (&RoutingProtocol::TopologyTupleTimerExpire,
+                                     this, tuple->destAddr, tuple->lastAddr));
     }
 }
 
@@ -2788,9 +2825,9 @@ RoutingProtocol::IfaceAssocTupleTimerExpire (Ipv4Address ifaceAddr)
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (tuple->time),
-                                           &RoutingProtocol::IfaceAssocTupleTimerExpire,
-                                           this, ifaceAddr));
+      ScheduleTupleTimer (tuple->time,
+                          MakeEvent (&RoutingProtocol::IfaceAssocTupleTimerExpire,
+                                     this, ifaceAddr));
     }
 }
 
@@ -2808,9 +2845,9 @@ RoutingProtocol::AssociationTupleTimerExpire (Ipv4Address gatewayAddr, Ipv4Addre
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (tuple->expirationTime),
-                                           &RoutingProtocol::AssociationTupleTimerExpire,
-                                           this, gatewayAddr, networkAddr, netmask));
+      ScheduleTupleTimer (tuple->expirationTime,
+                          MakeEvent (&RoutingProtocol::AssociationTupleTimerExpire,
+                                     this, gatewayAddr, networkAddr, netmask));
     }
 }
 
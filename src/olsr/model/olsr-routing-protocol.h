@@ -32,7 +32,7 @@
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/socket.h"
-#include "ns3/event-garbage-collector.h"
+#include "ns3/timer-wheel.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/timer.h"
 #include "ns3/traced-callback.h"
@@ -204,7 +204,8 @@ private:
 
   Ptr<Ipv4StaticRouting> m_hnaRoutingTable; //!< Routing table for HNA routes
 
-  EventGarbageCollector m_events; //!< Running events.
+  Ptr<TimerWheel> m_timerWheel; //!< Timer wheel of the node, for the expiration of the tuples.
+  std::vector<TimerWheel::TimerId> m_tupleTimers; //!< Expiration timers of the tuples, possibly expired.
 
   uint16_t m_packetSequenceNumber;    //!< Packets sequence number counter.
   uint16_t m_messageSequenceNumber;   //!< Messages sequence number counter.
@@ -402,6 +403,16 @@ private:
    */
   void DupTupleTimerExpire (Ipv4Address address, uint16_t sequenceNumber);
 
+  /**
+   * \brief Schedules the expiration of a tuple on the timer wheel of the node.
+   *
+   * The expiration timers of the tuples are cancelled when the protocol is disposed.
+   *
+   * \param expirationTime the expiration time of the tuple.
+   * \param event the event checking the expiration of the tuple.
+   */
+  void ScheduleTupleTimer (Time expirationTime, Ptr<EventImpl> event);
+
   bool m_linkTupleTimerFirstTime; //!< Flag to indicate if it is the first time the LinkTupleTimer fires.
   /**
    * \brief Removes tuple_ if expired. Else if symmetric time
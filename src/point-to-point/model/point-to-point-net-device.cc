@@ -26,6 +26,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-item.h"
+#include "ns3/segmentation-offload.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -249,6 +251,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_txSegments.clear ();
   m_queue = 0;
   m_queueInterface = 0;
   NetDevice::DoDispose ();
@@ -317,7 +320,7 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
-  Ptr<Packet> p = m_queue->Dequeue ();
+  Ptr<Packet> p = DequeueSegment ();
   if (p == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
@@ -332,6 +335,42 @@ PointToPointNetDevice::TransmitComplete (void)
   TransmitStart (p);
 }
 
+Ptr<Packet>
+PointToPointNetDevice::DequeueSegment (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> p;
+  if (!m_txSegments.empty ())
+    {
+      p = m_txSegments.front ();
+      m_txSegments.pop_front ();
+      return p;
+    }
+  p = m_queue->Dequeue ();
+  SegmentationOffloadTag tag;
+  if (p == 0 || !p->PeekPacketTag (tag))
+    {
+      return p;
+    }
+
+  //
+  // Split the offloaded packet into the segments which go on the wire, each
+  // with its own PPP header.
+  //
+  uint16_t protocol;
+  ProcessHeader (p, protocol);
+  std::vector<Ptr<Packet> > segments;
+  SegmentationOffload::Segment (protocol, p, segments);
+  for (std::vector<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+    {
+      AddHeader (*it, protocol);
+      m_txSegments.push_back (*it);
+    }
+  p = m_txSegments.front ();
+  m_txSegments.pop_front ();
+  return p;
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
@@ -577,7 +616,7 @@ PointToPointNetDevice::Send (
       // 
       if (m_txMachineState == READY)
         {
-          packet = m_queue->Dequeue ();
+          packet = DequeueSegment ();
           m_snifferTrace (packet);
           m_promiscSnifferTrace (packet);
           bool ret = TransmitStart (packet);
@@ -592,6 +631,64 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  if (IsLinkUp () == false)
+    {
+      for (uint32_t i = 0; i < items.size (); i++)
+        {
+          m_macTxDropTrace (items[i]->GetPacket ());
+        }
+      return items.size ();
+    }
+
+  //
+  // Enqueue the packets until the device queue is stopped, and inform the
+  // queue limits of the bytes queued once for the whole batch.
+  //
+  Ptr<NetDeviceQueue> txq = m_queueInterface ? m_queueInterface->GetTxQueue (0) : 0;
+  if (txq)
+    {
+      txq->StartBatch ();
+    }
+
+  uint32_t count = 0;
+  for (; count < items.size (); count++)
+    {
+      if (txq && txq->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = items[count]->GetPacket ();
+      AddHeader (packet, items[count]->GetProtocol ());
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  if (txq)
+    {
+      txq->EndBatch ();
+    }
+
+  //
+  // If the channel is ready for transition, start sending the batch
+  //
+  if (m_txMachineState == READY && !m_queue->IsEmpty ())
+    {
+      Ptr<Packet> packet = DequeueSegment ();
+      m_snifferTrace (packet);
+      m_promiscSnifferTrace (packet);
+      TransmitStart (packet);
+    }
+  return count;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -641,6 +738,12 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSegmentationOffload (void) const
+{
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
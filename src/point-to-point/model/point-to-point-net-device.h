@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <deque>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -178,6 +179,7 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -190,6 +192,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSegmentationOffload (void) const;
 
 protected:
   /**
@@ -279,6 +282,17 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * \brief Get the next packet to transmit.
+   *
+   * A packet tagged with a SegmentationOffloadTag is split into segments
+   * when it is dequeued, and the segments are transmitted one after the
+   * other before the next packet is dequeued.
+   *
+   * \returns the next packet to transmit, or 0 if there is none
+   */
+  Ptr<Packet> DequeueSegment (void);
+
   /**
    * \brief Make the link up and running
    *
@@ -461,6 +475,7 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  std::deque<Ptr<Packet> > m_txSegments; //!< Segments of the current offloaded packet not transmitted yet
 
   /**
    * \brief PPP to Ethernet protocol number mapping
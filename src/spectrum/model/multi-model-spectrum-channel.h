@@ -30,6 +30,8 @@
 #include <map>
 #include <set>
 
+class MultiModelSpectrumChannelConversionTestCase;
+
 namespace ns3 {
 
 
@@ -37,7 +39,7 @@ namespace ns3 {
  * \ingroup spectrum
  * Container: SpectrumModelUid_t, SpectrumConverter
  */
-typedef std::map<SpectrumModelUid_t, SpectrumConverter> SpectrumConverterMap_t;
+typedef std::map<SpectrumModelUid_t, Ptr<const SpectrumConverter> > SpectrumConverterMap_t;
 
 /**
  * \ingroup spectrum
@@ -81,6 +83,7 @@ public:
 
   Ptr<const SpectrumModel> m_rxSpectrumModel;  //!< Rx Spectrum model.
   std::set<Ptr<SpectrumPhy> > m_rxPhySet;      //!< Container of the Rx Spectrum phy objects.
+  Ptr<SpectrumValue> m_convertedPsd;           //!< Buffer the Tx PSDs are converted into, reused by every transmission.
 };
 
 /**
@@ -105,6 +108,8 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
+  /// allow MultiModelSpectrumChannelConversionTestCase class access
+  friend class ::MultiModelSpectrumChannelConversionTestCase;
 
 public:
   MultiModelSpectrumChannel ();
@@ -22,6 +22,7 @@
 #include <ns3/assert.h>
 #include <ns3/log.h>
 #include <algorithm>
+#include <map>
 
 
 
@@ -29,6 +30,15 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumConverter");
 
+/**
+ * \ingroup spectrum
+ * Container: (from SpectrumModelUid_t, to SpectrumModelUid_t), SpectrumConverter
+ */
+typedef std::map<std::pair<SpectrumModelUid_t, SpectrumModelUid_t>, Ptr<const SpectrumConverter> > SpectrumConverterRegistry_t;
+
+/// process-wide registry of the converters between SpectrumModels
+static SpectrumConverterRegistry_t g_spectrumConverterRegistry;
+
 SpectrumConverter::SpectrumConverter ()
 {
 }
@@ -75,31 +85,57 @@ double SpectrumConverter::GetCoefficient (const BandInfo& from, const BandInfo&
 
 
 
+Ptr<const SpectrumConverter>
+SpectrumConverter::GetConverter (Ptr<const SpectrumModel> fromSpectrumModel, Ptr<const SpectrumModel> toSpectrumModel)
+{
+  NS_LOG_FUNCTION (fromSpectrumModel << toSpectrumModel);
+  std::pair<SpectrumModelUid_t, SpectrumModelUid_t> key (fromSpectrumModel->GetUid (), toSpectrumModel->GetUid ());
+  SpectrumConverterRegistry_t::const_iterator it = g_spectrumConverterRegistry.find (key);
+  if (it != g_spectrumConverterRegistry.end ())
+    {
+      return it->second;
+    }
+  NS_LOG_LOGIC ("Creating converter between SpectrumModelUid " << key.first << " and " << key.second);
+  Ptr<const SpectrumConverter> converter = Create<SpectrumConverter> (fromSpectrumModel, toSpectrumModel);
+  g_spectrumConverterRegistry.insert (std::make_pair (key, converter));
+  return converter;
+}
+
 Ptr<SpectrumValue>
 SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
 {
-  NS_ASSERT ( *(fvvf->GetSpectrumModel ()) == *m_fromSpectrumModel);
-
   Ptr<SpectrumValue> tvvf = Create<SpectrumValue> (m_toSpectrumModel);
+  Convert (*fvvf, *tvvf);
+  return tvvf;
+}
 
-  Values::iterator tvit = tvvf->ValuesBegin ();
+void
+SpectrumConverter::Convert (const SpectrumValue& fvvf, SpectrumValue& tvvf) const
+{
+  NS_ASSERT ( *(fvvf.GetSpectrumModel ()) == *m_fromSpectrumModel);
+
+  if (tvvf.GetSpectrumModel () != m_toSpectrumModel)
+    {
+      tvvf = SpectrumValue (m_toSpectrumModel);
+    }
+
+  Values::const_iterator fvit = fvvf.ConstValuesBegin ();
+  Values::iterator tvit = tvvf.ValuesBegin ();
+  const size_t *colInd = m_conversionColInd.data ();
+  const double *coeff = m_conversionMatrix.data ();
+  size_t nRows = m_conversionRowPtr.size ();
   size_t i = 0; // Index of conversion coefficient
 
-  for (std::vector<size_t>::const_iterator convIt = m_conversionRowPtr.begin ();
-       convIt != m_conversionRowPtr.end ();
-       ++convIt)
+  for (size_t row = 0; row < nRows; row++)
     {
       double sum = 0;
-      while (i < *convIt)
+      size_t rowEnd = m_conversionRowPtr[row];
+      for (; i < rowEnd; i++)
         {
-          sum += (*fvvf)[m_conversionColInd.at (i)] * m_conversionMatrix.at (i);
-          i++;
+          sum += fvit[colInd[i]] * coeff[i];
         }
-      *tvit = sum;
-      ++tvit;
+      tvit[row] = sum;
     }
-
-  return tvvf;
 }
 
 
@@ -54,7 +54,20 @@ public:
 
   SpectrumConverter ();
 
-
+  /**
+   * Get the converter between two SpectrumModels from the process-wide
+   * registry of converters, creating it the first time it is requested.
+   * Since SpectrumModel UIDs are never reused, converters are shared by
+   * all the users (e.g., all the MultiModelSpectrumChannel instances)
+   * that need to convert between the same pair of SpectrumModels.
+   *
+   * @param fromSpectrumModel the SpectrumModel to convert from
+   * @param toSpectrumModel the SpectrumModel to convert to
+   *
+   * @return the converter from fromSpectrumModel to toSpectrumModel
+   */
+  static Ptr<const SpectrumConverter> GetConverter (Ptr<const SpectrumModel> fromSpectrumModel,
+                                                    Ptr<const SpectrumModel> toSpectrumModel);
 
   /**
    * Convert a particular ValueVsFreq instance to
@@ -65,6 +78,17 @@ public:
    */
   Ptr<SpectrumValue> Convert (Ptr<const SpectrumValue> vvf) const;
 
+  /**
+   * Convert a particular ValueVsFreq instance, storing the result in a
+   * caller-provided SpectrumValue. If the latter is already defined over
+   * the SpectrumModel to convert to, no memory is allocated.
+   *
+   * @param vvf the ValueVsFreq instance to be converted
+   * @param result the SpectrumValue where the converted version of the
+   *        provided ValueVsFreq is stored
+   */
+  void Convert (const SpectrumValue& vvf, SpectrumValue& result) const;
+
 
 private:
   /**
@@ -27,6 +27,137 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumValue");
 
+/**
+ * \defgroup spectrumvaluekernels SpectrumValue kernels
+ *
+ * Element-wise loops over contiguous arrays of doubles. They are written
+ * on raw pointers, without branches or assertions in the loop body, so
+ * that the compiler can vectorize them.
+ */
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] + b[i]
+ * \param r result
+ * \param a first operand
+ * \param b second operand
+ * \param n number of elements
+ */
+static inline void
+KernelAdd (double *r, const double *a, const double *b, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] + b[i];
+    }
+}
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] - b[i]
+ * \param r result
+ * \param a first operand
+ * \param b second operand
+ * \param n number of elements
+ */
+static inline void
+KernelSubtract (double *r, const double *a, const double *b, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] - b[i];
+    }
+}
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] * b[i]
+ * \param r result
+ * \param a first operand
+ * \param b second operand
+ * \param n number of elements
+ */
+static inline void
+KernelMultiply (double *r, const double *a, const double *b, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] * b[i];
+    }
+}
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] / b[i]
+ * \param r result
+ * \param a first operand
+ * \param b second operand
+ * \param n number of elements
+ */
+static inline void
+KernelDivide (double *r, const double *a, const double *b, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] / b[i];
+    }
+}
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] * b[i] + c[i]
+ * \param r result
+ * \param a first operand
+ * \param b second operand
+ * \param c third operand
+ * \param n number of elements
+ */
+static inline void
+KernelMultiplyAdd (double *r, const double *a, const double *b, const double *c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] * b[i] + c[i];
+    }
+}
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] - b[i] + c[i]
+ * \param r result
+ * \param a first operand
+ * \param b second operand
+ * \param c third operand
+ * \param n number of elements
+ */
+static inline void
+KernelSubtractAdd (double *r, const double *a, const double *b, const double *c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] - b[i] + c[i];
+    }
+}
+
+/**
+ * \ingroup spectrumvaluekernels
+ * r[i] = a[i] * s + b[i]
+ * \param r result
+ * \param a first operand
+ * \param s scale factor
+ * \param b second operand
+ * \param n number of elements
+ */
+static inline void
+KernelScaleAdd (double *r, const double *a, double s, const double *b, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      r[i] = a[i] * s + b[i];
+    }
+}
+
+
 SpectrumValue::SpectrumValue ()
 {
 }
@@ -106,30 +237,20 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  KernelAdd (m_values.data (), m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -138,18 +259,9 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  KernelSubtract (m_values.data (), m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
@@ -164,30 +276,20 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  KernelMultiply (m_values.data (), m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -197,18 +299,9 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  KernelDivide (m_values.data (), m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
@@ -216,12 +309,11 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] /= s;
     }
 }
 
@@ -362,11 +454,11 @@ double
 Sum (const SpectrumValue& x)
 {
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const double *v = x.m_values.data ();
+  size_t n = x.m_values.size ();
+  for (size_t i = 0; i < n; i++)
     {
-      s += (*it1);
-      ++it1;
+      s += v[i];
     }
   return s;
 }
@@ -405,6 +497,103 @@ Integral (const SpectrumValue& arg)
 
 
 
+void
+SpectrumValue::PrepareResult (const SpectrumValue& x)
+{
+  m_spectrumModel = x.m_spectrumModel;
+  // no reallocation happens if the capacity is already large enough
+  m_values.resize (x.m_values.size ());
+}
+
+void
+SpectrumValue::SetSum (const SpectrumValue& a, const SpectrumValue& b)
+{
+  NS_ASSERT (a.m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (a.m_values.size () == b.m_values.size ());
+  PrepareResult (a);
+  KernelAdd (m_values.data (), a.m_values.data (), b.m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::SetDifference (const SpectrumValue& a, const SpectrumValue& b)
+{
+  NS_ASSERT (a.m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (a.m_values.size () == b.m_values.size ());
+  PrepareResult (a);
+  KernelSubtract (m_values.data (), a.m_values.data (), b.m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::SetProduct (const SpectrumValue& a, const SpectrumValue& b)
+{
+  NS_ASSERT (a.m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (a.m_values.size () == b.m_values.size ());
+  PrepareResult (a);
+  KernelMultiply (m_values.data (), a.m_values.data (), b.m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::SetQuotient (const SpectrumValue& a, const SpectrumValue& b)
+{
+  NS_ASSERT (a.m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (a.m_values.size () == b.m_values.size ());
+  PrepareResult (a);
+  KernelDivide (m_values.data (), a.m_values.data (), b.m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::SetMultiplyAdd (const SpectrumValue& a, const SpectrumValue& b, const SpectrumValue& c)
+{
+  NS_ASSERT (a.m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (a.m_spectrumModel == c.m_spectrumModel);
+  NS_ASSERT (a.m_values.size () == b.m_values.size ());
+  NS_ASSERT (a.m_values.size () == c.m_values.size ());
+  PrepareResult (a);
+  KernelMultiplyAdd (m_values.data (), a.m_values.data (), b.m_values.data (), c.m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::SetSubtractAdd (const SpectrumValue& a, const SpectrumValue& b, const SpectrumValue& c)
+{
+  NS_ASSERT (a.m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (a.m_spectrumModel == c.m_spectrumModel);
+  NS_ASSERT (a.m_values.size () == b.m_values.size ());
+  NS_ASSERT (a.m_values.size () == c.m_values.size ());
+  PrepareResult (a);
+  KernelSubtractAdd (m_values.data (), a.m_values.data (), b.m_values.data (), c.m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::AddProduct (const SpectrumValue& a, const SpectrumValue& b)
+{
+  NS_ASSERT (m_spectrumModel == a.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == b.m_spectrumModel);
+  NS_ASSERT (m_values.size () == a.m_values.size ());
+  NS_ASSERT (m_values.size () == b.m_values.size ());
+  KernelMultiplyAdd (m_values.data (), a.m_values.data (), b.m_values.data (), m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::AddScaled (const SpectrumValue& a, double s)
+{
+  NS_ASSERT (m_spectrumModel == a.m_spectrumModel);
+  NS_ASSERT (m_values.size () == a.m_values.size ());
+  KernelScaleAdd (m_values.data (), a.m_values.data (), s, m_values.data (), m_values.size ());
+}
+
+void
+SpectrumValue::SetLog10 (const SpectrumValue& a)
+{
+  PrepareResult (a);
+  const double *x = a.m_values.data ();
+  double *v = m_values.data ();
+  size_t n = m_values.size ();
+  for (size_t i = 0; i < n; i++)
+    {
+      v[i] = std::log10 (x[i]);
+    }
+}
+
 Ptr<SpectrumValue>
 SpectrumValue::Copy () const
 {
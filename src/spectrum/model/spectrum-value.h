@@ -497,6 +497,74 @@ public:
    */
   friend double Integral (const SpectrumValue&  arg);
 
+  /**
+   * \name In-place and fused operations
+   *
+   * These methods store the result of an element-wise operation into
+   * *this, reusing its storage: unlike the binary operators, they do
+   * not allocate a temporary SpectrumValue, and the fused variants
+   * compute the result in a single pass over the operands. The result
+   * takes the SpectrumModel of the operands, which must all share the
+   * same SpectrumModel. *this may alias any of the operands.
+   * @{
+   */
+  /**
+   * *this = a + b
+   * \param a first operand
+   * \param b second operand
+   */
+  void SetSum (const SpectrumValue& a, const SpectrumValue& b);
+  /**
+   * *this = a - b
+   * \param a first operand
+   * \param b second operand
+   */
+  void SetDifference (const SpectrumValue& a, const SpectrumValue& b);
+  /**
+   * *this = a * b
+   * \param a first operand
+   * \param b second operand
+   */
+  void SetProduct (const SpectrumValue& a, const SpectrumValue& b);
+  /**
+   * *this = a / b
+   * \param a first operand
+   * \param b second operand
+   */
+  void SetQuotient (const SpectrumValue& a, const SpectrumValue& b);
+  /**
+   * *this = a * b + c
+   * \param a first operand
+   * \param b second operand
+   * \param c third operand
+   */
+  void SetMultiplyAdd (const SpectrumValue& a, const SpectrumValue& b, const SpectrumValue& c);
+  /**
+   * *this = a - b + c
+   * \param a first operand
+   * \param b second operand
+   * \param c third operand
+   */
+  void SetSubtractAdd (const SpectrumValue& a, const SpectrumValue& b, const SpectrumValue& c);
+  /**
+   * *this += a * b
+   * \param a first operand
+   * \param b second operand
+   */
+  void AddProduct (const SpectrumValue& a, const SpectrumValue& b);
+  /**
+   * *this += a * s
+   * \param a the operand
+   * \param s the scale factor
+   */
+  void AddScaled (const SpectrumValue& a, double s);
+  /**
+   * *this = Log10 (a)
+   * \param a the operand
+   */
+  void SetLog10 (const SpectrumValue& a);
+  /**@}*/
+
   /**
    *
    * @return a Ptr to a copy of this instance
@@ -515,6 +583,12 @@ public:
 
 
 private:
+  /**
+   * Set the SpectrumModel and the number of values of *this to those of
+   * the given SpectrumValue, before storing the result of an operation.
+   * \param x SpectrumValue
+   */
+  void PrepareResult (const SpectrumValue& x);
   /**
    * Add a SpectrumValue (element to element addition)
    * \param x SpectrumValue
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/object.h>
+#include <ns3/simulator.h>
+#include <ns3/net-device.h>
+#include <ns3/mobility-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-converter.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/test.h>
+#include <vector>
+
+#include "spectrum-test.h"
+
+using namespace ns3;
+
+#define TOLERANCE 1e-6
+
+/**
+ * A SpectrumPhy that only records the PSDs it receives
+ */
+class RecordingSpectrumPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   * \param rxSpectrumModel the SpectrumModel used to receive
+   */
+  RecordingSpectrumPhy (Ptr<const SpectrumModel> rxSpectrumModel)
+    : m_rxSpectrumModel (rxSpectrumModel)
+  {
+  }
+
+  // inherited from SpectrumPhy
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return 0;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return 0;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return m_rxSpectrumModel;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    m_rxPsds.push_back (params->psd);
+  }
+
+  std::vector<Ptr<SpectrumValue> > m_rxPsds; //!< the PSDs received, in order
+
+private:
+  Ptr<const SpectrumModel> m_rxSpectrumModel; //!< the SpectrumModel used to receive
+};
+
+/**
+ * Check that MultiModelSpectrumChannel converts the transmitted PSDs into a
+ * buffer kept for each receiving SpectrumModel, instead of building a new
+ * converted value per transmission, and that every receiver still gets its
+ * own PSD with the converted values.
+ */
+class MultiModelSpectrumChannelConversionTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumChannelConversionTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Transmit a PSD on the channel
+   * \param channel the channel
+   * \param txPhy the transmitting SpectrumPhy
+   * \param psd the PSD
+   */
+  void Send (Ptr<MultiModelSpectrumChannel> channel, Ptr<SpectrumPhy> txPhy, Ptr<SpectrumValue> psd);
+};
+
+MultiModelSpectrumChannelConversionTestCase::MultiModelSpectrumChannelConversionTestCase ()
+  : TestCase ("MultiModelSpectrumChannel converts into a reused buffer")
+{
+}
+
+void
+MultiModelSpectrumChannelConversionTestCase::Send (Ptr<MultiModelSpectrumChannel> channel, Ptr<SpectrumPhy> txPhy,
+                                                    Ptr<SpectrumValue> psd)
+{
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->psd = psd;
+  params->txPhy = txPhy;
+  params->duration = MicroSeconds (1);
+  channel->StartTx (params);
+}
+
+void
+MultiModelSpectrumChannelConversionTestCase::DoRun (void)
+{
+  std::vector<double> freqs1;
+  for (int i = 0; i < 5; i++)
+    {
+      freqs1.push_back (1e9 + i * 1e6);
+    }
+  std::vector<double> freqs2;
+  for (int i = 0; i < 3; i++)
+    {
+      freqs2.push_back (1e9 + 0.5e6 + i * 1.5e6);
+    }
+  Ptr<SpectrumModel> model1 = Create<SpectrumModel> (freqs1);
+  Ptr<SpectrumModel> model2 = Create<SpectrumModel> (freqs2);
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  Ptr<RecordingSpectrumPhy> tx = CreateObject<RecordingSpectrumPhy> (model1);
+  Ptr<RecordingSpectrumPhy> rxA = CreateObject<RecordingSpectrumPhy> (model2);
+  Ptr<RecordingSpectrumPhy> rxB = CreateObject<RecordingSpectrumPhy> (model2);
+  channel->AddRx (tx);
+  channel->AddRx (rxA);
+  channel->AddRx (rxB);
+
+  RxSpectrumModelInfoMap_t::iterator rxInfo = channel->m_rxSpectrumModelInfoMap.find (model2->GetUid ());
+  NS_TEST_ASSERT_MSG_EQ ((rxInfo != channel->m_rxSpectrumModelInfoMap.end ()), true, "no entry for the receiving SpectrumModel");
+  Ptr<SpectrumValue> buffer = rxInfo->second.m_convertedPsd;
+
+  SpectrumConverter converter (model1, model2);
+  std::vector<Ptr<SpectrumValue> > expected;
+  for (int n = 0; n < 3; n++)
+    {
+      Ptr<SpectrumValue> psd = Create<SpectrumValue> (model1);
+      for (size_t i = 0; i < model1->GetNumBands (); i++)
+        {
+          (*psd)[i] = (n + 1) * (i + 1);
+        }
+      expected.push_back (converter.Convert (psd));
+      Send (channel, tx, psd);
+      NS_TEST_ASSERT_MSG_EQ (rxInfo->second.m_convertedPsd, buffer, "a new converted value was built for transmission " << n);
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (tx->m_rxPsds.size (), 0, "the transmitter should not receive its own signal");
+  NS_TEST_ASSERT_MSG_EQ (rxA->m_rxPsds.size (), 3, "wrong number of signals received");
+  NS_TEST_ASSERT_MSG_EQ (rxB->m_rxPsds.size (), 3, "wrong number of signals received");
+  for (int n = 0; n < 3; n++)
+    {
+      Ptr<SpectrumValue> psdA = rxA->m_rxPsds[n];
+      Ptr<SpectrumValue> psdB = rxB->m_rxPsds[n];
+      NS_TEST_ASSERT_MSG_NE (psdA, buffer, "the receivers must not share the conversion buffer");
+      NS_TEST_ASSERT_MSG_NE (psdA, psdB, "every receiver must get its own PSD");
+      NS_TEST_ASSERT_MSG_EQ (psdA->GetSpectrumModelUid (), model2->GetUid (), "PSD not converted");
+      NS_TEST_ASSERT_MSG_SPECTRUM_VALUE_EQ_TOL (*psdA, *expected[n], TOLERANCE, "wrong PSD received by A");
+      NS_TEST_ASSERT_MSG_SPECTRUM_VALUE_EQ_TOL (*psdB, *expected[n], TOLERANCE, "wrong PSD received by B");
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * MultiModelSpectrumChannel TestSuite
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumChannelTestSuite ();
+};
+
+MultiModelSpectrumChannelTestSuite::MultiModelSpectrumChannelTestSuite ()
+  : TestSuite ("multi-model-spectrum-channel", UNIT)
+{
+  AddTestCase (new MultiModelSpectrumChannelConversionTestCase, TestCase::QUICK);
+}
+
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite; //!< the test suite
@@ -203,6 +203,33 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv5, v5, "tv5 *= v2"), TestCase::QUICK);
   AddTestCase (new SpectrumValueTestCase (tv6, v6, "tv6 div= v2"), TestCase::QUICK);
 
+  // in-place operations, starting from default-constructed (empty) values
+  SpectrumValue sv3, sv4, sv5, sv6;
+  sv3.SetSum (v1, v2);
+  sv4.SetDifference (v1, v2);
+  sv5.SetProduct (v1, v2);
+  sv6.SetQuotient (v1, v2);
+  AddTestCase (new SpectrumValueTestCase (sv3, v3, "sv3.SetSum (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (sv4, v4, "sv4.SetDifference (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (sv5, v5, "sv5.SetProduct (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (sv6, v6, "sv6.SetQuotient (v1, v2)"), TestCase::QUICK);
+
+  // fused operations, also with the result aliasing an operand
+  SpectrumValue fv1 (f), fv2 (f), fv3 (f), fv4 (f), fv5 (f);
+  fv1.SetMultiplyAdd (v1, v2, v3);
+  fv2.SetSubtractAdd (v3, v2, v4);
+  fv3 = v3;
+  fv3.AddProduct (v1, v2);
+  fv4 = v3;
+  fv4.AddScaled (v1, doubleValue);
+  fv5 = v2;
+  fv5.SetQuotient (v1, fv5);
+  AddTestCase (new SpectrumValueTestCase (fv1, v1 * v2 + v3, "fv1.SetMultiplyAdd (v1, v2, v3)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (fv2, v3 - v2 + v4, "fv2.SetSubtractAdd (v3, v2, v4)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (fv3, v3 + v1 * v2, "fv3.AddProduct (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (fv4, v3 + v1 * doubleValue, "fv4.AddScaled (v1, doubleValue)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (fv5, v6, "fv5.SetQuotient (v1, fv5)"), TestCase::QUICK);
+
   SpectrumValue tv7a (f), tv8a (f), tv9a (f), tv10a (f);
   tv7a = v1 + doubleValue;
   tv8a = v1 - doubleValue;
@@ -250,6 +277,47 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
 
 
 
+// Check that the registry of SpectrumConverters returns the same converter
+// for the same pair of SpectrumModels, and that it is equivalent to a newly
+// constructed one
+class SpectrumConverterRegistryTestCase : public TestCase
+{
+public:
+  SpectrumConverterRegistryTestCase (Ptr<const SpectrumModel> from, Ptr<const SpectrumModel> to);
+  virtual void DoRun (void);
+
+private:
+  Ptr<const SpectrumModel> m_from;
+  Ptr<const SpectrumModel> m_to;
+};
+
+SpectrumConverterRegistryTestCase::SpectrumConverterRegistryTestCase (Ptr<const SpectrumModel> from, Ptr<const SpectrumModel> to)
+  : TestCase ("SpectrumConverter registry"),
+    m_from (from),
+    m_to (to)
+{
+}
+
+void
+SpectrumConverterRegistryTestCase::DoRun (void)
+{
+  Ptr<const SpectrumConverter> c12 = SpectrumConverter::GetConverter (m_from, m_to);
+  Ptr<const SpectrumConverter> c21 = SpectrumConverter::GetConverter (m_to, m_from);
+  NS_TEST_ASSERT_MSG_EQ (c12, SpectrumConverter::GetConverter (m_from, m_to), "Converter not shared");
+  NS_TEST_ASSERT_MSG_NE (c12, c21, "Converters in opposite directions must differ");
+
+  Ptr<SpectrumValue> v = Create<SpectrumValue> (m_from);
+  for (size_t i = 0; i < v->GetSpectrumModel ()->GetNumBands (); i++)
+    {
+      (*v)[i] = i + 1;
+    }
+  SpectrumConverter reference (m_from, m_to);
+  // the macro evaluates its arguments several times
+  Ptr<SpectrumValue> converted = c12->Convert (v);
+  Ptr<SpectrumValue> expected = reference.Convert (v);
+  NS_TEST_ASSERT_MSG_SPECTRUM_VALUE_EQ_TOL (*converted, *expected, TOLERANCE, "");
+}
+
 class SpectrumConverterTestSuite : public TestSuite
 {
 public:
@@ -328,7 +396,16 @@ SpectrumConverterTestSuite::SpectrumConverterTestSuite ()
 //   NS_LOG_LOGIC(*res);
   AddTestCase (new SpectrumValueTestCase (t21b, *res, ""), TestCase::QUICK);
 
+  // conversion into a caller-provided SpectrumValue, first defined over
+  // no SpectrumModel and then reused
+  SpectrumValue out;
+  c21.Convert (*v2a, out);
+  AddTestCase (new SpectrumValueTestCase (t21a, out, "convert into a new buffer"), TestCase::QUICK);
+  c21.Convert (*v2b, out);
+  AddTestCase (new SpectrumValueTestCase (t21b, out, "convert into a reused buffer"), TestCase::QUICK);
 
+  // converters obtained from the registry
+  AddTestCase (new SpectrumConverterRegistryTestCase (sof1, sof2), TestCase::QUICK);
 }
 
 
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/fq-codel-queue-disc.h"
+#include "ns3/flat-fq-codel-queue-disc.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/string.h"
+
+using namespace ns3;
+
+/**
+ * Create an IPv4 queue disc item
+ * \param size the size of the payload
+ * \param dest the last byte of the destination address, which selects the flow
+ * \return the item
+ */
+static Ptr<Ipv4QueueDiscItem>
+CreateFlatTestItem (uint32_t size, uint8_t dest)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (size);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0100 + dest));
+  hdr.SetProtocol (7);
+  Address addr;
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (size), addr, 0, hdr);
+}
+
+/**
+ * This class tests the IP flows separation and the packet limit
+ */
+class FlatFqCoDelQueueDiscFlowsSeparationAndPacketLimit : public TestCase
+{
+public:
+  FlatFqCoDelQueueDiscFlowsSeparationAndPacketLimit ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlatFqCoDelQueueDiscFlowsSeparationAndPacketLimit::FlatFqCoDelQueueDiscFlowsSeparationAndPacketLimit ()
+  : TestCase ("Test IP flows separation and packet limit")
+{
+}
+
+void
+FlatFqCoDelQueueDiscFlowsSeparationAndPacketLimit::DoRun (void)
+{
+  Ptr<FlatFqCoDelQueueDisc> queueDisc = CreateObjectWithAttributes<FlatFqCoDelQueueDisc> ("MaxSize", StringValue ("4p"));
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  uint32_t flow1 = CreateFlatTestItem (100, 2)->Hash (0) % 1024;
+  uint32_t flow2 = CreateFlatTestItem (100, 7)->Hash (0) % 1024;
+  NS_TEST_ASSERT_MSG_NE (flow1, flow2, "The two flows should be hashed to different queues");
+
+  // Add three packets from the first flow
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queueDisc->Enqueue (CreateFlatTestItem (100, 2));
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowNPackets (flow1), 3, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNActiveFlows (), 1, "unexpected number of active flows");
+
+  // Add two packets from the second flow; the second one causes two packets
+  // to be dropped from the fat flow (max backlog = 360, threshold = 180)
+  queueDisc->Enqueue (CreateFlatTestItem (100, 7));
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowNPackets (flow2), 1, "unexpected number of packets in the flow queue");
+  queueDisc->Enqueue (CreateFlatTestItem (100, 7));
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowNPackets (flow1), 1, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetFlowNPackets (flow2), 2, "unexpected number of packets in the flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (FlatFqCoDelQueueDisc::OVERLIMIT_DROP),
+                         2, "unexpected number of overlimit drops");
+
+  // Empty the queue disc: the flows become inactive
+  while (queueDisc->Dequeue ())
+    {
+    }
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNActiveFlows (), 0, "unexpected number of active flows");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class checks that FlatFqCoDelQueueDisc dequeues and drops the same
+ * packets as FqCoDelQueueDisc, when the queue disc gets overloaded
+ */
+class FlatFqCoDelQueueDiscEquivalence : public TestCase
+{
+public:
+  FlatFqCoDelQueueDiscEquivalence ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue the same packets in both queue discs
+   * \param n the number of the packet
+   */
+  void Enqueue (uint32_t n);
+  /**
+   * Dequeue a packet from both queue discs and compare them
+   */
+  void Dequeue (void);
+
+  Ptr<FqCoDelQueueDisc> m_fqCoDel;          //!< The reference queue disc
+  Ptr<FlatFqCoDelQueueDisc> m_flatFqCoDel;  //!< The queue disc under test
+  uint32_t m_dequeued;                      //!< Number of packets dequeued by both queue discs
+  uint32_t m_mismatches;                    //!< Number of dequeues returning different packets
+};
+
+FlatFqCoDelQueueDiscEquivalence::FlatFqCoDelQueueDiscEquivalence ()
+  : TestCase ("Test that FlatFqCoDelQueueDisc behaves as FqCoDelQueueDisc"),
+    m_dequeued (0),
+    m_mismatches (0)
+{
+}
+
+void
+FlatFqCoDelQueueDiscEquivalence::Enqueue (uint32_t n)
+{
+  uint32_t size = 100 + (n % 7) * 200;
+  uint8_t dest = 2 + n % 5;
+  Ptr<Ipv4QueueDiscItem> item = CreateFlatTestItem (size, dest);
+  m_fqCoDel->Enqueue (item);
+  m_flatFqCoDel->Enqueue (Create<Ipv4QueueDiscItem> (item->GetPacket (), item->GetAddress (),
+                                                     item->GetProtocol (), item->GetHeader ()));
+}
+
+void
+FlatFqCoDelQueueDiscEquivalence::Dequeue (void)
+{
+  Ptr<QueueDiscItem> item1 = m_fqCoDel->Dequeue ();
+  Ptr<QueueDiscItem> item2 = m_flatFqCoDel->Dequeue ();
+  if ((item1 == 0) != (item2 == 0)
+      || (item1 && item1->GetPacket ()->GetUid () != item2->GetPacket ()->GetUid ()))
+    {
+      m_mismatches++;
+    }
+  if (item1)
+    {
+      m_dequeued++;
+    }
+}
+
+void
+FlatFqCoDelQueueDiscEquivalence::DoRun (void)
+{
+  m_fqCoDel = CreateObjectWithAttributes<FqCoDelQueueDisc> ("MaxSize", StringValue ("100p"));
+  m_fqCoDel->SetQuantum (1500);
+  m_fqCoDel->Initialize ();
+  m_flatFqCoDel = CreateObjectWithAttributes<FlatFqCoDelQueueDisc> ("MaxSize", StringValue ("100p"));
+  m_flatFqCoDel->SetQuantum (1500);
+  m_flatFqCoDel->Initialize ();
+
+  // three packets are enqueued and two packets are dequeued every millisecond
+  for (uint32_t n = 0; n < 450; n++)
+    {
+      Simulator::Schedule (MicroSeconds (n * 1000 / 3), &FlatFqCoDelQueueDiscEquivalence::Enqueue, this, n);
+    }
+  for (uint32_t n = 0; n < 600; n++)
+    {
+      Simulator::Schedule (MicroSeconds (n * 500 + 100), &FlatFqCoDelQueueDiscEquivalence::Dequeue, this);
+    }
+  Simulator::Run ();
+
+  const QueueDisc::Stats &st1 = m_fqCoDel->GetStats ();
+  const QueueDisc::Stats &st2 = m_flatFqCoDel->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (m_mismatches, 0, "The queue discs dequeued different packets");
+  NS_TEST_EXPECT_MSG_GT (m_dequeued, 0, "No packet dequeued");
+  NS_TEST_EXPECT_MSG_EQ (st2.nTotalEnqueuedPackets, st1.nTotalEnqueuedPackets, "Different number of enqueued packets");
+  NS_TEST_EXPECT_MSG_EQ (st2.nTotalDroppedPacketsAfterDequeue, st1.nTotalDroppedPacketsAfterDequeue,
+                         "Different number of packets dropped after dequeue");
+  NS_TEST_EXPECT_MSG_EQ (st2.nTotalSentPackets, st1.nTotalSentPackets, "Different number of sent packets");
+  NS_TEST_EXPECT_MSG_GT (st2.GetNDroppedPackets (CoDelQueueDisc::TARGET_EXCEEDED_DROP), 0,
+                         "The CoDel algorithm did not drop packets");
+  NS_TEST_EXPECT_MSG_GT (st2.GetNDroppedPackets (FlatFqCoDelQueueDisc::OVERLIMIT_DROP), 0,
+                         "No packet dropped because of the packet limit");
+  NS_TEST_EXPECT_MSG_EQ (m_flatFqCoDel->QueueDisc::GetNPackets (), m_fqCoDel->QueueDisc::GetNPackets (),
+                         "Different number of packets in the queue discs");
+
+  m_fqCoDel = 0;
+  m_flatFqCoDel = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests the dequeue of bursts of packets
+ */
+class FlatFqCoDelQueueDiscDequeueBurst : public TestCase
+{
+public:
+  FlatFqCoDelQueueDiscDequeueBurst ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlatFqCoDelQueueDiscDequeueBurst::FlatFqCoDelQueueDiscDequeueBurst ()
+  : TestCase ("Test the dequeue of bursts of packets")
+{
+}
+
+void
+FlatFqCoDelQueueDiscDequeueBurst::DoRun (void)
+{
+  Ptr<FlatFqCoDelQueueDisc> queueDisc = CreateObject<FlatFqCoDelQueueDisc> ();
+  queueDisc->SetQuantum (1500);
+  queueDisc->Initialize ();
+
+  // 4 packets of 520 bytes for each of 3 flows
+  for (uint32_t i = 0; i < 12; i++)
+    {
+      queueDisc->Enqueue (CreateFlatTestItem (500, 2 + i % 3));
+    }
+
+  // the peeked packet is the first packet of the burst
+  Ptr<const QueueDiscItem> peeked = queueDisc->Peek ();
+  std::vector<Ptr<QueueDiscItem> > items;
+  uint32_t n = queueDisc->DequeueBurst (items, 4, 100000);
+  NS_TEST_ASSERT_MSG_EQ (n, 4, "unexpected number of packets dequeued");
+  NS_TEST_ASSERT_MSG_EQ (items.size (), 4, "unexpected number of packets returned");
+  NS_TEST_EXPECT_MSG_EQ (items[0], peeked, "the peeked packet was not returned first");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 8, "unexpected number of packets in the queue disc");
+
+  // the burst stops once the byte limit is reached
+  n = queueDisc->DequeueBurst (items, 100, 1000);
+  NS_TEST_EXPECT_MSG_EQ (n, 2, "unexpected number of packets dequeued");
+  NS_TEST_EXPECT_MSG_EQ (items.size (), 6, "unexpected number of packets returned");
+
+  // the burst stops once the queue disc is empty
+  n = queueDisc->DequeueBurst (items, 100, 100000);
+  NS_TEST_EXPECT_MSG_EQ (n, 6, "unexpected number of packets dequeued");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
+
+  const QueueDisc::Stats &stats = queueDisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDequeuedPackets, 12, "unexpected number of dequeued packets");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalSentPackets, 12, "unexpected number of sent packets");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * FlatFqCoDelQueueDisc test suite
+ */
+class FlatFqCoDelQueueDiscTestSuite : public TestSuite
+{
+public:
+  FlatFqCoDelQueueDiscTestSuite ();
+};
+
+FlatFqCoDelQueueDiscTestSuite::FlatFqCoDelQueueDiscTestSuite ()
+  : TestSuite ("flat-fq-codel-queue-disc", UNIT)
+{
+  AddTestCase (new FlatFqCoDelQueueDiscFlowsSeparationAndPacketLimit, TestCase::QUICK);
+  AddTestCase (new FlatFqCoDelQueueDiscEquivalence, TestCase::QUICK);
+  AddTestCase (new FlatFqCoDelQueueDiscDequeueBurst, TestCase::QUICK);
+}
+
+static FlatFqCoDelQueueDiscTestSuite flatFqCoDelQueueDiscTestSuite;
@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/pcap-file.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/mac48-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpSegmentationOffloadTest");
+
+// ===========================================================================
+// Tests of the split of the TCP segmentation offload by the NetDevices
+// ===========================================================================
+//
+// A bulk transfer is run over a PointToPointNetDevice or a CsmaNetDevice,
+// without and with the segmentation offload.  The devices split the
+// offloaded packets when they dequeue them, so the frames on the wire, as
+// seen by the sniffer trace and in the pcap files, must be the same in both
+// runs.
+//
+class Ns3TcpSegmentationOffloadTestCase : public TestCase
+{
+public:
+  Ns3TcpSegmentationOffloadTestCase (bool csma);
+  virtual ~Ns3TcpSegmentationOffloadTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Run the transfer
+   * \param tsoMaxSegments the value of the TsoMaxSegments attribute
+   * \param pcapFile the pcap file of the sender device
+   */
+  void RunTransfer (uint32_t tsoMaxSegments, std::string pcapFile);
+  /**
+   * Record a frame sniffed on the sender device
+   * \param p the frame
+   */
+  void Sniffer (Ptr<const Packet> p);
+  /**
+   * Count the offloaded packets sent to the sender device
+   * \param p the packet
+   */
+  void MacTx (Ptr<const Packet> p);
+
+  bool m_csma;                                   //!< Whether to use CSMA instead of point-to-point
+  std::vector<std::pair<Time, std::vector<uint8_t> > > m_frames; //!< Frames sniffed in the current run
+  uint32_t m_offloaded;                          //!< Offloaded packets sent in the current run
+  uint32_t m_rxBytes;                            //!< Bytes received in the current run
+};
+
+Ns3TcpSegmentationOffloadTestCase::Ns3TcpSegmentationOffloadTestCase (bool csma)
+  : TestCase (csma ? "Check that CsmaNetDevice transmits the offloaded TCP segments as sent one by one"
+              : "Check that PointToPointNetDevice transmits the offloaded TCP segments as sent one by one"),
+    m_csma (csma),
+    m_offloaded (0),
+    m_rxBytes (0)
+{
+}
+
+void
+Ns3TcpSegmentationOffloadTestCase::Sniffer (Ptr<const Packet> p)
+{
+  std::vector<uint8_t> buffer (p->GetSize ());
+  p->CopyData (buffer.data (), buffer.size ());
+  m_frames.push_back (std::make_pair (Simulator::Now (), buffer));
+}
+
+void
+Ns3TcpSegmentationOffloadTestCase::MacTx (Ptr<const Packet> p)
+{
+  SegmentationOffloadTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      m_offloaded++;
+    }
+}
+
+void
+Ns3TcpSegmentationOffloadTestCase::RunTransfer (uint32_t tsoMaxSegments, std::string pcapFile)
+{
+  uint16_t sinkPort = 50000;
+  uint32_t maxBytes = 200000;
+
+  m_frames.clear ();
+  m_offloaded = 0;
+
+  Config::SetDefault ("ns3::TcpSocketBase::TsoMaxSegments", UintegerValue (tsoMaxSegments));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  NetDeviceContainer devices;
+  if (m_csma)
+    {
+      CsmaHelper csma;
+      csma.SetChannelAttribute ("DataRate", StringValue ("5Mbps"));
+      csma.SetChannelAttribute ("Delay", StringValue ("2ms"));
+      devices = csma.Install (nodes);
+      csma.AssignStreams (devices, 0);
+      // the same addresses in both runs
+      devices.Get (0)->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+      devices.Get (1)->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+      csma.EnablePcap (pcapFile, devices.Get (0), false, true);
+    }
+  else
+    {
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+      pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+      devices = pointToPoint.Install (nodes);
+      pointToPoint.EnablePcap (pcapFile, devices.Get (0), false, true);
+    }
+  devices.Get (0)->TraceConnectWithoutContext ("Sniffer",
+                                               MakeCallback (&Ns3TcpSegmentationOffloadTestCase::Sniffer, this));
+  devices.Get (0)->TraceConnectWithoutContext ("MacTx",
+                                               MakeCallback (&Ns3TcpSegmentationOffloadTestCase::MacTx, this));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  internet.AssignStreams (nodes, 100);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  BulkSendHelper source ("ns3::TcpSocketFactory",
+                         InetSocketAddress (interfaces.GetAddress (1), sinkPort));
+  source.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (1));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                         InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (1));
+  sinkApps.Start (Seconds (0));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  m_rxBytes = DynamicCast<PacketSink> (sinkApps.Get (0))->GetTotalRx ();
+  NS_TEST_EXPECT_MSG_EQ (m_rxBytes, maxBytes, "Not all the data received");
+
+  Simulator::Destroy ();
+}
+
+void
+Ns3TcpSegmentationOffloadTestCase::DoRun (void)
+{
+  std::string pcapFile = CreateTempDirFilename ("ns3tcp-segmentation-offload.pcap");
+  std::string tsoPcapFile = CreateTempDirFilename ("ns3tcp-segmentation-offload-tso.pcap");
+
+  RunTransfer (1, pcapFile);
+  NS_TEST_ASSERT_MSG_EQ (m_offloaded, 0, "Packets offloaded with TsoMaxSegments set to 1");
+  std::vector<std::pair<Time, std::vector<uint8_t> > > frames = m_frames;
+
+  RunTransfer (16, tsoPcapFile);
+  NS_TEST_ASSERT_MSG_GT (m_offloaded, 0, "No packet offloaded");
+
+  NS_TEST_ASSERT_MSG_EQ (m_frames.size (), frames.size (), "Different number of frames sniffed");
+  for (uint32_t i = 0; i < frames.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_frames[i].first, frames[i].first, "Frame " << i << " sniffed at a different time");
+      NS_TEST_ASSERT_MSG_EQ ((m_frames[i].second == frames[i].second), true, "Frame " << i << " differs");
+    }
+
+  uint32_t sec = 0, usec = 0, packets = 0;
+  bool diff = PcapFile::Diff (pcapFile, tsoPcapFile, sec, usec, packets);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "The pcap files differ at packet " << packets
+                         << " (" << sec << " s " << usec << " us)");
+}
+
+void
+Ns3TcpSegmentationOffloadTestCase::DoTeardown (void)
+{
+  Config::Reset ();
+}
+
+class Ns3TcpSegmentationOffloadTestSuite : public TestSuite
+{
+public:
+  Ns3TcpSegmentationOffloadTestSuite ();
+};
+
+Ns3TcpSegmentationOffloadTestSuite::Ns3TcpSegmentationOffloadTestSuite ()
+  : TestSuite ("ns3-tcp-segmentation-offload", SYSTEM)
+{
+  AddTestCase (new Ns3TcpSegmentationOffloadTestCase (false), TestCase::QUICK);
+  AddTestCase (new Ns3TcpSegmentationOffloadTestCase (true), TestCase::QUICK);
+}
+
+static Ns3TcpSegmentationOffloadTestSuite ns3TcpSegmentationOffloadTestSuite;
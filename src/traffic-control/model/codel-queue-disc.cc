@@ -68,6 +68,9 @@ static uint32_t CoDelGetTime (void)
 
 NS_OBJECT_ENSURE_REGISTERED (CoDelQueueDisc);
 
+const uint32_t CoDelQueueDisc::TARGET_EXCEEDED_DROP_ID = QueueDisc::GetReasonId (CoDelQueueDisc::TARGET_EXCEEDED_DROP);
+const uint32_t CoDelQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::GetReasonId (CoDelQueueDisc::OVERLIMIT_DROP);
+
 TypeId CoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::CoDelQueueDisc")
@@ -165,7 +168,7 @@ CoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (GetCurrentSize () + item > GetMaxSize ())
     {
       NS_LOG_LOGIC ("Queue full -- dropping pkt");
-      DropBeforeEnqueue (item, OVERLIMIT_DROP);
+      DropBeforeEnqueue (item, OVERLIMIT_DROP_ID);
       return false;
     }
 
@@ -266,7 +269,7 @@ CoDelQueueDisc::DoDequeue (void)
               // rates so high that the next drop should happen now,
               // hence the while loop.
               NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop; dropping " << item);
-              DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+              DropAfterDequeue (item, TARGET_EXCEEDED_DROP_ID);
 
               ++m_count;
               NewtonStep ();
@@ -304,7 +307,7 @@ CoDelQueueDisc::DoDequeue (void)
         {
           // Drop the first packet and enter dropping state unless the queue is empty
           NS_LOG_LOGIC ("Sojourn time goes above target, dropping the first packet " << item << " and entering the dropping state");
-          DropAfterDequeue (item, TARGET_EXCEEDED_DROP);
+          DropAfterDequeue (item, TARGET_EXCEEDED_DROP_ID);
 
           item = GetInternalQueue (0)->Dequeue ();
 
@@ -102,6 +102,9 @@ public:
   static constexpr const char* TARGET_EXCEEDED_DROP = "Target exceeded drop";  //!< Sojourn time above target
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";  //!< Overlimit dropped packet
 
+  static const uint32_t TARGET_EXCEEDED_DROP_ID; //!< ID of TARGET_EXCEEDED_DROP
+  static const uint32_t OVERLIMIT_DROP_ID; //!< ID of OVERLIMIT_DROP
+
 private:
   friend class::CoDelQueueDiscNewtonStepTest;  // Test code
   friend class::CoDelQueueDiscControlLawTest;  // Test code
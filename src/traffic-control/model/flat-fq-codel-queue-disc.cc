@@ -0,0 +1,651 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "flat-fq-codel-queue-disc.h"
+#include "codel-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlatFqCoDelQueueDisc");
+
+/**
+ * Performs a reciprocal divide, similar to the
+ * Linux kernel reciprocal_divide function
+ * \param A numerator
+ * \param R reciprocal of the denominator B
+ * \return the value of A/B
+ */
+static inline uint32_t
+FlatReciprocalDivide (uint32_t A, uint32_t R)
+{
+  return (uint32_t)(((uint64_t)A * R) >> 32);
+}
+
+/**
+ * Return the unsigned 32-bit integer representation of a time
+ * \param t the time
+ * \return the time in CoDel time representation
+ */
+static inline uint32_t
+FlatTime2CoDel (Time t)
+{
+  return static_cast<uint32_t> (t.GetNanoSeconds () >> CODEL_SHIFT);
+}
+
+/**
+ * Check if CoDel time a is successive to b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is greater than b
+ */
+static inline bool
+FlatCoDelTimeAfter (uint32_t a, uint32_t b)
+{
+  return ((int)(a) - (int)(b) > 0);
+}
+
+/**
+ * Check if CoDel time a is successive or equal to b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is greater than or equal to b
+ */
+static inline bool
+FlatCoDelTimeAfterEq (uint32_t a, uint32_t b)
+{
+  return ((int)(a) - (int)(b) >= 0);
+}
+
+/**
+ * Check if CoDel time a is preceding b
+ * \param a left operand
+ * \param b right operand
+ * \return true if a is less than to b
+ */
+static inline bool
+FlatCoDelTimeBefore (uint32_t a, uint32_t b)
+{
+  return ((int)(a) - (int)(b) < 0);
+}
+
+/**
+ * Update the reciprocal square root of the count of a flow by using
+ * Newton's method, as CoDelQueueDisc::NewtonStep does
+ * \param count the count
+ * \param recInvSqrt the reciprocal square root to update
+ */
+static inline void
+FlatNewtonStep (uint32_t count, uint16_t &recInvSqrt)
+{
+  uint32_t invsqrt = ((uint32_t) recInvSqrt) << REC_INV_SQRT_SHIFT;
+  uint32_t invsqrt2 = ((uint64_t) invsqrt * invsqrt) >> 32;
+  uint64_t val = (3ll << 32) - ((uint64_t) count * invsqrt2);
+
+  val >>= 2; /* avoid overflow */
+  val = (val * invsqrt) >> (32 - 2 + 1);
+  recInvSqrt = static_cast<uint16_t> (val >> REC_INV_SQRT_SHIFT);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (FlatFqCoDelQueueDisc);
+
+const uint32_t FlatFqCoDelQueueDisc::UNCLASSIFIED_DROP_ID = QueueDisc::GetReasonId (FlatFqCoDelQueueDisc::UNCLASSIFIED_DROP);
+const uint32_t FlatFqCoDelQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::GetReasonId (FlatFqCoDelQueueDisc::OVERLIMIT_DROP);
+
+TypeId FlatFqCoDelQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlatFqCoDelQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FlatFqCoDelQueueDisc> ()
+    .AddAttribute ("Interval",
+                   "The CoDel algorithm interval for each FQCoDel queue",
+                   StringValue ("100ms"),
+                   MakeTimeAccessor (&FlatFqCoDelQueueDisc::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Target",
+                   "The CoDel algorithm target queue delay for each FQCoDel queue",
+                   StringValue ("5ms"),
+                   MakeTimeAccessor (&FlatFqCoDelQueueDisc::m_target),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinBytes",
+                   "The CoDel algorithm minbytes parameter for each FQCoDel queue",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_minBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxSize",
+                   "The maximum number of packets accepted by this queue disc",
+                   QueueSizeValue (QueueSize ("10240p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Flows",
+                   "The number of queues into which the incoming packets are classified",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DropBatchSize",
+                   "The maximum number of packets dropped from the fat flow",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_dropBatchSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FlatFqCoDelQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+FlatFqCoDelQueueDisc::FlatFqCoDelQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+    m_quantum (0),
+    m_codelInterval (0),
+    m_codelTarget (0),
+    m_freeSlot (NONE),
+    m_nActiveFlows (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+}
+
+FlatFqCoDelQueueDisc::~FlatFqCoDelQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FlatFqCoDelQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flowTable.clear ();
+  m_slots.clear ();
+  m_usedFlows.clear ();
+  m_freeSlot = NONE;
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+  m_nActiveFlows = 0;
+  QueueDisc::DoDispose ();
+}
+
+void
+FlatFqCoDelQueueDisc::SetQuantum (uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_quantum = quantum;
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::GetFlowNPackets (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_flowTable.size ());
+  return m_flowTable[flow].nPackets;
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::GetNActiveFlows (void) const
+{
+  return m_nActiveFlows;
+}
+
+void
+FlatFqCoDelQueueDisc::PushItem (Flow &flow, Ptr<QueueDiscItem> item)
+{
+  uint32_t slot = m_freeSlot;
+  if (slot == NONE)
+    {
+      slot = m_slots.size ();
+      m_slots.push_back (Slot ());
+    }
+  else
+    {
+      m_freeSlot = m_slots[slot].next;
+    }
+
+  m_slots[slot].item = item;
+  m_slots[slot].next = NONE;
+  if (flow.tail == NONE)
+    {
+      flow.head = slot;
+    }
+  else
+    {
+      m_slots[flow.tail].next = slot;
+    }
+  flow.tail = slot;
+  flow.nPackets++;
+  flow.nBytes += item->GetSize ();
+
+  PacketEnqueued (item);
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::PopItem (Flow &flow)
+{
+  uint32_t slot = flow.head;
+  if (slot == NONE)
+    {
+      return 0;
+    }
+
+  Ptr<QueueDiscItem> item = m_slots[slot].item;
+  m_slots[slot].item = 0;
+  flow.head = m_slots[slot].next;
+  if (flow.head == NONE)
+    {
+      flow.tail = NONE;
+    }
+  m_slots[slot].next = m_freeSlot;
+  m_freeSlot = slot;
+  flow.nPackets--;
+  flow.nBytes -= item->GetSize ();
+
+  PacketDequeued (item);
+  return item;
+}
+
+void
+FlatFqCoDelQueueDisc::PushFlow (FlowList &list, uint32_t index)
+{
+  m_flowTable[index].next = NONE;
+  if (list.tail == NONE)
+    {
+      list.head = index;
+    }
+  else
+    {
+      m_flowTable[list.tail].next = index;
+    }
+  list.tail = index;
+}
+
+void
+FlatFqCoDelQueueDisc::PopFlow (FlowList &list)
+{
+  NS_ASSERT (list.head != NONE);
+  uint32_t index = list.head;
+  list.head = m_flowTable[index].next;
+  if (list.head == NONE)
+    {
+      list.tail = NONE;
+    }
+  m_flowTable[index].next = NONE;
+}
+
+bool
+FlatFqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t h = 0;
+
+  if (GetNPacketFilters () == 0)
+    {
+      h = item->Hash (m_perturbation) % m_flows;
+    }
+  else
+    {
+      int32_t ret = Classify (item);
+
+      if (ret != PacketFilter::PF_NO_MATCH)
+        {
+          h = ret % m_flows;
+        }
+      else
+        {
+          NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP_ID);
+          return false;
+        }
+    }
+
+  Flow &flow = m_flowTable[h];
+
+  if (!flow.used)
+    {
+      flow.used = true;
+      m_usedFlows.push_back (h);
+    }
+
+  if (flow.status == INACTIVE)
+    {
+      flow.status = NEW_FLOW;
+      flow.deficit = m_quantum;
+      PushFlow (m_newFlows, h);
+      m_nActiveFlows++;
+    }
+
+  PushItem (flow, item);
+
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
+
+  if (GetCurrentSize () > GetMaxSize ())
+    {
+      FqCoDelDrop ();
+    }
+
+  return true;
+}
+
+bool
+FlatFqCoDelQueueDisc::OkToDrop (Flow &flow, Ptr<QueueDiscItem> item, uint32_t now)
+{
+  if (!item)
+    {
+      flow.firstAboveTime = 0;
+      return false;
+    }
+
+  uint32_t sojournTime = FlatTime2CoDel (Simulator::Now () - item->GetTimeStamp ());
+
+  if (FlatCoDelTimeBefore (sojournTime, m_codelTarget) || flow.nBytes < m_minBytes)
+    {
+      // went below so we'll stay below for at least interval
+      flow.firstAboveTime = 0;
+      return false;
+    }
+
+  bool okToDrop = false;
+  if (flow.firstAboveTime == 0)
+    {
+      // just went above from below. If we stay above for at least
+      // interval we'll say it's ok to drop
+      flow.firstAboveTime = now + m_codelInterval;
+    }
+  else if (FlatCoDelTimeAfter (now, flow.firstAboveTime))
+    {
+      okToDrop = true;
+    }
+  return okToDrop;
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::CoDelDequeue (Flow &flow, uint32_t now)
+{
+  Ptr<QueueDiscItem> item = PopItem (flow);
+  if (!item)
+    {
+      // Leave dropping state when queue is empty
+      flow.dropping = false;
+      return 0;
+    }
+
+  bool okToDrop = OkToDrop (flow, item, now);
+
+  if (flow.dropping)
+    {
+      if (!okToDrop)
+        {
+          // sojourn time fell below target - leave dropping state
+          flow.dropping = false;
+        }
+      else if (FlatCoDelTimeAfterEq (now, flow.dropNext))
+        {
+          while (flow.dropping && FlatCoDelTimeAfterEq (now, flow.dropNext))
+            {
+              // It's time for the next drop. Drop the current packet and
+              // dequeue the next. The dequeue might take us out of dropping
+              // state. If not, schedule the next drop.
+              NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop; dropping " << item);
+              DropAfterDequeue (item, CoDelQueueDisc::TARGET_EXCEEDED_DROP_ID);
+
+              ++flow.count;
+              FlatNewtonStep (flow.count, flow.recInvSqrt);
+              item = PopItem (flow);
+
+              if (!OkToDrop (flow, item, now))
+                {
+                  // leave dropping state
+                  flow.dropping = false;
+                }
+              else
+                {
+                  // schedule the next drop
+                  flow.dropNext += FlatReciprocalDivide (m_codelInterval, flow.recInvSqrt << REC_INV_SQRT_SHIFT);
+                }
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      // Drop the first packet and enter dropping state unless the queue is empty
+      NS_LOG_LOGIC ("Sojourn time goes above target, dropping the first packet " << item << " and entering the dropping state");
+      DropAfterDequeue (item, CoDelQueueDisc::TARGET_EXCEEDED_DROP_ID);
+
+      item = PopItem (flow);
+
+      OkToDrop (flow, item, now);
+      flow.dropping = true;
+      // if min went above target close to when we last went below it
+      // assume that the drop rate that controlled the queue on the
+      // last cycle is a good starting point to control it now.
+      int delta = flow.count - flow.lastCount;
+      if (delta > 1 && FlatCoDelTimeBefore (now - flow.dropNext, 16 * m_codelInterval))
+        {
+          flow.count = delta;
+          FlatNewtonStep (flow.count, flow.recInvSqrt);
+        }
+      else
+        {
+          flow.count = 1;
+          flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+        }
+      flow.lastCount = flow.count;
+      flow.dropNext = now + FlatReciprocalDivide (m_codelInterval, flow.recInvSqrt << REC_INV_SQRT_SHIFT);
+    }
+  return item;
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::DequeueOne (uint32_t now)
+{
+  Ptr<QueueDiscItem> item;
+  uint32_t index = NONE;
+  bool isNew;
+
+  do
+    {
+      // look for a new flow with positive deficit
+      while (m_newFlows.head != NONE && m_flowTable[m_newFlows.head].deficit <= 0)
+        {
+          index = m_newFlows.head;
+          m_flowTable[index].deficit += m_quantum;
+          m_flowTable[index].status = OLD_FLOW;
+          PopFlow (m_newFlows);
+          PushFlow (m_oldFlows, index);
+        }
+      isNew = (m_newFlows.head != NONE);
+
+      // otherwise, look for an old flow with positive deficit
+      if (!isNew)
+        {
+          while (m_oldFlows.head != NONE && m_flowTable[m_oldFlows.head].deficit <= 0)
+            {
+              index = m_oldFlows.head;
+              m_flowTable[index].deficit += m_quantum;
+              PopFlow (m_oldFlows);
+              PushFlow (m_oldFlows, index);
+            }
+          if (m_oldFlows.head == NONE)
+            {
+              NS_LOG_DEBUG ("No flow found to dequeue a packet");
+              return 0;
+            }
+        }
+
+      index = isNew ? m_newFlows.head : m_oldFlows.head;
+      Flow &flow = m_flowTable[index];
+      item = CoDelDequeue (flow, now);
+
+      if (!item)
+        {
+          NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
+          if (isNew)
+            {
+              flow.status = OLD_FLOW;
+              PopFlow (m_newFlows);
+              PushFlow (m_oldFlows, index);
+            }
+          else
+            {
+              flow.status = INACTIVE;
+              PopFlow (m_oldFlows);
+              m_nActiveFlows--;
+            }
+        }
+      else
+        {
+          flow.deficit -= item->GetSize ();
+        }
+    } while (item == 0);
+
+  NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket () << " from flow " << index);
+  return item;
+}
+
+Ptr<QueueDiscItem>
+FlatFqCoDelQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+  return DequeueOne (FlatTime2CoDel (Simulator::Now ()));
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::DoDequeueBurst (std::vector<Ptr<QueueDiscItem> > &items,
+                                      uint32_t maxPackets, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (this << maxPackets << maxBytes);
+
+  // the current time is the same for all the packets of the burst
+  uint32_t now = FlatTime2CoDel (Simulator::Now ());
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+  Ptr<QueueDiscItem> item;
+
+  while (count < maxPackets && bytes < maxBytes && (item = DequeueOne (now)))
+    {
+      bytes += item->GetSize ();
+      items.push_back (item);
+      count++;
+    }
+  return count;
+}
+
+bool
+FlatFqCoDelQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("FlatFqCoDelQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("FlatFqCoDelQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+FlatFqCoDelQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // we are at initialization time. If the user has not set a quantum value,
+  // set the quantum to the MTU of the device
+  if (!m_quantum)
+    {
+      Ptr<NetDevice> device = GetNetDevice ();
+      NS_ASSERT_MSG (device, "Device not set for the queue disc");
+      m_quantum = device->GetMtu ();
+      NS_LOG_DEBUG ("Setting the quantum to the MTU of the device: " << m_quantum);
+    }
+
+  m_codelInterval = FlatTime2CoDel (m_interval);
+  m_codelTarget = FlatTime2CoDel (m_target);
+
+  Flow flow;
+  flow.head = flow.tail = NONE;
+  flow.nPackets = 0;
+  flow.nBytes = 0;
+  flow.next = NONE;
+  flow.deficit = 0;
+  flow.status = INACTIVE;
+  flow.dropping = false;
+  flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+  flow.count = 0;
+  flow.lastCount = 0;
+  flow.firstAboveTime = 0;
+  flow.dropNext = 0;
+  flow.used = false;
+  m_flowTable.assign (m_flows, flow);
+  m_usedFlows.clear ();
+
+  // at most one packet more than the maximum size is stored, before the
+  // excess packets are dropped
+  m_slots.reserve (GetMaxSize ().GetValue () + 1);
+}
+
+uint32_t
+FlatFqCoDelQueueDisc::FqCoDelDrop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t maxBacklog = 0, index = 0;
+
+  /* Queue is full! Find the fat flow and drop packet(s) from it. The
+     flows are scanned in order of first use, as FqCoDelQueueDisc scans
+     its classes, so that ties are broken the same way */
+  for (std::vector<uint32_t>::const_iterator i = m_usedFlows.begin (); i != m_usedFlows.end (); i++)
+    {
+      if (m_flowTable[*i].nBytes > maxBacklog)
+        {
+          maxBacklog = m_flowTable[*i].nBytes;
+          index = *i;
+        }
+    }
+
+  /* Our goal is to drop half of this fat flow backlog */
+  uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
+  Flow &flow = m_flowTable[index];
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      item = PopItem (flow);
+      DropAfterDequeue (item, OVERLIMIT_DROP_ID);
+      len += item->GetSize ();
+    } while (++count < m_dropBatchSize && len < threshold);
+
+  return index;
+}
+
+} // namespace ns3
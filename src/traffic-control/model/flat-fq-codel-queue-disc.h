@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLAT_FQ_CODEL_QUEUE_DISC
+#define FLAT_FQ_CODEL_QUEUE_DISC
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A FqCoDel packet queue disc with a flat flow table
+ *
+ * This queue disc implements the same algorithm as FqCoDelQueueDisc, but
+ * it does not create a QueueDiscClass and a child CoDelQueueDisc for each
+ * flow. Instead:
+ *
+ * - the flows are stored in a vector, which is indexed by the hash of the
+ *   packets (or by the value returned by the packet filters);
+ * - the lists of new and old flows are linked through the index of the
+ *   next flow, which is stored in the flows;
+ * - the state of the CoDel algorithm is stored in the flows;
+ * - the packets are stored in a vector of slots shared by all the flows,
+ *   each flow linking its packets through the index of the next slot.
+ *
+ * Hence, no memory is allocated to enqueue and dequeue packets once the
+ * flow table and the slots have been created, and the packets of a flow
+ * are found without following pointers to other objects. The queue disc
+ * also overrides DoDequeueBurst to dequeue multiple packets at once.
+ *
+ * The drops of the CoDel algorithm are reported with the reason
+ * CoDelQueueDisc::TARGET_EXCEEDED_DROP, while FqCoDelQueueDisc reports
+ * the reason prefixed by QueueDisc::CHILD_QUEUE_DISC_DROP.
+ */
+class FlatFqCoDelQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief FlatFqCoDelQueueDisc constructor
+   */
+  FlatFqCoDelQueueDisc ();
+
+  virtual ~FlatFqCoDelQueueDisc ();
+
+  /**
+   * \brief Set the quantum value.
+   *
+   * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  void SetQuantum (uint32_t quantum);
+
+  /**
+   * \brief Get the quantum value.
+   *
+   * \returns The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  uint32_t GetQuantum (void) const;
+
+  /**
+   * \brief Get the number of packets stored in a flow queue
+   *
+   * \param flow the index of the flow queue
+   * \returns the number of packets stored in the flow queue
+   */
+  uint32_t GetFlowNPackets (uint32_t flow) const;
+
+  /**
+   * \brief Get the number of flow queues which store packets or are scheduled
+   *
+   * \returns the number of flow queues in the lists of new and old flows
+   */
+  uint32_t GetNActiveFlows (void) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
+  static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
+
+  static const uint32_t UNCLASSIFIED_DROP_ID; //!< ID of UNCLASSIFIED_DROP
+  static const uint32_t OVERLIMIT_DROP_ID; //!< ID of OVERLIMIT_DROP
+
+private:
+  /// Index of a missing flow or slot
+  static const uint32_t NONE = 0xffffffff;
+
+  /**
+   * \enum FlowStatus
+   * \brief Used to determine the status of a flow queue
+   */
+  enum FlowStatus
+    {
+      INACTIVE,
+      NEW_FLOW,
+      OLD_FLOW
+    };
+
+  /// A flow queue, with the state of the CoDel algorithm
+  struct Flow
+  {
+    uint32_t head;            //!< Slot of the first packet, or NONE
+    uint32_t tail;            //!< Slot of the last packet, or NONE
+    uint32_t nPackets;        //!< Number of packets
+    uint32_t nBytes;          //!< Number of bytes
+    uint32_t next;            //!< Next flow of the list of new or old flows, or NONE
+    int32_t deficit;          //!< Deficit
+    FlowStatus status;        //!< Status
+    bool dropping;            //!< True if in dropping state
+    uint16_t recInvSqrt;      //!< Reciprocal inverse square root
+    uint32_t count;           //!< Number of packets dropped since entering drop state
+    uint32_t lastCount;       //!< Last number of packets dropped since entering drop state
+    uint32_t firstAboveTime;  //!< Time to declare sojourn time above target
+    uint32_t dropNext;        //!< Time to drop next packet
+    bool used;                //!< True once the flow has received a packet
+  };
+
+  /// A slot storing a packet of a flow queue
+  struct Slot
+  {
+    Ptr<QueueDiscItem> item;  //!< The packet
+    uint32_t next;            //!< Next slot of the flow queue or of the free list, or NONE
+  };
+
+  /// A list of flows linked through their index
+  struct FlowList
+  {
+    uint32_t head;  //!< First flow, or NONE
+    uint32_t tail;  //!< Last flow, or NONE
+  };
+
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual uint32_t DoDequeueBurst (std::vector<Ptr<QueueDiscItem> > &items,
+                                   uint32_t maxPackets, uint32_t maxBytes);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Dequeue a packet by the deficit round robin scheduler
+   * \param now the current time in CoDel time representation
+   * \return the packet, or 0 if the queue disc is empty
+   */
+  Ptr<QueueDiscItem> DequeueOne (uint32_t now);
+
+  /**
+   * \brief Dequeue a packet from a flow queue by the CoDel algorithm
+   * \param flow the flow queue
+   * \param now the current time in CoDel time representation
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> CoDelDequeue (Flow &flow, uint32_t now);
+
+  /**
+   * \brief Determine whether a packet is OK to be dropped, as CoDelQueueDisc does
+   * \param flow the flow queue of the packet
+   * \param item the packet
+   * \param now the current time in CoDel time representation
+   * \return true if the sojourn time has been above target for at least interval
+   */
+  bool OkToDrop (Flow &flow, Ptr<QueueDiscItem> item, uint32_t now);
+
+  /**
+   * \brief Append a packet to a flow queue
+   * \param flow the flow queue
+   * \param item the packet
+   */
+  void PushItem (Flow &flow, Ptr<QueueDiscItem> item);
+
+  /**
+   * \brief Extract the first packet of a flow queue
+   * \param flow the flow queue
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> PopItem (Flow &flow);
+
+  /**
+   * \brief Append a flow to a list
+   * \param list the list
+   * \param index the index of the flow
+   */
+  void PushFlow (FlowList &list, uint32_t index);
+
+  /**
+   * \brief Remove the first flow of a list
+   * \param list the list
+   */
+  void PopFlow (FlowList &list);
+
+  /**
+   * \brief Drop packets from the head of the queue with the largest current byte count
+   * \return the index of the queue with the largest current byte count
+   */
+  uint32_t FqCoDelDrop (void);
+
+  Time m_interval;           //!< CoDel interval attribute
+  Time m_target;             //!< CoDel target attribute
+  uint32_t m_minBytes;       //!< CoDel minbytes attribute
+  uint32_t m_quantum;        //!< Deficit assigned to flows at each round
+  uint32_t m_flows;          //!< Number of flow queues
+  uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
+  uint32_t m_perturbation;   //!< hash perturbation value
+
+  uint32_t m_codelInterval;  //!< The interval in CoDel time representation
+  uint32_t m_codelTarget;    //!< The target in CoDel time representation
+
+  std::vector<Flow> m_flowTable;  //!< The flow queues, indexed by hash
+  std::vector<Slot> m_slots;      //!< The slots storing the packets
+  std::vector<uint32_t> m_usedFlows; //!< The flows which have received packets, in order of first use
+  uint32_t m_freeSlot;            //!< First slot of the free list, or NONE
+  FlowList m_newFlows;            //!< The list of new flows
+  FlowList m_oldFlows;            //!< The list of old flows
+  uint32_t m_nActiveFlows;        //!< Number of flows in the lists of new and old flows
+};
+
+} // namespace ns3
+
+#endif /* FLAT_FQ_CODEL_QUEUE_DISC */
@@ -92,6 +92,9 @@ FqCoDelFlow::GetStatus (void) const
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
+const uint32_t FqCoDelQueueDisc::UNCLASSIFIED_DROP_ID = QueueDisc::GetReasonId (FqCoDelQueueDisc::UNCLASSIFIED_DROP);
+const uint32_t FqCoDelQueueDisc::OVERLIMIT_DROP_ID = QueueDisc::GetReasonId (FqCoDelQueueDisc::OVERLIMIT_DROP);
+
 TypeId FqCoDelQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::FqCoDelQueueDisc")
@@ -180,7 +183,7 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       else
         {
           NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
-          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP_ID);
           return false;
         }
     }
@@ -372,7 +375,7 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   do
     {
       item = qd->GetInternalQueue (0)->Dequeue ();
-      DropAfterDequeue (item, OVERLIMIT_DROP);
+      DropAfterDequeue (item, OVERLIMIT_DROP_ID);
       len += item->GetSize ();
     } while (++count < m_dropBatchSize && len < threshold);
 
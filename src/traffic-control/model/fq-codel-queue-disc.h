@@ -130,6 +130,9 @@ public:
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
+  static const uint32_t UNCLASSIFIED_DROP_ID; //!< ID of UNCLASSIFIED_DROP
+  static const uint32_t OVERLIMIT_DROP_ID; //!< ID of OVERLIMIT_DROP
+
 private:
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
@@ -33,6 +33,8 @@ NS_LOG_COMPONENT_DEFINE ("PfifoFastQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (PfifoFastQueueDisc);
 
+const uint32_t PfifoFastQueueDisc::LIMIT_EXCEEDED_DROP_ID = QueueDisc::GetReasonId (PfifoFastQueueDisc::LIMIT_EXCEEDED_DROP);
+
 TypeId PfifoFastQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::PfifoFastQueueDisc")
@@ -70,7 +72,7 @@ PfifoFastQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (GetCurrentSize () >= GetMaxSize ())
     {
       NS_LOG_LOGIC ("Queue disc limit exceeded -- dropping packet");
-      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP);
+      DropBeforeEnqueue (item, LIMIT_EXCEEDED_DROP_ID);
       return false;
     }
 
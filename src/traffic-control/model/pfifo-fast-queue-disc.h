@@ -65,6 +65,8 @@ public:
   // Reasons for dropping packets
   static constexpr const char* LIMIT_EXCEEDED_DROP = "Queue disc limit exceeded";  //!< Packet dropped due to queue disc limit exceeded
 
+  static const uint32_t LIMIT_EXCEEDED_DROP_ID; //!< ID of LIMIT_EXCEEDED_DROP
+
 private:
   /**
    * Priority to band map. Values are taken from the prio2band array used by
@@ -41,6 +41,9 @@ NS_LOG_COMPONENT_DEFINE ("PieQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (PieQueueDisc);
 
+const uint32_t PieQueueDisc::UNFORCED_DROP_ID = QueueDisc::GetReasonId (PieQueueDisc::UNFORCED_DROP);
+const uint32_t PieQueueDisc::FORCED_DROP_ID = QueueDisc::GetReasonId (PieQueueDisc::FORCED_DROP);
+
 TypeId PieQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::PieQueueDisc")
@@ -145,13 +148,13 @@ PieQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   if (nQueued + item > GetMaxSize ())
     {
       // Drops due to queue limit: reactive
-      DropBeforeEnqueue (item, FORCED_DROP);
+      DropBeforeEnqueue (item, FORCED_DROP_ID);
       return false;
     }
   else if (DropEarly (item, nQueued.GetValue ()))
     {
       // Early probability drop: proactive
-      DropBeforeEnqueue (item, UNFORCED_DROP);
+      DropBeforeEnqueue (item, UNFORCED_DROP_ID);
       return false;
     }
 
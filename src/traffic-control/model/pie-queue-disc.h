@@ -98,6 +98,9 @@ public:
   static constexpr const char* UNFORCED_DROP = "Unforced drop";  //!< Early probability drops: proactive
   static constexpr const char* FORCED_DROP = "Forced drop";      //!< Drops due to queue limit: reactive
 
+  static const uint32_t UNFORCED_DROP_ID; //!< ID of UNFORCED_DROP
+  static const uint32_t FORCED_DROP_ID; //!< ID of FORCED_DROP
+
 protected:
   /**
    * \brief Dispose of the object
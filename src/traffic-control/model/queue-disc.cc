@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
@@ -27,8 +28,10 @@
 #include "ns3/unused.h"
 #include "ns3/simulator.h"
 #include "queue-disc.h"
+#include <deque>
 #include <ns3/drop-tail-queue.h>
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
 
 namespace ns3 {
 
@@ -37,6 +40,76 @@ NS_OBJECT_TEMPLATE_CLASS_DEFINE (DropTailQueue,QueueDiscItem);
 
 NS_LOG_COMPONENT_DEFINE ("QueueDisc");
 
+/**
+ * \ingroup traffic-control
+ *
+ * \brief The reasons why packets are dropped or marked, by ID
+ */
+struct QueueDiscReasons
+{
+  std::deque<std::string> names;          //!< The reasons, by ID (the strings do not move)
+  std::map<std::string, uint32_t> ids;    //!< The IDs, by reason
+};
+
+/**
+ * \brief Get the table of the reasons why packets are dropped or marked.
+ *
+ * The table is a function static, so that it is built before the static
+ * members of the queue discs that register their reasons.
+ *
+ * \return the table of the reasons
+ */
+static QueueDiscReasons &
+GetQueueDiscReasons (void)
+{
+  static QueueDiscReasons reasons;
+  return reasons;
+}
+
+/**
+ * \brief Find the ID of a reason, without registering it.
+ * \param reason the reason
+ * \param [out] reasonId the ID of the reason
+ * \return true if the reason is registered
+ */
+static bool
+FindReasonId (const std::string &reason, uint32_t &reasonId)
+{
+  QueueDiscReasons &reasons = GetQueueDiscReasons ();
+  std::map<std::string, uint32_t>::const_iterator it = reasons.ids.find (reason);
+  if (it == reasons.ids.end ())
+    {
+      return false;
+    }
+  reasonId = it->second;
+  return true;
+}
+
+uint32_t
+QueueDisc::GetReasonId (const std::string &reason)
+{
+  QueueDiscReasons &reasons = GetQueueDiscReasons ();
+  std::map<std::string, uint32_t>::const_iterator it = reasons.ids.find (reason);
+  if (it != reasons.ids.end ())
+    {
+      return it->second;
+    }
+  uint32_t id = reasons.names.size ();
+  reasons.names.push_back (reason);
+  reasons.ids[reason] = id;
+  return id;
+}
+
+const std::string &
+QueueDisc::GetReasonName (uint32_t reasonId)
+{
+  QueueDiscReasons &reasons = GetQueueDiscReasons ();
+  NS_ASSERT_MSG (reasonId < reasons.names.size (), "Unknown reason ID " << reasonId);
+  return reasons.names[reasonId];
+}
+
+const uint32_t QueueDisc::INTERNAL_QUEUE_DROP_ID = QueueDisc::GetReasonId (QueueDisc::INTERNAL_QUEUE_DROP);
+
 
 NS_OBJECT_ENSURE_REGISTERED (QueueDiscClass);
 
@@ -112,69 +185,45 @@ QueueDisc::Stats::Stats ()
 uint32_t
 QueueDisc::Stats::GetNDroppedPackets (std::string reason) const
 {
-  uint32_t count = 0;
-  auto it = nDroppedPacketsBeforeEnqueue.find (reason);
-
-  if (it != nDroppedPacketsBeforeEnqueue.end ())
-    {
-      count += it->second;
-    }
-
-  it = nDroppedPacketsAfterDequeue.find (reason);
-
-  if (it != nDroppedPacketsAfterDequeue.end ())
+  uint32_t id;
+  if (!FindReasonId (reason, id) || id >= nByReason.size ())
     {
-      count += it->second;
+      return 0;
     }
-
-  return count;
+  return nByReason[id].nDroppedPacketsBeforeEnqueue + nByReason[id].nDroppedPacketsAfterDequeue;
 }
 
 uint64_t
 QueueDisc::Stats::GetNDroppedBytes (std::string reason) const
 {
-  uint64_t count = 0;
-  auto it = nDroppedBytesBeforeEnqueue.find (reason);
-
-  if (it != nDroppedBytesBeforeEnqueue.end ())
+  uint32_t id;
+  if (!FindReasonId (reason, id) || id >= nByReason.size ())
     {
-      count += it->second;
+      return 0;
     }
-
-  it = nDroppedBytesAfterDequeue.find (reason);
-
-  if (it != nDroppedBytesAfterDequeue.end ())
-    {
-      count += it->second;
-    }
-
-  return count;
+  return nByReason[id].nDroppedBytesBeforeEnqueue + nByReason[id].nDroppedBytesAfterDequeue;
 }
 
 uint32_t
 QueueDisc::Stats::GetNMarkedPackets (std::string reason) const
 {
-  auto it = nMarkedPackets.find (reason);
-
-  if (it != nMarkedPackets.end ())
+  uint32_t id;
+  if (!FindReasonId (reason, id) || id >= nByReason.size ())
     {
-      return it->second;
+      return 0;
     }
-
-  return 0;
+  return nByReason[id].nMarkedPackets;
 }
 
 uint64_t
 QueueDisc::Stats::GetNMarkedBytes (std::string reason) const
 {
-  auto it = nMarkedBytes.find (reason);
-
-  if (it != nMarkedBytes.end ())
+  uint32_t id;
+  if (!FindReasonId (reason, id) || id >= nByReason.size ())
     {
-      return it->second;
+      return 0;
     }
-
-  return 0;
+  return nByReason[id].nMarkedBytes;
 }
 
 void
@@ -273,6 +322,13 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BulkDequeue",
+                   "Whether the root queue disc of a device with a single transmission "
+                   "queue and queue limits dequeues in bulk the packets that fit the "
+                   "budget of the queue limits",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QueueDisc::m_bulkDequeue),
+                   MakeBooleanChecker ())
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -327,6 +383,8 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
      m_nBytes (0),
      m_maxSize (QueueSize ("1p")),         // to avoid that setting the mode at construction time is ignored
      m_running (false),
+     m_bulkDequeue (true),
+     m_bulkHead (0),
      m_peeked (false),
      m_sizePolicy (policy),
      m_prohibitChangeMode (false)
@@ -340,11 +398,11 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // why the packet is dropped.
   m_internalQueueDbeFunctor = [this] (Ptr<const QueueDiscItem> item)
     {
-      return DropBeforeEnqueue (item, INTERNAL_QUEUE_DROP);
+      return DropBeforeEnqueue (item, INTERNAL_QUEUE_DROP_ID);
     };
   m_internalQueueDadFunctor = [this] (Ptr<const QueueDiscItem> item)
     {
-      return DropAfterDequeue (item, INTERNAL_QUEUE_DROP);
+      return DropAfterDequeue (item, INTERNAL_QUEUE_DROP_ID);
     };
 
   // These lambdas call the DropBeforeEnqueue or DropAfterDequeue methods of this
@@ -352,16 +410,16 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // is connected to the DropBeforeEnqueue and DropAfterDequeue traces of the
   // child queue discs, the concatenation of the CHILD_QUEUE_DISC_DROP constant
   // and the second argument provided by such traces is passed as the reason why
-  // the packet is dropped.
+  // the packet is dropped.  As the reasons passed by the traces are the
+  // strings of the table of reasons, the ID of the concatenation is cached by
+  // the address of the reason of the child.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DropBeforeEnqueue (item, GetChildQueueDiscDropId (r));
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DropAfterDequeue (item, GetChildQueueDiscDropId (r));
     };
 }
 
@@ -387,6 +445,8 @@ QueueDisc::DoDispose (void)
   m_device = 0;
   m_devQueueIface = 0;
   m_requeued = 0;
+  m_bulk.clear ();
+  m_bulkHead = 0;
   Object::DoDispose ();
 }
 
@@ -427,11 +487,46 @@ QueueDisc::GetStats (void)
 
   // the total number of sent packets is only updated here to avoid to increase it
   // after a dequeue and then having to decrease it if the packet is dropped after
-  // dequeue or requeued
+  // dequeue or requeued. The packets dequeued in bulk and not yet transmitted
+  // have not been sent either
+  uint64_t bulkBytes = 0;
+  for (std::size_t i = m_bulkHead; i < m_bulk.size (); i++)
+    {
+      bulkBytes += m_bulk[i]->GetSize ();
+    }
   m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - (m_requeued ? 1 : 0)
+                              - (m_bulk.size () - m_bulkHead)
                               - m_stats.nTotalDroppedPacketsAfterDequeue;
   m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - (m_requeued ? m_requeued->GetSize () : 0)
-                            - m_stats.nTotalDroppedBytesAfterDequeue;
+                            - bulkBytes - m_stats.nTotalDroppedBytesAfterDequeue;
+
+  // the counters by reason string are only built here, from the counters by ID
+  m_stats.nDroppedPacketsBeforeEnqueue.clear ();
+  m_stats.nDroppedBytesBeforeEnqueue.clear ();
+  m_stats.nDroppedPacketsAfterDequeue.clear ();
+  m_stats.nDroppedBytesAfterDequeue.clear ();
+  m_stats.nMarkedPackets.clear ();
+  m_stats.nMarkedBytes.clear ();
+  for (uint32_t id = 0; id < m_stats.nByReason.size (); id++)
+    {
+      const Stats::ReasonCounters &counters = m_stats.nByReason[id];
+      const std::string &reason = GetReasonName (id);
+      if (counters.nDroppedPacketsBeforeEnqueue > 0)
+        {
+          m_stats.nDroppedPacketsBeforeEnqueue[reason] = counters.nDroppedPacketsBeforeEnqueue;
+          m_stats.nDroppedBytesBeforeEnqueue[reason] = counters.nDroppedBytesBeforeEnqueue;
+        }
+      if (counters.nDroppedPacketsAfterDequeue > 0)
+        {
+          m_stats.nDroppedPacketsAfterDequeue[reason] = counters.nDroppedPacketsAfterDequeue;
+          m_stats.nDroppedBytesAfterDequeue[reason] = counters.nDroppedBytesAfterDequeue;
+        }
+      if (counters.nMarkedPackets > 0)
+        {
+          m_stats.nMarkedPackets[reason] = counters.nMarkedPackets;
+          m_stats.nMarkedBytes[reason] = counters.nMarkedBytes;
+        }
+    }
 
   return m_stats;
 }
@@ -711,72 +806,52 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 {
-  NS_LOG_FUNCTION (this << item << reason);
+  DropBeforeEnqueue (item, GetReasonId (reason));
+}
+
+void
+QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t reasonId)
+{
+  NS_LOG_FUNCTION (this << item << reasonId);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  Stats::ReasonCounters &counters = m_stats.GetReasonCounters (reasonId);
+  counters.nDroppedPacketsBeforeEnqueue++;
+  counters.nDroppedBytesBeforeEnqueue += item->GetSize ();
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
                 << m_stats.nTotalDroppedBytesBeforeEnqueue);
   NS_LOG_LOGIC ("m_traceDropBeforeEnqueue (p)");
   m_traceDrop (item);
-  m_traceDropBeforeEnqueue (item, reason);
+  m_traceDropBeforeEnqueue (item, GetReasonName (reasonId).c_str ());
 }
 
 void
 QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
 {
-  NS_LOG_FUNCTION (this << item << reason);
+  DropAfterDequeue (item, GetReasonId (reason));
+}
+
+void
+QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t reasonId)
+{
+  NS_LOG_FUNCTION (this << item << reasonId);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  Stats::ReasonCounters &counters = m_stats.GetReasonCounters (reasonId);
+  counters.nDroppedPacketsAfterDequeue++;
+  counters.nDroppedBytesAfterDequeue += item->GetSize ();
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -794,13 +869,19 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
                 << m_stats.nTotalDroppedBytesAfterDequeue);
   NS_LOG_LOGIC ("m_traceDropAfterDequeue (p)");
   m_traceDrop (item);
-  m_traceDropAfterDequeue (item, reason);
+  m_traceDropAfterDequeue (item, GetReasonName (reasonId).c_str ());
 }
 
 bool
 QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
 {
-  NS_LOG_FUNCTION (this << item << reason);
+  return Mark (item, GetReasonId (reason));
+}
+
+bool
+QueueDisc::Mark (Ptr<QueueDiscItem> item, uint32_t reasonId)
+{
+  NS_LOG_FUNCTION (this << item << reasonId);
 
   bool retval = item->Mark ();
 
@@ -812,34 +893,31 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes marked for the given reason
+  Stats::ReasonCounters &counters = m_stats.GetReasonCounters (reasonId);
+  counters.nMarkedPackets++;
+  counters.nMarkedBytes += item->GetSize ();
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
                 << m_stats.nTotalMarkedBytes);
-  m_traceMark (item, reason);
+  m_traceMark (item, GetReasonName (reasonId).c_str ());
   return true;
 }
 
+uint32_t
+QueueDisc::GetChildQueueDiscDropId (const char* reason)
+{
+  std::map<const char*, uint32_t>::const_iterator it = m_childQueueDiscDropIds.find (reason);
+  if (it != m_childQueueDiscDropIds.end ())
+    {
+      return it->second;
+    }
+  uint32_t id = GetReasonId (std::string (CHILD_QUEUE_DISC_DROP) + reason);
+  m_childQueueDiscDropIds[reason] = id;
+  return id;
+}
+
 bool
 QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
 {
@@ -898,6 +976,11 @@ QueueDisc::Dequeue (void)
           PacketDequeued (item);
         }
     }
+  else if (m_bulkHead < m_bulk.size ())
+    {
+      // packets dequeued in bulk have already been accounted for as dequeued
+      item = PopBulk ();
+    }
   else
     {
       item = DoDequeue ();
@@ -909,6 +992,68 @@ QueueDisc::Dequeue (void)
   return item;
 }
 
+uint32_t
+QueueDisc::DequeueBurst (std::vector<Ptr<QueueDiscItem> > &items, uint32_t maxPackets, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (this << maxPackets << maxBytes);
+
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+
+  // first extract the packets held by the queue disc, in the order Dequeue does
+  while (count < maxPackets && bytes < maxBytes
+         && (m_requeued || m_bulkHead < m_bulk.size ()))
+    {
+      Ptr<QueueDiscItem> item = Dequeue ();
+      bytes += item->GetSize ();
+      items.push_back (item);
+      count++;
+    }
+
+  if (count < maxPackets && bytes < maxBytes)
+    {
+      count += DoDequeueBurst (items, maxPackets - count, maxBytes - bytes);
+    }
+
+  NS_ASSERT (m_nPackets == m_stats.nTotalEnqueuedPackets - m_stats.nTotalDequeuedPackets);
+  NS_ASSERT (m_nBytes == m_stats.nTotalEnqueuedBytes - m_stats.nTotalDequeuedBytes);
+
+  return count;
+}
+
+uint32_t
+QueueDisc::DoDequeueBurst (std::vector<Ptr<QueueDiscItem> > &items, uint32_t maxPackets, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (this << maxPackets << maxBytes);
+
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+  Ptr<QueueDiscItem> item;
+
+  while (count < maxPackets && bytes < maxBytes && (item = DoDequeue ()))
+    {
+      bytes += item->GetSize ();
+      items.push_back (item);
+      count++;
+    }
+  return count;
+}
+
+Ptr<QueueDiscItem>
+QueueDisc::PopBulk (void)
+{
+  NS_ASSERT (m_bulkHead < m_bulk.size ());
+  Ptr<QueueDiscItem> item = m_bulk[m_bulkHead];
+  m_bulk[m_bulkHead++] = 0;
+  if (m_bulkHead == m_bulk.size ())
+    {
+      // keep the capacity of the vector for the next bulk dequeue
+      m_bulk.clear ();
+      m_bulkHead = 0;
+    }
+  return item;
+}
+
 Ptr<const QueueDiscItem>
 QueueDisc::Peek (void)
 {
@@ -921,6 +1066,12 @@ QueueDisc::DoPeek (void)
 {
   NS_LOG_FUNCTION (this);
 
+  if (!m_requeued && m_bulkHead < m_bulk.size ())
+    {
+      // a packet dequeued in bulk is already accounted for as dequeued, hence
+      // it is held as a requeued packet without setting the m_peeked flag
+      m_requeued = PopBulk ();
+    }
   if (!m_requeued)
     {
       m_peeked = true;
@@ -942,9 +1093,8 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      while (Restart (quota))
         {
-          quota -= 1;
           if (quota <= 0)
             {
               /// \todo netif_schedule (q);
@@ -976,9 +1126,9 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t &quota)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << quota);
   Ptr<QueueDiscItem> item = DequeuePacket();
   if (item == 0)
     {
@@ -986,6 +1136,14 @@ QueueDisc::Restart (void)
       return false;
     }
 
+  // if packets dequeued in bulk are pending, send them to the device along
+  // with the dequeued packet
+  if (m_bulkHead < m_bulk.size () && quota > 1)
+    {
+      return TransmitBatch (item, quota);
+    }
+
+  quota -= 1;
   return Transmit (item);
 }
 
@@ -1016,6 +1174,15 @@ QueueDisc::DequeuePacket ()
               }
           }
     }
+  else if (m_bulkHead < m_bulk.size ())
+    {
+      // Packets are only dequeued in bulk for single queue devices. Return the
+      // next packet dequeued in bulk if the (unique) queue is not stopped.
+      if (!m_devQueueIface->GetTxQueue (0)->IsStopped ())
+        {
+          item = PopBulk ();
+        }
+    }
   else
     {
       // If the device is multi-queue (actually, Linux checks if the queue disc has
@@ -1031,7 +1198,22 @@ QueueDisc::DequeuePacket ()
             {
               item->AddHeader ();
             }
-          // Here, Linux tries bulk dequeues
+          // As Linux does for queue discs attached to a single queue, dequeue in
+          // bulk the packets that fit the budget of the queue limits, if any. The
+          // packets are returned by the next calls to this method.
+          if (item != 0 && m_bulkDequeue && m_devQueueIface->GetNTxQueues () == 1 && m_quota > 1)
+            {
+              Ptr<QueueLimits> ql = m_devQueueIface->GetTxQueue (0)->GetQueueLimits ();
+              int32_t budget = ql ? ql->Available () - static_cast<int32_t> (item->GetSize ()) : 0;
+              if (budget > 0)
+                {
+                  DoDequeueBurst (m_bulk, m_quota - 1, budget);
+                  for (std::size_t i = m_bulkHead; i < m_bulk.size (); i++)
+                    {
+                      m_bulk[i]->AddHeader ();
+                    }
+                }
+            }
         }
     }
   return item;
@@ -1088,9 +1270,59 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   // of the value returned by NetDevice::Send does not match that of the value
   // returned by ndo_start_xmit.
 
-  // if the queue disc is empty or the device queue is now stopped, return false so
-  // that the Run method does not attempt to dequeue other packets and exits
-  if (GetNPackets () == 0 || m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
+  // if the queue disc is empty (and holds no packet dequeued in bulk) or the device
+  // queue is now stopped, return false so that the Run method does not attempt to
+  // dequeue other packets and exits
+  if ((GetNPackets () == 0 && m_bulkHead == m_bulk.size ())
+      || m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
+    {
+      return false;
+    }
+
+  return true;
+}
+
+bool
+QueueDisc::TransmitBatch (Ptr<QueueDiscItem> item, uint32_t &quota)
+{
+  NS_LOG_FUNCTION (this << item << quota);
+  NS_ASSERT (m_devQueueIface && m_devQueueIface->GetNTxQueues () == 1);
+
+  // the batch is made of the given packet followed by the packets dequeued
+  // in bulk, which stay in m_bulk until they are taken by the device
+  m_batch.push_back (item);
+  for (std::size_t i = m_bulkHead; i < m_bulk.size () && m_batch.size () < quota; i++)
+    {
+      m_batch.push_back (m_bulk[i]);
+    }
+
+  // a single queue device makes no use of the priority tag
+  SocketPriorityTag priorityTag;
+  for (std::size_t i = 0; i < m_batch.size (); i++)
+    {
+      m_batch[i]->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+
+  uint32_t n = m_device->SendBatch (m_batch);
+  NS_ASSERT (n <= m_batch.size ());
+  m_batch.clear ();
+
+  // as in Transmit, the packets taken by the device are consumed. The packets
+  // which have not been taken are transmitted when the device queue restarts:
+  // the first packet is requeued, while the others are still held in m_bulk
+  if (n == 0)
+    {
+      Requeue (item);
+      return false;
+    }
+  for (uint32_t i = 1; i < n; i++)
+    {
+      PopBulk ();
+    }
+  quota -= n;
+
+  if ((GetNPackets () == 0 && m_bulkHead == m_bulk.size ())
+      || m_devQueueIface->GetTxQueue (0)->IsStopped ())
     {
       return false;
     }
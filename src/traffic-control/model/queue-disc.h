@@ -234,9 +234,40 @@ public:
     /// Marked bytes, for each reason
     std::map<std::string, uint64_t> nMarkedBytes;
 
+    /// Counters of the packets dropped or marked for a reason
+    struct ReasonCounters
+    {
+      uint32_t nDroppedPacketsBeforeEnqueue; //!< Packets dropped before enqueue
+      uint64_t nDroppedBytesBeforeEnqueue;   //!< Bytes dropped before enqueue
+      uint32_t nDroppedPacketsAfterDequeue;  //!< Packets dropped after dequeue
+      uint64_t nDroppedBytesAfterDequeue;    //!< Bytes dropped after dequeue
+      uint32_t nMarkedPackets;               //!< Marked packets
+      uint64_t nMarkedBytes;                 //!< Marked bytes
+    };
+    /**
+     * Counters for each reason, indexed by reason ID (see QueueDisc::GetReasonId).
+     * These counters are kept up to date, while the maps above, indexed by
+     * the reason strings, are only filled by QueueDisc::GetStats.
+     */
+    std::vector<ReasonCounters> nByReason;
+
     /// constructor
     Stats ();
 
+    /**
+     * \brief Get the counters of the given reason, adding them if needed
+     * \param reasonId the ID of the reason
+     * \return the counters of the reason
+     */
+    ReasonCounters & GetReasonCounters (uint32_t reasonId)
+    {
+      if (reasonId >= nByReason.size ())
+        {
+          nByReason.resize (reasonId + 1, ReasonCounters ());
+        }
+      return nByReason[reasonId];
+    }
+
     /**
      * \brief Get the number of packets dropped for the given reason
      * \param reason the reason why packets were dropped
@@ -380,6 +411,21 @@ public:
    */
   Ptr<QueueDiscItem> Dequeue (void);
 
+  /**
+   * Extract multiple packets from the queue disc. The packets held by the
+   * queue disc (because of a Peek or a failed transmission) are extracted
+   * first, then the private DoDequeueBurst method is called, whose default
+   * implementation calls DoDequeue repeatedly. Packets are extracted until
+   * the given number of packets is reached, the total size of the extracted
+   * packets reaches the given number of bytes or the queue disc is empty.
+   *
+   * \param items the vector the extracted items are appended to
+   * \param maxPackets the maximum number of packets to extract
+   * \param maxBytes the number of bytes after which no more packets are extracted
+   * \return the number of items extracted
+   */
+  uint32_t DequeueBurst (std::vector<Ptr<QueueDiscItem> > &items, uint32_t maxPackets, uint32_t maxBytes);
+
   /**
    * Get a copy of the next packet the queue discipline will extract. This
    * function only calls the (private) DoPeek function. This base class provides
@@ -494,6 +540,29 @@ public:
   static constexpr const char* INTERNAL_QUEUE_DROP = "Dropped by internal queue";    //!< Packet dropped by an internal queue
   static constexpr const char* CHILD_QUEUE_DISC_DROP = "(Dropped by child queue disc) "; //!< Packet dropped by a child queue disc
 
+  /**
+   * \brief Get the ID of a reason why packets are dropped or marked
+   *
+   * The reasons are registered in a table shared by all the queue discs the
+   * first time their ID is requested, and are then referred to by their ID,
+   * so that dropping or marking a packet involves no string operation.
+   * Queue disc types usually get the IDs of their reasons once, in static
+   * members initialized along with their type.
+   *
+   * \param reason the reason
+   * \return the ID of the reason
+   */
+  static uint32_t GetReasonId (const std::string &reason);
+
+  /**
+   * \brief Get the reason with a given ID
+   * \param reasonId the ID of the reason, returned by GetReasonId
+   * \return the reason
+   */
+  static const std::string & GetReasonName (uint32_t reasonId);
+
+  static const uint32_t INTERNAL_QUEUE_DROP_ID; //!< ID of INTERNAL_QUEUE_DROP
+
 protected:
   /**
    * \brief Dispose of the object
@@ -519,6 +588,14 @@ protected:
    */
   void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dropped before enqueue
+   *  \param item item that was dropped
+   *  \param reasonId the ID of the reason why the item was dropped
+   */
+  void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t reasonId);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet dropped after dequeue
@@ -529,6 +606,14 @@ protected:
    */
   void DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dropped after dequeue
+   *  \param item item that was dropped
+   *  \param reasonId the ID of the reason why the item was dropped
+   */
+  void DropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t reasonId);
+
   /**
    *  \brief Marks the given packet and, if successful, updates the counters
    *         associated with the given reason
@@ -538,7 +623,41 @@ protected:
    */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Marks the given packet and, if successful, updates the counters
+   *         associated with the given reason
+   *  \param item item that has to be marked
+   *  \param reasonId the ID of the reason why the item has to be marked
+   *  \return true if the item was successfully marked, false otherwise
+   */
+  bool Mark (Ptr<QueueDiscItem> item, uint32_t reasonId);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet enqueue
+   *  \param item item that was enqueued
+   *  This method is called by the internal queues and the child queue discs;
+   *  subclasses which store packets themselves must call it after storing a packet
+   */
+  void PacketEnqueued (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dequeue
+   *  \param item item that was dequeued
+   *  This method is called by the internal queues and the child queue discs;
+   *  subclasses which store packets themselves must call it after extracting a packet
+   */
+  void PacketDequeued (Ptr<const QueueDiscItem> item);
+
 private:
+  /**
+   * \brief Get the ID of the reason of the drop of a packet by a child queue disc
+   * \param reason the reason passed by the drop trace of the child queue disc
+   * \return the ID of the concatenation of CHILD_QUEUE_DISC_DROP and the reason
+   */
+  uint32_t GetChildQueueDiscDropId (const char* reason);
+
   /**
    * \brief Copy constructor
    * \param o object to copy
@@ -569,6 +688,19 @@ private:
    */
   virtual Ptr<QueueDiscItem> DoDequeue (void) = 0;
 
+  /**
+   * This function actually extracts multiple packets from the queue disc.
+   * The default implementation calls DoDequeue until one of the limits is
+   * reached; subclasses can override it to amortize the cost of a dequeue
+   * over a batch of packets.
+   * \param items the vector the extracted items are appended to
+   * \param maxPackets the maximum number of packets to extract
+   * \param maxBytes the number of bytes after which no more packets are extracted
+   * \return the number of items extracted
+   */
+  virtual uint32_t DoDequeueBurst (std::vector<Ptr<QueueDiscItem> > &items,
+                                   uint32_t maxPackets, uint32_t maxBytes);
+
   /**
    * \brief Return a copy of the next packet the queue disc will extract.
    *
@@ -617,17 +749,32 @@ private:
 
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
-   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
+   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling
+   * Transmit), along with the pending packets dequeued in bulk, if any (by calling
+   * TransmitBatch).
+   * \param quota the number of packets which can still be sent in this run,
+   *        decreased by the number of packets sent to the device
    * \return true if a packet is successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t &quota);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
-   * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
+   * If the device has a single transmission queue with queue limits, the
+   * packets that fit the budget of the queue limits are dequeued in bulk
+   * (as try_bulk_dequeue_skb does) and returned by the next calls. The header
+   * is added to the packets when they are dequeued.
+   * \return the requeued packet, if any, the next packet dequeued in bulk,
+   *         if any, or the packet dequeued by the queue disc, otherwise.
    */
   Ptr<QueueDiscItem> DequeuePacket (void);
 
+  /**
+   * Extract the next packet dequeued in bulk, which must exist.
+   * \return the packet
+   */
+  Ptr<QueueDiscItem> PopBulk (void);
+
   /**
    * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
    * Requeues a packet whose transmission failed.
@@ -645,18 +792,16 @@ private:
   bool Transmit (Ptr<QueueDiscItem> item);
 
   /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet enqueue
-   *  \param item item that was enqueued
-   */
-  void PacketEnqueued (Ptr<const QueueDiscItem> item);
-
-  /**
-   *  \brief Perform the actions required when the queue disc is notified of
-   *         a packet dequeue
-   *  \param item item that was dequeued
+   * Sends a packet to the device in a single batch with the pending packets
+   * dequeued in bulk (the equivalent of the xmit_more flag of Linux), up to
+   * the given quota, by calling NetDevice::SendBatch. If the device takes no
+   * packet, the given packet is requeued.
+   * \param item the packet to transmit first
+   * \param quota the number of packets which can still be sent in this run,
+   *        decreased by the number of packets taken by the device
+   * \return true if the device queue is not stopped and the queue disc is not empty
    */
-  void PacketDequeued (Ptr<const QueueDiscItem> item);
+  bool TransmitBatch (Ptr<QueueDiscItem> item, uint32_t &quota);
 
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
@@ -675,8 +820,12 @@ private:
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  bool m_bulkDequeue;               //!< Whether to dequeue in bulk the packets that fit the queue limits
+  std::vector<Ptr<QueueDiscItem> > m_bulk; //!< Packets dequeued in bulk and not yet transmitted
+  std::size_t m_bulkHead;           //!< Index of the next packet of m_bulk to transmit
+  std::vector<Ptr<QueueDiscItem> > m_batch; //!< Packets sent to the device in a batch
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
+  std::map<const char*, uint32_t> m_childQueueDiscDropIds;  //!< IDs of the reasons of the drops by the child queue discs, by child reason
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
 
@@ -72,6 +72,11 @@ NS_LOG_COMPONENT_DEFINE ("RedQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (RedQueueDisc);
 
+const uint32_t RedQueueDisc::UNFORCED_DROP_ID = QueueDisc::GetReasonId (RedQueueDisc::UNFORCED_DROP);
+const uint32_t RedQueueDisc::FORCED_DROP_ID = QueueDisc::GetReasonId (RedQueueDisc::FORCED_DROP);
+const uint32_t RedQueueDisc::UNFORCED_MARK_ID = QueueDisc::GetReasonId (RedQueueDisc::UNFORCED_MARK);
+const uint32_t RedQueueDisc::FORCED_MARK_ID = QueueDisc::GetReasonId (RedQueueDisc::FORCED_MARK);
+
 TypeId RedQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::RedQueueDisc")
@@ -409,20 +414,20 @@ RedQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
   if (dropType == DTYPE_UNFORCED)
     {
-      if (!m_useEcn || !Mark (item, UNFORCED_MARK))
+      if (!m_useEcn || !Mark (item, UNFORCED_MARK_ID))
         {
           NS_LOG_DEBUG ("\t Dropping due to Prob Mark " << m_qAvg);
-          DropBeforeEnqueue (item, UNFORCED_DROP);
+          DropBeforeEnqueue (item, UNFORCED_DROP_ID);
           return false;
         }
       NS_LOG_DEBUG ("\t Marking due to Prob Mark " << m_qAvg);
     }
   else if (dropType == DTYPE_FORCED)
     {
-      if (m_useHardDrop || !m_useEcn || !Mark (item, FORCED_MARK))
+      if (m_useHardDrop || !m_useEcn || !Mark (item, FORCED_MARK_ID))
         {
           NS_LOG_DEBUG ("\t Dropping due to Hard Mark " << m_qAvg);
-          DropBeforeEnqueue (item, FORCED_DROP);
+          DropBeforeEnqueue (item, FORCED_DROP_ID);
           if (m_isNs1Compat)
             {
               m_count = 0;
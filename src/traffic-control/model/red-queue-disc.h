@@ -199,6 +199,11 @@ public:
   static constexpr const char* UNFORCED_MARK = "Unforced mark";  //!< Early probability marks
   static constexpr const char* FORCED_MARK = "Forced mark";      //!< Forced marks, m_qAvg > m_maxTh
 
+  static const uint32_t UNFORCED_DROP_ID; //!< ID of UNFORCED_DROP
+  static const uint32_t FORCED_DROP_ID; //!< ID of FORCED_DROP
+  static const uint32_t UNFORCED_MARK_ID; //!< ID of UNFORCED_MARK
+  static const uint32_t FORCED_MARK_ID; //!< ID of FORCED_MARK
+
 protected:
   /**
    * \brief Dispose of the object
@@ -24,7 +24,6 @@
 #include "ns3/packet.h"
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
-#include <tuple>
 
 namespace ns3 {
 
@@ -55,7 +54,8 @@ TrafficControlLayer::GetInstanceTypeId (void) const
 }
 
 TrafficControlLayer::TrafficControlLayer ()
-  : Object ()
+  : Object (),
+    m_nHandlers (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -86,6 +86,10 @@ TrafficControlLayer::NetDeviceInfo::NetDeviceInfo (Ptr<QueueDisc> rootQueueDisc,
 {
 }
 
+TrafficControlLayer::NetDeviceInfo::NetDeviceInfo ()
+{
+}
+
 TrafficControlLayer::NetDeviceInfo::~NetDeviceInfo ()
 {
   NS_LOG_FUNCTION (this);
@@ -95,37 +99,41 @@ void
 TrafficControlLayer::DoInitialize (void)
 {
   NS_LOG_FUNCTION (this);
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi;
+  std::vector<NetDeviceInfo>::iterator ndi;
   for (ndi = m_netDevices.begin (); ndi != m_netDevices.end (); ndi++)
     {
-      Ptr<NetDeviceQueueInterface> devQueueIface = ndi->second.m_ndqi;
-      NS_ASSERT (devQueueIface);
+      Ptr<NetDeviceQueueInterface> devQueueIface = ndi->m_ndqi;
+      if (!devQueueIface)
+        {
+          // the device has not been set up
+          continue;
+        }
 
-      if (ndi->second.m_rootQueueDisc)
+      if (ndi->m_rootQueueDisc)
         {
           // set the wake callbacks on netdevice queues
-           if (ndi->second.m_rootQueueDisc->GetWakeMode () == QueueDisc::WAKE_ROOT)
+           if (ndi->m_rootQueueDisc->GetWakeMode () == QueueDisc::WAKE_ROOT)
             {
               for (uint8_t i = 0; i < devQueueIface->GetNTxQueues (); i++)
                 {
-                  devQueueIface->GetTxQueue (i)->SetWakeCallback (MakeCallback (&QueueDisc::Run, ndi->second.m_rootQueueDisc));
-                  ndi->second.m_queueDiscsToWake.push_back (ndi->second.m_rootQueueDisc);
+                  devQueueIface->GetTxQueue (i)->SetWakeCallback (MakeCallback (&QueueDisc::Run, ndi->m_rootQueueDisc));
+                  ndi->m_queueDiscsToWake.push_back (ndi->m_rootQueueDisc);
                 }
             }
-          else if (ndi->second.m_rootQueueDisc->GetWakeMode () == QueueDisc::WAKE_CHILD)
+          else if (ndi->m_rootQueueDisc->GetWakeMode () == QueueDisc::WAKE_CHILD)
             {
-              NS_ASSERT_MSG (ndi->second.m_rootQueueDisc->GetNQueueDiscClasses () == devQueueIface->GetNTxQueues (),
+              NS_ASSERT_MSG (ndi->m_rootQueueDisc->GetNQueueDiscClasses () == devQueueIface->GetNTxQueues (),
                              "The number of child queue discs does not match the number of netdevice queues");
               for (uint8_t i = 0; i < devQueueIface->GetNTxQueues (); i++)
                 {
                   devQueueIface->GetTxQueue (i)->SetWakeCallback (MakeCallback (&QueueDisc::Run,
-                                                                  ndi->second.m_rootQueueDisc->GetQueueDiscClass (i)->GetQueueDisc ()));
-                  ndi->second.m_queueDiscsToWake.push_back (ndi->second.m_rootQueueDisc->GetQueueDiscClass (i)->GetQueueDisc ());
+                                                                  ndi->m_rootQueueDisc->GetQueueDiscClass (i)->GetQueueDisc ()));
+                  ndi->m_queueDiscsToWake.push_back (ndi->m_rootQueueDisc->GetQueueDiscClass (i)->GetQueueDisc ());
                 }
             }
 
           // initialize the queue disc
-          ndi->second.m_rootQueueDisc->Initialize ();
+          ndi->m_rootQueueDisc->Initialize ();
         }
     }
   Object::DoInitialize ();
@@ -161,13 +169,18 @@ TrafficControlLayer::SetupDevice (Ptr<NetDevice> device)
   // devices can set a select queue callback in their NotifyNewAggregate method
   SelectQueueCallback cb = devQueueIface->GetSelectQueueCallback ();
 
-  // create an entry in the m_netDevices map for this device
-  NS_ASSERT_MSG (m_netDevices.find (device) == m_netDevices.end (), "This is a bug,"
-                 << "  SetupDevice only can insert an entry in the m_netDevices map");
+  // fill the entry of the m_netDevices vector for this device
+  NS_ASSERT_MSG (device->GetNode () == m_node, "The device does not belong to the node");
+  uint32_t index = device->GetIfIndex ();
+  if (index >= m_netDevices.size ())
+    {
+      m_netDevices.resize (index + 1);
+    }
+  NS_ASSERT_MSG (!m_netDevices[index].m_ndqi, "This is a bug,"
+                 << "  SetupDevice only can fill an entry of the m_netDevices vector once");
 
-  m_netDevices.emplace (std::piecewise_construct,
-                        std::forward_as_tuple (device),
-                        std::forward_as_tuple ((Ptr<QueueDisc>) 0, devQueueIface, QueueDiscVector (), cb));
+  m_netDevices[index].m_ndqi = devQueueIface;
+  m_netDevices[index].m_selectQueueCallback = cb;
 }
 
 void
@@ -181,8 +194,23 @@ TrafficControlLayer::RegisterProtocolHandler (Node::ProtocolHandler handler,
   entry.protocol = protocolType;
   entry.device = device;
   entry.promiscuous = false;
+  entry.order = m_nHandlers++;
 
-  m_handlers.push_back (entry);
+  if (device == 0)
+    {
+      m_handlers.push_back (entry);
+    }
+  else
+    {
+      // handlers registered for a device are stored in the entry of the device,
+      // so that Receive does not look through the handlers of the other devices
+      uint32_t index = device->GetIfIndex ();
+      if (index >= m_netDevices.size ())
+        {
+          m_netDevices.resize (index + 1);
+        }
+      m_netDevices[index].m_handlers.push_back (entry);
+    }
 
   NS_LOG_DEBUG ("Handler for NetDevice: " << device << " registered for protocol " <<
                 protocolType << ".");
@@ -193,22 +221,22 @@ TrafficControlLayer::SetRootQueueDiscOnDevice (Ptr<NetDevice> device, Ptr<QueueD
 {
   NS_LOG_FUNCTION (this << device << qDisc);
 
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+  NetDeviceInfo* ndi = GetNetDeviceInfo (device);
 
-  if (ndi == m_netDevices.end ())
+  if (ndi == 0)
     {
       // SetupDevice has not been called yet. This may happen when the tc helper is
       // invoked (to install a queue disc) before the creation of the Ipv{4,6}Interface.
       // Since queue discs require that a netdevice queue interface is aggregated
       // to the device, call SetupDevice
       SetupDevice (device);
-      ndi = m_netDevices.find (device);
-      NS_ASSERT (ndi != m_netDevices.end ());
+      ndi = GetNetDeviceInfo (device);
+      NS_ASSERT (ndi != 0);
     }
 
-  NS_ASSERT_MSG (ndi->second.m_rootQueueDisc == 0, "Cannot install a root queue disc on a "
+  NS_ASSERT_MSG (ndi->m_rootQueueDisc == 0, "Cannot install a root queue disc on a "
                   << "device already having one. Delete the existing queue disc first.");
-  ndi->second.m_rootQueueDisc = qDisc;
+  ndi->m_rootQueueDisc = qDisc;
 }
 
 Ptr<QueueDisc>
@@ -216,13 +244,14 @@ TrafficControlLayer::GetRootQueueDiscOnDevice (Ptr<NetDevice> device) const
 {
   NS_LOG_FUNCTION (this << device);
 
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::const_iterator ndi = m_netDevices.find (device);
+  uint32_t index = device->GetIfIndex ();
 
-  if (ndi == m_netDevices.end ())
+  if (index >= m_netDevices.size () || !m_netDevices[index].m_ndqi
+      || device->GetNode () != m_node)
     {
       return 0;
     }
-  return ndi->second.m_rootQueueDisc;
+  return m_netDevices[index].m_rootQueueDisc;
 }
 
 Ptr<QueueDisc>
@@ -237,14 +266,14 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
 {
   NS_LOG_FUNCTION (this << device);
 
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+  NetDeviceInfo* ndi = GetNetDeviceInfo (device);
 
-  NS_ASSERT_MSG (ndi != m_netDevices.end () && ndi->second.m_rootQueueDisc != 0, "No root queue disc"
+  NS_ASSERT_MSG (ndi != 0 && ndi->m_rootQueueDisc != 0, "No root queue disc"
                  << " installed on device " << device);
 
   // remove the root queue disc
-  ndi->second.m_rootQueueDisc = 0;
-  ndi->second.m_queueDiscsToWake.clear ();
+  ndi->m_rootQueueDisc = 0;
+  ndi->m_queueDiscsToWake.clear ();
 }
 
 void
@@ -277,6 +306,19 @@ TrafficControlLayer::GetNDevices (void) const
   return m_node->GetNDevices ();
 }
 
+TrafficControlLayer::NetDeviceInfo*
+TrafficControlLayer::GetNetDeviceInfo (Ptr<NetDevice> device)
+{
+  uint32_t index = device->GetIfIndex ();
+
+  if (index >= m_netDevices.size () || !m_netDevices[index].m_ndqi)
+    {
+      return 0;
+    }
+  NS_ASSERT_MSG (device->GetNode () == m_node, "The device does not belong to the node");
+  return &m_netDevices[index];
+}
+
 
 void
 TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
@@ -287,21 +329,38 @@ TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
 
   bool found = false;
 
-  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
-       i != m_handlers.end (); i++)
+  // call the handlers registered for the device and those registered for all
+  // the devices in the order they were registered
+  uint32_t index = device->GetIfIndex ();
+  ProtocolHandlerList *devHandlers = 0;
+  if (index < m_netDevices.size ())
+    {
+      devHandlers = &m_netDevices[index].m_handlers;
+    }
+  std::size_t nDevHandlers = devHandlers ? devHandlers->size () : 0;
+  std::size_t d = 0, a = 0;
+
+  while (d < nDevHandlers || a < m_handlers.size ())
     {
-      if (i->device == 0
-          || (i->device != 0 && i->device == device))
+      ProtocolHandlerEntry *entry;
+      if (a == m_handlers.size ()
+          || (d < nDevHandlers && (*devHandlers)[d].order < m_handlers[a].order))
         {
-          if (i->protocol == 0
-              || i->protocol == protocol)
-            {
-              NS_LOG_DEBUG ("Found handler for packet " << p << ", protocol " <<
-                            protocol << " and NetDevice " << device <<
-                            ". Send packet up");
-              i->handler (device, p, protocol, from, to, packetType);
-              found = true;
-            }
+          entry = &(*devHandlers)[d++];
+        }
+      else
+        {
+          entry = &m_handlers[a++];
+        }
+
+      if ((entry->device == 0 || entry->device == device)
+          && (entry->protocol == 0 || entry->protocol == protocol))
+        {
+          NS_LOG_DEBUG ("Found handler for packet " << p << ", protocol " <<
+                        protocol << " and NetDevice " << device <<
+                        ". Send packet up");
+          entry->handler (device, p, protocol, from, to, packetType);
+          found = true;
         }
     }
 
@@ -320,18 +379,19 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
   NS_LOG_DEBUG ("Send packet to device " << device << " protocol number " <<
                 item->GetProtocol ());
 
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
-  NS_ASSERT (ndi != m_netDevices.end ());
-  Ptr<NetDeviceQueueInterface> devQueueIface = ndi->second.m_ndqi;
+  NS_ASSERT (device->GetIfIndex () < m_netDevices.size ());
+  NS_ASSERT_MSG (device->GetNode () == m_node, "The device does not belong to the node");
+  NetDeviceInfo* ndi = &m_netDevices[device->GetIfIndex ()];
+  Ptr<NetDeviceQueueInterface> devQueueIface = ndi->m_ndqi;
   NS_ASSERT (devQueueIface);
 
   // determine the transmission queue of the device where the packet will be enqueued
   uint8_t txq = 0;
   if (devQueueIface->GetNTxQueues () > 1)
     {
-      if (!ndi->second.m_selectQueueCallback.IsNull ())
+      if (!ndi->m_selectQueueCallback.IsNull ())
         {
-          txq = ndi->second.m_selectQueueCallback (item);
+          txq = ndi->m_selectQueueCallback (item);
         }
       // otherwise, Linux determines the queue index by using a hash function
       // and associates such index to the socket which the packet belongs to,
@@ -343,7 +403,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
   NS_ASSERT (txq < devQueueIface->GetNTxQueues ());
 
-  if (ndi->second.m_rootQueueDisc == 0)
+  if (ndi->m_rootQueueDisc == 0)
     {
       // The device has no attached queue disc, thus add the header to the packet and
       // send it directly to the device if the selected queue is not stopped
@@ -365,7 +425,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
       // selected for the packet and try to dequeue packets from such queue disc
       item->SetTxQueueIndex (txq);
 
-      Ptr<QueueDisc> qDisc = ndi->second.m_queueDiscsToWake[txq];
+      Ptr<QueueDisc> qDisc = ndi->m_queueDiscsToWake[txq];
       NS_ASSERT (qDisc);
       qDisc->Enqueue (item);
       qDisc->Run ();
@@ -225,8 +225,12 @@ private:
     Ptr<NetDevice> device;         //!< the NetDevice
     uint16_t protocol;             //!< the protocol number
     bool promiscuous;              //!< true if it is a promiscuous handler
+    uint32_t order;                //!< the order in which the handler was registered
   };
 
+  /// Typedef for protocol handlers container
+  typedef std::vector<struct ProtocolHandlerEntry> ProtocolHandlerList;
+
   /**
    * \brief Information to store for each device
    */
@@ -243,33 +247,22 @@ private:
      */
     NetDeviceInfo (Ptr<QueueDisc> rootQueueDisc, Ptr<NetDeviceQueueInterface> ndqi,
                    QueueDiscVector queueDiscsToWake, SelectQueueCallback selectQueueCallback);
+    /**
+     * \brief Constructor of the information of a device which has not been set up
+     */
+    NetDeviceInfo ();
     virtual ~NetDeviceInfo ();
 
     Ptr<QueueDisc> m_rootQueueDisc;       //!< the root queue disc on the device
-    Ptr<NetDeviceQueueInterface> m_ndqi;  //!< the netdevice queue interface
+    Ptr<NetDeviceQueueInterface> m_ndqi;  //!< the netdevice queue interface, null if the device has not been set up
     QueueDiscVector m_queueDiscsToWake;   //!< the vector of queue discs to wake
     SelectQueueCallback m_selectQueueCallback;  //!< the select queue callback
-  private:
-    NetDeviceInfo ();
-    /**
-     * \brief Copy constructor
-     * Disable default implementation to avoid misuse
-     */
-    NetDeviceInfo (NetDeviceInfo const &);
-    /**
-     * \brief Assignment operator
-     * \return this object
-     * Disable default implementation to avoid misuse
-     */
-    NetDeviceInfo& operator= (NetDeviceInfo const &);
+    ProtocolHandlerList m_handlers;       //!< the upper-layer handlers registered for the device
   };
 
-  /// Typedef for protocol handlers container
-  typedef std::vector<struct ProtocolHandlerEntry> ProtocolHandlerList;
-
   /**
    * \brief Required by the object map accessor
-   * \return the number of devices in the m_netDevices map
+   * \return the number of devices of the node
    */
   uint32_t GetNDevices (void) const;
   /**
@@ -279,11 +272,19 @@ private:
    */
   Ptr<QueueDisc> GetRootQueueDiscOnDeviceByIndex (uint32_t index) const;
 
+  /**
+   * \brief Get the information stored for a device
+   * \param device the device
+   * \return the information stored for the device, or 0 if the device has not been set up
+   */
+  NetDeviceInfo* GetNetDeviceInfo (Ptr<NetDevice> device);
+
   /// The node this TrafficControlLayer object is aggregated to
   Ptr<Node> m_node;
-  /// Map storing the required information for each device with a queue disc installed
-  std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDevices;
-  ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
+  /// Vector storing the required information for each device, indexed by the index of the device in the node
+  std::vector<NetDeviceInfo> m_netDevices;
+  ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers registered for all the devices
+  uint32_t m_nHandlers;            //!< Number of upper-layer handlers registered
 };
 
 } // namespace ns3
@@ -555,6 +555,26 @@ QueueDiscTracesTestCase::DoRun (void)
   CheckDroppedBeforeEnqueue (child, 1, pktSizeUnit * 5);
   CheckDroppedAfterDequeue (child, 2, pktSizeUnit * 3);
 
+  // The drops are counted by reason, the root queue disc prefixing the
+  // reasons of the drops by its child
+  QueueDisc::Stats childStats = child->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Wrong number of packets dropped before enqueue");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedBytes (TestChildQueueDisc::AFTER_DEQUEUE), pktSizeUnit * 3,
+                         "Wrong amount of bytes dropped after dequeue");
+  NS_TEST_EXPECT_MSG_EQ (childStats.nDroppedPacketsAfterDequeue[TestChildQueueDisc::AFTER_DEQUEUE], 2,
+                         "Wrong number of packets dropped after dequeue");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets ("Unknown reason"), 0,
+                         "Packets dropped for an unknown reason");
+  QueueDisc::Stats rootStats = root->GetStats ();
+  std::string reason = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::AFTER_DEQUEUE;
+  NS_TEST_EXPECT_MSG_EQ (rootStats.GetNDroppedPackets (reason), 2,
+                         "Wrong number of packets dropped by the child");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.nDroppedPacketsAfterDequeue.size (), 1,
+                         "Wrong number of reasons of drops after dequeue");
+  NS_TEST_EXPECT_MSG_EQ (QueueDisc::GetReasonName (QueueDisc::GetReasonId (reason)), reason,
+                         "Wrong reason name");
+
   Simulator::Destroy ();
 }
 
@@ -0,0 +1,589 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/error-model.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
+#include <vector>
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Bulk Dequeue Test Item
+ */
+class BulkDequeueTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet stored in this item
+   */
+  BulkDequeueTestItem (Ptr<Packet> p);
+  virtual ~BulkDequeueTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+
+private:
+  BulkDequeueTestItem ();
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  BulkDequeueTestItem (const BulkDequeueTestItem &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  BulkDequeueTestItem &operator = (const BulkDequeueTestItem &);
+};
+
+BulkDequeueTestItem::BulkDequeueTestItem (Ptr<Packet> p)
+  : QueueDiscItem (p, Mac48Address ("00:00:00:00:00:02"), 0)
+{
+}
+
+BulkDequeueTestItem::~BulkDequeueTestItem ()
+{
+}
+
+void
+BulkDequeueTestItem::AddHeader (void)
+{
+}
+
+bool
+BulkDequeueTestItem::Mark (void)
+{
+  return false;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Bulk Dequeue Test Case
+ *
+ * Ten packets are sent at once through a FIFO queue disc installed on a
+ * SimpleNetDevice with dynamic queue limits, whose queue stops after three
+ * packets.  When the device queue restarts, the queue disc dequeues in bulk
+ * all the packets it holds, and the device only takes the first one: the
+ * queue disc is then empty, while packets dequeued in bulk are pending.
+ * These packets must still be transmitted, in order, when the device queue
+ * restarts again.  With the BulkDequeue attribute set to false, the packets
+ * are dequeued one at a time.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param bulk the value of the BulkDequeue attribute
+   */
+  TcBulkDequeueTestCase (bool bulk);
+  virtual ~TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets through the traffic control layer of a node
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendPackets (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Record a packet dequeued by the queue disc
+   * \param item the packet
+   */
+  void QueueDiscDequeue (Ptr<const QueueDiscItem> item);
+  /**
+   * Record a packet enqueued in the device queue
+   * \param p the packet
+   */
+  void DeviceEnqueue (Ptr<const Packet> p);
+  /**
+   * Record a packet received by the receiver device
+   * \param dev the device
+   * \param p the packet
+   * \param protocol the protocol
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * Check the state of the queue disc and of the device queue
+   * \param qdisc the queue disc
+   * \param qdPackets the expected number of packets in the queue disc
+   * \param dequeued the expected number of packets dequeued by the queue disc
+   * \param enqueued the expected number of packets enqueued in the device queue
+   */
+  void Check (Ptr<QueueDisc> qdisc, uint32_t qdPackets, uint32_t dequeued, uint32_t enqueued);
+
+  bool m_bulk;                       //!< Whether the bulk dequeue is enabled
+  std::vector<uint64_t> m_sent;      //!< UIDs of the packets sent, in order
+  std::vector<uint64_t> m_enqueued;  //!< UIDs of the packets enqueued in the device queue, in order
+  std::vector<uint64_t> m_received;  //!< UIDs of the packets received, in order
+  uint32_t m_dequeued;               //!< Number of packets dequeued by the queue disc
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase (bool bulk)
+  : TestCase (bulk ? "Test the transmission of the packets dequeued in bulk"
+              : "Test the queue disc with the bulk dequeue disabled"),
+    m_bulk (bulk),
+    m_dequeued (0)
+{
+}
+
+TcBulkDequeueTestCase::~TcBulkDequeueTestCase ()
+{
+}
+
+void
+TcBulkDequeueTestCase::SendPackets (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      m_sent.push_back (p->GetUid ());
+      tc->Send (n->GetDevice (0), Create<BulkDequeueTestItem> (p));
+    }
+}
+
+void
+TcBulkDequeueTestCase::QueueDiscDequeue (Ptr<const QueueDiscItem> item)
+{
+  m_dequeued++;
+}
+
+void
+TcBulkDequeueTestCase::DeviceEnqueue (Ptr<const Packet> p)
+{
+  m_enqueued.push_back (p->GetUid ());
+}
+
+bool
+TcBulkDequeueTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received.push_back (p->GetUid ());
+  return true;
+}
+
+void
+TcBulkDequeueTestCase::Check (Ptr<QueueDisc> qdisc, uint32_t qdPackets, uint32_t dequeued, uint32_t enqueued)
+{
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), qdPackets, "Unexpected number of packets in the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (m_dequeued, dequeued, "Unexpected number of packets dequeued by the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (m_enqueued.size (), enqueued, "Unexpected number of packets enqueued in the device queue");
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  Ptr<Queue<Packet> > queue = CreateObjectWithAttributes<DropTailQueue<Packet> > ("MaxSize", StringValue ("3p"));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&TcBulkDequeueTestCase::DeviceEnqueue, this));
+
+  Ptr<SimpleNetDevice> txDev, rxDev;
+  txDev = CreateObjectWithAttributes<SimpleNetDevice> ("TxQueue", PointerValue (queue),
+                                                       "DataRate", DataRateValue (DataRate ("1Mb/s")));
+  rxDev = CreateObject<SimpleNetDevice> ();
+  txDev->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  rxDev->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  n.Get (0)->AddDevice (txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  txDev->SetChannel (channel);
+  rxDev->SetChannel (channel);
+  rxDev->SetReceiveCallback (MakeCallback (&TcBulkDequeueTestCase::Receive, this));
+
+  // the queue limits never stop the device queue, which is stopped when full
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "BulkDequeue", BooleanValue (m_bulk));
+  tch.SetQueueLimits ("ns3::DynamicQueueLimits", "MinLimit", UintegerValue (100000));
+  QueueDiscContainer qdiscs = tch.Install (txDev);
+  qdiscs.Get (0)->TraceConnectWithoutContext ("Dequeue", MakeCallback (&TcBulkDequeueTestCase::QueueDiscDequeue, this));
+
+  Simulator::Schedule (Seconds (0), &TcBulkDequeueTestCase::SendPackets, this, n.Get (0), 10);
+
+  // The transmission of each packet takes 1000B/1Mbps = 8ms. At time 0, the
+  // first packet is transmitted and the next three fill the device queue.
+  Simulator::Schedule (MilliSeconds (1), &TcBulkDequeueTestCase::Check, this, qdiscs.Get (0), 6, 4, 4);
+  // After 8ms, the device queue restarts and takes one packet. With the bulk
+  // dequeue, the other packets have been dequeued from the queue disc.
+  Simulator::Schedule (MilliSeconds (9), &TcBulkDequeueTestCase::Check, this, qdiscs.Get (0),
+                       m_bulk ? 0 : 5, m_bulk ? 10 : 5, 5);
+  Simulator::Schedule (MilliSeconds (17), &TcBulkDequeueTestCase::Check, this, qdiscs.Get (0),
+                       m_bulk ? 0 : 4, m_bulk ? 10 : 6, 6);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (qdiscs.Get (0)->GetNPackets (), 0, "The queue disc is not empty");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "The device queue is not empty");
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), m_sent.size (), "Not all the packets have been received");
+  for (uint32_t i = 0; i < m_sent.size () && i < m_enqueued.size () && i < m_received.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_enqueued[i], m_sent[i], "Packet " << i << " enqueued out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], m_sent[i], "Packet " << i << " received out of order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_enqueued.size (), m_sent.size (), "Packets enqueued more than once");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue limits recording the bytes they are notified
+ *
+ * The limit is large enough never to stop the device queue.
+ */
+class BatchRecordingQueueLimits : public QueueLimits
+{
+public:
+  BatchRecordingQueueLimits ();
+  virtual ~BatchRecordingQueueLimits ();
+  virtual void Reset ();
+  virtual void Completed (uint32_t count);
+  virtual int32_t Available () const;
+  virtual void Queued (uint32_t count);
+
+  std::vector<uint32_t> m_queuedCalls;  //!< Bytes notified by each call to Queued, in order
+private:
+  uint32_t m_inFlight;                  //!< Bytes queued and not completed yet
+};
+
+BatchRecordingQueueLimits::BatchRecordingQueueLimits ()
+  : m_inFlight (0)
+{
+}
+
+BatchRecordingQueueLimits::~BatchRecordingQueueLimits ()
+{
+}
+
+void
+BatchRecordingQueueLimits::Reset ()
+{
+  m_inFlight = 0;
+}
+
+void
+BatchRecordingQueueLimits::Completed (uint32_t count)
+{
+  m_inFlight -= count;
+}
+
+int32_t
+BatchRecordingQueueLimits::Available () const
+{
+  return 100000 - m_inFlight;
+}
+
+void
+BatchRecordingQueueLimits::Queued (uint32_t count)
+{
+  m_queuedCalls.push_back (count);
+  m_inFlight += count;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief SimpleNetDevice able to refuse a whole batch
+ */
+class BatchRefusingNetDevice : public SimpleNetDevice
+{
+public:
+  BatchRefusingNetDevice ();
+  virtual uint32_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+  /**
+   * Take no packet from the next batch
+   */
+  void RefuseNextBatch (void);
+
+  std::vector<uint32_t> m_batchSizes;  //!< Number of packets in each batch, in order
+private:
+  bool m_refuse;                       //!< Whether to refuse the next batch
+};
+
+BatchRefusingNetDevice::BatchRefusingNetDevice ()
+  : m_refuse (false)
+{
+}
+
+uint32_t
+BatchRefusingNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  m_batchSizes.push_back (items.size ());
+  if (m_refuse)
+    {
+      m_refuse = false;
+      return 0;
+    }
+  return SimpleNetDevice::SendBatch (items);
+}
+
+void
+BatchRefusingNetDevice::RefuseNextBatch (void)
+{
+  m_refuse = true;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Batch Transmit Test Case
+ *
+ * Packets accumulate in a FIFO queue disc, with the quota set to four, while
+ * the device queue is stopped.  When the device queue is woken, the queue
+ * disc passes a single batch of four packets to the device, which reports
+ * their bytes to the queue limits at once, and keeps the other packets until
+ * it runs again.  When the device takes no packet of a batch, the first
+ * packet is requeued and the others stay pending, to be passed to the device
+ * in the same batch by the next run.  In the end, all the packets must be
+ * transmitted once, in order.
+ */
+class TcBatchTransmitTestCase : public TestCase
+{
+public:
+  TcBatchTransmitTestCase ();
+  virtual ~TcBatchTransmitTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Send packets through the traffic control layer of a node
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendPackets (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Record a packet requeued by the queue disc
+   * \param item the packet
+   */
+  void QueueDiscRequeue (Ptr<const QueueDiscItem> item);
+  /**
+   * Record a packet enqueued in the device queue
+   * \param p the packet
+   */
+  void DeviceEnqueue (Ptr<const Packet> p);
+  /**
+   * Record a packet received by the receiver device
+   * \param dev the device
+   * \param p the packet
+   * \param protocol the protocol
+   * \param from the sender address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  /**
+   * Check the state of the queue disc and of the device
+   * \param qdisc the queue disc
+   * \param qdPackets the expected number of packets in the queue disc
+   * \param enqueued the expected number of packets enqueued in the device queue
+   * \param batches the expected number of batches passed to the device
+   * \param lastBatch the expected number of packets in the last batch
+   */
+  void Check (Ptr<QueueDisc> qdisc, uint32_t qdPackets, uint32_t enqueued, uint32_t batches, uint32_t lastBatch);
+
+  Ptr<BatchRefusingNetDevice> m_txDev;  //!< The sender device
+  std::vector<uint64_t> m_sent;         //!< UIDs of the packets sent, in order
+  std::vector<uint64_t> m_enqueued;     //!< UIDs of the packets enqueued in the device queue, in order
+  std::vector<uint64_t> m_received;     //!< UIDs of the packets received, in order
+  std::vector<uint64_t> m_requeued;     //!< UIDs of the packets requeued, in order
+};
+
+TcBatchTransmitTestCase::TcBatchTransmitTestCase ()
+  : TestCase ("Test the transmission of batches of packets")
+{
+}
+
+TcBatchTransmitTestCase::~TcBatchTransmitTestCase ()
+{
+}
+
+void
+TcBatchTransmitTestCase::SendPackets (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      m_sent.push_back (p->GetUid ());
+      tc->Send (n->GetDevice (0), Create<BulkDequeueTestItem> (p));
+    }
+}
+
+void
+TcBatchTransmitTestCase::QueueDiscRequeue (Ptr<const QueueDiscItem> item)
+{
+  m_requeued.push_back (item->GetPacket ()->GetUid ());
+}
+
+void
+TcBatchTransmitTestCase::DeviceEnqueue (Ptr<const Packet> p)
+{
+  m_enqueued.push_back (p->GetUid ());
+}
+
+bool
+TcBatchTransmitTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received.push_back (p->GetUid ());
+  return true;
+}
+
+void
+TcBatchTransmitTestCase::Check (Ptr<QueueDisc> qdisc, uint32_t qdPackets, uint32_t enqueued, uint32_t batches, uint32_t lastBatch)
+{
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), qdPackets, "Unexpected number of packets in the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (m_enqueued.size (), enqueued, "Unexpected number of packets enqueued in the device queue");
+  NS_TEST_EXPECT_MSG_EQ (m_txDev->m_batchSizes.size (), batches, "Unexpected number of batches");
+  if (batches > 0 && !m_txDev->m_batchSizes.empty ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_txDev->m_batchSizes.back (), lastBatch, "Unexpected number of packets in the last batch");
+    }
+}
+
+void
+TcBatchTransmitTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  Ptr<Queue<Packet> > queue = CreateObjectWithAttributes<DropTailQueue<Packet> > ("MaxSize", StringValue ("100p"));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&TcBatchTransmitTestCase::DeviceEnqueue, this));
+
+  m_txDev = CreateObject<BatchRefusingNetDevice> ();
+  m_txDev->SetAttribute ("TxQueue", PointerValue (queue));
+  m_txDev->SetAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  Ptr<SimpleNetDevice> rxDev = CreateObject<SimpleNetDevice> ();
+  m_txDev->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  rxDev->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  n.Get (0)->AddDevice (m_txDev);
+  n.Get (1)->AddDevice (rxDev);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  m_txDev->SetChannel (channel);
+  rxDev->SetChannel (channel);
+  rxDev->SetReceiveCallback (MakeCallback (&TcBatchTransmitTestCase::Receive, this));
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "Quota", UintegerValue (4));
+  QueueDiscContainer qdiscs = tch.Install (m_txDev);
+  Ptr<QueueDisc> qdisc = qdiscs.Get (0);
+  qdisc->TraceConnectWithoutContext ("Requeue", MakeCallback (&TcBatchTransmitTestCase::QueueDiscRequeue, this));
+
+  Ptr<NetDeviceQueue> txq = m_txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  Ptr<BatchRecordingQueueLimits> ql = CreateObject<BatchRecordingQueueLimits> ();
+  txq->SetQueueLimits (ql);
+
+  // the packets sent at time 0 stay in the queue disc until the device queue is woken
+  Simulator::Schedule (Seconds (0), &NetDeviceQueue::Stop, txq);
+  Simulator::Schedule (Seconds (0), &TcBatchTransmitTestCase::SendPackets, this, n.Get (0), 10);
+  Simulator::Schedule (MilliSeconds (1), &TcBatchTransmitTestCase::Check, this, qdisc, 10, 0, 0, 0);
+  // the wake runs the queue disc once, which passes a batch of four packets
+  // (the quota) to the device and keeps the other six
+  Simulator::Schedule (MilliSeconds (10), &NetDeviceQueue::Wake, txq);
+  Simulator::Schedule (MilliSeconds (11), &TcBatchTransmitTestCase::Check, this, qdisc, 6, 4, 1, 4);
+  // the device takes no packet of the next batch: the first packet of the
+  // batch is requeued, the other three stay pending
+  Simulator::Schedule (MilliSeconds (50), &BatchRefusingNetDevice::RefuseNextBatch, m_txDev);
+  Simulator::Schedule (MilliSeconds (50), &TcBatchTransmitTestCase::SendPackets, this, n.Get (0), 1);
+  Simulator::Schedule (MilliSeconds (51), &TcBatchTransmitTestCase::Check, this, qdisc, 3, 4, 2, 4);
+  // the next run passes the requeued packet and the pending ones in a batch
+  Simulator::Schedule (MilliSeconds (60), &TcBatchTransmitTestCase::SendPackets, this, n.Get (0), 1);
+  Simulator::Schedule (MilliSeconds (61), &TcBatchTransmitTestCase::Check, this, qdisc, 4, 8, 3, 4);
+  Simulator::Schedule (MilliSeconds (70), &TcBatchTransmitTestCase::SendPackets, this, n.Get (0), 1);
+  Simulator::Schedule (MilliSeconds (71), &TcBatchTransmitTestCase::Check, this, qdisc, 1, 12, 4, 4);
+  Simulator::Schedule (MilliSeconds (80), &TcBatchTransmitTestCase::SendPackets, this, n.Get (0), 1);
+  Simulator::Schedule (MilliSeconds (81), &TcBatchTransmitTestCase::Check, this, qdisc, 0, 14, 5, 2);
+
+  Simulator::Run ();
+
+  uint32_t qdPackets = qdisc->GetNPackets ();
+  uint32_t devPackets = queue->GetNPackets ();
+  m_txDev = 0;
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_requeued.size (), 1, "Exactly one packet should have been requeued");
+  if (!m_requeued.empty ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_requeued[0], m_sent[4], "The first packet of the refused batch should have been requeued");
+    }
+
+  // the bytes of each batch taken by the device are reported once
+  uint32_t batchBytes[] = { 4000, 4000, 4000, 2000 };
+  NS_TEST_EXPECT_MSG_EQ (ql->m_queuedCalls.size (), 4, "The bytes should be reported once per batch");
+  for (uint32_t i = 0; i < std::min<std::size_t> (ql->m_queuedCalls.size (), 4); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ql->m_queuedCalls[i], batchBytes[i], "Unexpected bytes reported for batch " << i);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (qdPackets, 0, "The queue disc is not empty");
+  NS_TEST_EXPECT_MSG_EQ (devPackets, 0, "The device queue is not empty");
+  NS_TEST_EXPECT_MSG_EQ (m_received.size (), m_sent.size (), "Not all the packets have been received");
+  NS_TEST_EXPECT_MSG_EQ (m_enqueued.size (), m_sent.size (), "Packets enqueued more than once");
+  for (uint32_t i = 0; i < m_sent.size () && i < m_enqueued.size () && i < m_received.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_enqueued[i], m_sent[i], "Packet " << i << " enqueued out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], m_sent[i], "Packet " << i << " received out of order");
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Bulk Dequeue Test Suite
+ */
+static class TcBulkDequeueTestSuite : public TestSuite
+{
+public:
+  TcBulkDequeueTestSuite ()
+    : TestSuite ("tc-bulk-dequeue", UNIT)
+  {
+    AddTestCase (new TcBulkDequeueTestCase (true), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcBatchTransmitTestCase (), TestCase::QUICK);
+  }
+} g_tcBulkDequeueTestSuite; ///< the test suite
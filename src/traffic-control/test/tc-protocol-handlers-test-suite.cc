@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/traffic-control-layer.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Protocol handler recording the order of its calls
+ */
+class OrderRecordingProtocolHandler : public SimpleRefCount<OrderRecordingProtocolHandler>
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param calls the vector where the calls are recorded
+   * \param id the identifier recorded at each call
+   */
+  OrderRecordingProtocolHandler (std::vector<uint32_t> *calls, uint32_t id);
+  /**
+   * Record a received packet
+   * \param device the device
+   * \param p the packet
+   * \param protocol the protocol
+   * \param from the sender address
+   * \param to the destination address
+   * \param packetType the type of the packet
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+private:
+  std::vector<uint32_t> *m_calls;  //!< Vector where the calls are recorded
+  uint32_t m_id;                   //!< Identifier recorded at each call
+};
+
+OrderRecordingProtocolHandler::OrderRecordingProtocolHandler (std::vector<uint32_t> *calls, uint32_t id)
+  : m_calls (calls),
+    m_id (id)
+{
+}
+
+void
+OrderRecordingProtocolHandler::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                        const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_calls->push_back (m_id);
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Protocol Handlers Test Case
+ *
+ * Handlers are registered for a single device or for all the devices, and
+ * for a single protocol or for all the protocols.  The traffic control layer
+ * must call the handlers matching a received packet in the order they were
+ * registered.
+ */
+class TcProtocolHandlersTestCase : public TestCase
+{
+public:
+  TcProtocolHandlersTestCase ();
+  virtual ~TcProtocolHandlersTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Register a handler
+   * \param tc the traffic control layer
+   * \param id the identifier recorded by the handler
+   * \param protocol the protocol of the handler
+   * \param device the device of the handler, or 0 for all the devices
+   */
+  void Register (Ptr<TrafficControlLayer> tc, uint32_t id, uint16_t protocol, Ptr<NetDevice> device);
+  /**
+   * Pass a packet to the traffic control layer and check the handlers called
+   * \param tc the traffic control layer
+   * \param device the receiving device
+   * \param protocol the protocol of the packet
+   * \param expected the identifiers of the handlers expected to be called, in order
+   */
+  void Check (Ptr<TrafficControlLayer> tc, Ptr<NetDevice> device, uint16_t protocol,
+              std::vector<uint32_t> expected);
+
+  std::vector<Ptr<OrderRecordingProtocolHandler> > m_handlers;  //!< The registered handlers
+  std::vector<uint32_t> m_calls;                                //!< Identifiers of the handlers called
+};
+
+TcProtocolHandlersTestCase::TcProtocolHandlersTestCase ()
+  : TestCase ("Test the order in which the protocol handlers are called")
+{
+}
+
+TcProtocolHandlersTestCase::~TcProtocolHandlersTestCase ()
+{
+}
+
+void
+TcProtocolHandlersTestCase::Register (Ptr<TrafficControlLayer> tc, uint32_t id, uint16_t protocol, Ptr<NetDevice> device)
+{
+  Ptr<OrderRecordingProtocolHandler> handler = Create<OrderRecordingProtocolHandler> (&m_calls, id);
+  m_handlers.push_back (handler);
+  tc->RegisterProtocolHandler (MakeCallback (&OrderRecordingProtocolHandler::Receive, handler),
+                               protocol, device);
+}
+
+void
+TcProtocolHandlersTestCase::Check (Ptr<TrafficControlLayer> tc, Ptr<NetDevice> device, uint16_t protocol,
+                                   std::vector<uint32_t> expected)
+{
+  m_calls.clear ();
+  tc->Receive (device, Create<Packet> (100), protocol, Mac48Address ("00:00:00:00:00:09"),
+               device->GetAddress (), NetDevice::PACKET_HOST);
+  NS_TEST_EXPECT_MSG_EQ (m_calls.size (), expected.size (), "Unexpected number of handlers called");
+  for (uint32_t i = 0; i < m_calls.size () && i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_calls[i], expected[i], "Handler " << i << " called out of order");
+    }
+}
+
+void
+TcProtocolHandlersTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<TrafficControlLayer> tc = CreateObject<TrafficControlLayer> ();
+  node->AggregateObject (tc);
+
+  Ptr<SimpleNetDevice> dev0 = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> dev1 = CreateObject<SimpleNetDevice> ();
+  dev0->SetAddress (Mac48Address ("00:00:00:00:00:01"));
+  dev1->SetAddress (Mac48Address ("00:00:00:00:00:02"));
+  node->AddDevice (dev0);
+  node->AddDevice (dev1);
+
+  Register (tc, 0, 0x0800, 0);
+  Register (tc, 1, 0x0800, dev0);
+  Register (tc, 2, 0, 0);
+  Register (tc, 3, 0x0800, dev1);
+  Register (tc, 4, 0, dev0);
+  Register (tc, 5, 0x0806, 0);
+  Register (tc, 6, 0x0806, dev0);
+
+  uint32_t ipv4Dev0[] = { 0, 1, 2, 4 };
+  Check (tc, dev0, 0x0800, std::vector<uint32_t> (ipv4Dev0, ipv4Dev0 + 4));
+  uint32_t ipv4Dev1[] = { 0, 2, 3 };
+  Check (tc, dev1, 0x0800, std::vector<uint32_t> (ipv4Dev1, ipv4Dev1 + 3));
+  uint32_t arpDev0[] = { 2, 4, 5, 6 };
+  Check (tc, dev0, 0x0806, std::vector<uint32_t> (arpDev0, arpDev0 + 4));
+  uint32_t arpDev1[] = { 2, 5 };
+  Check (tc, dev1, 0x0806, std::vector<uint32_t> (arpDev1, arpDev1 + 2));
+
+  m_handlers.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Protocol Handlers Test Suite
+ */
+static class TcProtocolHandlersTestSuite : public TestSuite
+{
+public:
+  TcProtocolHandlersTestSuite ()
+    : TestSuite ("tc-protocol-handlers", UNIT)
+  {
+    AddTestCase (new TcProtocolHandlersTestCase (), TestCase::QUICK);
+  }
+} g_tcProtocolHandlersTestSuite; ///< the test suite
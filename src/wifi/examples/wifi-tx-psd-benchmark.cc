@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the wall clock time taken by a saturated ad hoc
+// network of SpectrumWifiPhy devices, with and without the cache of the
+// transmit power spectral densities (SpectrumWifiPhy::CacheTxPsd attribute).
+//
+// Example usage:
+//   ./waf --run "wifi-tx-psd-benchmark --nStations=20 --simulationTime=2"
+
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/spectrum-wifi-helper.h"
+#include "ns3/multi-model-spectrum-channel.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-client.h"
+#include "ns3/packet-socket-server.h"
+
+using namespace ns3;
+
+static uint64_t g_rxPackets; ///< number of PHY receptions
+
+/**
+ * PHY reception trace sink
+ * \param context the context
+ * \param p the packet
+ */
+static void
+PhyRxEnd (std::string context, Ptr<const Packet> p)
+{
+  g_rxPackets++;
+}
+
+/**
+ * Run the scenario once.
+ *
+ * \param cacheTxPsd whether the Tx PSD cache is enabled
+ * \param nStations the number of stations
+ * \param standard the Wi-Fi standard
+ * \param simulationTime the simulated time (seconds)
+ * \param[out] rxPackets the number of packets received by all the stations
+ * \return the elapsed wall clock time (ms)
+ */
+static int64_t
+RunOne (bool cacheTxPsd, uint32_t nStations, WifiPhyStandard standard, double simulationTime, uint64_t &rxPackets)
+{
+  Config::SetDefault ("ns3::SpectrumWifiPhy::CacheTxPsd", BooleanValue (cacheTxPsd));
+
+  NodeContainer nodes;
+  nodes.Create (nStations);
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->AddPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  SpectrumWifiPhyHelper phy = SpectrumWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetStandard (standard);
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (1.0),
+                                 "DeltaY", DoubleValue (1.0),
+                                 "GridWidth", UintegerValue (10));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (nodes);
+
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      PacketSocketAddress socket;
+      socket.SetSingleDevice (devices.Get (i)->GetIfIndex ());
+      socket.SetPhysicalAddress (devices.Get ((i + 1) % nStations)->GetAddress ());
+      socket.SetProtocol (1);
+
+      Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient> ();
+      client->SetRemote (socket);
+      client->SetAttribute ("PacketSize", UintegerValue (1000));
+      client->SetAttribute ("MaxPackets", UintegerValue (0));
+      client->SetAttribute ("Interval", TimeValue (MicroSeconds (100)));
+      nodes.Get (i)->AddApplication (client);
+      client->SetStartTime (Seconds (0.1));
+
+      Ptr<PacketSocketServer> server = CreateObject<PacketSocketServer> ();
+      server->SetLocal (socket);
+      nodes.Get ((i + 1) % nStations)->AddApplication (server);
+    }
+
+  g_rxPackets = 0;
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd", MakeCallback (&PhyRxEnd));
+
+  Simulator::Stop (Seconds (simulationTime + 0.1));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  rxPackets = g_rxPackets;
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nStations = 10;
+  double simulationTime = 1; //seconds
+  std::string standard = "11ac";
+
+  CommandLine cmd;
+  cmd.AddValue ("nStations", "Number of stations", nStations);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("standard", "Wi-Fi standard (11a, 11n, 11ac or 11ax)", standard);
+  cmd.Parse (argc, argv);
+
+  WifiPhyStandard phyStandard = WIFI_PHY_STANDARD_80211ac;
+  if (standard == "11a")
+    {
+      phyStandard = WIFI_PHY_STANDARD_80211a;
+    }
+  else if (standard == "11n")
+    {
+      phyStandard = WIFI_PHY_STANDARD_80211n_5GHZ;
+    }
+  else if (standard == "11ax")
+    {
+      phyStandard = WIFI_PHY_STANDARD_80211ax_5GHZ;
+    }
+  else if (standard != "11ac")
+    {
+      NS_FATAL_ERROR ("Unsupported standard: " << standard);
+    }
+
+  uint64_t rxUncached;
+  uint64_t rxCached;
+  int64_t uncached = RunOne (false, nStations, phyStandard, simulationTime, rxUncached);
+  int64_t cached = RunOne (true, nStations, phyStandard, simulationTime, rxCached);
+
+  std::cout << "Tx PSD built per transmission: " << uncached << " ms, " << rxUncached << " PHY receptions" << std::endl;
+  std::cout << "Tx PSD from cached templates:  " << cached << " ms, " << rxCached << " PHY receptions" << std::endl;
+  if (cached > 0)
+    {
+      std::cout << "Speedup: " << static_cast<double> (uncached) / cached << std::endl;
+    }
+  return 0;
+}
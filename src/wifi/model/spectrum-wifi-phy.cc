@@ -39,6 +39,73 @@ NS_LOG_COMPONENT_DEFINE ("SpectrumWifiPhy");
 
 NS_OBJECT_ENSURE_REGISTERED (SpectrumWifiPhy);
 
+/// Tx PSD template key structure
+struct TxPsdTemplateId
+{
+  /**
+   * Constructor
+   * \param f the center frequency (in MHz)
+   * \param w the channel width (in MHz)
+   * \param g the guard band width (in MHz)
+   * \param m the modulation class
+   */
+  TxPsdTemplateId (uint16_t f, uint16_t w, uint16_t g, WifiModulationClass m);
+  uint16_t m_centerFrequency;         ///< center frequency (in MHz)
+  uint16_t m_channelWidth;            ///< channel width (in MHz)
+  uint16_t m_guardBandwidth;          ///< guard band width (in MHz)
+  WifiModulationClass m_modulation;   ///< modulation class
+};
+
+TxPsdTemplateId::TxPsdTemplateId (uint16_t f, uint16_t w, uint16_t g, WifiModulationClass m)
+  : m_centerFrequency (f),
+    m_channelWidth (w),
+    m_guardBandwidth (g),
+    m_modulation (m)
+{
+  // modulation classes sharing the same spectrum mask share the same template
+  switch (m)
+    {
+    case WIFI_MOD_CLASS_ERP_OFDM:
+      m_modulation = WIFI_MOD_CLASS_OFDM;
+      break;
+    case WIFI_MOD_CLASS_HR_DSSS:
+      m_modulation = WIFI_MOD_CLASS_DSSS;
+      break;
+    case WIFI_MOD_CLASS_VHT:
+      m_modulation = WIFI_MOD_CLASS_HT;
+      break;
+    default:
+      break;
+    }
+}
+
+/**
+ * Less than operator
+ * \param a the first Tx PSD template key to compare
+ * \param b the second Tx PSD template key to compare
+ * \returns true if the first key is less than the second key
+ */
+bool
+operator < (const TxPsdTemplateId& a, const TxPsdTemplateId& b)
+{
+  if (a.m_centerFrequency != b.m_centerFrequency)
+    {
+      return a.m_centerFrequency < b.m_centerFrequency;
+    }
+  if (a.m_channelWidth != b.m_channelWidth)
+    {
+      return a.m_channelWidth < b.m_channelWidth;
+    }
+  if (a.m_guardBandwidth != b.m_guardBandwidth)
+    {
+      return a.m_guardBandwidth < b.m_guardBandwidth;
+    }
+  return a.m_modulation < b.m_modulation;
+}
+
+/// Tx PSDs normalized to 1 W, shared by all the SpectrumWifiPhy instances
+static std::map<TxPsdTemplateId, Ptr<const SpectrumValue> > g_txPsdTemplateMap;
+
 TypeId
 SpectrumWifiPhy::GetTypeId (void)
 {
@@ -50,6 +117,14 @@ SpectrumWifiPhy::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&SpectrumWifiPhy::m_disableWifiReception),
                    MakeBooleanChecker ())
+    .AddAttribute ("CacheTxPsd",
+                   "If true, the transmit PSD is obtained by scaling a cached PSD normalized "
+                   "to 1 W for the channel in use, and is reused as long as the transmit power "
+                   "does not change. Otherwise, it is built from the spectrum mask for every "
+                   "transmission.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&SpectrumWifiPhy::m_cacheTxPsd),
+                   MakeBooleanChecker ())
     .AddTraceSource ("SignalArrival",
                      "Signal arrival",
                      MakeTraceSourceAccessor (&SpectrumWifiPhy::m_signalCb),
@@ -59,6 +134,7 @@ SpectrumWifiPhy::GetTypeId (void)
 }
 
 SpectrumWifiPhy::SpectrumWifiPhy ()
+  : m_lastTxPowerW (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -74,6 +150,8 @@ SpectrumWifiPhy::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_channel = 0;
   m_wifiSpectrumPhyInterface = 0;
+  m_lastTxPsd = 0;
+  m_lastTxPsdTemplate = 0;
   WifiPhy::DoDispose ();
 }
 
@@ -286,6 +364,33 @@ SpectrumWifiPhy::CreateWifiSpectrumPhyInterface (Ptr<NetDevice> device)
 
 Ptr<SpectrumValue>
 SpectrumWifiPhy::GetTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, WifiModulationClass modulationClass) const
+{
+  NS_LOG_FUNCTION (centerFrequency << channelWidth << txPowerW);
+  if (!m_cacheTxPsd)
+    {
+      return CreateTxPowerSpectralDensity (centerFrequency, channelWidth, txPowerW, modulationClass);
+    }
+  TxPsdTemplateId key (centerFrequency, channelWidth, GetGuardBandwidth (channelWidth), modulationClass);
+  std::map<TxPsdTemplateId, Ptr<const SpectrumValue> >::const_iterator it = g_txPsdTemplateMap.find (key);
+  if (it == g_txPsdTemplateMap.end ())
+    {
+      NS_LOG_DEBUG ("Creating Tx PSD template for (" << centerFrequency << ", " << channelWidth << ", " << modulationClass << ")");
+      it = g_txPsdTemplateMap.insert (std::make_pair (key, CreateTxPowerSpectralDensity (centerFrequency, channelWidth, 1.0, modulationClass))).first;
+    }
+  // The Tx PSD is not modified by the spectrum channels (they work on copies),
+  // hence the same instance can be handed out as long as nothing changes
+  if (m_lastTxPsdTemplate != it->second || m_lastTxPowerW != txPowerW)
+    {
+      m_lastTxPsd = it->second->Copy ();
+      *m_lastTxPsd *= txPowerW;
+      m_lastTxPsdTemplate = it->second;
+      m_lastTxPowerW = txPowerW;
+    }
+  return m_lastTxPsd;
+}
+
+Ptr<SpectrumValue>
+SpectrumWifiPhy::CreateTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, WifiModulationClass modulationClass) const
 {
   NS_LOG_FUNCTION (centerFrequency << channelWidth << txPowerW);
   Ptr<SpectrumValue> v;
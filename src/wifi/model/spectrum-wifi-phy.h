@@ -31,6 +31,8 @@
 #include "ns3/spectrum-model.h"
 #include "wifi-phy.h"
 
+class SpectrumWifiPhyTxPsdTest;
+
 namespace ns3 {
 
 class WifiSpectrumPhyInterface;
@@ -50,6 +52,9 @@ class WifiSpectrumPhyInterface;
 class SpectrumWifiPhy : public WifiPhy
 {
 public:
+  /// Allow test cases to access private members
+  friend class ::SpectrumWifiPhyTxPsdTest;
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -203,6 +208,17 @@ private:
    * to the standard in use.
    */
   Ptr<SpectrumValue> GetTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, WifiModulationClass modulationClass) const;
+  /**
+   * \param centerFrequency center frequency (MHz)
+   * \param channelWidth channel width (MHz) of the channel for the current transmission
+   * \param txPowerW power in W to spread across the bands
+   * \param modulationClass the modulation class
+   * \return Ptr to SpectrumValue
+   *
+   * Build the Tx PSD through the WifiSpectrumValueHelper, without
+   * looking up the PSD templates.
+   */
+  Ptr<SpectrumValue> CreateTxPowerSpectralDensity (uint16_t centerFrequency, uint16_t channelWidth, double txPowerW, WifiModulationClass modulationClass) const;
 
   /**
    * Perform run-time spectrum model change
@@ -216,6 +232,10 @@ private:
   Ptr<AntennaModel> m_antenna; //!< antenna model
   mutable Ptr<const SpectrumModel> m_rxSpectrumModel; //!< receive spectrum model
   bool m_disableWifiReception;          //!< forces this Phy to fail to sync on any signal
+  bool m_cacheTxPsd;                    //!< whether Tx PSDs are obtained by scaling cached templates
+  mutable Ptr<SpectrumValue> m_lastTxPsd;   //!< last Tx PSD returned by GetTxPowerSpectralDensity
+  mutable Ptr<const SpectrumValue> m_lastTxPsdTemplate; //!< template the last Tx PSD was obtained from
+  mutable double m_lastTxPowerW;        //!< Tx power (W) of the last Tx PSD
   TracedCallback<bool, uint32_t, double, Time> m_signalCb; //!< Signal callback
 
 };
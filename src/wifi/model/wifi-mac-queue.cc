@@ -31,6 +31,9 @@ NS_LOG_COMPONENT_DEFINE ("WifiMacQueue");
 
 NS_OBJECT_ENSURE_REGISTERED (WifiMacQueue);
 
+/// TID used in the secondary index for the frames that are not QoS data frames
+static const uint8_t NON_QOS_TID = 255;
+
 TypeId
 WifiMacQueue::GetTypeId (void)
 {
@@ -52,7 +55,9 @@ WifiMacQueue::GetTypeId (void)
 }
 
 WifiMacQueue::WifiMacQueue ()
-  : NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
+  : m_headSeq (0),
+    m_tailSeq (0),
+    NS_LOG_TEMPLATE_DEFINE ("WifiMacQueue")
 {
 }
 
@@ -90,6 +95,148 @@ WifiMacQueue::TtlExceeded (ConstIterator &it)
   return false;
 }
 
+WifiMacQueue::IndexKey
+WifiMacQueue::GetIndexKey (Ptr<const WifiMacQueueItem> item)
+{
+  if (item->GetHeader ().IsQosData ())
+    {
+      return IndexKey (item->GetDestinationAddress (), item->GetHeader ().GetQosTid ());
+    }
+  return IndexKey (item->GetDestinationAddress (), NON_QOS_TID);
+}
+
+bool
+WifiMacQueue::DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  NS_ASSERT (pos == Head () || pos == Tail ());
+  bool atHead = (pos == Head ());
+
+  if (!Queue<WifiMacQueueItem>::DoEnqueue (pos, item))
+    {
+      return false;
+    }
+
+  IndexKey key = GetIndexKey (item);
+  IndexEntry entry;
+  std::list<IndexEntry> &items = m_index[key];
+  if (atHead)
+    {
+      entry.seq = --m_headSeq;
+      entry.it = Head ();
+      if (!items.empty ())
+        {
+          m_heads.erase (std::make_pair (items.front ().seq, key));
+        }
+      items.push_front (entry);
+      m_heads.insert (std::make_pair (entry.seq, key));
+    }
+  else
+    {
+      entry.seq = m_tailSeq++;
+      entry.it = std::prev (Tail ());
+      if (items.empty ())
+        {
+          m_heads.insert (std::make_pair (entry.seq, key));
+        }
+      items.push_back (entry);
+    }
+  return true;
+}
+
+void
+WifiMacQueue::RemoveFromIndex (ConstIterator pos)
+{
+  NS_LOG_FUNCTION (this);
+  IndexKey key = GetIndexKey (*pos);
+  Index::iterator idx = m_index.find (key);
+  NS_ASSERT (idx != m_index.end ());
+  std::list<IndexEntry> &items = idx->second;
+  // the item to remove is most often the first one having its key
+  if (items.front ().it == pos)
+    {
+      m_heads.erase (std::make_pair (items.front ().seq, key));
+      items.pop_front ();
+      if (items.empty ())
+        {
+          m_index.erase (idx);
+        }
+      else
+        {
+          m_heads.insert (std::make_pair (items.front ().seq, key));
+        }
+      return;
+    }
+  for (auto entry = std::next (items.begin ()); entry != items.end (); entry++)
+    {
+      if (entry->it == pos)
+        {
+          items.erase (entry);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Item not found in the index");
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueue::DoDequeue (ConstIterator pos)
+{
+  RemoveFromIndex (pos);
+  return Queue<WifiMacQueueItem>::DoDequeue (pos);
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueue::DoRemove (ConstIterator pos)
+{
+  RemoveFromIndex (pos);
+  return Queue<WifiMacQueueItem>::DoRemove (pos);
+}
+
+WifiMacQueue::ConstIterator
+WifiMacQueue::GetFirstValid (const IndexKey &key)
+{
+  NS_LOG_FUNCTION (this);
+  // TtlExceeded removes the stale item from the index, and the list of
+  // items with it once it is empty
+  for (Index::iterator idx = m_index.find (key); idx != m_index.end (); idx = m_index.find (key))
+    {
+      ConstIterator it = idx->second.front ().it;
+      if (!TtlExceeded (it))
+        {
+          return it;
+        }
+    }
+  return Tail ();
+}
+
+WifiMacQueue::ConstIterator
+WifiMacQueue::GetFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
+{
+  NS_LOG_FUNCTION (this);
+  // the first items of every key, in queue order: only the keys that are
+  // blocked are skipped before the first available item is found
+  Heads::iterator head = m_heads.begin ();
+  while (head != m_heads.end ())
+    {
+      Heads::value_type first = *head;
+      if (first.second.second != NON_QOS_TID
+          && blockedPackets->IsBlocked (first.second.first, first.second.second))
+        {
+          head++;
+          continue;
+        }
+      ConstIterator it = m_index.find (first.second)->second.front ().it;
+      if (!TtlExceeded (it))
+        {
+          return it;
+        }
+      // the stale item has been removed, along with its entry in m_heads;
+      // the entries before it are unchanged
+      head = m_heads.lower_bound (first);
+    }
+  return Tail ();
+}
+
 bool
 WifiMacQueue::Enqueue (Ptr<WifiMacQueueItem> item)
 {
@@ -185,18 +332,10 @@ WifiMacQueue::DequeueByTidAndAddress (uint8_t tid,
                                       WifiMacHeader::AddressType type, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  for (auto it = Head (); it != Tail (); )
+  ConstIterator it = GetFirstValid (IndexKey (dest, tid));
+  if (it != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
-        }
+      return DoDequeue (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -206,18 +345,10 @@ Ptr<WifiMacQueueItem>
 WifiMacQueue::DequeueFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  ConstIterator it = GetFirstAvailable (blockedPackets);
+  if (it != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          if (!(*it)->GetHeader ().IsQosData ()
-              || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
-            {
-              return DoDequeue (it);
-            }
-
-          it++;
-        }
+      return DoDequeue (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -245,18 +376,10 @@ WifiMacQueue::PeekByTidAndAddress (uint8_t tid,
                                    WifiMacHeader::AddressType type, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  for (auto it = Head (); it != Tail (); )
+  ConstIterator it = GetFirstValid (IndexKey (dest, tid));
+  if (it != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return DoPeek (it);
-            }
-
-          it++;
-        }
+      return DoPeek (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -266,18 +389,10 @@ Ptr<const WifiMacQueueItem>
 WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it = Head (); it != Tail (); )
+  ConstIterator it = GetFirstAvailable (blockedPackets);
+  if (it != Tail ())
     {
-      if (!TtlExceeded (it))
-        {
-          if (!(*it)->GetHeader ().IsQosData ()
-              || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
-            {
-              return DoPeek (it);
-            }
-
-          it++;
-        }
+      return DoPeek (it);
     }
   NS_LOG_DEBUG ("The queue is empty");
   return 0;
@@ -348,17 +463,23 @@ WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
   uint32_t nPackets = 0;
-  for (auto it = Head (); it != Tail (); )
+  Index::iterator idx = m_index.find (IndexKey (dest, tid));
+  if (idx != m_index.end ())
     {
-      if (!TtlExceeded (it))
+      // TtlExceeded erases the entry if the item is removed, and the list
+      // of items with the last entry
+      std::vector<ConstIterator> items;
+      items.reserve (idx->second.size ());
+      for (auto &entry : idx->second)
+        {
+          items.push_back (entry.it);
+        }
+      for (auto it : items)
         {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
+          if (!TtlExceeded (it))
             {
               nPackets++;
             }
-
-          it++;
         }
     }
   NS_LOG_DEBUG ("returns " << nPackets);
@@ -25,6 +25,9 @@
 #define WIFI_MAC_QUEUE_H
 
 #include "wifi-mac-queue-item.h"
+#include <map>
+#include <set>
+#include <list>
 
 namespace ns3 {
 
@@ -44,6 +47,11 @@ class QosBlockedDestinations;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * In addition to the FIFO list of items, the queue maintains a secondary
+ * index of the items per receiver address and TID, so that the methods
+ * searching for an item by TID and address do not need to scan the whole
+ * queue. Such methods only drop the stale packets they encounter.
  */
 class WifiMacQueue : public Queue<WifiMacQueueItem>
 {
@@ -235,8 +243,89 @@ private:
    */
   bool TtlExceeded (ConstIterator &it);
 
+  /**
+   * Key of the secondary index: the receiver address and the TID of QoS data
+   * frames, or the receiver address and NON_QOS_TID for all the other frames.
+   */
+  typedef std::pair<Mac48Address, uint8_t> IndexKey;
+
+  /// An item of the secondary index
+  struct IndexEntry
+  {
+    int64_t seq;        //!< position of the item in the queue (increasing from head to tail)
+    ConstIterator it;   //!< iterator pointing to the item in the queue
+  };
+
+  /// The secondary index: for each key, the items in the same order as in the queue
+  typedef std::map<IndexKey, std::list<IndexEntry> > Index;
+
+  /// The sequence number and the key of the first item of each key, in queue order
+  typedef std::set<std::pair<int64_t, IndexKey> > Heads;
+
+  /**
+   * \param item the Wifi MAC queue item
+   * \return the key of the secondary index the item belongs to
+   */
+  static IndexKey GetIndexKey (Ptr<const WifiMacQueueItem> item);
+
+  /**
+   * Return the first item (in queue order) having the given key, after
+   * removing the items with that key that stayed in the queue for too long.
+   *
+   * \param key the key of the secondary index
+   * \return an iterator pointing to the item, or Tail () if there is no such item
+   */
+  ConstIterator GetFirstValid (const IndexKey &key);
+
+  /**
+   * Return the first item (in queue order) that is not a QoS data frame or whose
+   * receiver address and TID are not blocked, after removing the stale items
+   * encountered.
+   *
+   * \param blockedPackets the blocked destinations
+   * \return an iterator pointing to the item, or Tail () if there is no such item
+   */
+  ConstIterator GetFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets);
+
+  /**
+   * Insert the given item in the queue and in the secondary index. Only
+   * insertions at the head or at the tail of the queue are supported.
+   * Hides Queue::DoEnqueue.
+   *
+   * \param pos the position before which the item will be inserted
+   * \param item the item to enqueue
+   * \return true if success, false if the packet has been dropped
+   */
+  bool DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item);
+  /**
+   * Dequeue the given item and remove it from the secondary index.
+   * Hides Queue::DoDequeue.
+   *
+   * \param pos the position of the item to dequeue
+   * \return the item
+   */
+  Ptr<WifiMacQueueItem> DoDequeue (ConstIterator pos);
+  /**
+   * Remove (and drop) the given item and remove it from the secondary index.
+   * Hides Queue::DoRemove.
+   *
+   * \param pos the position of the item to remove
+   * \return the item
+   */
+  Ptr<WifiMacQueueItem> DoRemove (ConstIterator pos);
+  /**
+   * Remove the item pointed to by the given iterator from the secondary index.
+   *
+   * \param pos the position of the item
+   */
+  void RemoveFromIndex (ConstIterator pos);
+
   Time m_maxDelay;                          //!< Time to live for packets in the queue
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
+  Index m_index;                            //!< Per receiver/TID index of the queued items
+  Heads m_heads;                            //!< First item of each receiver/TID, in queue order
+  int64_t m_headSeq;                        //!< sequence number of the last item enqueued at the head
+  int64_t m_tailSeq;                        //!< sequence number of the next item enqueued at the tail
 
   NS_LOG_TEMPLATE_DECLARE;                  //!< redefinition of the log component
 };
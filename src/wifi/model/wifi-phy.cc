@@ -304,6 +304,13 @@ WifiPhy::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&WifiPhy::m_frameCaptureModel),
                    MakePointerChecker <FrameCaptureModel> ())
+    .AddAttribute ("TxDurationCacheSize",
+                   "The maximum number of entries of the cache of the durations computed by "
+                   "CalculateTxDuration and GetPayloadDuration. The cache is emptied when it is full. "
+                   "A value of zero disables the cache.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&WifiPhy::m_txDurationCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("PhyTxBegin",
                      "Trace source indicating a packet "
                      "has begun transmitting over the channel medium",
@@ -372,6 +379,9 @@ WifiPhy::WifiPhy ()
     m_initialChannelNumber (0),
     m_totalAmpduSize (0),
     m_totalAmpduNumSymbols (0),
+    m_txDurationCacheSize (0),
+    m_txDurationCacheHits (0),
+    m_txDurationCacheMisses (0),
     m_currentEvent (0),
     m_wifiRadioEnergyModel (0)
 {
@@ -395,6 +405,7 @@ WifiPhy::DoDispose (void)
   m_wifiRadioEnergyModel = 0;
   m_deviceRateSet.clear ();
   m_deviceMcsSet.clear ();
+  m_txDurationCache.clear ();
 }
 
 void
@@ -611,6 +622,7 @@ WifiPhy::SetShortGuardInterval (bool shortGuardInterval)
 {
   NS_LOG_FUNCTION (this << shortGuardInterval);
   m_shortGuardInterval = shortGuardInterval;
+  FlushTxDurationCache ();
 }
 
 bool
@@ -625,6 +637,7 @@ WifiPhy::SetGuardInterval (Time guardInterval)
   NS_LOG_FUNCTION (this << guardInterval);
   NS_ASSERT (guardInterval == NanoSeconds (800) || guardInterval == NanoSeconds (1600) || guardInterval == NanoSeconds (3200));
   m_guardInterval = guardInterval;
+  FlushTxDurationCache ();
 }
 
 Time
@@ -1121,6 +1134,7 @@ WifiPhy::ConfigureStandard (WifiPhyStandard standard)
   NS_LOG_FUNCTION (this << standard);
   m_standard = standard;
   m_isConstructed = true;
+  FlushTxDurationCache ();
   if (m_frequencyChannelNumberInitialized == false)
     {
       InitializeFrequencyChannelNumber ();
@@ -1217,6 +1231,7 @@ WifiPhy::SetFrequency (uint16_t frequency)
           NS_LOG_DEBUG ("Channel frequency switched to " << frequency << "; channel number to " << +nch);
           m_channelCenterFrequency = frequency;
           m_channelNumber = nch;
+          FlushTxDurationCache ();
         }
       else
         {
@@ -1231,6 +1246,7 @@ WifiPhy::SetFrequency (uint16_t frequency)
           NS_LOG_DEBUG ("Channel frequency switched to " << frequency << "; channel number to " << 0);
           m_channelCenterFrequency = frequency;
           m_channelNumber = 0;
+          FlushTxDurationCache ();
         }
       else
         {
@@ -1252,6 +1268,7 @@ WifiPhy::SetChannelWidth (uint16_t channelwidth)
   NS_ASSERT_MSG (channelwidth == 5 || channelwidth == 10 || channelwidth == 20 || channelwidth == 22 || channelwidth == 40 || channelwidth == 80 || channelwidth == 160, "wrong channel width value");
   bool changed = (m_channelWidth == channelwidth);
   m_channelWidth = channelwidth;
+  FlushTxDurationCache ();
   AddSupportedChannelWidth (channelwidth);
   if (changed && !m_capabilitiesChangedCallback.IsNull ())
     {
@@ -1940,6 +1957,24 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
 
 Time
 WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
+{
+  const TxDurationCacheEntry *entry = LookupTxDurationCache (size, txVector, frequency, mpdutype);
+  if (entry == 0)
+    {
+      double numSymbols;
+      return DoGetPayloadDuration (size, txVector, frequency, mpdutype, incFlag, numSymbols);
+    }
+  if (incFlag == 1 && mpdutype == MPDU_IN_AGGREGATE)
+    {
+      m_totalAmpduSize += size;
+      m_totalAmpduNumSymbols += entry->numSymbols;
+    }
+  return entry->payload;
+}
+
+Time
+WifiPhy::DoGetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency,
+                               MpduType mpdutype, uint8_t incFlag, double &numSymbols)
 {
   WifiMode payloadMode = txVector.GetMode ();
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -2113,7 +2148,7 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
 
   double numDataBitsPerSymbol = payloadMode.GetDataRate (txVector) * symbolDuration.GetNanoSeconds () / 1e9;
 
-  double numSymbols = 0;
+  numSymbols = 0;
   if (mpdutype == MPDU_IN_AGGREGATE && preamble != WIFI_PREAMBLE_NONE)
     {
       //First packet in an A-MPDU
@@ -2225,9 +2260,117 @@ WifiPhy::CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector)
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
 {
-  Time duration = CalculatePlcpPreambleAndHeaderDuration (txVector)
-    + GetPayloadDuration (size, txVector, frequency, mpdutype, incFlag);
-  return duration;
+  const TxDurationCacheEntry *entry = LookupTxDurationCache (size, txVector, frequency, mpdutype);
+  if (entry == 0)
+    {
+      double numSymbols;
+      Time duration = CalculatePlcpPreambleAndHeaderDuration (txVector)
+        + DoGetPayloadDuration (size, txVector, frequency, mpdutype, incFlag, numSymbols);
+      return duration;
+    }
+  if (incFlag == 1 && mpdutype == MPDU_IN_AGGREGATE)
+    {
+      m_totalAmpduSize += size;
+      m_totalAmpduNumSymbols += entry->numSymbols;
+    }
+  return entry->preambleAndHeader + entry->payload;
+}
+
+bool
+WifiPhy::TxDurationCacheKey::operator < (const TxDurationCacheKey &o) const
+{
+  if (size != o.size)
+    {
+      return size < o.size;
+    }
+  if (modeUid != o.modeUid)
+    {
+      return modeUid < o.modeUid;
+    }
+  if (frequency != o.frequency)
+    {
+      return frequency < o.frequency;
+    }
+  if (channelWidth != o.channelWidth)
+    {
+      return channelWidth < o.channelWidth;
+    }
+  if (guardInterval != o.guardInterval)
+    {
+      return guardInterval < o.guardInterval;
+    }
+  if (preamble != o.preamble)
+    {
+      return preamble < o.preamble;
+    }
+  if (nss != o.nss)
+    {
+      return nss < o.nss;
+    }
+  if (ness != o.ness)
+    {
+      return ness < o.ness;
+    }
+  if (stbc != o.stbc)
+    {
+      return stbc < o.stbc;
+    }
+  return mpdutype < o.mpdutype;
+}
+
+const WifiPhy::TxDurationCacheEntry *
+WifiPhy::LookupTxDurationCache (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype)
+{
+  //The duration of the last MPDU of an A-MPDU depends on the previous MPDUs
+  if (m_txDurationCacheSize == 0 || mpdutype == LAST_MPDU_IN_AGGREGATE)
+    {
+      return 0;
+    }
+  TxDurationCacheKey key;
+  key.size = size;
+  key.modeUid = txVector.GetMode ().GetUid ();
+  key.frequency = frequency;
+  key.channelWidth = txVector.GetChannelWidth ();
+  key.guardInterval = txVector.GetGuardInterval ();
+  key.preamble = txVector.GetPreambleType ();
+  key.nss = txVector.GetNss ();
+  key.ness = txVector.GetNess ();
+  key.stbc = txVector.IsStbc ();
+  key.mpdutype = mpdutype;
+  TxDurationCache::const_iterator it = m_txDurationCache.find (key);
+  if (it != m_txDurationCache.end ())
+    {
+      m_txDurationCacheHits++;
+      return &it->second;
+    }
+  m_txDurationCacheMisses++;
+  if (m_txDurationCache.size () >= m_txDurationCacheSize)
+    {
+      NS_LOG_DEBUG ("TX duration cache full, flushing " << m_txDurationCache.size () << " entries");
+      m_txDurationCache.clear ();
+    }
+  TxDurationCacheEntry entry;
+  entry.preambleAndHeader = CalculatePlcpPreambleAndHeaderDuration (txVector);
+  entry.payload = DoGetPayloadDuration (size, txVector, frequency, mpdutype, 0, entry.numSymbols);
+  return &m_txDurationCache.insert (std::make_pair (key, entry)).first->second;
+}
+
+double
+WifiPhy::GetTxDurationCacheHitRatio (void) const
+{
+  uint64_t total = m_txDurationCacheHits + m_txDurationCacheMisses;
+  if (total == 0)
+    {
+      return 0;
+    }
+  return static_cast<double> (m_txDurationCacheHits) / total;
+}
+
+void
+WifiPhy::FlushTxDurationCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_txDurationCache.clear ();
 }
 
 Time
@@ -323,6 +323,22 @@ public:
    */
   Time GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag);
 
+  /**
+   * \return the fraction of CalculateTxDuration and GetPayloadDuration
+   *         calls that have been served from the TX duration cache
+   *
+   * Calls for the last MPDU of an A-MPDU are never cached and are not
+   * accounted for. Zero is returned if no cacheable call has been made yet.
+   */
+  double GetTxDurationCacheHitRatio (void) const;
+  /**
+   * Remove all the entries of the TX duration cache. The hit/miss
+   * counters are kept, so that the hit ratio covers the whole run.
+   *
+   * This is called whenever the PHY configuration changes.
+   */
+  void FlushTxDurationCache (void);
+
   /**
    * The WifiPhy::GetNModes() and WifiPhy::GetMode() methods are used
    * (e.g., by a WifiRemoteStationManager) to determine the set of
@@ -1630,6 +1646,69 @@ private:
                 Time rxDuration,
                 Ptr<Event> event);
 
+  /**
+   * Compute the duration of the payload without looking up the TX duration cache.
+   *
+   * \param size the number of bytes in the packet to send
+   * \param txVector the TXVECTOR used for the transmission of this packet
+   * \param frequency the channel center frequency (MHz)
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
+   * \param incFlag this flag is used to indicate that the static variables need to be update or not
+   * \param numSymbols the number of OFDM symbols of the payload (output)
+   *
+   * \return the duration of the payload
+   */
+  Time DoGetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency,
+                             MpduType mpdutype, uint8_t incFlag, double &numSymbols);
+
+  /**
+   * Key of the TX duration cache: all the parameters the durations
+   * returned by CalculateTxDuration and GetPayloadDuration depend on.
+   */
+  struct TxDurationCacheKey
+  {
+    uint32_t size;         ///< the number of bytes in the packet
+    uint32_t modeUid;      ///< the UID of the payload WifiMode
+    uint16_t frequency;    ///< the channel center frequency (MHz)
+    uint16_t channelWidth; ///< the channel width (MHz)
+    uint16_t guardInterval; ///< the guard interval (ns)
+    uint8_t preamble;      ///< the preamble type
+    uint8_t nss;           ///< the number of spatial streams
+    uint8_t ness;          ///< the number of extension spatial streams
+    uint8_t stbc;          ///< whether STBC is used
+    uint8_t mpdutype;      ///< the type of the MPDU
+
+    /**
+     * \param o the other key
+     * \return true if this key sorts before the other key
+     */
+    bool operator < (const TxDurationCacheKey &o) const;
+  };
+
+  /// Value of the TX duration cache
+  struct TxDurationCacheEntry
+  {
+    Time preambleAndHeader; ///< duration of the PLCP preamble and header
+    Time payload;           ///< duration of the payload
+    double numSymbols;      ///< number of payload symbols, needed to update the A-MPDU state
+  };
+
+  /// TX duration cache typedef
+  typedef std::map<TxDurationCacheKey, TxDurationCacheEntry> TxDurationCache;
+
+  /**
+   * Lookup (and fill, on a miss) the TX duration cache.
+   *
+   * \param size the number of bytes in the packet to send
+   * \param txVector the TXVECTOR used for the transmission of this packet
+   * \param frequency the channel center frequency (MHz)
+   * \param mpdutype the type of the MPDU as defined in WifiPhy::MpduType.
+   *
+   * \return the cache entry, or 0 if the durations cannot be cached
+   */
+  const TxDurationCacheEntry * LookupTxDurationCache (uint32_t size, WifiTxVector txVector,
+                                                      uint16_t frequency, MpduType mpdutype);
+
   /**
    * The trace source fired when a packet begins the transmission process on
    * the medium.
@@ -1784,6 +1863,11 @@ private:
   uint32_t m_totalAmpduSize;     //!< Total size of the previously transmitted MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
   double m_totalAmpduNumSymbols; //!< Number of symbols previously transmitted for the MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
 
+  TxDurationCache m_txDurationCache;     //!< cache of TX durations
+  uint32_t m_txDurationCacheSize;        //!< maximum number of entries of the TX duration cache
+  uint64_t m_txDurationCacheHits;        //!< number of TX duration cache hits
+  uint64_t m_txDurationCacheMisses;      //!< number of TX duration cache misses
+
   Ptr<NetDevice>     m_device;   //!< Pointer to the device
   Ptr<MobilityModel> m_mobility; //!< Pointer to the mobility model
 
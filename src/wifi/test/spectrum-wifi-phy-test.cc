@@ -28,6 +28,7 @@
 #include "ns3/wifi-spectrum-signal-parameters.h"
 #include "ns3/wifi-phy-listener.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
 
 using namespace ns3;
 
@@ -308,6 +309,130 @@ SpectrumWifiPhyListenerTest::DoRun (void)
   delete m_listener;
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Spectrum Wifi Phy Tx PSD Test
+ *
+ * The Tx PSDs obtained by scaling the cached templates must be the ones
+ * built from the spectrum masks, for each mask and channel width, and the
+ * PSD reused from the last transmission must follow the Tx power.
+ */
+class SpectrumWifiPhyTxPsdTest : public TestCase
+{
+public:
+  SpectrumWifiPhyTxPsdTest ();
+  virtual ~SpectrumWifiPhyTxPsdTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that two PSDs are equal, to the rounding errors
+   * \param actual the PSD to check
+   * \param expected the expected PSD
+   * \param context description of the PSDs
+   */
+  void CheckPsd (Ptr<const SpectrumValue> actual, Ptr<const SpectrumValue> expected, std::string context);
+};
+
+SpectrumWifiPhyTxPsdTest::SpectrumWifiPhyTxPsdTest ()
+  : TestCase ("SpectrumWifiPhy test of the cached Tx PSDs")
+{
+}
+
+SpectrumWifiPhyTxPsdTest::~SpectrumWifiPhyTxPsdTest ()
+{
+}
+
+void
+SpectrumWifiPhyTxPsdTest::CheckPsd (Ptr<const SpectrumValue> actual, Ptr<const SpectrumValue> expected, std::string context)
+{
+  NS_TEST_ASSERT_MSG_EQ (actual->GetSpectrumModel ()->GetNumBands (), expected->GetSpectrumModel ()->GetNumBands (),
+                         "Wrong number of bands for " << context);
+  NS_TEST_EXPECT_MSG_EQ (actual->GetSpectrumModel ()->GetUid (), expected->GetSpectrumModel ()->GetUid (),
+                         "Wrong spectrum model for " << context);
+  Values::const_iterator a = actual->ConstValuesBegin ();
+  Values::const_iterator e = expected->ConstValuesBegin ();
+  for (uint32_t band = 0; e != expected->ConstValuesEnd (); ++a, ++e, ++band)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (*a, *e, *e * 1e-12, "Wrong value in band " << band << " for " << context);
+    }
+}
+
+void
+SpectrumWifiPhyTxPsdTest::DoRun (void)
+{
+  Ptr<SpectrumWifiPhy> cached = CreateObject<SpectrumWifiPhy> ();
+  cached->SetAttribute ("CacheTxPsd", BooleanValue (true));
+  Ptr<SpectrumWifiPhy> other = CreateObject<SpectrumWifiPhy> ();
+  other->SetAttribute ("CacheTxPsd", BooleanValue (true));
+  Ptr<SpectrumWifiPhy> uncached = CreateObject<SpectrumWifiPhy> ();
+  uncached->SetAttribute ("CacheTxPsd", BooleanValue (false));
+
+  struct
+  {
+    uint16_t frequency;
+    uint16_t width;
+    WifiModulationClass modulation;
+  } channels[] = {
+    { 2412, 22, WIFI_MOD_CLASS_DSSS },
+    { 2412, 22, WIFI_MOD_CLASS_HR_DSSS },
+    { 2412, 20, WIFI_MOD_CLASS_ERP_OFDM },
+    { 5180, 20, WIFI_MOD_CLASS_OFDM },
+    { 5180, 20, WIFI_MOD_CLASS_HT },
+    { 5190, 40, WIFI_MOD_CLASS_HT },
+    { 5180, 20, WIFI_MOD_CLASS_VHT },
+    { 5190, 40, WIFI_MOD_CLASS_VHT },
+    { 5210, 80, WIFI_MOD_CLASS_VHT },
+    { 5250, 160, WIFI_MOD_CLASS_VHT },
+    { 5180, 20, WIFI_MOD_CLASS_HE },
+    { 5190, 40, WIFI_MOD_CLASS_HE },
+    { 5210, 80, WIFI_MOD_CLASS_HE },
+    { 5250, 160, WIFI_MOD_CLASS_HE },
+  };
+  // the same power twice, to reuse the last PSD, then other powers
+  double txPowersW[] = { 0.01, 0.01, 0.1, 0.02, 0.02 };
+
+  for (uint32_t i = 0; i < sizeof (channels) / sizeof (channels[0]); i++)
+    {
+      Ptr<SpectrumValue> previous;
+      double previousTxPowerW = 0;
+      for (uint32_t j = 0; j < sizeof (txPowersW) / sizeof (txPowersW[0]); j++)
+        {
+          std::ostringstream oss;
+          oss << channels[i].frequency << " MHz, " << channels[i].width << " MHz, modulation "
+              << channels[i].modulation << ", " << txPowersW[j] << " W";
+          Ptr<SpectrumValue> expected = uncached->GetTxPowerSpectralDensity (channels[i].frequency, channels[i].width,
+                                                                             txPowersW[j], channels[i].modulation);
+          CheckPsd (expected, uncached->CreateTxPowerSpectralDensity (channels[i].frequency, channels[i].width,
+                                                                      txPowersW[j], channels[i].modulation), oss.str ());
+          // another phy sharing the templates transmits in between with a different power
+          other->GetTxPowerSpectralDensity (channels[i].frequency, channels[i].width, 2 * txPowersW[j], channels[i].modulation);
+          Ptr<SpectrumValue> psd = cached->GetTxPowerSpectralDensity (channels[i].frequency, channels[i].width,
+                                                                      txPowersW[j], channels[i].modulation);
+          CheckPsd (psd, expected, oss.str ());
+          if (previous != 0 && previousTxPowerW != txPowersW[j])
+            {
+              NS_TEST_EXPECT_MSG_NE (psd, previous, "Stale PSD returned for " << oss.str ());
+            }
+          if (previous != 0)
+            {
+              // the PSD handed out before is not modified
+              CheckPsd (previous, uncached->CreateTxPowerSpectralDensity (channels[i].frequency, channels[i].width,
+                                                                          previousTxPowerW, channels[i].modulation),
+                        "the previous PSD of " + oss.str ());
+            }
+          previous = psd;
+          previousTxPowerW = txPowersW[j];
+        }
+    }
+
+  cached->Dispose ();
+  other->Dispose ();
+  uncached->Dispose ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -325,6 +450,7 @@ SpectrumWifiPhyTestSuite::SpectrumWifiPhyTestSuite ()
 {
   AddTestCase (new SpectrumWifiPhyBasicTest, TestCase::QUICK);
   AddTestCase (new SpectrumWifiPhyListenerTest, TestCase::QUICK);
+  AddTestCase (new SpectrumWifiPhyTxPsdTest, TestCase::QUICK);
 }
 
 static SpectrumWifiPhyTestSuite spectrumWifiPhyTestSuite; ///< the test suite
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/yans-wifi-phy.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -426,6 +427,121 @@ TxDurationTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "an 802.11ax duration failed");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Tx Duration Cache Test
+ *
+ * Check that the durations served from the TX duration cache match
+ * those computed by a PHY whose cache is disabled, including the
+ * A-MPDU accounting done when incFlag is set.
+ */
+class TxDurationCacheTest : public TestCase
+{
+public:
+  TxDurationCacheTest ();
+  virtual ~TxDurationCacheTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Transmit an A-MPDU made of the given number of MPDUs on both PHYs
+   * and check that the durations are the same.
+   *
+   * \param cached the PHY whose TX duration cache is enabled
+   * \param uncached the PHY whose TX duration cache is disabled
+   * \param txVector the TXVECTOR used for the transmission
+   * \param size the size of each MPDU
+   * \param nMpdus the number of MPDUs in the A-MPDU
+   */
+  void CheckAmpdu (Ptr<WifiPhy> cached, Ptr<WifiPhy> uncached, WifiTxVector txVector, uint32_t size, uint8_t nMpdus);
+};
+
+TxDurationCacheTest::TxDurationCacheTest ()
+  : TestCase ("Wifi TX Duration cache")
+{
+}
+
+TxDurationCacheTest::~TxDurationCacheTest ()
+{
+}
+
+void
+TxDurationCacheTest::CheckAmpdu (Ptr<WifiPhy> cached, Ptr<WifiPhy> uncached, WifiTxVector txVector, uint32_t size, uint8_t nMpdus)
+{
+  WifiPreamble preamble = txVector.GetPreambleType ();
+  for (uint8_t i = 0; i < nMpdus; i++)
+    {
+      MpduType type = (i == nMpdus - 1) ? LAST_MPDU_IN_AGGREGATE : MPDU_IN_AGGREGATE;
+      txVector.SetPreambleType (i == 0 ? preamble : WIFI_PREAMBLE_NONE);
+      //the MAC first computes the duration without updating the A-MPDU state
+      NS_TEST_EXPECT_MSG_EQ (cached->CalculateTxDuration (size, txVector, CHANNEL_36_MHZ, type, 0),
+                             uncached->CalculateTxDuration (size, txVector, CHANNEL_36_MHZ, type, 0),
+                             "TX durations differ for MPDU " << +i);
+      NS_TEST_EXPECT_MSG_EQ (cached->CalculateTxDuration (size, txVector, CHANNEL_36_MHZ, type, 1),
+                             uncached->CalculateTxDuration (size, txVector, CHANNEL_36_MHZ, type, 1),
+                             "TX durations differ for MPDU " << +i);
+    }
+}
+
+void
+TxDurationCacheTest::DoRun (void)
+{
+  Ptr<YansWifiPhy> cached = CreateObject<YansWifiPhy> ();
+  Ptr<YansWifiPhy> uncached = CreateObject<YansWifiPhy> ();
+  uncached->SetAttribute ("TxDurationCacheSize", UintegerValue (0));
+  NS_TEST_EXPECT_MSG_EQ (cached->GetTxDurationCacheHitRatio (), 0, "hit ratio should be zero before any lookup");
+
+  WifiMode modes[] = {WifiPhy::GetOfdmRate6Mbps (), WifiPhy::GetOfdmRate54Mbps (),
+                      WifiPhy::GetHtMcs7 (), WifiPhy::GetVhtMcs9 (), WifiPhy::GetHeMcs11 ()};
+  WifiPreamble preambles[] = {WIFI_PREAMBLE_LONG, WIFI_PREAMBLE_LONG,
+                              WIFI_PREAMBLE_HT_MF, WIFI_PREAMBLE_VHT, WIFI_PREAMBLE_HE_SU};
+  uint16_t gis[] = {800, 800, 400, 400, 1600};
+  uint32_t sizes[] = {14, 76, 1536};
+  for (uint8_t round = 0; round < 2; round++)
+    {
+      for (uint8_t m = 0; m < 5; m++)
+        {
+          WifiTxVector txVector;
+          txVector.SetMode (modes[m]);
+          txVector.SetPreambleType (preambles[m]);
+          txVector.SetChannelWidth (m < 2 ? 20 : 40);
+          txVector.SetGuardInterval (gis[m]);
+          txVector.SetNss (1);
+          txVector.SetStbc (0);
+          txVector.SetNess (0);
+          for (uint8_t i = 0; i < 3; i++)
+            {
+              NS_TEST_EXPECT_MSG_EQ (cached->CalculateTxDuration (sizes[i], txVector, CHANNEL_36_MHZ),
+                                     uncached->CalculateTxDuration (sizes[i], txVector, CHANNEL_36_MHZ),
+                                     "TX durations differ for mode " << modes[m]);
+              NS_TEST_EXPECT_MSG_EQ (cached->GetPayloadDuration (sizes[i], txVector, CHANNEL_1_MHZ),
+                                     uncached->GetPayloadDuration (sizes[i], txVector, CHANNEL_1_MHZ),
+                                     "payload durations differ for mode " << modes[m]);
+            }
+          if (m >= 2)
+            {
+              CheckAmpdu (cached, uncached, txVector, 1536, 4);
+            }
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (cached->GetTxDurationCacheHitRatio (), 0.5, "second round should be served from the cache");
+  NS_TEST_EXPECT_MSG_EQ (uncached->GetTxDurationCacheHitRatio (), 0, "disabled cache should never hit");
+
+  double ratio = cached->GetTxDurationCacheHitRatio ();
+  cached->SetGuardInterval (NanoSeconds (800));
+  NS_TEST_EXPECT_MSG_EQ (cached->GetTxDurationCacheHitRatio (), ratio, "configuration change should keep the hit/miss counters");
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
+  txVector.SetChannelWidth (20);
+  txVector.SetGuardInterval (800);
+  txVector.SetNss (1);
+  cached->CalculateTxDuration (sizes[0], txVector, CHANNEL_36_MHZ);
+  NS_TEST_EXPECT_MSG_LT (cached->GetTxDurationCacheHitRatio (), ratio, "configuration change should flush the cached durations");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -442,6 +558,7 @@ TxDurationTestSuite::TxDurationTestSuite ()
   : TestSuite ("devices-wifi-tx-duration", UNIT)
 {
   AddTestCase (new TxDurationTest, TestCase::QUICK);
+  AddTestCase (new TxDurationCacheTest, TestCase::QUICK);
 }
 
 static TxDurationTestSuite g_txDurationTestSuite; ///< the test suite
@@ -43,6 +43,8 @@
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/qos-blocked-destinations.h"
 
 using namespace ns3;
 
@@ -237,6 +239,154 @@ public:
 };
 
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that the per receiver/TID lookups of the WifiMacQueue
+ * return the same items as a FIFO scan of the queue
+ */
+class WifiMacQueueIndexTest : public TestCase
+{
+public:
+  WifiMacQueueIndexTest () : TestCase ("WifiMacQueue per receiver and TID index")
+  {
+  }
+
+private:
+  /**
+   * Enqueue a frame
+   * \param queue the queue
+   * \param addr1 the receiver address
+   * \param tid the TID, or -1 for a non-QoS data frame
+   * \param front whether to enqueue the frame at the head of the queue
+   * \return the packet enqueued
+   */
+  Ptr<Packet> Add (Ptr<WifiMacQueue> queue, Mac48Address addr1, int tid, bool front = false)
+  {
+    WifiMacHeader hdr;
+    if (tid < 0)
+      {
+        hdr.SetType (WIFI_MAC_DATA);
+      }
+    else
+      {
+        hdr.SetType (WIFI_MAC_QOSDATA);
+        hdr.SetQosTid (static_cast<uint8_t> (tid));
+      }
+    hdr.SetAddr1 (addr1);
+    Ptr<Packet> pkt = Create<Packet> (100);
+    if (front)
+      {
+        queue->PushFront (Create<WifiMacQueueItem> (pkt, hdr));
+      }
+    else
+      {
+        queue->Enqueue (Create<WifiMacQueueItem> (pkt, hdr));
+      }
+    return pkt;
+  }
+
+  /**
+   * Enqueue a QoS data frame and remember it
+   * \param queue the queue
+   * \param addr1 the receiver address
+   */
+  void AddFresh (Ptr<WifiMacQueue> queue, Mac48Address addr1)
+  {
+    m_fresh = Add (queue, addr1, 0);
+  }
+
+  Ptr<Packet> m_fresh; ///< the last packet enqueued by AddFresh
+
+  virtual void DoRun (void)
+  {
+    Ptr<WifiMacQueue> queue = CreateObject<WifiMacQueue> ();
+    queue->SetMaxSize (QueueSize ("100p"));
+    queue->SetMaxDelay (MilliSeconds (10));
+    Mac48Address a ("00:00:00:00:00:01");
+    Mac48Address b ("00:00:00:00:00:02");
+
+    Ptr<Packet> a0first = Add (queue, a, 0);
+    Ptr<Packet> b0 = Add (queue, b, 0);
+    Ptr<Packet> a1 = Add (queue, a, 1);
+    Ptr<Packet> a0second = Add (queue, a, 0);
+    Ptr<Packet> aNonQos = Add (queue, a, -1);
+    Ptr<Packet> b0front = Add (queue, b, 0, true);
+
+    NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (0, a), 2, "wrong number of packets for (a, 0)");
+    NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (0, b), 2, "wrong number of packets for (b, 0)");
+    NS_TEST_EXPECT_MSG_EQ (queue->PeekByTidAndAddress (0, WifiMacHeader::ADDR1, b)->GetPacket (), b0front,
+                           "the packet pushed at the front should be the first one for (b, 0)");
+    NS_TEST_EXPECT_MSG_EQ (queue->PeekByTidAndAddress (2, WifiMacHeader::ADDR1, a), 0, "no packet for (a, 2)");
+
+    Ptr<QosBlockedDestinations> blocked = Create<QosBlockedDestinations> ();
+    NS_TEST_EXPECT_MSG_EQ (queue->PeekFirstAvailable (blocked)->GetPacket (), b0front, "wrong first available packet");
+    blocked->Block (b, 0);
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), a0first, "wrong first available packet");
+    blocked->Block (a, 0);
+    blocked->Block (a, 1);
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), aNonQos,
+                           "non-QoS frames should never be blocked");
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked), 0, "all the remaining packets are blocked");
+
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueByTidAndAddress (0, WifiMacHeader::ADDR1, a)->GetPacket (), a0second,
+                           "wrong packet for (a, 0)");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue ()->GetPacket (), b0front, "FIFO order not preserved");
+    NS_TEST_EXPECT_MSG_EQ (queue->Remove (a1), true, "packet should be found in the queue");
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueByTidAndAddress (1, WifiMacHeader::ADDR1, a), 0, "no packet for (a, 1)");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue ()->GetPacket (), b0, "FIFO order not preserved");
+    NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "queue should be empty");
+
+    Add (queue, a, 0);
+    Add (queue, a, 0);
+    Simulator::Schedule (MilliSeconds (20), &WifiMacQueueIndexTest::AddFresh, this, queue, b);
+    Simulator::Schedule (MilliSeconds (20), &WifiMacQueueIndexTest::AddFresh, this, queue, a);
+    Simulator::Run ();
+    NS_TEST_EXPECT_MSG_EQ (queue->GetNPacketsByTidAndAddress (0, a), 1, "stale packets should not be counted");
+    NS_TEST_EXPECT_MSG_EQ (queue->PeekByTidAndAddress (0, WifiMacHeader::ADDR1, a)->GetPacket (), m_fresh,
+                           "stale packets should be skipped");
+    NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 2, "stale packets should have been removed");
+    Simulator::Destroy ();
+
+    // the first item of every receiver/TID is kept in queue order, also when
+    // the receivers are emptied and refilled
+    queue = CreateObject<WifiMacQueue> ();
+    queue->SetMaxSize (QueueSize ("100p"));
+    std::vector<Mac48Address> receivers;
+    std::vector<Ptr<Packet> > packets;
+    for (uint8_t i = 0; i < 10; i++)
+      {
+        receivers.push_back (Mac48Address::Allocate ());
+        packets.push_back (Add (queue, receivers[i], 0));
+      }
+    for (uint8_t i = 0; i < 10; i += 2)
+      {
+        NS_TEST_EXPECT_MSG_EQ (queue->DequeueByTidAndAddress (0, WifiMacHeader::ADDR1, receivers[i])->GetPacket (),
+                               packets[i], "wrong packet for receiver " << +i);
+      }
+    blocked = Create<QosBlockedDestinations> ();
+    blocked->Block (receivers[1], 0);
+    blocked->Block (receivers[3], 0);
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), packets[5], "wrong first available packet");
+    Ptr<Packet> r0 = Add (queue, receivers[0], 0);
+    Ptr<Packet> r3front = Add (queue, receivers[3], 0, true);
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), packets[7], "wrong first available packet");
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), packets[9], "wrong first available packet");
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), r0,
+                           "a refilled receiver should be served after the older items");
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked), 0, "all the remaining packets are blocked");
+    blocked->Unblock (receivers[3], 0);
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), r3front,
+                           "the packet pushed at the front should be the first one");
+    blocked->Unblock (receivers[1], 0);
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), packets[1], "wrong first available packet");
+    NS_TEST_EXPECT_MSG_EQ (queue->DequeueFirstAvailable (blocked)->GetPacket (), packets[3], "wrong first available packet");
+    NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "queue should be empty");
+  }
+};
+
+
 /**
  * See \bugid{991}
  */
@@ -1707,6 +1857,7 @@ WifiTestSuite::WifiTestSuite ()
 {
   AddTestCase (new WifiTest, TestCase::QUICK);
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueIndexTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); //Bug 991
   AddTestCase (new DcfImmediateAccessBroadcastTestCase, TestCase::QUICK);
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
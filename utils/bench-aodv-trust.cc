@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the trust path of AODV.
+//
+// A SimpleAodvTrustHandler observes 'n' AODV messages (RREQs and RREPs)
+// sent by 'nNeighbours' neighbours, and recomputes the trust values of
+// all the neighbours 'nRecomputes' times in between.  The program prints
+// the wall clock time spent observing the messages and recomputing the
+// trust values.
+// Sample usage:  ./waf --run 'bench-aodv-trust --nNeighbours=5000 --n=1000000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/aodv-helper.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/aodv-routing-protocol.h"
+#include "ns3/simple-aodv-trust-handler.h"
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * Build an AODV message as seen by a promiscuous callback.
+ *
+ * \param source the IPv4 address of the sender
+ * \param type the AODV message type
+ * \returns the packet
+ */
+static Ptr<Packet>
+CreateAodvPacket (Ipv4Address source, aodv::MessageType type)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  if (type == aodv::AODVTYPE_RREQ)
+    {
+      packet->AddHeader (aodv::RreqHeader (0, 0, 1, 1, Ipv4Address ("10.255.255.254"), 0, source, 1));
+    }
+  else
+    {
+      packet->AddHeader (aodv::RrepHeader (0, 1, Ipv4Address ("10.255.255.254"), 1, source));
+    }
+  packet->AddHeader (aodv::TypeHeader (type));
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (aodv::RoutingProtocol::AODV_PORT);
+  udpHeader.SetDestinationPort (aodv::RoutingProtocol::AODV_PORT);
+  packet->AddHeader (udpHeader);
+  Ipv4Header ipv4Header;
+  ipv4Header.SetSource (source);
+  ipv4Header.SetDestination (Ipv4Address ("10.255.255.255"));
+  ipv4Header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ipv4Header.SetPayloadSize (packet->GetSize ());
+  packet->AddHeader (ipv4Header);
+  return packet;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nNeighbours = 1000;
+  uint32_t n = 100000;
+  uint32_t nRecomputes = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("nNeighbours", "Number of neighbours observed", nNeighbours);
+  cmd.AddValue ("n", "Number of AODV messages observed", n);
+  cmd.AddValue ("nRecomputes", "Number of recomputations of all the trust values", nRecomputes);
+  cmd.Parse (argc, argv);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  AodvHelper aodv;
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (aodv);
+  internet.Install (node);
+
+  Ptr<aodv::SimpleAodvTrustHandler> handler = CreateObject<aodv::SimpleAodvTrustHandler> ();
+  node->AggregateObject (handler);
+
+  // one RREQ and one RREP per neighbour, reused for every message
+  std::vector<Ptr<Packet> > packets;
+  Ipv4Address base ("10.0.0.1");
+  for (uint32_t i = 0; i < nNeighbours; i++)
+    {
+      Ipv4Address source (base.Get () + i);
+      packets.push_back (CreateAodvPacket (source, aodv::AODVTYPE_RREQ));
+      packets.push_back (CreateAodvPacket (source, aodv::AODVTYPE_RREP));
+    }
+
+  Ptr<NetDevice> device = node->GetDevice (0);
+  Mac48Address mac;
+  uint32_t perRound = nRecomputes > 0 ? n / nRecomputes : n;
+  int64_t observeMs = 0;
+  int64_t recomputeMs = 0;
+  SystemWallClockMs clock;
+  uint32_t observed = 0;
+  while (observed < n)
+    {
+      clock.Start ();
+      for (uint32_t i = 0; i < perRound && observed < n; i++, observed++)
+        {
+          handler->OnReceivePromiscuousCallback (device, packets[observed % packets.size ()],
+                                                 Ipv4L3Protocol::PROT_NUMBER, mac, mac,
+                                                 NetDevice::PACKET_OTHERHOST);
+        }
+      observeMs += clock.End ();
+      if (nRecomputes > 0)
+        {
+          clock.Start ();
+          handler->RecomputeTrust ();
+          recomputeMs += clock.End ();
+        }
+    }
+
+  Ipv4TrustEntry entry;
+  handler->GetTrustTable ().LookupTrustEntry (base, entry);
+  std::cout << nNeighbours << " neighbours, " << n << " messages: "
+            << observeMs << " ms observing ("
+            << (n > 0 ? observeMs * 1e6 / n : 0) << " ns/message), "
+            << recomputeMs << " ms recomputing trust, trust of "
+            << base << " = " << entry.GetTrustValue () << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the IPv4 forwarding path.
+//
+// Two hosts are linked through a chain of 'nRouters' routers by
+// SimpleNetDevices, with static routes.  The first host sends 'n' UDP
+// packets to the second one, each of them being forwarded by every router.
+// The program prints the wall clock time of the simulation divided by the
+// number of packets forwarded by the routers.
+// Sample usage:  ./waf --run 'bench-router-chain --nRouters=16 --n=100000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include <iostream>
+
+using namespace ns3;
+
+static uint64_t g_rxPackets = 0; //!< Packets received by the sink
+
+/**
+ * Count the packets received by the sink.
+ *
+ * \param socket the socket
+ */
+static void
+Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_rxPackets++;
+    }
+}
+
+/**
+ * Send a packet and schedule the next one.
+ *
+ * \param socket the socket
+ * \param size the size of the packets
+ * \param left the number of packets left to send
+ * \param interval the interval between packets
+ */
+static void
+SendPacket (Ptr<Socket> socket, uint32_t size, uint32_t left, Time interval)
+{
+  socket->Send (Create<Packet> (size));
+  if (left > 1)
+    {
+      Simulator::Schedule (interval, &SendPacket, socket, size, left - 1, interval);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nRouters = 8;
+  uint32_t n = 10000;
+  uint32_t size = 1000;
+  std::string interval = "10us";
+
+  CommandLine cmd;
+  cmd.AddValue ("nRouters", "Number of routers between the hosts", nRouters);
+  cmd.AddValue ("n", "Number of packets sent", n);
+  cmd.AddValue ("size", "Size of the UDP payload (bytes)", size);
+  cmd.AddValue ("interval", "Interval between the packets", interval);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (nRouters + 2);
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper link;
+  link.SetNetDevicePointToPointMode (true);
+  link.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  link.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1)));
+
+  // link i connects node i (interface 1, or 2 for the routers) to
+  // node i + 1 (interface 1)
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  std::vector<Ipv4InterfaceContainer> links;
+  for (uint32_t i = 0; i < nRouters + 1; i++)
+    {
+      NetDeviceContainer devices = link.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 1)));
+      links.push_back (ipv4.Assign (devices));
+      ipv4.NewNetwork ();
+    }
+
+  // every node sends the packets towards the sink to its right neighbor,
+  // and the other packets to its left neighbor
+  Ipv4StaticRoutingHelper staticRouting;
+  Ipv4Address sinkAddress = links[nRouters].GetAddress (1);
+  for (uint32_t i = 0; i < nRouters + 2; i++)
+    {
+      Ptr<Ipv4StaticRouting> routing = staticRouting.GetStaticRouting (nodes.Get (i)->GetObject<Ipv4> ());
+      if (i < nRouters + 1)
+        {
+          uint32_t interface = (i == 0) ? 1 : 2;
+          routing->AddHostRouteTo (sinkAddress, links[i].GetAddress (1), interface);
+        }
+      if (i > 0)
+        {
+          routing->SetDefaultRoute (links[i - 1].GetAddress (0), 1);
+        }
+    }
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (nRouters + 1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&Receive));
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  source->Connect (InetSocketAddress (sinkAddress, 9));
+  Simulator::Schedule (MilliSeconds (1), &SendPacket, source, size, n, Time (interval));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+  Simulator::Destroy ();
+
+  uint64_t forwarded = g_rxPackets * nRouters;
+  std::cout << nRouters << " routers: " << elapsed << " ms, "
+            << g_rxPackets << " packets received, "
+            << forwarded << " packets forwarded";
+  if (forwarded > 0)
+    {
+      std::cout << ", " << elapsed * 1e6 / forwarded << " ns/forwarded packet";
+    }
+  std::cout << std::endl;
+  return 0;
+}